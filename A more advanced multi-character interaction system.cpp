@@ -1,104 +1,488 @@
 #include <iostream>
+#include <string>
+#include <string_view>
 #include <vector>
+#include <map>
 #include <memory>
+#include <random>
+#include <variant>
+#include <iterator>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
 
-// 基础对话组件
-class DialogueComponent {
-public:
-    virtual std::string getLine() = 0;
-    virtual ~DialogueComponent() {}
-};
+// 统计全局 operator new 的调用次数，--alloc-check 用它检查广播时是否分配内存
+static std::atomic<uint64_t> g_allocationCount{0};
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+// 替换的 new/delete 与使用处在同一文件中，内联后 GCC 会误报 malloc/free 与 new/delete 不匹配
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static void* countedAllocate(std::size_t size) {
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = countedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
 
-// 可爱语气组件
-class CuteToneComponent : public DialogueComponent {
+// 事件ID：事件名只在建场景时查一次表，之后都用整数分发
+using EventId = uint16_t;
+
+class EventTable {
 private:
-    std::vector<std::string> cuteSuffixes = {"~", "喵", "呢", "哦", "呀"};
-    
+    std::map<std::string, EventId, std::less<>> ids;
+    std::vector<std::string_view> names;
+
 public:
-    std::string addCuteTone(const std::string& line) {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, cuteSuffixes.size() - 1);
-        
-        return line + cuteSuffixes[dis(gen)];
+    EventId intern(std::string_view name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        EventId id = static_cast<EventId>(names.size());
+        auto inserted = ids.emplace(std::string(name), id).first;
+        names.push_back(inserted->first);
+        return id;
     }
-    
-    std::string getLine() override {
-        return "";
+
+    std::string_view nameOf(EventId id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+};
+
+// 可爱语气组件：句尾随机加一个语气词
+struct CuteToneComponent {
+    static constexpr std::string_view suffixes[] = {"~", "喵", "呢", "哦", "呀"};
+
+    void before(std::string_view, std::string&, std::mt19937&) const {}
+
+    void after(std::string_view, std::string& out, std::mt19937& rng) const {
+        std::uniform_int_distribution<size_t> dis(0, std::size(suffixes) - 1);
+        out.append(suffixes[dis(rng)]);
     }
 };
 
-// 具体角色
+// 说话组件：不用虚函数，按值存放，整条流水线一次遍历；新的语气组件加到这里
+using DialogueComponent = std::variant<CuteToneComponent>;
+
+// 对某个事件的反应
+struct Reaction {
+    std::string_view line;         // 空表示没有专门的反应
+    std::string_view repeatLine;   // 再次遇到同一事件时说的话，可为空
+    int moodDelta = 0;
+    int minMood = 0;               // 心情低于此值时改用默认反应
+};
+
+// 角色：由组件列表和反应表组成，所有输出写入调用者提供的缓冲区
 class KawaiiCharacter {
-protected:
+private:
     std::string name;
-    std::unique_ptr<CuteToneComponent> toneComponent;
-    
+    std::vector<DialogueComponent> components;
+    std::vector<Reaction> reactions;  // 下标为 EventId
+    std::vector<uint16_t> memory;     // 每种事件经历过的次数
+    std::string_view introduction;
+    std::string_view defaultReaction;
+    int mood;
+    std::mt19937 rng;
+
 public:
-    KawaiiCharacter(const std::string& name) : name(name) {
-        toneComponent = std::make_unique<CuteToneComponent>();
+    KawaiiCharacter(const std::string& name, uint32_t seed = std::random_device{}())
+        : name(name), mood(50), rng(seed) {}
+
+    KawaiiCharacter& addComponent(DialogueComponent component) {
+        components.push_back(std::move(component));
+        return *this;
+    }
+
+    KawaiiCharacter& setIntroduction(std::string_view line) {
+        introduction = line;
+        return *this;
+    }
+
+    KawaiiCharacter& setDefaultReaction(std::string_view line) {
+        defaultReaction = line;
+        return *this;
+    }
+
+    KawaiiCharacter& addReaction(EventId event, std::string_view line, int moodDelta = 0) {
+        if (event >= reactions.size()) reactions.resize(event + 1);
+        reactions[event].line = line;
+        reactions[event].moodDelta = moodDelta;
+        return *this;
+    }
+
+    KawaiiCharacter& addReaction(EventId event, const Reaction& reaction) {
+        if (event >= reactions.size()) reactions.resize(event + 1);
+        reactions[event] = reaction;
+        return *this;
+    }
+
+    // 场景开始前按事件总数预留记忆，之后反应时不再分配内存
+    void prepareForEvents(size_t eventCount) {
+        if (memory.size() < eventCount) memory.resize(eventCount, 0);
+    }
+
+    bool handles(EventId event) const {
+        return event < reactions.size() && !reactions[event].line.empty();
+    }
+
+    bool hasDefaultReaction() const {
+        return !defaultReaction.empty();
     }
-    
-    virtual std::string introduce() = 0;
-    virtual std::string reactTo(const std::string& event) = 0;
-    
-    std::string speak(const std::string& text) {
-        return name + ": \"" + toneComponent->addCuteTone(text) + "\"";
+
+    // 输出格式：名字: "台词"，out 会先被清空，容量足够时不会分配内存
+    void speak(std::string_view text, std::string& out) {
+        out.clear();
+        out.append(name);
+        out.append(": \"");
+        for (const DialogueComponent& component : components) {
+            std::visit([&](const auto& c) { c.before(text, out, rng); }, component);
+        }
+        out.append(text);
+        for (const DialogueComponent& component : components) {
+            std::visit([&](const auto& c) { c.after(text, out, rng); }, component);
+        }
+        out.push_back('"');
     }
+
+    void introduce(std::string& out) {
+        speak(introduction, out);
+    }
+
+    void reactTo(EventId event, std::string& out) {
+        if (!handles(event)) {
+            speak(defaultReaction, out);
+            return;
+        }
+
+        const Reaction& reaction = reactions[event];
+        uint16_t seen = event < memory.size() ? memory[event] : 0;
+        if (event < memory.size() && seen < UINT16_MAX) ++memory[event];
+
+        if (mood < reaction.minMood) {
+            speak(defaultReaction, out);
+            return;
+        }
+        mood = std::clamp(mood + reaction.moodDelta, 0, 100);
+        speak(seen > 0 && !reaction.repeatLine.empty() ? reaction.repeatLine : reaction.line, out);
+    }
+
+    const std::string& getName() const { return name; }
+    int getMood() const { return mood; }
 };
 
 // 示例角色：魔法少女
-class MagicalGirl : public KawaiiCharacter {
+std::unique_ptr<KawaiiCharacter> createMagicalGirl(EventTable& events) {
+    auto character = std::make_unique<KawaiiCharacter>("小樱");
+    character->addComponent(CuteToneComponent{})
+             .setIntroduction("我是魔法少女小樱！爱与正义的使者！")
+             .addReaction(events.intern("战斗"), "以月亮的名义，我要消灭你！")
+             .addReaction(events.intern("美食"), "草莓蛋糕！我最喜欢了！")
+             .setDefaultReaction("唔... 有点困惑呢");
+    return character;
+}
+
+// 示例角色：小精灵
+std::unique_ptr<KawaiiCharacter> createFairy(EventTable& events) {
+    auto character = std::make_unique<KawaiiCharacter>("皮皮");
+    character->addComponent(CuteToneComponent{})
+             .setIntroduction("我是森林的小精灵，会发光的那种哦！")
+             .addReaction(events.intern("森林"), "听！是风的声音，还有鸟儿的歌唱！")
+             .addReaction(events.intern("魔法"), "让我为你施展一个小小的祝福魔法吧！")
+             .setDefaultReaction("（快乐地转圈圈）");
+    return character;
+}
+
+// 工作窃取线程池：每个线程有自己的任务队列，空闲时从别人队列的另一端偷任务
+class WorkStealingPool {
+private:
+    struct Range {
+        size_t begin;
+        size_t end;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::vector<Range> ranges;
+        size_t head = 0;  // 偷取端，所有者从尾部取
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;  // 0号队列属于调用 parallelFor 的线程
+    std::vector<std::thread> threads;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    bool stopping = false;
+    std::atomic<size_t> remaining{0};
+    const std::function<void(size_t, size_t)>* body = nullptr;
+
+    bool popLocal(size_t self, Range& range) {
+        WorkerQueue& queue = *queues[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.ranges.size() == queue.head) return false;
+        range = queue.ranges.back();
+        queue.ranges.pop_back();
+        return true;
+    }
+
+    bool steal(size_t self, Range& range) {
+        for (size_t i = 1; i < queues.size(); ++i) {
+            WorkerQueue& victim = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.ranges.size() > victim.head) {
+                range = victim.ranges[victim.head++];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void runTasks(size_t self) {
+        Range range;
+        while (popLocal(self, range) || steal(self, range)) {
+            (*body)(range.begin, range.end);
+            if (remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    void workerLoop(size_t self) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            runTasks(self);
+        }
+    }
+
 public:
-    MagicalGirl() : KawaiiCharacter("小樱") {}
-    
-    std::string introduce() override {
-        return speak("我是魔法少女小樱！爱与正义的使者！");
+    explicit WorkStealingPool(size_t threadCount = std::thread::hardware_concurrency()) {
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t i = 0; i < threadCount; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (size_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
     }
-    
-    std::string reactTo(const std::string& event) override {
-        if (event == "战斗") {
-            return speak("以月亮的名义，我要消灭你！");
-        } else if (event == "美食") {
-            return speak("草莓蛋糕！我最喜欢了！");
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
         }
-        return speak("唔... 有点困惑呢");
+        wake.notify_all();
+        for (std::thread& thread : threads) thread.join();
+    }
+
+    size_t threadCount() const { return queues.size(); }
+
+    // 把 [0, count) 切成每块 grain 个元素分给各线程，调用线程也参与，全部完成后返回
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+        grain = std::max<size_t>(grain, 1);
+        if (count <= grain || queues.size() == 1) {
+            if (count > 0) fn(0, count);
+            return;
+        }
+
+        size_t chunks = (count + grain - 1) / grain;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            body = &fn;
+            remaining = chunks;
+            for (auto& queue : queues) {
+                std::lock_guard<std::mutex> queueLock(queue->mutex);
+                queue->ranges.clear();
+                queue->head = 0;
+            }
+            for (size_t c = 0; c < chunks; ++c) {
+                WorkerQueue& queue = *queues[c % queues.size()];
+                std::lock_guard<std::mutex> queueLock(queue.mutex);
+                queue.ranges.push_back({c * grain, std::min(count, (c + 1) * grain)});
+            }
+            ++generation;
+        }
+        wake.notify_all();
+
+        runTasks(0);
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        done.wait(lock, [&] { return remaining.load() == 0; });
     }
 };
 
-// 示例角色：小精灵
-class Fairy : public KawaiiCharacter {
+// 场景事件分发器：每种事件只分发给订阅了它的角色，
+// 反应在线程池上并行计算，结果按演员表顺序收集。
+// 角色只订阅自己处理的事件；默认反应不算订阅，只在 broadcastWithFallback 中另走一条路径
+class SceneEventDispatcher {
+private:
+    WorkStealingPool& pool;
+    std::vector<KawaiiCharacter*> cast;
+    std::vector<std::vector<uint32_t>> listeners;  // 下标为 EventId，按演员表顺序
+    std::vector<uint32_t> fallbacks;               // 有默认反应的角色，按演员表顺序
+    std::vector<std::string> outputs;              // 每个角色一个输出缓冲区，反复复用
+    EventId currentEvent = 0;
+    std::function<void(size_t, size_t)> task;
+
 public:
-    Fairy() : KawaiiCharacter("皮皮") {}
-    
-    std::string introduce() override {
-        return speak("我是森林的小精灵，会发光的那种哦！");
+    explicit SceneEventDispatcher(WorkStealingPool& pool) : pool(pool) {
+        task = [this](size_t begin, size_t end) {
+            const std::vector<uint32_t>& list = listeners[currentEvent];
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t member = list[i];
+                cast[member]->reactTo(currentEvent, outputs[member]);
+            }
+        };
+    }
+
+    // 演员表或事件表变化后调用一次
+    void setCast(const std::vector<std::unique_ptr<KawaiiCharacter>>& characters, const EventTable& events) {
+        cast.clear();
+        listeners.assign(events.size(), {});
+        fallbacks.clear();
+        outputs.resize(characters.size());
+        for (uint32_t member = 0; member < characters.size(); ++member) {
+            KawaiiCharacter* character = characters[member].get();
+            character->prepareForEvents(events.size());
+            cast.push_back(character);
+            outputs[member].reserve(256);
+            for (EventId e = 0; e < events.size(); ++e) {
+                if (character->handles(e)) {
+                    listeners[e].push_back(member);
+                }
+            }
+            if (character->hasDefaultReaction()) {
+                fallbacks.push_back(member);
+            }
+        }
     }
-    
-    std::string reactTo(const std::string& event) override {
-        if (event == "森林") {
-            return speak("听！是风的声音，还有鸟儿的歌唱！");
-        } else if (event == "魔法") {
-            return speak("让我为你施展一个小小的祝福魔法吧！");
+
+    // 广播事件，只有订阅了它的角色参与，sink(角色, 台词) 按演员表顺序被调用
+    template <typename Sink>
+    void broadcast(EventId event, Sink&& sink) {
+        if (event >= listeners.size()) return;
+        for (uint32_t member : react(event)) {
+            sink(*cast[member], std::string_view(outputs[member]));
         }
-        return speak("（快乐地转圈圈）");
+    }
+
+    // 同 broadcast，另外让没有订阅该事件的角色说默认反应。
+    // 默认反应只是一句固定台词，在调用线程中按演员表顺序与订阅者的结果合并，不进线程池
+    template <typename Sink>
+    void broadcastWithFallback(EventId event, Sink&& sink) {
+        static const std::vector<uint32_t> none;
+        const std::vector<uint32_t>& list = event < listeners.size() ? react(event) : none;
+
+        size_t next = 0;
+        for (uint32_t member : fallbacks) {
+            for (; next < list.size() && list[next] < member; ++next) {
+                sink(*cast[list[next]], std::string_view(outputs[list[next]]));
+            }
+            if (next < list.size() && list[next] == member) {
+                continue;  // 订阅者已经有自己的反应
+            }
+            cast[member]->reactTo(event, outputs[member]);
+            sink(*cast[member], std::string_view(outputs[member]));
+        }
+        for (; next < list.size(); ++next) {
+            sink(*cast[list[next]], std::string_view(outputs[list[next]]));
+        }
+    }
+
+private:
+    // 订阅者在线程池上并行反应，返回订阅者列表
+    const std::vector<uint32_t>& react(EventId event) {
+        const std::vector<uint32_t>& list = listeners[event];
+        currentEvent = event;
+        size_t grain = std::max<size_t>(1, list.size() / (pool.threadCount() * 4));
+        pool.parallelFor(list.size(), grain, task);
+        return list;
     }
 };
 
-int main() {
+// 300 个角色、100 轮事件，一个输出缓冲区反复使用：预留好之后不应再有任何分配
+int runAllocationCheck() {
+    const size_t castSize = 300;
+    const int rounds = 100;
+
+    EventTable events;
     std::vector<std::unique_ptr<KawaiiCharacter>> characters;
-    characters.push_back(std::make_unique<MagicalGirl>());
-    characters.push_back(std::make_unique<Fairy>());
-    
+    for (size_t i = 0; i < castSize; ++i) {
+        characters.push_back(i % 2 ? createFairy(events) : createMagicalGirl(events));
+    }
+    std::vector<EventId> scene = {events.intern("森林"), events.intern("战斗"), events.intern("美食"),
+                                  events.intern("魔法"), events.intern("下雨")};
+    for (auto& character : characters) character->prepareForEvents(events.size());
+
+    std::string line;
+    line.reserve(256);
+    uint64_t before = g_allocationCount.load();
+    for (int round = 0; round < rounds; ++round) {
+        for (auto& character : characters) {
+            character->reactTo(scene[round % scene.size()], line);
+        }
+    }
+    uint64_t allocations = g_allocationCount.load() - before;
+
+    std::cout << castSize << " 个角色 x " << rounds << " 轮: " << allocations << " 次分配" << std::endl;
+    return allocations == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string_view(argv[1]) == "--alloc-check") {
+        return runAllocationCheck();
+    }
+
+    EventTable events;
+    std::vector<std::unique_ptr<KawaiiCharacter>> characters;
+    characters.push_back(createMagicalGirl(events));
+    characters.push_back(createFairy(events));
+
+    // 所有角色共用一个输出缓冲区
+    std::string line;
+    line.reserve(256);
+
     // 角色介绍
     for (auto& character : characters) {
-        std::cout << character->introduce() << std::endl;
+        character->introduce(line);
+        std::cout << line << std::endl;
     }
-    
+
+    EventId forest = events.intern("森林");
+
+    WorkStealingPool pool;
+    SceneEventDispatcher dispatcher(pool);
+    dispatcher.setCast(characters, events);
+
+    // 小樱对森林没有专门的反应，说她的默认台词
     std::cout << "\n=== 场景：来到魔法森林 ===\n";
-    for (auto& character : characters) {
-        std::cout << character->reactTo("森林") << std::endl;
-    }
-    
+    dispatcher.broadcastWithFallback(forest, [](const KawaiiCharacter&, std::string_view text) {
+        std::cout << text << std::endl;
+    });
+
     return 0;
-}
\ No newline at end of file
+}
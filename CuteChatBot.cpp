@@ -1,12 +1,15 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <random>
 #include <chrono>
 #include <thread>
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <iterator>
+#include "chatbot/InputClassifier.h"
 
 // 颜色代码（Windows控制台）
 #ifdef _WIN32
@@ -40,25 +43,196 @@ public:
 };
 #endif
 
-// 可爱的表情符号库
+// 表情的情绪类别
+enum class EmojiMood {
+    None,       // 不加表情
+    Happy,
+    Sad,
+    Love,
+    Surprise
+};
+
+// 可爱的表情符号库：编译期常量，放在只读数据段，按 EmojiMood 下标取用
 struct Emoji {
-    static std::vector<std::string> happy;
-    static std::vector<std::string> sad;
-    static std::vector<std::string> love;
-    static std::vector<std::string> surprise;
-    
-    static void initialize() {
-        happy = {"(*^▽^*)", "(≧∇≦)ﾉ", "ヽ(✿ﾟ▽ﾟ)ノ", "(๑•̀ㅂ•́)و✧", "٩(◕‿◕｡)۶"};
-        sad = {"(；ω；)", "(╥﹏╥)", "(ノдヽ)", "(；一_一)", "(-ω-；)"};
-        love = {"(ﾉ´ з `)ノ", "(●´З｀●)", "(♡μ_μ)", "(*´∀｀*)", "(灬º‿º灬)♡"};
-        surprise = {"Σ(°△°|||)︴", "(⊙ˍ⊙)", "（・□・；）", "(ﾟДﾟ;)", "ヽ(°〇°)ﾉ"};
-    }
+    static constexpr size_t kPerMood = 5;
+    static constexpr std::string_view table[][kPerMood] = {
+        {},
+        {"(*^▽^*)", "(≧∇≦)ﾉ", "ヽ(✿ﾟ▽ﾟ)ノ", "(๑•̀ㅂ•́)و✧", "٩(◕‿◕｡)۶"},
+        {"(；ω；)", "(╥﹏╥)", "(ノдヽ)", "(；一_一)", "(-ω-；)"},
+        {"(ﾉ´ з `)ノ", "(●´З｀●)", "(♡μ_μ)", "(*´∀｀*)", "(灬º‿º灬)♡"},
+        {"Σ(°△°|||)︴", "(⊙ˍ⊙)", "（・□・；）", "(ﾟДﾟ;)", "ヽ(°〇°)ﾉ"}
+    };
+};
+
+// 台词类别
+enum class DialogueCategory {
+    Greeting,
+    AskName,
+    Daily,
+    AskMood,
+    Game,
+    Farewell,
+    Random,
+    Count
+};
+
+// 台词库中的一行：{name} 在说出时替换为角色名，decoration 是说出时紧跟在句末的表情
+struct CorpusLine {
+    std::string_view text;
+    EmojiMood decoration;
+};
+
+// 台词库同样是编译期常量，所有角色共用，创建角色时不需要构建
+// 问候语 - 增加到10个选项
+constexpr CorpusLine greetingLines[] = {
+    {"你好呀，我是{name}！今天天气真好呢~", EmojiMood::None},
+    {"喵~ 你来啦！我等你好久了", EmojiMood::Happy},
+    {"呜哇！你突然出现吓我一跳", EmojiMood::Surprise},
+    {"下午好！要一起喝杯茶吗？", EmojiMood::None},
+    {"嗨嗨~ 我刚刚在数云朵呢！", EmojiMood::None},
+    {"欢迎回来！想我了吗？", EmojiMood::None},
+    {"啊！是你！今天过得怎么样？", EmojiMood::None},
+    {"终于等到你啦！我有好多话想跟你说~", EmojiMood::None},
+    {"哈喽！今天的阳光好温暖呀", EmojiMood::None},
+    {"你来啦！我正准备去冒险呢，要一起吗？", EmojiMood::None}
+};
+
+// 询问姓名 - 增加到8个选项
+constexpr CorpusLine askNameLines[] = {
+    {"可以告诉我你的名字吗？我会好好记住的！", EmojiMood::None},
+    {"你叫什么名字呀？我想用特别的名字称呼你~", EmojiMood::None},
+    {"告诉我你的名字嘛，这样我们就是朋友了！", EmojiMood::Love},
+    {"唔...还不知道你的名字呢，可以告诉我吗？", EmojiMood::None},
+    {"我想给你起个昵称，但先要知道你的名字呀~", EmojiMood::None},
+    {"请告诉我你的名字，我会把它记在小本本上！", EmojiMood::None},
+    {"名字是很重要的呢！请告诉我你的名字吧~", EmojiMood::None},
+    {"我们可以交换名字吗？我的名字是{name}！", EmojiMood::None}
+};
+
+// 日常对话 - 增加到30个选项，大大减少重复
+constexpr CorpusLine dailyLines[] = {
+    {"今天有没有好好吃饭呀？要记得按时吃饭哦~", EmojiMood::None},
+    {"我最近在看一本有趣的书，要一起看吗？", EmojiMood::None},
+    {"你知道吗？蝴蝶的翅膀上有好多美丽的图案呢！", EmojiMood::None},
+    {"好想和你一起去吃草莓蛋糕呀", EmojiMood::Love},
+    {"我有点困了... Zzz...", EmojiMood::Sad},
+    {"你看！那片云朵好像一只小兔子！", EmojiMood::None},
+    {"风的声音真好听，像是在唱歌呢~", EmojiMood::None},
+    {"我学会了一个新的舞蹈，跳给你看好不好？", EmojiMood::None},
+    {"彩虹有七种颜色，你最喜欢哪一种呢？", EmojiMood::None},
+    {"下雨天其实也不错，可以听到雨滴的歌声", EmojiMood::None},
+    {"我刚做了一个美梦，梦见我们一起在花田里奔跑", EmojiMood::None},
+    {"你闻到了吗？空气中飘着甜甜的香气", EmojiMood::None},
+    {"我好喜欢看星星，每颗星星都有一个故事", EmojiMood::None},
+    {"听说对着流星许愿会成真呢！", EmojiMood::None},
+    {"春天来了，花儿们都睡醒了", EmojiMood::None},
+    {"蝴蝶结要这样系才可爱，我教你呀~", EmojiMood::None},
+    {"我今天发现了一个秘密基地！", EmojiMood::None},
+    {"唱首歌给你听吧：啦啦啦~♪", EmojiMood::None},
+    {"好想养一只小猫咪呀，软软的暖暖的", EmojiMood::None},
+    {"你看过萤火虫吗？像会飞的小星星", EmojiMood::None},
+    {"我喜欢收集漂亮的石头，每颗都很特别", EmojiMood::None},
+    {"下雨后会有彩虹，难过之后会有开心", EmojiMood::None},
+    {"我偷偷种了一朵花，等开花就送给你", EmojiMood::None},
+    {"听说鱼的记忆只有7秒，好短呀", EmojiMood::None},
+    {"今天的月亮好圆，像一个大月饼", EmojiMood::None},
+    {"我想学画画，把你画得特别好看", EmojiMood::None},
+    {"泡泡在阳光下会变成彩虹色呢！", EmojiMood::None},
+    {"我编了一个花环，送给你当礼物", EmojiMood::None},
+    {"你喜欢晴天还是雨天？", EmojiMood::None},
+    {"我们一起数云朵吧，看谁数得快！", EmojiMood::None}
+};
+
+// 询问心情 - 增加到8个选项
+constexpr CorpusLine askMoodLines[] = {
+    {"你今天心情怎么样呀？要和我分享吗？", EmojiMood::None},
+    {"有什么开心的事情吗？让我也高兴一下！", EmojiMood::None},
+    {"如果有什么烦恼，可以跟我说哦~", EmojiMood::None},
+    {"你笑起来最好看了，要多笑笑呀！", EmojiMood::None},
+    {"心情就像天气，会有晴有雨，但都会过去", EmojiMood::None},
+    {"我有个秘诀：不开心的时候就吃糖！甜甜的~", EmojiMood::None},
+    {"给你一个魔法拥抱，把所有不开心都赶跑！", EmojiMood::None},
+    {"要记得，我一直在这里陪着你呢", EmojiMood::None}
+};
+
+// 游戏相关 - 增加到10个选项
+constexpr CorpusLine gameLines[] = {
+    {"我们来玩游戏吧！猜猜我在想什么？", EmojiMood::None},
+    {"石头剪刀布！我出...布！你输了！", EmojiMood::Happy},
+    {"要听我唱歌吗？虽然可能有点跑调...", EmojiMood::None},
+    {"我们来玩词语接龙吧！我先说：天空", EmojiMood::None},
+    {"我藏了一个东西，猜猜在哪里？左手还是右手？", EmojiMood::None},
+    {"我会变魔术哦！看，花瓣变成了蝴蝶~", EmojiMood::None},
+    {"数到三一起说一个词！1...2...3...", EmojiMood::None},
+    {"我们来比赛谁先眨眼睛，准备好了吗？", EmojiMood::None},
+    {"我学了一个新的折纸，折只小鸟给你看", EmojiMood::None},
+    {"猜谜语：什么东西越洗越脏？（答案是：水！）", EmojiMood::None}
+};
+
+// 告别 - 增加到8个选项
+constexpr CorpusLine farewellLines[] = {
+    {"这么快就要走了吗？我会想你的...", EmojiMood::None},
+    {"再见啦！明天也要来找我玩哦~", EmojiMood::None},
+    {"要照顾好自己，我们下次见！", EmojiMood::Love},
+    {"路上小心，我会在这里等你回来的", EmojiMood::None},
+    {"再见不是结束，而是下一次相见的开始", EmojiMood::None},
+    {"给你一颗幸运星，带着它就不会迷路啦", EmojiMood::None},
+    {"要记得我们的约定哦！下次见~", EmojiMood::None},
+    {"挥挥~ 梦里也要来找我玩呀！", EmojiMood::None}
+};
+
+// 随机回应 - 增加到20个选项
+constexpr CorpusLine randomLines[] = {
+    {"诶？这个问题好难回答...让我想想...", EmojiMood::None},
+    {"不知道呢，不过和你聊天很开心！", EmojiMood::None},
+    {"今天也是个美好的日子呢~", EmojiMood::None},
+    {"你看，窗外有只小鸟飞过去了！", EmojiMood::None},
+    {"我好喜欢你和我聊天", EmojiMood::Love},
+    {"唔...让我用魔法水晶球看看答案...", EmojiMood::None},
+    {"这个嘛...我觉得重要的是你的想法~", EmojiMood::None},
+    {"有时候没有答案也是一种答案呢", EmojiMood::None},
+    {"你问得真好！我要好好想一想", EmojiMood::None},
+    {"每个人都有自己的想法，你的想法是什么呢？", EmojiMood::None},
+    {"生活就像一盒巧克力，你永远不知道下一颗是什么味道", EmojiMood::None},
+    {"我相信你的直觉会告诉你答案的", EmojiMood::None},
+    {"这个问题让我想起了昨天的一个梦", EmojiMood::None},
+    {"我们一起寻找答案好不好？", EmojiMood::None},
+    {"答案就在你的心里呀~", EmojiMood::None},
+    {"有时候问题本身比答案更有趣呢", EmojiMood::None},
+    {"让我变个魔术，答案就会出现！", EmojiMood::None},
+    {"唔...肚子突然有点饿了...", EmojiMood::None},
+    {"你听，风在告诉我们答案呢", EmojiMood::None},
+    {"重要的不是答案，而是我们一起寻找的过程", EmojiMood::None}
+};
+
+struct CorpusCategory {
+    const CorpusLine* lines;
+    size_t count;
+};
+
+template <size_t N>
+constexpr CorpusCategory makeCategory(const CorpusLine (&lines)[N]) {
+    return {lines, N};
+}
+
+// 按 DialogueCategory 下标取用
+constexpr CorpusCategory corpusByCategory[] = {
+    makeCategory(greetingLines),
+    makeCategory(askNameLines),
+    makeCategory(dailyLines),
+    makeCategory(askMoodLines),
+    makeCategory(gameLines),
+    makeCategory(farewellLines),
+    makeCategory(randomLines)
 };
+static_assert(std::size(corpusByCategory) == static_cast<size_t>(DialogueCategory::Count),
+              "每个台词类别都要有台词");
 
-std::vector<std::string> Emoji::happy;
-std::vector<std::string> Emoji::sad;
-std::vector<std::string> Emoji::love;
-std::vector<std::string> Emoji::surprise;
+// 角色的随机种子：每个线程只读一次 random_device，之后创建的角色由它派生
+inline uint32_t nextCharacterSeed() {
+    thread_local std::mt19937 seeder(std::random_device{}());
+    return seeder();
+}
 
 // 角色类
 class KawaiiCharacter {
@@ -67,14 +241,29 @@ private:
     std::string personality;
     int affection; // 好感度 0-100
     int energy;    // 精力 0-100
-    std::map<std::string, std::vector<std::string>> dialogueMap;
-    std::random_device rd;
-    std::mt19937 gen;
+    std::minstd_rand gen;  // 只用来挑台词和表情，状态小、播种快
     
     // 获取随机表情
-    std::string getRandomEmoji(const std::vector<std::string>& emojiList) {
-        std::uniform_int_distribution<> dis(0, emojiList.size() - 1);
-        return emojiList[dis(gen)];
+    std::string_view getRandomEmoji(EmojiMood mood) {
+        std::uniform_int_distribution<size_t> dis(0, Emoji::kPerMood - 1);
+        return Emoji::table[static_cast<size_t>(mood)][dis(gen)];
+    }
+    
+    // 把台词库中的一行变成要说的话：代入名字，加上句末表情
+    std::string renderLine(const CorpusLine& line) {
+        std::string speech;
+        size_t placeholder = line.text.find("{name}");
+        if (placeholder == std::string_view::npos) {
+            speech.assign(line.text);
+        } else {
+            speech.append(line.text.substr(0, placeholder));
+            speech += name;
+            speech.append(line.text.substr(placeholder + 6));
+        }
+        if (line.decoration != EmojiMood::None) {
+            speech += getRandomEmoji(line.decoration);
+        }
+        return speech;
     }
     
     // 打字机效果显示文本
@@ -102,156 +291,23 @@ private:
     
 public:
     KawaiiCharacter(const std::string& n, const std::string& p) 
-        : name(n), personality(p), affection(50), energy(80), gen(rd()) {
-        
-        Emoji::initialize();
-        initializeDialogue();
+        : name(n), personality(p), affection(50), energy(80), gen(nextCharacterSeed()) {
     }
     
-void initializeDialogue() {
-    // 问候语 - 增加到10个选项
-    dialogueMap["greeting"] = {
-        "你好呀，我是" + name + "！今天天气真好呢~",
-        "喵~ 你来啦！我等你好久了" + getRandomEmoji(Emoji::happy),
-        "呜哇！你突然出现吓我一跳" + getRandomEmoji(Emoji::surprise),
-        "下午好！要一起喝杯茶吗？",
-        "嗨嗨~ 我刚刚在数云朵呢！",
-        "欢迎回来！想我了吗？",
-        "啊！是你！今天过得怎么样？",
-        "终于等到你啦！我有好多话想跟你说~",
-        "哈喽！今天的阳光好温暖呀",
-        "你来啦！我正准备去冒险呢，要一起吗？"
-    };
-    
-    // 询问姓名 - 增加到8个选项
-    dialogueMap["ask_name"] = {
-        "可以告诉我你的名字吗？我会好好记住的！",
-        "你叫什么名字呀？我想用特别的名字称呼你~",
-        "告诉我你的名字嘛，这样我们就是朋友了！" + getRandomEmoji(Emoji::love),
-        "唔...还不知道你的名字呢，可以告诉我吗？",
-        "我想给你起个昵称，但先要知道你的名字呀~",
-        "请告诉我你的名字，我会把它记在小本本上！",
-        "名字是很重要的呢！请告诉我你的名字吧~",
-        "我们可以交换名字吗？我的名字是" + name + "！"
-    };
-    
-    // 日常对话 - 增加到30个选项，大大减少重复
-    dialogueMap["daily"] = {
-        "今天有没有好好吃饭呀？要记得按时吃饭哦~",
-        "我最近在看一本有趣的书，要一起看吗？",
-        "你知道吗？蝴蝶的翅膀上有好多美丽的图案呢！",
-        "好想和你一起去吃草莓蛋糕呀" + getRandomEmoji(Emoji::love),
-        "我有点困了... Zzz..." + getRandomEmoji(Emoji::sad),
-        "你看！那片云朵好像一只小兔子！",
-        "风的声音真好听，像是在唱歌呢~",
-        "我学会了一个新的舞蹈，跳给你看好不好？",
-        "彩虹有七种颜色，你最喜欢哪一种呢？",
-        "下雨天其实也不错，可以听到雨滴的歌声",
-        "我刚做了一个美梦，梦见我们一起在花田里奔跑",
-        "你闻到了吗？空气中飘着甜甜的香气",
-        "我好喜欢看星星，每颗星星都有一个故事",
-        "听说对着流星许愿会成真呢！",
-        "春天来了，花儿们都睡醒了",
-        "蝴蝶结要这样系才可爱，我教你呀~",
-        "我今天发现了一个秘密基地！",
-        "唱首歌给你听吧：啦啦啦~♪",
-        "好想养一只小猫咪呀，软软的暖暖的",
-        "你看过萤火虫吗？像会飞的小星星",
-        "我喜欢收集漂亮的石头，每颗都很特别",
-        "下雨后会有彩虹，难过之后会有开心",
-        "我偷偷种了一朵花，等开花就送给你",
-        "听说鱼的记忆只有7秒，好短呀",
-        "今天的月亮好圆，像一个大月饼",
-        "我想学画画，把你画得特别好看",
-        "泡泡在阳光下会变成彩虹色呢！",
-        "我编了一个花环，送给你当礼物",
-        "你喜欢晴天还是雨天？",
-        "我们一起数云朵吧，看谁数得快！"
-    };
-    
-    // 询问心情 - 增加到8个选项
-    dialogueMap["ask_mood"] = {
-        "你今天心情怎么样呀？要和我分享吗？",
-        "有什么开心的事情吗？让我也高兴一下！",
-        "如果有什么烦恼，可以跟我说哦~",
-        "你笑起来最好看了，要多笑笑呀！",
-        "心情就像天气，会有晴有雨，但都会过去",
-        "我有个秘诀：不开心的时候就吃糖！甜甜的~",
-        "给你一个魔法拥抱，把所有不开心都赶跑！",
-        "要记得，我一直在这里陪着你呢"
-    };
-    
-    // 游戏相关 - 增加到10个选项
-    dialogueMap["game"] = {
-        "我们来玩游戏吧！猜猜我在想什么？",
-        "石头剪刀布！我出...布！你输了！" + getRandomEmoji(Emoji::happy),
-        "要听我唱歌吗？虽然可能有点跑调...",
-        "我们来玩词语接龙吧！我先说：天空",
-        "我藏了一个东西，猜猜在哪里？左手还是右手？",
-        "我会变魔术哦！看，花瓣变成了蝴蝶~",
-        "数到三一起说一个词！1...2...3...",
-        "我们来比赛谁先眨眼睛，准备好了吗？",
-        "我学了一个新的折纸，折只小鸟给你看",
-        "猜谜语：什么东西越洗越脏？（答案是：水！）"
-    };
-    
-    // 告别 - 增加到8个选项
-    dialogueMap["farewell"] = {
-        "这么快就要走了吗？我会想你的...",
-        "再见啦！明天也要来找我玩哦~",
-        "要照顾好自己，我们下次见！" + getRandomEmoji(Emoji::love),
-        "路上小心，我会在这里等你回来的",
-        "再见不是结束，而是下一次相见的开始",
-        "给你一颗幸运星，带着它就不会迷路啦",
-        "要记得我们的约定哦！下次见~",
-        "挥挥~ 梦里也要来找我玩呀！"
-    };
-    
-    // 随机回应 - 增加到20个选项
-    dialogueMap["random"] = {
-        "诶？这个问题好难回答...让我想想...",
-        "不知道呢，不过和你聊天很开心！",
-        "今天也是个美好的日子呢~",
-        "你看，窗外有只小鸟飞过去了！",
-        "我好喜欢你和我聊天" + getRandomEmoji(Emoji::love),
-        "唔...让我用魔法水晶球看看答案...",
-        "这个嘛...我觉得重要的是你的想法~",
-        "有时候没有答案也是一种答案呢",
-        "你问得真好！我要好好想一想",
-        "每个人都有自己的想法，你的想法是什么呢？",
-        "生活就像一盒巧克力，你永远不知道下一颗是什么味道",
-        "我相信你的直觉会告诉你答案的",
-        "这个问题让我想起了昨天的一个梦",
-        "我们一起寻找答案好不好？",
-        "答案就在你的心里呀~",
-        "有时候问题本身比答案更有趣呢",
-        "让我变个魔术，答案就会出现！",
-        "唔...肚子突然有点饿了...",
-        "你听，风在告诉我们答案呢",
-        "重要的不是答案，而是我们一起寻找的过程"
-    };
-}
-    
-    void speak(const std::string& category) {
-        std::string emoji = "";
+    void speak(DialogueCategory category) {
+        // 获取对话
+        const CorpusCategory& lines = corpusByCategory[static_cast<size_t>(category)];
+        std::uniform_int_distribution<size_t> dis(0, lines.count - 1);
+        std::string speech = renderLine(lines.lines[dis(gen)]);
         
         // 根据好感度调整语气
+        speech += ' ';
         if (affection > 70) {
-            emoji = " " + getRandomEmoji(Emoji::love);
+            speech += getRandomEmoji(EmojiMood::Love);
         } else if (affection > 40) {
-            emoji = " " + getRandomEmoji(Emoji::happy);
+            speech += getRandomEmoji(EmojiMood::Happy);
         } else {
-            emoji = " " + getRandomEmoji(Emoji::sad);
-        }
-        
-        // 获取对话
-        std::string speech;
-        if (dialogueMap.find(category) != dialogueMap.end() && !dialogueMap[category].empty()) {
-            std::uniform_int_distribution<> dis(0, dialogueMap[category].size() - 1);
-            speech = dialogueMap[category][dis(gen)];
-        } else {
-            std::uniform_int_distribution<> dis(0, dialogueMap["random"].size() - 1);
-            speech = dialogueMap["random"][dis(gen)];
+            speech += getRandomEmoji(EmojiMood::Sad);
         }
         
         // 显示角色名和对话
@@ -264,7 +320,7 @@ void initializeDialogue() {
         
         console.setColor(11); // 青色
         std::cout << "│ ";
-        typewriterPrint(speech + emoji);
+        typewriterPrint(speech);
         
         console.setColor(13);
         std::cout << "└";
@@ -279,46 +335,35 @@ void initializeDialogue() {
     }
     
     void respondToInput(const std::string& input) {
-        std::string lowercase = input;
-        std::transform(lowercase.begin(), lowercase.end(), lowercase.begin(),
-                      [](unsigned char c){ return std::tolower(c); });
-        
         // 检查关键词并回应
-        if (lowercase.find("你好") != std::string::npos || 
-            lowercase.find("嗨") != std::string::npos ||
-            lowercase.find("hello") != std::string::npos) {
-            affection += 5;
-            speak("greeting");
-        }
-        else if (lowercase.find("名字") != std::string::npos ||
-                 lowercase.find("叫") != std::string::npos) {
-            affection += 3;
-            speak("ask_name");
-        }
-        else if (lowercase.find("心情") != std::string::npos ||
-                 lowercase.find("感觉") != std::string::npos) {
-            speak("ask_mood");
-        }
-        else if (lowercase.find("游戏") != std::string::npos ||
-                 lowercase.find("玩") != std::string::npos) {
-            energy += 10;
-            if (energy > 100) energy = 100;
-            speak("game");
-        }
-        else if (lowercase.find("再见") != std::string::npos ||
-                 lowercase.find("拜拜") != std::string::npos ||
-                 lowercase.find("bye") != std::string::npos) {
-            speak("farewell");
-            return;
-        }
-        else if (lowercase.find("喜欢") != std::string::npos ||
-                 lowercase.find("爱") != std::string::npos) {
-            affection += 10;
-            speak("random");
-        }
-        else {
-            affection += 1;
-            speak("daily");
+        switch (classifyInput(input)) {
+            case InputIntent::Greeting:
+                affection += 5;
+                speak(DialogueCategory::Greeting);
+                break;
+            case InputIntent::AskName:
+                affection += 3;
+                speak(DialogueCategory::AskName);
+                break;
+            case InputIntent::AskMood:
+                speak(DialogueCategory::AskMood);
+                break;
+            case InputIntent::Game:
+                energy += 10;
+                if (energy > 100) energy = 100;
+                speak(DialogueCategory::Game);
+                break;
+            case InputIntent::Farewell:
+                speak(DialogueCategory::Farewell);
+                return;
+            case InputIntent::Love:
+                affection += 10;
+                speak(DialogueCategory::Random);
+                break;
+            case InputIntent::Daily:
+                affection += 1;
+                speak(DialogueCategory::Daily);
+                break;
         }
         
         // 显示状态
@@ -412,25 +457,25 @@ void initializeDialogue() {
             energy += 30;
             affection += 15;
             std::cout << "\n🍰 " << name << ": \"哇！是最喜欢的草莓蛋糕！太开心了！\" ";
-            std::cout << getRandomEmoji(Emoji::love) << std::endl;
+            std::cout << getRandomEmoji(EmojiMood::Love) << std::endl;
         }
         else if (food == "饼干" || food == "曲奇") {
             energy += 20;
             affection += 10;
             std::cout << "\n🍪 " << name << ": \"饼干好香呀！谢谢你！\" ";
-            std::cout << getRandomEmoji(Emoji::happy) << std::endl;
+            std::cout << getRandomEmoji(EmojiMood::Happy) << std::endl;
         }
         else if (food == "咖啡" || food == "茶") {
             energy += 15;
             affection += 5;
             std::cout << "\n☕ " << name << ": \"暖暖的饮料，感觉精神多了！\" ";
-            std::cout << getRandomEmoji(Emoji::happy) << std::endl;
+            std::cout << getRandomEmoji(EmojiMood::Happy) << std::endl;
         }
         else {
             energy += 10;
             affection += 3;
             std::cout << "\n🍴 " << name << ": \"" << food << "吗？谢谢你！\" ";
-            std::cout << getRandomEmoji(Emoji::happy) << std::endl;
+            std::cout << getRandomEmoji(EmojiMood::Happy) << std::endl;
         }
         
         if (energy > 100) energy = 100;
@@ -563,4 +608,4 @@ int main() {
     console.reset();
     
     return 0;
-}
\ No newline at end of file
+}
@@ -1,92 +1,908 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <vector>
-#include <map>
-
-struct DialogueNode {
-    int id;
-    std::string text;
-    std::vector<std::pair<std::string, int>> choices;  // 选项文本和目标节点ID
-    bool isEnd;
-    
-    DialogueNode(int id, std::string text, bool isEnd = false) 
-        : id(id), text(text), isEnd(isEnd) {}
-    
-    void addChoice(std::string choiceText, int targetId) {
-        choices.push_back({choiceText, targetId});
+#include <unordered_map>
+#include <limits>
+#include <algorithm>
+#include <climits>
+#include <future>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 文本池中的一段文本
+struct TextSpan {
+    uint32_t offset;
+    uint32_t length;
+};
+
+// 文本池：所有节点/选项文本连续存放，相同文本只存一份
+class TextPool {
+private:
+    std::string data;
+    std::vector<TextSpan> spans;
+    std::vector<uint32_t> slots;  // 开放寻址哈希表，存 spans 下标+1，0 表示空槽
+
+    static uint64_t hashText(std::string_view text) {
+        uint64_t h = 1469598103934665603ull;  // FNV-1a
+        for (unsigned char c : text) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    void rehash(size_t newSize) {
+        std::vector<uint32_t> old;
+        old.swap(slots);
+        slots.assign(newSize, 0);
+        for (uint32_t entry : old) {
+            if (entry == 0) continue;
+            size_t i = hashText(view(spans[entry - 1])) & (newSize - 1);
+            while (slots[i] != 0) i = (i + 1) & (newSize - 1);
+            slots[i] = entry;
+        }
+    }
+
+public:
+    TextSpan intern(std::string_view text) {
+        if ((spans.size() + 1) * 2 > slots.size()) {
+            rehash(slots.empty() ? 64 : slots.size() * 2);
+        }
+
+        size_t mask = slots.size() - 1;
+        size_t i = hashText(text) & mask;
+        while (slots[i] != 0) {
+            const TextSpan& span = spans[slots[i] - 1];
+            if (view(span) == text) return span;
+            i = (i + 1) & mask;
+        }
+
+        TextSpan span{static_cast<uint32_t>(data.size()), static_cast<uint32_t>(text.size())};
+        data.append(text);
+        spans.push_back(span);
+        slots[i] = static_cast<uint32_t>(spans.size());
+        return span;
+    }
+
+    std::string_view view(TextSpan span) const {
+        return std::string_view(data).substr(span.offset, span.length);
+    }
+
+    // 构建完成后交出文本数据，哈希表随之释放
+    std::string release() {
+        std::vector<TextSpan>().swap(spans);
+        std::vector<uint32_t>().swap(slots);
+        return std::move(data);
+    }
+};
+
+// 编译后的对话节点：16字节，连续存放
+struct CompiledNode {
+    TextSpan text;
+    uint32_t firstChoice;  // 在选项边数组中的起始下标
+    uint16_t choiceCount;
+    uint16_t isEnd;
+};
+
+// 选项边（CSR）：同一节点的选项在数组中相邻
+struct ChoiceEdge {
+    TextSpan text;
+    uint32_t target;  // 目标节点的数组下标，而不是作者写的ID
+};
+
+// 只读文件映射：大图的页面由操作系统按访问按需载入
+class MappedFile {
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { close(); return false; }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) { close(); return false; }
+        base = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base = static_cast<const char*>(p);
+        length = static_cast<size_t>(st.st_size);
+#endif
+        return base != nullptr;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(const_cast<char*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+// 二进制对话图文件头（.dlgb）
+// 布局：头 | CompiledNode[nodeCount] | ChoiceEdge[edgeCount] | int32[nodeCount] | 文本
+struct BinaryGraphHeader {
+    char magic[4];        // "DLGB"
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t edgeCount;
+    uint64_t textSize;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(CompiledNode) == 16, "CompiledNode 是二进制格式的一部分");
+static_assert(sizeof(ChoiceEdge) == 12, "ChoiceEdge 是二进制格式的一部分");
+static_assert(sizeof(BinaryGraphHeader) == 32, "BinaryGraphHeader 是二进制格式的一部分");
+
+// 编译后的对话图，遍历只需要数组下标
+// 数据既可以由构建器持有，也可以直接指向映射的 .dlgb 文件
+class DialogueGraph {
+private:
+    std::vector<CompiledNode> ownedNodes;
+    std::vector<ChoiceEdge> ownedEdges;
+    std::vector<int32_t> ownedIds;
+    std::string ownedText;
+    MappedFile mapped;
+
+    const CompiledNode* nodes = nullptr;
+    const ChoiceEdge* edges = nullptr;
+    const int32_t* nodeIds = nullptr;  // 下标 -> 作者ID，仅用于诊断
+    const char* text = nullptr;
+    uint32_t nodeTotal = 0;
+    uint32_t edgeTotal = 0;
+    uint64_t textSize = 0;
+
+    friend class DialogueTreeBuilder;
+
+    void bindOwned() {
+        nodes = ownedNodes.data();
+        edges = ownedEdges.data();
+        nodeIds = ownedIds.data();
+        text = ownedText.data();
+        nodeTotal = static_cast<uint32_t>(ownedNodes.size());
+        edgeTotal = static_cast<uint32_t>(ownedEdges.size());
+        textSize = ownedText.size();
+    }
+
+public:
+    DialogueGraph() = default;
+    DialogueGraph(const DialogueGraph&) = delete;
+    DialogueGraph& operator=(const DialogueGraph&) = delete;
+
+    uint32_t nodeCount() const { return nodeTotal; }
+    const CompiledNode& node(uint32_t index) const { return nodes[index]; }
+    const ChoiceEdge& choice(const CompiledNode& n, uint32_t i) const { return edges[n.firstChoice + i]; }
+    int nodeId(uint32_t index) const { return nodeIds[index]; }
+
+    std::string_view textOf(TextSpan span) const {
+        return std::string_view(text + span.offset, span.length);
+    }
+
+    // 映射文件只在加载时检查头部，节点在第一次访问时才校验，避免启动时触碰整个文件
+    bool isValidNode(uint32_t index) const {
+        if (index >= nodeTotal) return false;
+        const CompiledNode& n = nodes[index];
+        if (uint64_t(n.text.offset) + n.text.length > textSize) return false;
+        if (uint64_t(n.firstChoice) + n.choiceCount > edgeTotal) return false;
+        for (uint32_t i = 0; i < n.choiceCount; ++i) {
+            const ChoiceEdge& e = edges[n.firstChoice + i];
+            if (e.target >= nodeTotal || uint64_t(e.text.offset) + e.text.length > textSize) return false;
+        }
+        return true;
+    }
+
+    size_t memoryUsage() const {
+        return ownedNodes.capacity() * sizeof(CompiledNode) +
+               ownedEdges.capacity() * sizeof(ChoiceEdge) +
+               ownedIds.capacity() * sizeof(int32_t) +
+               ownedText.capacity();
+    }
+
+    // 以深度优先顺序写出，使同一子树的节点、选项和文本在文件中相邻，
+    // 映射后沿着剧情走只会载入走到的那几页
+    bool saveBinary(const std::string& path) const {
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> newIndex(nodeTotal, UINT32_MAX);
+        order.reserve(nodeTotal);
+        std::vector<uint32_t> stack;
+        for (uint32_t root = 0; root < nodeTotal; ++root) {
+            if (newIndex[root] != UINT32_MAX) continue;
+            stack.push_back(root);
+            while (!stack.empty()) {
+                uint32_t n = stack.back();
+                stack.pop_back();
+                if (newIndex[n] != UINT32_MAX) continue;
+                newIndex[n] = static_cast<uint32_t>(order.size());
+                order.push_back(n);
+                for (uint32_t i = nodes[n].choiceCount; i-- > 0;) {
+                    uint32_t t = edges[nodes[n].firstChoice + i].target;
+                    if (newIndex[t] == UINT32_MAX) stack.push_back(t);
+                }
+            }
+        }
+
+        TextPool pool;
+        std::vector<CompiledNode> outNodes;
+        std::vector<ChoiceEdge> outEdges;
+        std::vector<int32_t> outIds;
+        outNodes.reserve(nodeTotal);
+        outEdges.reserve(edgeTotal);
+        outIds.reserve(nodeTotal);
+        for (uint32_t n : order) {
+            const CompiledNode& src = nodes[n];
+            outNodes.push_back({pool.intern(textOf(src.text)), static_cast<uint32_t>(outEdges.size()),
+                                src.choiceCount, src.isEnd});
+            outIds.push_back(nodeIds[n]);
+            for (uint32_t i = 0; i < src.choiceCount; ++i) {
+                const ChoiceEdge& e = edges[src.firstChoice + i];
+                outEdges.push_back({pool.intern(textOf(e.text)), newIndex[e.target]});
+            }
+        }
+        std::string outText = pool.release();
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        BinaryGraphHeader header{{'D', 'L', 'G', 'B'}, 1, nodeTotal, edgeTotal, outText.size(), 0};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(outNodes.data()), outNodes.size() * sizeof(CompiledNode));
+        file.write(reinterpret_cast<const char*>(outEdges.data()), outEdges.size() * sizeof(ChoiceEdge));
+        file.write(reinterpret_cast<const char*>(outIds.data()), outIds.size() * sizeof(int32_t));
+        file.write(outText.data(), static_cast<std::streamsize>(outText.size()));
+        return static_cast<bool>(file);
+    }
+
+    // 映射 .dlgb 文件，加载时间和常驻内存与图的大小无关
+    bool mapBinary(const std::string& path, std::string& error) {
+        if (!mapped.open(path)) {
+            error = "无法映射文件 " + path;
+            return false;
+        }
+
+        BinaryGraphHeader header;
+        if (mapped.size() < sizeof(header)) {
+            error = "文件太小";
+            return false;
+        }
+        std::memcpy(&header, mapped.data(), sizeof(header));
+        if (std::memcmp(header.magic, "DLGB", 4) != 0 || header.version != 1) {
+            error = "不是对话图文件或版本不支持";
+            return false;
+        }
+
+        uint64_t expected = sizeof(header) +
+                            uint64_t(header.nodeCount) * sizeof(CompiledNode) +
+                            uint64_t(header.edgeCount) * sizeof(ChoiceEdge) +
+                            uint64_t(header.nodeCount) * sizeof(int32_t) +
+                            header.textSize;
+        if (expected != mapped.size() || header.nodeCount == 0) {
+            error = "文件长度与文件头不符";
+            return false;
+        }
+
+        const char* cursor = mapped.data() + sizeof(header);
+        nodes = reinterpret_cast<const CompiledNode*>(cursor);
+        cursor += uint64_t(header.nodeCount) * sizeof(CompiledNode);
+        edges = reinterpret_cast<const ChoiceEdge*>(cursor);
+        cursor += uint64_t(header.edgeCount) * sizeof(ChoiceEdge);
+        nodeIds = reinterpret_cast<const int32_t*>(cursor);
+        cursor += uint64_t(header.nodeCount) * sizeof(int32_t);
+        text = cursor;
+        nodeTotal = header.nodeCount;
+        edgeTotal = header.edgeCount;
+        textSize = header.textSize;
+        return true;
+    }
+};
+
+// 对话树构建器：先录入节点和选项，build() 时统一编译并校验
+class DialogueTreeBuilder {
+private:
+    struct PendingChoice {
+        TextSpan text;
+        int targetId;
+    };
+
+    TextPool pool;
+    std::vector<CompiledNode> nodes;
+    std::vector<PendingChoice> choices;
+    std::vector<int32_t> nodeIds;
+    std::unordered_map<int, uint32_t> indexOf;
+    std::vector<std::string> errors;
+
+public:
+    // 新建节点，之后的 choice() 都属于这个节点
+    DialogueTreeBuilder& node(int id, std::string_view text, bool isEnd = false) {
+        if (!indexOf.emplace(id, static_cast<uint32_t>(nodes.size())).second) {
+            errors.push_back("节点 " + std::to_string(id) + " 重复定义");
+        }
+        nodes.push_back({pool.intern(text), static_cast<uint32_t>(choices.size()), 0,
+                         static_cast<uint16_t>(isEnd ? 1 : 0)});
+        nodeIds.push_back(id);
+        return *this;
+    }
+
+    DialogueTreeBuilder& choice(std::string_view text, int targetId) {
+        if (nodes.empty()) {
+            errors.push_back("选项 \"" + std::string(text) + "\" 之前没有节点");
+            return *this;
+        }
+        CompiledNode& owner = nodes.back();
+        if (owner.choiceCount == std::numeric_limits<uint16_t>::max()) {
+            errors.push_back("节点 " + std::to_string(nodeIds.back()) + " 的选项过多");
+            return *this;
+        }
+        choices.push_back({pool.intern(text), targetId});
+        ++owner.choiceCount;
+        return *this;
+    }
+
+    // 编译为连续数组，校验悬空目标、死路和不可达节点；
+    // requireReachable 为 false 时不可达节点照常编入（分析工具要报告它们，而不是拒绝载入）
+    bool build(DialogueGraph& graph, int startId = 0, bool requireReachable = true) {
+        auto start = indexOf.find(startId);
+        if (start == indexOf.end()) {
+            errors.push_back("起始节点 " + std::to_string(startId) + " 不存在");
+        }
+
+        std::vector<ChoiceEdge> edges;
+        edges.reserve(choices.size());
+        for (uint32_t n = 0; n < nodes.size(); ++n) {
+            const CompiledNode& cn = nodes[n];
+            if (!cn.isEnd && cn.choiceCount == 0) {
+                errors.push_back("节点 " + std::to_string(nodeIds[n]) + " 不是结束节点却没有选项");
+            }
+            for (uint32_t c = cn.firstChoice; c < cn.firstChoice + cn.choiceCount; ++c) {
+                auto target = indexOf.find(choices[c].targetId);
+                if (target == indexOf.end()) {
+                    errors.push_back("节点 " + std::to_string(nodeIds[n]) + " 的选项 \"" +
+                                     std::string(pool.view(choices[c].text)) + "\" 指向不存在的节点 " +
+                                     std::to_string(choices[c].targetId));
+                    edges.push_back({choices[c].text, 0});
+                } else {
+                    edges.push_back({choices[c].text, target->second});
+                }
+            }
+        }
+
+        if (start != indexOf.end()) {
+            // 从起始节点出发做一次遍历，找出不可达节点
+            std::vector<uint8_t> visited(nodes.size(), 0);
+            std::vector<uint32_t> stack{start->second};
+            visited[start->second] = 1;
+            while (!stack.empty()) {
+                uint32_t n = stack.back();
+                stack.pop_back();
+                for (uint32_t c = nodes[n].firstChoice; c < nodes[n].firstChoice + nodes[n].choiceCount; ++c) {
+                    uint32_t t = edges[c].target;
+                    if (!visited[t]) {
+                        visited[t] = 1;
+                        stack.push_back(t);
+                    }
+                }
+            }
+            for (uint32_t n = 0; n < nodes.size() && requireReachable; ++n) {
+                if (!visited[n]) {
+                    errors.push_back("节点 " + std::to_string(nodeIds[n]) + " 无法从起始节点到达");
+                }
+            }
+
+            // 让起始节点位于下标0
+            if (start->second != 0 && errors.empty()) {
+                uint32_t s = start->second;
+                std::swap(nodes[0], nodes[s]);
+                std::swap(nodeIds[0], nodeIds[s]);
+                for (ChoiceEdge& e : edges) {
+                    if (e.target == 0) e.target = s;
+                    else if (e.target == s) e.target = 0;
+                }
+            }
+        }
+
+        if (!errors.empty()) return false;
+
+        graph.mapped.close();
+        graph.ownedNodes = std::move(nodes);
+        graph.ownedEdges = std::move(edges);
+        graph.ownedIds = std::move(nodeIds);
+        graph.ownedText = pool.release();
+        graph.ownedNodes.shrink_to_fit();
+        graph.ownedText.shrink_to_fit();
+        graph.bindOwned();
+
+        choices.clear();
+        indexOf.clear();
+        return true;
+    }
+
+    const std::vector<std::string>& getErrors() const { return errors; }
+};
+
+// 文本格式（.dlg），每行一条指令，节点之后紧跟它的选项：
+//   # 注释
+//   @start 0
+//   @node 0 喵呜~ 你是来找我玩的吗？
+//   @choice 1 当然啦！我们一起玩吧~
+//   @end 6 （满足地吃着）喵呜~ 太好吃了！
+// 逐行读入并直接送进构建器，不会在内存中保留整份源文件
+bool loadDialogueText(std::istream& input, DialogueTreeBuilder& builder, int& startId,
+                      std::vector<std::string>& errors) {
+    std::string line;
+    int lineNumber = 0;
+    bool lastNodeIsEnd = false;  // 结束节点之后的 @choice 会挂到结束节点上，在这里拒绝
+    int lastNodeId = 0;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        std::string_view rest(line);
+        size_t first = rest.find_first_not_of(" \t");
+        if (first == std::string_view::npos || rest[first] == '#') continue;
+        rest.remove_prefix(first);
+
+        size_t space = rest.find(' ');
+        std::string_view keyword = rest.substr(0, space);
+        rest = space == std::string_view::npos ? std::string_view() : rest.substr(space + 1);
+
+        // 解析指令后的整数，剩下的部分就是文本
+        int number = 0;
+        size_t digits = 0;
+        bool negative = !rest.empty() && rest[0] == '-';
+        bool tooLarge = false;
+        for (size_t k = negative ? 1 : 0; k < rest.size() && rest[k] >= '0' && rest[k] <= '9'; ++k) {
+            int digit = rest[k] - '0';
+            if (number > (INT_MAX - digit) / 10) {
+                tooLarge = true;
+                break;
+            }
+            number = number * 10 + digit;
+            digits = k + 1;
+        }
+        if (tooLarge) {
+            errors.push_back("第 " + std::to_string(lineNumber) + " 行: 节点ID过大");
+            continue;
+        }
+        if (digits == 0 || (negative && digits == 1)) {
+            errors.push_back("第 " + std::to_string(lineNumber) + " 行: 缺少节点ID");
+            continue;
+        }
+        if (negative) number = -number;
+        std::string_view text = rest.substr(digits);
+        if (!text.empty() && text[0] == ' ') text.remove_prefix(1);
+
+        if (keyword == "@node" || keyword == "@end") {
+            lastNodeIsEnd = keyword == "@end";
+            lastNodeId = number;
+            builder.node(number, text, lastNodeIsEnd);
+        } else if (keyword == "@choice") {
+            if (lastNodeIsEnd) {
+                errors.push_back("第 " + std::to_string(lineNumber) + " 行: 结束节点 " +
+                                 std::to_string(lastNodeId) + " 不能有选项");
+                continue;
+            }
+            builder.choice(text, number);
+        } else if (keyword == "@start") {
+            startId = number;
+        } else {
+            errors.push_back("第 " + std::to_string(lineNumber) + " 行: 未知指令 " + std::string(keyword));
+        }
+    }
+    return errors.empty();
+}
+
+// 内置的示例对话，与 .dlg 文件使用同一种格式
+const char* const kDefaultDialogue = R"(# 小猫的对话
+@start 0
+@node 0 喵呜~ 你是来找我玩的吗？
+@choice 1 当然啦！我们一起玩吧~
+@choice 2 我是来给你送小鱼干的
+@choice 3 我只是路过...
+
+@node 1 太好了！（开心地转圈圈）你想玩什么？
+@choice 4 玩毛线球
+@choice 5 玩捉迷藏
+
+@node 2 小鱼干！（眼睛闪闪发亮）谢谢你！
+@choice 6 不客气，慢慢吃
+@choice 7 吃了要陪我玩哦
+
+# 结束节点
+@end 3 哼！路过也要摸摸我的头才能走！
+@end 4 （扑向毛线球）抓到啦！喵~
+@end 5 我藏好啦~ 你一定找不到我！（尾巴露在外面）
+@end 6 （满足地吃着）喵呜~ 太好吃了！
+@end 7 嗯嗯！吃完就陪你玩！
+)";
+
+// 路线数量：1e9 进制的大整数，低位在前
+class BigCount {
+private:
+    std::vector<uint32_t> limbs;
+
+public:
+    void addOne() {
+        BigCount one;
+        one.limbs.push_back(1);
+        add(one);
+    }
+
+    void add(const BigCount& other) {
+        if (other.limbs.size() > limbs.size()) limbs.resize(other.limbs.size(), 0);
+        uint32_t carry = 0;
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            if (i >= other.limbs.size() && carry == 0) break;
+            uint64_t sum = uint64_t(limbs[i]) + carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+            limbs[i] = static_cast<uint32_t>(sum % 1000000000u);
+            carry = static_cast<uint32_t>(sum / 1000000000u);
+        }
+        if (carry) limbs.push_back(carry);
     }
+
+    bool isZero() const { return limbs.empty(); }
+
+    std::string toString() const {
+        if (limbs.empty()) return "0";
+        std::string result = std::to_string(limbs.back());
+        char buffer[16];
+        for (size_t i = limbs.size() - 1; i-- > 0;) {
+            std::snprintf(buffer, sizeof(buffer), "%09u", limbs[i]);
+            result += buffer;
+        }
+        return result;
+    }
+};
+
+// 对话图分析结果，路线长度以经过的节点（台词）数计
+struct DialogueGraphReport {
+    uint32_t reachable = 0;
+    std::vector<int> unreachableIds;
+    std::vector<std::vector<int>> loops;
+    bool unbounded = false;  // 通往结局的路上有循环
+    BigCount pathCount;
+    uint32_t shortestRoute = 0;
+    uint32_t longestRoute = 0;
 };
 
+// 对整张图做一次线性时间的分析：
+// 可达性+最短路线（BFS）在另一个核心上运行，同时在本线程求强连通分量，
+// 之后路线计数和最长路线在凝聚图的逆拓扑序上并行做 DP
+DialogueGraphReport analyzeDialogueGraph(const DialogueGraph& graph) {
+    DialogueGraphReport report;
+    const uint32_t n = graph.nodeCount();
+    if (n == 0) return report;
+
+    auto successors = [&graph](uint32_t v, auto&& visit) {
+        const CompiledNode& node = graph.node(v);
+        for (uint32_t i = 0; i < node.choiceCount; ++i) visit(graph.choice(node, i).target);
+    };
+
+    auto bfsTask = std::async(std::launch::async, [&]() {
+        std::vector<uint32_t> depth(n, UINT32_MAX);
+        std::vector<uint32_t> queue{0};
+        depth[0] = 1;
+        uint32_t shortest = 0;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint32_t v = queue[head];
+            if (graph.node(v).isEnd && shortest == 0) shortest = depth[v];
+            successors(v, [&](uint32_t w) {
+                if (depth[w] == UINT32_MAX) {
+                    depth[w] = depth[v] + 1;
+                    queue.push_back(w);
+                }
+            });
+        }
+        return std::make_pair(depth, shortest);
+    });
+
+    // 迭代版 Tarjan，分量按逆拓扑序产生
+    std::vector<uint32_t> index(n, UINT32_MAX), low(n, 0), componentOf(n, 0);
+    std::vector<uint8_t> onStack(n, 0);
+    std::vector<uint32_t> stack;
+    std::vector<std::pair<uint32_t, uint32_t>> callStack;
+    std::vector<std::vector<uint32_t>> components;
+    uint32_t counter = 0;
+    for (uint32_t root = 0; root < n; ++root) {
+        if (index[root] != UINT32_MAX) continue;
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        onStack[root] = 1;
+        callStack.push_back({root, 0});
+        while (!callStack.empty()) {
+            uint32_t v = callStack.back().first;
+            uint32_t& next = callStack.back().second;
+            const CompiledNode& node = graph.node(v);
+            if (next < node.choiceCount) {
+                uint32_t w = graph.choice(node, next++).target;
+                if (index[w] == UINT32_MAX) {
+                    index[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    onStack[w] = 1;
+                    callStack.push_back({w, 0});
+                } else if (onStack[w]) {
+                    low[v] = std::min(low[v], index[w]);
+                }
+                continue;
+            }
+            callStack.pop_back();
+            if (low[v] == index[v]) {
+                components.emplace_back();
+                uint32_t w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = 0;
+                    componentOf[w] = static_cast<uint32_t>(components.size() - 1);
+                    components.back().push_back(w);
+                } while (w != v);
+            }
+            if (!callStack.empty()) {
+                uint32_t parent = callStack.back().first;
+                low[parent] = std::min(low[parent], low[v]);
+            }
+        }
+    }
+
+    std::vector<uint8_t> cyclic(components.size(), 0);
+    for (uint32_t c = 0; c < components.size(); ++c) {
+        cyclic[c] = components[c].size() > 1;
+        successors(components[c][0], [&](uint32_t w) { if (w == components[c][0]) cyclic[c] = 1; });
+        if (cyclic[c]) {
+            report.loops.emplace_back();
+            for (uint32_t v : components[c]) report.loops.back().push_back(graph.nodeId(v));
+        }
+    }
+
+    auto countTask = std::async(std::launch::async, [&]() {
+        std::vector<BigCount> paths(components.size());
+        std::vector<uint8_t> infinite(components.size(), 0);
+        for (uint32_t c = 0; c < components.size(); ++c) {
+            BigCount sum;
+            bool inf = false;
+            bool reachesEnd = false;
+            for (uint32_t v : components[c]) {
+                if (graph.node(v).isEnd) { sum.addOne(); reachesEnd = true; }
+                successors(v, [&](uint32_t w) {
+                    uint32_t t = componentOf[w];
+                    if (t == c) return;
+                    if (infinite[t]) inf = true;
+                    else if (!paths[t].isZero()) { sum.add(paths[t]); reachesEnd = true; }
+                });
+            }
+            infinite[c] = inf || (cyclic[c] && reachesEnd);
+            if (!infinite[c]) paths[c] = std::move(sum);
+        }
+        return std::make_pair(infinite[componentOf[0]] != 0, paths[componentOf[0]]);
+    });
+
+    std::vector<int64_t> longest(components.size(), -1);
+    std::vector<uint8_t> longestInfinite(components.size(), 0);
+    for (uint32_t c = 0; c < components.size(); ++c) {
+        int64_t best = -1;
+        bool inf = false;
+        for (uint32_t v : components[c]) {
+            if (graph.node(v).isEnd) best = std::max<int64_t>(best, 0);
+            successors(v, [&](uint32_t w) {
+                uint32_t t = componentOf[w];
+                if (t == c) return;
+                if (longestInfinite[t]) inf = true;
+                best = std::max(best, longest[t]);
+            });
+        }
+        longestInfinite[c] = inf || (cyclic[c] && best >= 0);
+        if (!longestInfinite[c] && best >= 0) longest[c] = best + 1;
+    }
+
+    auto bfs = bfsTask.get();
+    for (uint32_t v = 0; v < n; ++v) {
+        if (bfs.first[v] != UINT32_MAX) ++report.reachable;
+        else report.unreachableIds.push_back(graph.nodeId(v));
+    }
+    report.shortestRoute = bfs.second;
+
+    auto counted = countTask.get();
+    report.unbounded = counted.first || longestInfinite[componentOf[0]];
+    report.pathCount = counted.second;
+    report.longestRoute = longest[componentOf[0]] < 0 ? 0 : static_cast<uint32_t>(longest[componentOf[0]]);
+    return report;
+}
+
 class DialogueTree {
 private:
-    std::map<int, DialogueNode> nodes;
-    int currentId;
-    
+    DialogueGraph graph;
+    uint32_t currentIndex;
+
 public:
-    DialogueTree() : currentId(0) {
-        initializeDialogue();
-    }
-    
-    void initializeDialogue() {
-        // 创建对话树
-        DialogueNode start(0, "喵呜~ 你是来找我玩的吗？");
-        start.addChoice("当然啦！我们一起玩吧~", 1);
-        start.addChoice("我是来给你送小鱼干的", 2);
-        start.addChoice("我只是路过...", 3);
-        nodes[0] = start;
-        
-        DialogueNode node1(1, "太好了！（开心地转圈圈）你想玩什么？");
-        node1.addChoice("玩毛线球", 4);
-        node1.addChoice("玩捉迷藏", 5);
-        nodes[1] = node1;
-        
-        DialogueNode node2(2, "小鱼干！（眼睛闪闪发亮）谢谢你！");
-        node2.addChoice("不客气，慢慢吃", 6);
-        node2.addChoice("吃了要陪我玩哦", 7);
-        nodes[2] = node2;
-        
-        // 结束节点
-        DialogueNode end1(6, "（满足地吃着）喵呜~ 太好吃了！", true);
-        nodes[6] = end1;
-        
-        DialogueNode end2(7, "嗯嗯！吃完就陪你玩！", true);
-        nodes[7] = end2;
-    }
-    
+    DialogueTree() : currentIndex(0) {}
+
+    bool initializeDialogue() {
+        std::istringstream input(kDefaultDialogue);
+        return loadFromStream(input);
+    }
+
+    bool loadFromStream(std::istream& input, bool requireReachable = true) {
+        DialogueTreeBuilder builder;
+        std::vector<std::string> errors;
+        int startId = 0;
+        bool parsed = loadDialogueText(input, builder, startId, errors);
+        bool built = builder.build(graph, startId, requireReachable) && parsed;
+        if (!built) {
+            errors.insert(errors.end(), builder.getErrors().begin(), builder.getErrors().end());
+            for (const std::string& error : errors) {
+                std::cerr << "[对话树错误] " << error << std::endl;
+            }
+        }
+        return built;
+    }
+
+    // .dlgb 直接映射，其他扩展名按文本格式流式读入
+    bool loadFromFile(const std::string& path, bool requireReachable = true) {
+        if (path.size() > 5 && path.compare(path.size() - 5, 5, ".dlgb") == 0) {
+            std::string error;
+            if (!graph.mapBinary(path, error)) {
+                std::cerr << "[对话树错误] " << error << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "[对话树错误] 无法打开 " << path << std::endl;
+            return false;
+        }
+        return loadFromStream(file, requireReachable);
+    }
+
+    bool saveBinary(const std::string& path) const {
+        return graph.saveBinary(path);
+    }
+
+    bool analyze() const {
+        for (uint32_t i = 0; i < graph.nodeCount(); ++i) {
+            if (!graph.isValidNode(i)) {
+                std::cerr << "[对话树错误] 节点数据损坏" << std::endl;
+                return false;
+            }
+        }
+
+        DialogueGraphReport report = analyzeDialogueGraph(graph);
+        std::cout << "节点: " << graph.nodeCount() << "  可达: " << report.reachable
+                  << "  不可达: " << report.unreachableIds.size() << std::endl;
+        for (int id : report.unreachableIds) {
+            std::cout << "  [不可达] 节点 " << id << std::endl;
+        }
+        std::cout << "循环: " << report.loops.size() << std::endl;
+        for (const auto& loop : report.loops) {
+            std::cout << "  [循环]";
+            for (int id : loop) std::cout << " " << id;
+            std::cout << std::endl;
+        }
+        if (report.shortestRoute == 0) {
+            std::cout << "路线: 没有通往结局的路线" << std::endl;
+        } else if (report.unbounded) {
+            std::cout << "路线数: 无限（通往结局的路上有循环）" << std::endl;
+            std::cout << "最短路线: " << report.shortestRoute << " 句" << std::endl;
+            std::cout << "最长路线: 无上限" << std::endl;
+        } else {
+            std::cout << "路线数: " << report.pathCount.toString() << std::endl;
+            std::cout << "最短路线: " << report.shortestRoute << " 句" << std::endl;
+            std::cout << "最长路线: " << report.longestRoute << " 句" << std::endl;
+        }
+        return true;
+    }
+
     void startDialogue() {
-        currentId = 0;
-        
+        if (graph.nodeCount() == 0) return;
+        currentIndex = 0;
+
         while (true) {
-            DialogueNode& currentNode = nodes[currentId];
-            
-            std::cout << "\n" << currentNode.text << std::endl;
-            
+            if (!graph.isValidNode(currentIndex)) {
+                std::cerr << "[对话树错误] 节点数据损坏" << std::endl;
+                break;
+            }
+            const CompiledNode& currentNode = graph.node(currentIndex);
+
+            std::cout << "\n" << graph.textOf(currentNode.text) << std::endl;
+
             if (currentNode.isEnd) {
                 std::cout << "\n[对话结束]\n";
                 break;
             }
-            
+
             // 显示选项
-            for (int i = 0; i < currentNode.choices.size(); ++i) {
-                std::cout << i + 1 << ". " << currentNode.choices[i].first << std::endl;
+            for (uint32_t i = 0; i < currentNode.choiceCount; ++i) {
+                std::cout << i + 1 << ". " << graph.textOf(graph.choice(currentNode, i).text) << std::endl;
             }
-            
+
             // 获取玩家选择
             int choice;
-            std::cout << "请选择 (1-" << currentNode.choices.size() << "): ";
-            std::cin >> choice;
-            
-            if (choice < 1 || choice > currentNode.choices.size()) {
+            std::cout << "请选择 (1-" << currentNode.choiceCount << "): ";
+            if (!(std::cin >> choice)) {
+                if (std::cin.eof()) break;
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                choice = 0;
+            }
+
+            if (choice < 1 || choice > currentNode.choiceCount) {
                 std::cout << "无效的选择！" << std::endl;
                 continue;
             }
-            
-            currentId = currentNode.choices[choice - 1].second;
+
+            currentIndex = graph.choice(currentNode, choice - 1).target;
         }
     }
 };
 
-int main() {
+// 用法：
+//   DialogueTreeSystem                          使用内置对话
+//   DialogueTreeSystem story.dlg|story.dlgb     从文件加载
+//   DialogueTreeSystem --compile story.dlg story.dlgb
+//   DialogueTreeSystem --analyze story.dlg|story.dlgb
+int main(int argc, char* argv[]) {
     DialogueTree tree;
+
+    if (argc == 3 && std::string(argv[1]) == "--analyze") {
+        // 不可达节点由分析报告列出，载入时不作为错误
+        if (!tree.loadFromFile(argv[2], false)) return 1;
+        return tree.analyze() ? 0 : 1;
+    }
+
+    if (argc == 4 && std::string(argv[1]) == "--compile") {
+        if (!tree.loadFromFile(argv[2])) return 1;
+        if (!tree.saveBinary(argv[3])) {
+            std::cerr << "无法写入 " << argv[3] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    bool loaded = argc > 1 ? tree.loadFromFile(argv[1]) : tree.initializeDialogue();
+    if (!loaded) return 1;
+
     tree.startDialogue();
     return 0;
-}
\ No newline at end of file
+}
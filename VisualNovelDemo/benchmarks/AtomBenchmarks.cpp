@@ -0,0 +1,121 @@
+#include "BenchmarkHarness.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AtomTable.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        const size_t kCastCount = 12;
+        const size_t kExpressionCount = 8;
+        const char* const kPresets[] = {"left", "center", "right"};
+        const char* const kExpressions[] = {"normal", "happy", "sad", "angry", "surprised", "sleepy", "smile", "cry"};
+
+        // 与 CharacterRenderer 中按名字查找的三张表同样大小：角色、位置预设、每个角色的表情
+        struct NameKeyedScene {
+            std::map<std::string, std::map<std::string, int>> characters;
+            std::map<std::string, float> presets;
+        };
+
+        struct AtomKeyedScene {
+            AtomMap<AtomMap<int>> characters;
+            AtomMap<float> presets;
+        };
+
+        // 一条 @show 命令的三个名字
+        struct ShowCommand {
+            std::string character, preset, expression;
+            Atom characterAtom, presetAtom, expressionAtom;
+        };
+
+        std::vector<ShowCommand> MakeCommands(size_t count) {
+            std::vector<ShowCommand> commands;
+            for (size_t i = 0; i < count; ++i) {
+                ShowCommand command;
+                command.character = "character_" + std::to_string((i * 7) % kCastCount);
+                command.preset = kPresets[i % 3];
+                command.expression = kExpressions[(i * 5) % kExpressionCount];
+                // 解析时驻留一次
+                command.characterAtom = Atoms::Intern(command.character);
+                command.presetAtom = Atoms::Intern(command.preset);
+                command.expressionAtom = Atoms::Intern(command.expression);
+                commands.push_back(command);
+            }
+            return commands;
+        }
+    }
+
+    // 角色名驻留：执行 @show 时按名字查找角色、位置预设和表情，字符串键与 Atom 键对比
+    void RegisterAtomBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        const std::string stringName = "atoms/ShowLookup/string";
+        const std::string atomName = "atoms/ShowLookup/atom";
+        const std::string internName = "atoms/Intern/existing";
+        if (!IsSelected(options, stringName) && !IsSelected(options, atomName) && !IsSelected(options, internName)) {
+            return;
+        }
+        auto commands = std::make_shared<std::vector<ShowCommand>>(MakeCommands(1024));
+
+        if (IsSelected(options, stringName)) {
+            auto scene = std::make_shared<NameKeyedScene>();
+            for (size_t c = 0; c < kCastCount; ++c) {
+                auto& expressions = scene->characters["character_" + std::to_string(c)];
+                for (size_t e = 0; e < kExpressionCount; ++e) expressions[kExpressions[e]] = static_cast<int>(e);
+            }
+            for (size_t p = 0; p < 3; ++p) scene->presets[kPresets[p]] = 0.25f * (p + 1);
+            runner.Add(stringName, "commands", [scene, commands](uint64_t iterations) {
+                float sum = 0.0f;
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    const ShowCommand& command = (*commands)[i & 1023];
+                    auto character = scene->characters.find(command.character);
+                    auto preset = scene->presets.find(command.preset);
+                    if (character == scene->characters.end() || preset == scene->presets.end()) continue;
+                    auto expression = character->second.find(command.expression);
+                    if (expression != character->second.end()) sum += preset->second + expression->second;
+                }
+                DoNotOptimize(&sum);
+                return iterations;
+            });
+        }
+
+        if (IsSelected(options, atomName)) {
+            auto scene = std::make_shared<AtomKeyedScene>();
+            for (size_t c = 0; c < kCastCount; ++c) {
+                AtomMap<int>& expressions = scene->characters[Atoms::Intern("character_" + std::to_string(c))];
+                for (size_t e = 0; e < kExpressionCount; ++e) {
+                    expressions.Insert(Atoms::Intern(kExpressions[e]), static_cast<int>(e));
+                }
+            }
+            for (size_t p = 0; p < 3; ++p) scene->presets.Insert(Atoms::Intern(kPresets[p]), 0.25f * (p + 1));
+            runner.Add(atomName, "commands", [scene, commands](uint64_t iterations) {
+                float sum = 0.0f;
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    const ShowCommand& command = (*commands)[i & 1023];
+                    const AtomMap<int>* character = scene->characters.Find(command.characterAtom);
+                    const float* preset = scene->presets.Find(command.presetAtom);
+                    if (!character || !preset) continue;
+                    const int* expression = character->Find(command.expressionAtom);
+                    if (expression) sum += *preset + *expression;
+                }
+                DoNotOptimize(&sum);
+                return iterations;
+            });
+        }
+
+        // 解析脚本时每个名字驻留一次的代价
+        if (IsSelected(options, internName)) {
+            runner.Add(internName, "names", [commands](uint64_t iterations) {
+                uint32_t sum = 0;
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    sum += static_cast<uint32_t>(Atoms::Intern((*commands)[i & 1023].character));
+                }
+                DoNotOptimize(&sum);
+                return iterations;
+            });
+        }
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
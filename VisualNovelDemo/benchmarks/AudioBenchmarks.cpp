@@ -0,0 +1,130 @@
+#include "BenchmarkHarness.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "AudioMixer.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        const char* const kAudioRoot = "bench_audio";
+
+        // 写一个正弦波 16 位 PCM WAV
+        void WriteTone(const std::string& name, int sampleRate, int channels, double seconds, double frequency) {
+            std::filesystem::create_directories(kAudioRoot);
+            std::ofstream file(std::string(kAudioRoot) + "/" + name, std::ios::binary);
+            uint32_t frames = static_cast<uint32_t>(sampleRate * seconds);
+            uint32_t dataBytes = frames * channels * 2;
+            auto put = [&file](uint32_t value, int bytes) {
+                for (int i = 0; i < bytes; ++i) file.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+            };
+            file.write("RIFF", 4);
+            put(36 + dataBytes, 4);
+            file.write("WAVEfmt ", 8);
+            put(16, 4);
+            put(1, 2);
+            put(static_cast<uint32_t>(channels), 2);
+            put(static_cast<uint32_t>(sampleRate), 4);
+            put(static_cast<uint32_t>(sampleRate * channels * 2), 4);
+            put(static_cast<uint32_t>(channels * 2), 2);
+            put(16, 2);
+            file.write("data", 4);
+            put(dataBytes, 4);
+            for (uint32_t i = 0; i < frames; ++i) {
+                double value = std::sin(6.283185307179586 * frequency * i / sampleRate) * 0.25;
+                for (int c = 0; c < channels; ++c) {
+                    put(static_cast<uint16_t>(static_cast<int16_t>(value * 32767.0)), 2);
+                }
+            }
+        }
+
+        std::shared_ptr<AudioMixer> MakeMixer(bool simd) {
+            AudioConfig config;
+            config.assetRoot = kAudioRoot;
+            auto mixer = std::make_shared<AudioMixer>(config);
+            mixer->SetUseSimd(simd);
+            return mixer;
+        }
+
+        // BGM（44.1kHz 需要重采样）+ 语音 + 30 个循环环境音
+        void StartBusyScene(AudioMixer& mixer) {
+            mixer.PlayBgm("bgm.ogg");  // 没有 .ogg 时使用同名的 .wav
+            mixer.PlayVoice("voice.wav");
+            for (int i = 0; i < 30; ++i) {
+                mixer.PlaySound("ambient.wav", true);
+            }
+        }
+    }
+
+    // 混音：32 路同时播放时每块（512 帧）的解码与混音耗时，SSE 与标量对比；并检查语音起播延迟和两条路径的结果
+    void RegisterAudioBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        const std::string simdName = "audio/DecodeAndMix/32voices/simd";
+        const std::string scalarName = "audio/DecodeAndMix/32voices/scalar";
+        const std::string latencyName = "audio/VoiceStartLatency";
+        const std::string matchName = "audio/SimdMatchesScalar";
+        if (!IsSelected(options, simdName) && !IsSelected(options, scalarName) && !IsSelected(options, latencyName) &&
+            !IsSelected(options, matchName)) {
+            return;
+        }
+        WriteTone("bgm.wav", 44100, 2, 3.0, 220.0);
+        WriteTone("voice.wav", 48000, 1, 30.0, 440.0);
+        WriteTone("ambient.wav", 22050, 1, 1.0, 330.0);
+
+        for (bool simd : {true, false}) {
+            const std::string& name = simd ? simdName : scalarName;
+            if (!IsSelected(options, name)) continue;
+            auto mixer = MakeMixer(simd);
+            StartBusyScene(*mixer);
+            auto block = std::make_shared<std::vector<int16_t>>(mixer->GetConfig().bufferFrames * 2);
+            // 环形缓冲能存 32 块，每 16 块补一次解码；解码（含 44.1k/22.05k 重采样）占大部分时间
+            runner.Add(name, "blocks", [mixer, block](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    if (i % 16 == 0) mixer->Decode();
+                    mixer->MixBlock(block->data());
+                }
+                DoNotOptimize(block->data());
+                return iterations;
+            });
+        }
+
+        // 语音在 PlayVoice 之后的第一块就要有声音
+        if (IsSelected(options, latencyName)) {
+            auto mixer = MakeMixer(true);
+            std::vector<int16_t> block(mixer->GetConfig().bufferFrames * 2);
+            mixer->PlayBgm("bgm.wav");
+            for (int i = 0; i < 8; ++i) mixer->MixBlock(block.data());
+            std::vector<int16_t> withoutVoice = block;
+            mixer->PlayVoice("voice.wav");
+            mixer->MixBlock(block.data());
+            if (block == withoutVoice) {
+                runner.Fail(latencyName, "PlayVoice 之后的第一块混音中没有语音");
+            }
+        }
+
+        // 浮点乘加的顺序相同，两条路径转成 16 位后最多差 1
+        if (IsSelected(options, matchName)) {
+            auto simd = MakeMixer(true);
+            auto scalar = MakeMixer(false);
+            StartBusyScene(*simd);
+            StartBusyScene(*scalar);
+            std::vector<int16_t> a(simd->GetConfig().bufferFrames * 2), b(a.size());
+            int maxDifference = 0;
+            for (int i = 0; i < 200; ++i) {
+                simd->Decode();
+                scalar->Decode();
+                simd->MixBlock(a.data());
+                scalar->MixBlock(b.data());
+                for (size_t j = 0; j < a.size(); ++j) {
+                    maxDifference = std::max(maxDifference, std::abs(int(a[j]) - int(b[j])));
+                }
+            }
+            if (maxDifference > 1) {
+                runner.Fail(matchName, "SSE 与标量混音结果相差 " + std::to_string(maxDifference));
+            }
+        }
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
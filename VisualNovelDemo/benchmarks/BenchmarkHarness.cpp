@@ -0,0 +1,246 @@
+#include "BenchmarkHarness.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        double ElapsedNs(Clock::time_point start) {
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        }
+
+        std::string EscapeJson(const std::string& text) {
+            std::string out;
+            for (char c : text) {
+                switch (c) {
+                    case '"': out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    default: out += c; break;
+                }
+            }
+            return out;
+        }
+
+        bool ParsePositiveInt(const char* text, int& value) {
+            char* end = nullptr;
+            errno = 0;
+            long parsed = std::strtol(text, &end, 10);
+            if (end == text || *end != '\0' || errno == ERANGE || parsed < 1 || parsed > INT_MAX) {
+                return false;
+            }
+            value = static_cast<int>(parsed);
+            return true;
+        }
+
+        bool ParsePositiveDouble(const char* text, double& value) {
+            char* end = nullptr;
+            errno = 0;
+            double parsed = std::strtod(text, &end);
+            if (end == text || *end != '\0' || errno == ERANGE || !(parsed > 0.0)) {
+                return false;
+            }
+            value = parsed;
+            return true;
+        }
+
+        std::string CompilerName() {
+#if defined(__clang__)
+            return "clang " __clang_version__;
+#elif defined(__GNUC__)
+            return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+            return "msvc " + std::to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        }
+
+        volatile const void* sink = nullptr;
+    }
+
+    void DoNotOptimize(const void* value) {
+        sink = value;
+    }
+
+    bool IsSelected(const BenchmarkOptions& options, const std::string& name) {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    void BenchmarkRunner::Add(const std::string& name, const std::string& unit, BenchmarkBody body) {
+        cases.push_back({name, unit, false, std::move(body)});
+    }
+
+    void BenchmarkRunner::AddMacro(const std::string& name, const std::string& unit, BenchmarkBody body) {
+        cases.push_back({name, unit, true, std::move(body)});
+    }
+
+    void BenchmarkRunner::SetCounter(const std::string& benchmark, const std::string& counter, double value) {
+        pendingCounters[benchmark][counter] = value;
+    }
+
+    void BenchmarkRunner::Fail(const std::string& benchmark, const std::string& reason) {
+        failures.push_back(benchmark + ": " + reason);
+    }
+
+    const std::vector<std::string>& BenchmarkRunner::GetFailures() const {
+        return failures;
+    }
+
+    void BenchmarkRunner::Run(const BenchmarkOptions& options) {
+        results.clear();
+        for (const BenchmarkCase& benchmark : cases) {
+            if (!IsSelected(options, benchmark.name)) {
+                continue;
+            }
+            std::cerr << "[运行] " << benchmark.name << std::endl;
+            results.push_back(RunCase(benchmark, options));
+        }
+    }
+
+    BenchmarkResult BenchmarkRunner::RunCase(const BenchmarkCase& benchmark, const BenchmarkOptions& options) {
+        BenchmarkResult result;
+        result.name = benchmark.name;
+        result.unit = benchmark.unit;
+
+        // 预热，同时做倍增校准直到单次运行超过 minSeconds
+        uint64_t iterations = 1;
+        while (true) {
+            Clock::time_point start = Clock::now();
+            benchmark.body(iterations);
+            double elapsed = ElapsedNs(start);
+            if (benchmark.macro || elapsed >= options.minSeconds * 1e9 || iterations >= (1ull << 30)) {
+                break;
+            }
+            double scale = elapsed > 0 ? (options.minSeconds * 1e9 * 1.2) / elapsed : 10.0;
+            iterations = std::max<uint64_t>(iterations + 1,
+                                            static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+        }
+
+        uint64_t items = 0;
+        for (int r = 0; r < std::max(1, options.repetitions); ++r) {
+            Clock::time_point start = Clock::now();
+            items = benchmark.body(iterations);
+            result.samplesNs.push_back(ElapsedNs(start) / static_cast<double>(iterations));
+        }
+
+        std::vector<double> sorted = result.samplesNs;
+        std::sort(sorted.begin(), sorted.end());
+        result.iterations = iterations;
+        result.items = items;
+        result.minNs = sorted.front();
+        result.maxNs = sorted.back();
+        result.medianNs = sorted[sorted.size() / 2];
+        double itemsPerIteration = static_cast<double>(items) / static_cast<double>(iterations);
+        result.itemsPerSecond = result.medianNs > 0 ? itemsPerIteration * 1e9 / result.medianNs : 0;
+
+        auto counters = pendingCounters.find(benchmark.name);
+        if (counters != pendingCounters.end()) {
+            result.counters = counters->second;
+        }
+        return result;
+    }
+
+    const std::vector<BenchmarkResult>& BenchmarkRunner::GetResults() const {
+        return results;
+    }
+
+    void BenchmarkRunner::WriteJson(std::ostream& out) const {
+        std::time_t now = std::time(nullptr);
+        char timestamp[32];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        out << std::setprecision(6) << std::fixed;
+        out << "{\n";
+        out << "  \"suite\": \"dialogue_benchmarks\",\n";
+        out << "  \"schema_version\": 1,\n";
+        out << "  \"timestamp\": \"" << timestamp << "\",\n";
+        out << "  \"compiler\": \"" << EscapeJson(CompilerName()) << "\",\n";
+#ifdef NDEBUG
+        out << "  \"build\": \"release\",\n";
+#else
+        out << "  \"build\": \"debug\",\n";
+#endif
+        out << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& r = results[i];
+            out << "    {\n";
+            out << "      \"name\": \"" << EscapeJson(r.name) << "\",\n";
+            out << "      \"unit\": \"" << EscapeJson(r.unit) << "\",\n";
+            out << "      \"iterations\": " << r.iterations << ",\n";
+            out << "      \"items_per_iteration\": " << (r.iterations ? r.items / r.iterations : 0) << ",\n";
+            out << "      \"ns_per_iteration\": {\"min\": " << r.minNs << ", \"median\": " << r.medianNs
+                << ", \"max\": " << r.maxNs << "},\n";
+            out << "      \"items_per_second\": " << r.itemsPerSecond;
+            if (!r.counters.empty()) {
+                out << ",\n      \"counters\": {";
+                bool first = true;
+                for (const auto& counter : r.counters) {
+                    out << (first ? "" : ", ") << "\"" << EscapeJson(counter.first) << "\": " << counter.second;
+                    first = false;
+                }
+                out << "}";
+            }
+            out << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n";
+        out << "}\n";
+    }
+
+    void BenchmarkRunner::WriteTable(std::ostream& out) const {
+        out << std::left << std::setw(48) << "基准" << std::right << std::setw(16) << "ns/次"
+            << std::setw(18) << "吞吐量" << "\n";
+        for (const BenchmarkResult& r : results) {
+            out << std::left << std::setw(48) << r.name << std::right << std::setw(16)
+                << std::setprecision(1) << std::fixed << r.medianNs
+                << std::setw(14) << std::setprecision(0) << r.itemsPerSecond << " " << r.unit << "/s\n";
+        }
+    }
+
+    bool BenchmarkRunner::ParseOptions(int argc, char* argv[], BenchmarkOptions& options) {
+        std::string error;
+        for (int i = 1; i < argc && error.empty(); ++i) {
+            std::string arg = argv[i];
+            bool takesValue = arg == "--filter" || arg == "--repetitions" || arg == "--min-time" || arg == "--json";
+            if (takesValue && i + 1 >= argc) {
+                error = arg + " 缺少取值";
+            } else if (arg == "--filter") {
+                options.filter = argv[++i];
+            } else if (arg == "--repetitions") {
+                if (!ParsePositiveInt(argv[++i], options.repetitions)) {
+                    error = "--repetitions 需要正整数: " + std::string(argv[i]);
+                }
+            } else if (arg == "--min-time") {
+                if (!ParsePositiveDouble(argv[++i], options.minSeconds)) {
+                    error = "--min-time 需要大于 0 的秒数: " + std::string(argv[i]);
+                }
+            } else if (arg == "--json") {
+                options.jsonPath = argv[++i];
+            } else if (arg == "--quick") {
+                options.quick = true;
+            } else {
+                error = "未知参数: " + arg;
+            }
+        }
+        if (!error.empty()) {
+            std::cerr << error << "\n"
+                      << "用法: dialogue_benchmarks [--filter 子串] [--repetitions N] "
+                         "[--min-time 秒] [--json 文件] [--quick]" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
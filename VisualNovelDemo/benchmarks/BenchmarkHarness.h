@@ -0,0 +1,105 @@
+#pragma once
+#ifndef BENCHMARK_HARNESS_H
+#define BENCHMARK_HARNESS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <ostream>
+#include <cstdint>
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    // 单个基准的一次运行：body(iterations) 执行 iterations 次被测操作，
+    // 返回实际处理的条目数（行、帧、命令等），用于计算吞吐量
+    using BenchmarkBody = std::function<uint64_t(uint64_t iterations)>;
+
+    struct BenchmarkCase {
+        std::string name;       // 形如 "parse/ScriptParser/10000"
+        std::string unit;       // 条目的单位，如 "lines"、"frames"
+        bool macro;             // 宏基准：每次迭代耗时长，不做倍增校准
+        BenchmarkBody body;
+    };
+
+    struct BenchmarkResult {
+        std::string name;
+        std::string unit;
+        uint64_t iterations;
+        uint64_t items;
+        std::vector<double> samplesNs;  // 每次重复的单次迭代耗时
+        double minNs;
+        double medianNs;
+        double maxNs;
+        double itemsPerSecond;
+        std::map<std::string, double> counters;
+    };
+
+    struct BenchmarkOptions {
+        std::string filter;          // 名称包含该子串的基准才运行
+        int repetitions = 5;
+        double minSeconds = 0.2;     // 微基准校准的最短运行时间
+        bool quick = false;          // 跳过最大规模的输入
+        std::string jsonPath;        // 为空时输出到标准输出
+    };
+
+    // 基准注册与运行：固定随机种子、预热一次、取多次重复的中位数
+    class BenchmarkRunner {
+    private:
+        std::vector<BenchmarkCase> cases;
+        std::vector<BenchmarkResult> results;
+        std::map<std::string, std::map<std::string, double>> pendingCounters;
+        std::vector<std::string> failures;
+
+    public:
+        void Add(const std::string& name, const std::string& unit, BenchmarkBody body);
+        void AddMacro(const std::string& name, const std::string& unit, BenchmarkBody body);
+
+        // 基准可在运行时记录额外的指标（如内存、分配次数），写入结果
+        void SetCounter(const std::string& benchmark, const std::string& counter, double value);
+
+        // 基准同时可以充当检查：记录失败后 dialogue_benchmarks 以非零状态退出
+        void Fail(const std::string& benchmark, const std::string& reason);
+        const std::vector<std::string>& GetFailures() const;
+
+        void Run(const BenchmarkOptions& options);
+        const std::vector<BenchmarkResult>& GetResults() const;
+
+        void WriteJson(std::ostream& out) const;
+        void WriteTable(std::ostream& out) const;
+
+        // 未知参数、缺少取值或取值不合法时输出原因和用法，返回 false
+        static bool ParseOptions(int argc, char* argv[], BenchmarkOptions& options);
+
+    private:
+        BenchmarkResult RunCase(const BenchmarkCase& benchmark, const BenchmarkOptions& options);
+    };
+
+    // 防止被测结果被编译器优化掉
+    void DoNotOptimize(const void* value);
+
+    // 注册前判断基准是否会被运行，未选中的基准跳过耗时的准备工作
+    bool IsSelected(const BenchmarkOptions& options, const std::string& name);
+
+    // 各组基准的注册函数
+    void RegisterScriptBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterDialogueBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterRendererBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterSaveBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterChatBotBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterProfilerBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterMetricsBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterProjectBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterSearchBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterCompiledScriptBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterCompositorBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterAudioBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterTweenBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterAtomBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+    void RegisterHostBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options);
+
+} // namespace Benchmarks
+} // namespace VisualNovel
+
+#endif // BENCHMARK_HARNESS_H
@@ -0,0 +1,55 @@
+#include <fstream>
+#include <iostream>
+#include "BenchmarkHarness.h"
+
+using namespace VisualNovel::Benchmarks;
+
+// dialogue_benchmarks：引擎各热点路径的微基准与宏基准
+// 结果以 JSON 输出（--json 文件，默认标准输出），便于在版本之间比较回归
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if (!BenchmarkRunner::ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    BenchmarkRunner runner;
+    RegisterScriptBenchmarks(runner, options);
+    RegisterDialogueBenchmarks(runner, options);
+    RegisterRendererBenchmarks(runner, options);
+    RegisterSaveBenchmarks(runner, options);
+    RegisterChatBotBenchmarks(runner, options);
+    RegisterProfilerBenchmarks(runner, options);
+    RegisterMetricsBenchmarks(runner, options);
+    RegisterProjectBenchmarks(runner, options);
+    RegisterSearchBenchmarks(runner, options);
+    RegisterCompiledScriptBenchmarks(runner, options);
+    RegisterCompositorBenchmarks(runner, options);
+    RegisterAudioBenchmarks(runner, options);
+    RegisterTweenBenchmarks(runner, options);
+    RegisterAtomBenchmarks(runner, options);
+    RegisterHostBenchmarks(runner, options);
+
+    runner.Run(options);
+    if (runner.GetResults().empty()) {
+        // 拼错的 --filter 不应当作全部通过
+        std::cerr << "没有名称包含 \"" << options.filter << "\" 的基准" << std::endl;
+        return 1;
+    }
+    runner.WriteTable(std::cerr);
+
+    if (options.jsonPath.empty()) {
+        runner.WriteJson(std::cout);
+    } else {
+        std::ofstream file(options.jsonPath);
+        if (!file) {
+            std::cerr << "无法写入 " << options.jsonPath << std::endl;
+            return 1;
+        }
+        runner.WriteJson(file);
+    }
+
+    for (const std::string& failure : runner.GetFailures()) {
+        std::cerr << "[失败] " << failure << std::endl;
+    }
+    return runner.GetFailures().empty() ? 0 : 2;
+}
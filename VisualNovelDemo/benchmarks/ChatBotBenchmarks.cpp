@@ -0,0 +1,26 @@
+#include "BenchmarkHarness.h"
+#include <string>
+#include <vector>
+#include "InputClassifier.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    void RegisterChatBotBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions&) {
+        static const std::vector<std::string> inputs = {
+            "你好呀", "Hello there", "你叫什么名字？", "今天心情不太好", "我们来玩游戏吧",
+            "拜拜~", "我好喜欢你", "今天吃了什么", "感觉有点累", "BYE", "嗨！", "随便聊聊吧"
+        };
+
+        runner.Add("chatbot/classifyInput", "inputs", [](uint64_t iterations) {
+            int histogram[7] = {0};
+            for (uint64_t i = 0; i < iterations; ++i) {
+                ++histogram[static_cast<int>(classifyInput(inputs[i % inputs.size()]))];
+            }
+            DoNotOptimize(histogram);
+            return iterations;
+        });
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
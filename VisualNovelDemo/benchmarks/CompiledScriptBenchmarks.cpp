@@ -0,0 +1,98 @@
+#include "BenchmarkHarness.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include "ScriptInterpreter.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        // CMake 在构建时用 script_generator 生成这份脚本，再用 script_compiler 编译进基准程序
+        const char* const kCompiledScriptPath = "bench_aot/scripts/generated.txt";
+
+        // 一直选第一个选项，直到脚本结束；返回 Update 次数
+        uint64_t PlayThrough(ScriptInterpreter& interpreter, uint64_t limit) {
+            interpreter.Start();
+            uint64_t steps = 0;
+            while (interpreter.IsRunning() && steps < limit) {
+                interpreter.Update(0.0f);
+                ++steps;
+                const ChoiceOptionList& choices = interpreter.GetChoiceOptions();
+                if (!choices.empty()) {
+                    interpreter.JumpToLabel(std::string(choices.front().targetLabel));
+                } else {
+                    interpreter.Resume();
+                }
+            }
+            return steps;
+        }
+    }
+
+    // 预编译脚本：同一份脚本解释执行与执行 script_compiler 生成的代码，对比载入和通关
+    void RegisterCompiledScriptBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        const std::string suffix = "/10000";
+        const std::string loadInterpreted = "aot/LoadScript/interpreted" + suffix;
+        const std::string loadCompiled = "aot/LoadScript/compiled" + suffix;
+        const std::string playInterpreted = "aot/Playthrough/interpreted" + suffix;
+        const std::string playCompiled = "aot/Playthrough/compiled" + suffix;
+        if (!IsSelected(options, loadInterpreted) && !IsSelected(options, loadCompiled) &&
+            !IsSelected(options, playInterpreted) && !IsSelected(options, playCompiled)) {
+            return;
+        }
+
+        const CompiledScript* compiled = CompiledScriptRegistry::Find(kCompiledScriptPath);
+        std::ifstream file(kCompiledScriptPath, std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        if (!compiled || !file || HashScriptSource(content.str()) != compiled->sourceHash) {
+            std::cerr << "跳过 aot/*: 没有与 " << kCompiledScriptPath << " 一致的预编译脚本" << std::endl;
+            return;
+        }
+
+        runner.AddMacro(loadInterpreted, "loads", [](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                ScriptInterpreter interpreter;
+                interpreter.SetUseCompiledScripts(false);
+                interpreter.LoadScript(kCompiledScriptPath);
+                DoNotOptimize(&interpreter);
+            }
+            return iterations;
+        });
+
+        // 仍然读入文件并校验哈希，与游戏中 LoadScript 的实际开销一致
+        runner.AddMacro(loadCompiled, "loads", [](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                ScriptInterpreter interpreter;
+                interpreter.LoadScript(kCompiledScriptPath);
+                DoNotOptimize(&interpreter);
+            }
+            return iterations;
+        });
+
+        const uint64_t limit = 1000000;
+        auto interpreted = std::make_shared<ScriptInterpreter>();
+        interpreted->SetUseCompiledScripts(false);
+        interpreted->LoadScript(kCompiledScriptPath);
+        runner.AddMacro(playInterpreted, "steps", [interpreted, limit](uint64_t iterations) {
+            uint64_t steps = 0;
+            for (uint64_t i = 0; i < iterations; ++i) {
+                steps += PlayThrough(*interpreted, limit);
+            }
+            return steps;
+        });
+
+        auto native = std::make_shared<ScriptInterpreter>();
+        native->LoadScript(kCompiledScriptPath);
+        runner.AddMacro(playCompiled, "steps", [native, limit](uint64_t iterations) {
+            uint64_t steps = 0;
+            for (uint64_t i = 0; i < iterations; ++i) {
+                steps += PlayThrough(*native, limit);
+            }
+            return steps;
+        });
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
@@ -0,0 +1,458 @@
+#include "BenchmarkHarness.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "ScriptParser.h"
+#include "ScriptGenerator.h"
+#include "ScriptInterpreter.h"
+#include "DialogueSystem.h"
+#include "AllocationCounter.h"
+#include "Metrics.h"
+#include "CharacterRenderer.h"
+#include "VisualNovelEngine.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        const uint32_t kSeed = 20240601u;
+        const float kFrameTime = 1.0f / 60.0f;
+        const char* const kCharacterConfig = "data/characters/sakura.json";
+
+        std::vector<size_t> ScriptSizes(const BenchmarkOptions& options) {
+            if (options.quick) return {10000, 100000};
+            return {10000, 100000, 1000000};
+        }
+
+        // 分支剧本由 ScriptGenerator 生成，相同参数总是得到相同的文本
+        std::string GenerateScript(size_t lineCount, uint32_t seed) {
+            ScriptGeneratorOptions generatorOptions;
+            generatorOptions.lineCount = lineCount;
+            generatorOptions.seed = seed;
+            return ScriptGenerator(generatorOptions).GenerateScript();
+        }
+
+        // 不含等待和选择支的线性脚本，用于测量解释器每秒能执行多少步
+        std::string GenerateStraightScript(size_t commandCount) {
+            std::ostringstream out;
+            for (size_t i = 0; i < commandCount; ++i) {
+                if (i % 16 == 0) {
+                    out << "@label step_" << i << "\n";
+                } else {
+                    out << "@set counter_" << (i % 64) << " " << i << "\n";
+                }
+            }
+            out << "@end\n";
+            return out.str();
+        }
+
+        std::vector<DialogueLine> GenerateDialogue(size_t count) {
+            std::vector<DialogueLine> lines(count);
+            for (size_t i = 0; i < count; ++i) {
+                lines[i].characterName = i % 2 ? "tomoyo" : "sakura";
+                lines[i].characterDisplayName = i % 2 ? "大道寺知世" : "木之本樱";
+                lines[i].text = "早上好，知世！今天天气真好呢~ 我们一起去上学吧！第" + std::to_string(i) + "句";
+                lines[i].expression = "happy";
+                lines[i].position = i % 2 ? "right" : "left";
+                lines[i].displaySpeed = 1.0f;
+                lines[i].effects = {"shake", "wave"};
+                lines[i].metadata["voice"] = "voice/line_" + std::to_string(i) + ".ogg";
+            }
+            return lines;
+        }
+        // 各类型命令的执行次数之和（EngineMetrics 在每条命令执行时计数）
+        uint64_t ExecutedCommands() {
+            const EngineMetrics& metrics = EngineMetrics::Get();
+            uint64_t total = 0;
+            for (MetricId counter : metrics.commandsExecuted) {
+                total += MetricsRegistry::Instance().GetCounter(counter);
+            }
+            return total;
+        }
+
+        // 大量脚本挂起在 @wait 上，共用一个调度器
+        struct SchedulerState {
+            ScriptScheduler scheduler;
+            std::vector<std::unique_ptr<ScriptInterpreter>> interpreters;
+        };
+
+        // 执行到第一批台词为止；返回 Update 次数
+        uint64_t RunToFirstLine(ScriptInterpreter& interpreter) {
+            interpreter.Start();
+            uint64_t updates = 0;
+            while (interpreter.IsRunning() && interpreter.GetDialogueLines().empty()) {
+                interpreter.Update(0.0f);
+                ++updates;
+                // 游戏中两帧之间有空闲，这里让出 CPU，单核机器上后台解析才能推进
+                std::this_thread::yield();
+            }
+            return updates;
+        }
+
+        struct SteadyState {
+            DialogueSystem system;
+            EngineEventQueue events;
+            std::vector<DialogueLine> lines;
+            uint64_t frames = 0;
+            bool failed = false;
+        };
+
+        // 跳过模式下的一帧：大量台词、背景和 BGM 切换
+        struct SkipFrame {
+            std::vector<std::pair<EngineEventType, std::string>> script;
+            std::function<void(const std::string&)> onText;
+            std::function<void(const std::string&)> onBackground;
+            std::function<void(const std::string&)> onBgm;
+            std::function<void()> onChoice;
+            EngineEventQueue queue;
+            size_t delivered = 0;
+        };
+    }
+
+    void RegisterScriptBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        for (size_t lines : ScriptSizes(options)) {
+            if (!IsSelected(options, "parse/ScriptParser/" + std::to_string(lines)) &&
+                !IsSelected(options, "parse/ScriptParser+SceneArena/" + std::to_string(lines)) &&
+                !IsSelected(options, "parse/LoadScriptFromString/" + std::to_string(lines))) {
+                continue;
+            }
+            auto script = std::make_shared<std::string>(GenerateScript(lines, kSeed));
+
+            runner.AddMacro("parse/ScriptParser/" + std::to_string(lines), "lines",
+                [script, lines](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; ++i) {
+                        ScriptCommandList commands;
+                        std::map<std::string, ScriptLabel> labels;
+                        ScriptParser parser(commands, labels);
+                        parser.Parse(*script);
+                        DoNotOptimize(commands.data());
+                    }
+                    return iterations * lines;
+                });
+
+            // 同样的解析，命令分配在场景分配区中，拆除时整块归还
+            runner.AddMacro("parse/ScriptParser+SceneArena/" + std::to_string(lines), "lines",
+                [script, lines](uint64_t iterations) {
+                    SceneArena arena;
+                    for (uint64_t i = 0; i < iterations; ++i) {
+                        auto* commands = arena.Make<ScriptCommandList>();
+                        std::map<std::string, ScriptLabel> labels;
+                        ScriptParser parser(*commands, labels);
+                        parser.Parse(*script);
+                        DoNotOptimize(commands->data());
+                        arena.Reset();
+                    }
+                    return iterations * lines;
+                });
+
+            runner.AddMacro("parse/LoadScriptFromString/" + std::to_string(lines), "lines",
+                [script, lines](uint64_t iterations) {
+                    ScriptInterpreter interpreter;
+                    for (uint64_t i = 0; i < iterations; ++i) {
+                        interpreter.LoadScriptFromString(*script);
+                        interpreter.ClearScript();
+                    }
+                    return iterations * lines;
+                });
+        }
+
+        // 从开始载入到第一批台词可以显示的时间：一次性解析整个文件与边解析边执行对比
+        for (size_t lines : ScriptSizes(options)) {
+            const std::string blockingName = "load/FirstLine/LoadScript/" + std::to_string(lines);
+            const std::string streamingName = "load/FirstLine/LoadScriptStreaming/" + std::to_string(lines);
+            if (!IsSelected(options, blockingName) && !IsSelected(options, streamingName)) {
+                continue;
+            }
+            std::string path = (std::filesystem::temp_directory_path() /
+                                ("vn_bench_stream_" + std::to_string(lines) + ".txt")).string();
+            {
+                std::ofstream file(path, std::ios::binary);
+                file << GenerateScript(lines, kSeed);
+            }
+
+            runner.AddMacro(blockingName, "loads", [path](uint64_t iterations) {
+                ScriptInterpreter interpreter;
+                interpreter.SetUseCompiledScripts(false);
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    interpreter.LoadScript(path);
+                    uint64_t updates = RunToFirstLine(interpreter);
+                    DoNotOptimize(&updates);
+                }
+                return iterations;
+            });
+
+            // 下一次载入时放弃上一份脚本未解析的部分，计入耗时
+            runner.AddMacro(streamingName, "loads", [path](uint64_t iterations) {
+                ScriptInterpreter interpreter;
+                interpreter.SetUseCompiledScripts(false);
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    interpreter.LoadScriptStreaming(path);
+                    uint64_t updates = RunToFirstLine(interpreter);
+                    DoNotOptimize(&updates);
+                }
+                return iterations;
+            });
+        }
+
+        // 解释器逐条执行命令的开销：脚本在计时外解析一次，每轮以共用方式载入，按实际执行的命令数计
+        const size_t stepCommands = 100000;
+        const std::string stepsName = "interpreter/steps/" + std::to_string(stepCommands);
+        if (IsSelected(options, stepsName)) {
+            auto image = std::make_shared<ScriptImage>();
+            image->arena = std::make_unique<SceneArena>();
+            image->commands = image->arena->Make<ScriptCommandList>();
+            ScriptParser parser(*image->commands, image->labels);
+            if (!parser.Parse(GenerateStraightScript(stepCommands))) {
+                runner.Fail(stepsName, "脚本解析失败");
+            } else {
+                std::shared_ptr<const ScriptImage> shared = std::move(image);
+                auto failed = std::make_shared<bool>(false);
+                runner.AddMacro(stepsName, "commands", [shared, failed, stepsName, &runner](uint64_t iterations) {
+                    uint64_t before = ExecutedCommands();
+                    ScriptInterpreter interpreter;
+                    for (uint64_t i = 0; i < iterations; ++i) {
+                        interpreter.LoadShared(shared);
+                        interpreter.Start();
+                        // 上限防止解释器卡住时基准无法结束
+                        for (size_t guard = 0; interpreter.IsRunning() && guard < 1000; ++guard) {
+                            interpreter.Update(0.0f);
+                        }
+                        if (interpreter.IsRunning()) {
+                            if (!*failed) {
+                                *failed = true;
+                                runner.Fail(stepsName, "脚本没有执行完");
+                            }
+                            break;
+                        }
+                    }
+                    return ExecutedCommands() - before;
+                });
+            }
+        }
+
+        // 大量脚本挂起在 @wait 上时一帧的开销：只有到期的脚本被唤醒执行，其余不参与更新
+        const size_t waitingScripts = 1000;
+        const std::string schedulerName = "interpreter/SharedScheduler/" + std::to_string(waitingScripts);
+        if (IsSelected(options, schedulerName)) {
+            auto state = std::make_shared<SchedulerState>();
+            for (size_t i = 0; i < waitingScripts; ++i) {
+                // 等待时间各不相同，每帧约有几十个脚本到期
+                std::ostringstream script;
+                script << "@label loop\n@wait " << 0.2 + 0.001 * static_cast<double>(i % 400) << "\n@goto loop\n";
+                auto interpreter = std::make_unique<ScriptInterpreter>();
+                interpreter->SetScheduler(&state->scheduler);
+                interpreter->LoadScriptFromString(script.str());
+                interpreter->Start();
+                state->interpreters.push_back(std::move(interpreter));
+            }
+            runner.Add(schedulerName, "frames", [state](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    state->scheduler.Advance(kFrameTime);
+                    for (auto& interpreter : state->interpreters) {
+                        interpreter->Update(kFrameTime);
+                    }
+                }
+                return iterations;
+            });
+        }
+    }
+
+    void RegisterDialogueBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        // 场景载入后推进对话、打字和执行特效都不应分配堆内存，出现任何一次分配即判定失败
+        const std::string steadyName = "dialogue/SteadyState/zero-alloc";
+        if (IsSelected(options, steadyName)) {
+            auto state = std::make_shared<SteadyState>();
+            state->lines = GenerateDialogue(256);
+            state->system.RegisterTextEffect("shake", [](DialogueLine& line, float deltaTime) {
+                line.displaySpeed = 1.0f + 0.1f * deltaTime;
+            });
+            state->system.RegisterTextEffect("wave", [](DialogueLine& line, float) {
+                line.fontSize = 24 + (line.fontSize + 1) % 3;
+            });
+            state->system.SetTypingSpeed(200.0f);
+            state->system.SetAutoPlay(true);
+            state->system.SetAutoPlayDelay(0.05f);
+            state->system.SetEventQueue(&state->events);
+            state->system.StartDialogue(state->lines);
+            state->system.SetAllocationCheck(true);
+
+            runner.SetCounter(steadyName, "allocation_counter_installed", AllocationCounter::IsInstalled() ? 1.0 : 0.0);
+            runner.Add(steadyName, "frames", [state, steadyName, &runner](uint64_t iterations) {
+                DialogueSystem& system = state->system;
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    system.Update(kFrameTime);
+                    if (++state->frames % 7 == 0) {
+                        system.NextLine();
+                    }
+                    DoNotOptimize(system.GetVisibleText().data());
+                    // 宿主每帧取走事件
+                    state->events.Drain([](const EngineEvent& event) { DoNotOptimize(event.value.data()); });
+                    // 定期重新载入场景，载入本身允许分配，不在检查范围内
+                    if (state->frames % 4096 == 0) {
+                        system.StartDialogue(state->lines);
+                    }
+                }
+                uint64_t allocations = system.GetSteadyStateAllocations();
+                runner.SetCounter(steadyName, "steady_state_allocations", static_cast<double>(allocations));
+                if (allocations > 0 && !state->failed) {
+                    state->failed = true;
+                    runner.Fail(steadyName, "稳态下发生了 " + std::to_string(allocations) + " 次堆分配");
+                }
+                return iterations;
+            });
+        }
+
+        // 跳过模式下的一帧，对比逐个回调与每帧取一次事件
+        const std::string callbackName = "events/Callbacks/skip-frame";
+        const std::string queueName = "events/EngineEventQueue/skip-frame";
+        if (IsSelected(options, callbackName) || IsSelected(options, queueName)) {
+            auto frame = std::make_shared<SkipFrame>();
+            for (size_t i = 0; i < 200; ++i) {
+                if (i % 10 == 3) frame->script.emplace_back(EngineEventType::BACKGROUND, "classroom_day_" + std::to_string(i));
+                else if (i % 25 == 7) frame->script.emplace_back(EngineEventType::BGM, "bgm_" + std::to_string(i) + ".ogg");
+                else frame->script.emplace_back(EngineEventType::TEXT, "早上好，知世！今天天气真好呢~ 我们一起去上学吧！第" + std::to_string(i) + "句");
+            }
+            frame->script.emplace_back(EngineEventType::CHOICE, "");
+            SkipFrame* skip = frame.get();
+            frame->onText = [skip](const std::string& text) { skip->delivered += text.size(); };
+            frame->onBackground = [skip](const std::string& name) { skip->delivered += name.size(); };
+            frame->onBgm = [skip](const std::string& name) { skip->delivered += name.size(); };
+            frame->onChoice = [skip]() { ++skip->delivered; };
+
+            // 原来的方式：每个事件一次类型擦除的调用，参数从脚本文本复制成 std::string
+            runner.Add(callbackName, "frames", [frame](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    for (const auto& entry : frame->script) {
+                        std::string_view value = entry.second;
+                        switch (entry.first) {
+                            case EngineEventType::TEXT:       frame->onText(std::string(value)); break;
+                            case EngineEventType::BACKGROUND: frame->onBackground(std::string(value)); break;
+                            case EngineEventType::BGM:        frame->onBgm(std::string(value)); break;
+                            case EngineEventType::CHOICE:     frame->onChoice(); break;
+                            default: break;
+                        }
+                    }
+                }
+                DoNotOptimize(&frame->delivered);
+                return iterations;
+            });
+
+            runner.Add(queueName, "frames", [frame](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    for (const auto& entry : frame->script) {
+                        frame->queue.Push(entry.first, entry.second);
+                    }
+                    frame->queue.Drain([&frame](const EngineEvent& event) { frame->delivered += event.value.size(); });
+                }
+                DoNotOptimize(&frame->delivered);
+                return iterations;
+            });
+        }
+
+        if (!IsSelected(options, "dialogue/Update/typing+effects") && !IsSelected(options, "dialogue/NextLine")) {
+            return;
+        }
+
+        struct DialogueState {
+            DialogueSystem system;
+            std::vector<DialogueLine> lines;
+            size_t advanced = 0;
+        };
+
+        auto typing = std::make_shared<DialogueState>();
+        typing->lines = GenerateDialogue(256);
+        typing->system.SetTypingSpeed(50.0f);
+        typing->system.StartDialogue(typing->lines);
+
+        runner.Add("dialogue/Update/typing+effects", "frames", [typing](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                typing->system.Update(kFrameTime);
+                if (typing->system.IsTypingComplete()) {
+                    typing->system.NextLine();
+                    if (++typing->advanced % typing->lines.size() == 0) {
+                        typing->system.StartDialogue(typing->lines);
+                    }
+                }
+            }
+            return iterations;
+        });
+
+        auto advancing = std::make_shared<DialogueState>();
+        advancing->lines = GenerateDialogue(256);
+
+        runner.Add("dialogue/NextLine", "lines", [advancing](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                if (advancing->advanced++ % advancing->lines.size() == 0) {
+                    advancing->system.StartDialogue(advancing->lines);
+                }
+                advancing->system.CompleteTyping();
+                advancing->system.NextLine();
+            }
+            return iterations;
+        });
+    }
+
+    void RegisterRendererBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        std::vector<size_t> counts = {1, 10, 100, 1000};
+        if (!options.quick) counts.push_back(10000);
+
+        for (size_t count : counts) {
+            if (!IsSelected(options, "renderer/Update+GetRenderList/" + std::to_string(count))) continue;
+            auto renderer = std::make_shared<CharacterRenderer>();
+            renderer->AddPositionPreset("left", {"left", glm::vec2(0.2f, 0.5f), 0.5f, 1.0f, "middle"});
+            renderer->AddPositionPreset("right", {"right", glm::vec2(0.8f, 0.5f), 0.5f, 1.0f, "middle"});
+            std::mt19937 rng(kSeed);
+            for (size_t i = 0; i < count; ++i) {
+                std::string id = "sprite_" + std::to_string(i);
+                CharacterSprite* sprite = renderer->CreateCharacter(id, kCharacterConfig);
+                if (!sprite) continue;
+                renderer->SetCharacterPosition(id, i % 2 ? "left" : "right");
+                sprite->SetDepth(static_cast<float>(rng() % 1000) / 1000.0f);
+                sprite->MoveTo(glm::vec2(static_cast<float>(rng() % 100) / 100.0f, 0.5f), 0.5f);
+            }
+
+            runner.Add("renderer/Update+GetRenderList/" + std::to_string(count), "frames",
+                [renderer](uint64_t iterations) {
+                    size_t visible = 0;
+                    for (uint64_t i = 0; i < iterations; ++i) {
+                        renderer->Update(kFrameTime);
+                        std::vector<CharacterSprite*> list = renderer->GetRenderList();
+                        visible += list.size();
+                    }
+                    DoNotOptimize(&visible);
+                    return iterations;
+                });
+        }
+    }
+
+    void RegisterSaveBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        if (!IsSelected(options, "save/SaveGame+LoadGame")) return;
+
+        const std::string scriptPath = "bench_save_script.txt";
+        {
+            std::ofstream file(scriptPath);
+            file << GenerateScript(2000, kSeed);
+        }
+
+        auto engine = std::make_shared<VisualNovelEngine>();
+        engine->Initialize("config/game_config.ini");
+        engine->StartGame(scriptPath);
+        for (int i = 0; i < 64; ++i) {
+            engine->SetVariable("var_" + std::to_string(i), std::to_string(i * 7));
+            engine->SetFlag("flag_" + std::to_string(i), i % 3 == 0);
+        }
+
+        runner.Add("save/SaveGame+LoadGame", "roundtrips", [engine](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                engine->SaveGame(1, "benchmark");
+                engine->LoadGame(1);
+            }
+            return iterations;
+        });
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "BenchmarkHarness.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "ScriptGenerator.h"
+#include "SessionHost.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        const size_t kSessionCount = 10000;
+        const size_t kSessionBudgetBytes = 16 * 1024;
+        const float kHostFrame = 1.0f / 60.0f;
+
+        std::shared_ptr<const SharedProgram> MakeProgram() {
+            ScriptGeneratorOptions generatorOptions;
+            generatorOptions.lineCount = 2000;
+            ScriptGenerator generator(generatorOptions);
+            return SharedProgram::FromString(generator.GenerateScript(), "generated");
+        }
+
+        // 模拟每位玩家每帧点一次：有选项时选第一个，读完的玩家离开、新玩家加入
+        struct HostLoad {
+            std::shared_ptr<const SharedProgram> program;
+            SessionHost host;
+            std::vector<SessionInput> inputs;
+            std::vector<uint64_t> finished;
+
+            HostLoad(std::shared_ptr<const SharedProgram> shared, const SessionHostConfig& config)
+                : program(std::move(shared)), host(config) {
+                for (size_t i = 0; i < kSessionCount; ++i) {
+                    host.CreateSession(program);
+                }
+            }
+
+            void Step() {
+                host.Tick(kHostFrame);
+                host.Drain([this](const PlayerSession& session) {
+                    if (session.IsFinished()) {
+                        finished.push_back(session.GetId());
+                    } else if (!session.GetChoices().empty()) {
+                        inputs.push_back(SessionInput{session.GetId(), SessionInputType::CHOOSE, 0});
+                    } else {
+                        inputs.push_back(SessionInput{session.GetId(), SessionInputType::ADVANCE, 0});
+                    }
+                });
+                for (const SessionInput& input : inputs) {
+                    host.Post(input);
+                }
+                inputs.clear();
+                for (uint64_t id : finished) {
+                    host.DestroySession(id);
+                    host.CreateSession(program);
+                }
+                finished.clear();
+            }
+        };
+    }
+
+    // 多会话宿主：每个会话的内存（不含共用脚本）和一万个会话同时推进一帧的耗时
+    void RegisterHostBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        const std::string footprintName = "host/SessionFootprint";
+        const std::string tickName = "host/Tick/" + std::to_string(kSessionCount);
+        if (!IsSelected(options, footprintName) && !IsSelected(options, tickName)) {
+            return;
+        }
+        std::shared_ptr<const SharedProgram> program = MakeProgram();
+        if (!program) {
+            runner.Fail(footprintName, "生成的脚本解析失败");
+            return;
+        }
+
+        // 创建会话并执行到第一个等待玩家的位置，统计这期间的分配；在当前线程推进才能计数
+        if (IsSelected(options, footprintName)) {
+            const size_t count = 1000;
+            SessionHostConfig config;
+            config.threadCount = 1;
+            SessionHost host(config);
+            host.CreateSession(program);  // 分片的索引、调度器等一次性的增长不计入
+            host.Tick(kHostFrame);
+            AllocationCounter::Snapshot before = AllocationCounter::GetThreadSnapshot();
+            for (size_t i = 0; i < count; ++i) {
+                host.CreateSession(program);
+            }
+            host.Tick(kHostFrame);
+            AllocationCounter::Snapshot after = AllocationCounter::GetThreadSnapshot();
+            double bytesPerSession = static_cast<double>(after.bytes - before.bytes) / count;
+            double allocationsPerSession = static_cast<double>(after.allocations - before.allocations) / count;
+            runner.SetCounter(footprintName, "bytes_per_session", bytesPerSession);
+            runner.SetCounter(footprintName, "allocations_per_session", allocationsPerSession);
+            if (AllocationCounter::IsInstalled() && bytesPerSession > kSessionBudgetBytes) {
+                runner.Fail(footprintName, "每个会话占用 " + std::to_string(static_cast<size_t>(bytesPerSession)) +
+                                               " 字节，超过 " + std::to_string(kSessionBudgetBytes));
+            }
+            runner.AddMacro(footprintName, "sessions", [program](uint64_t iterations) {
+                SessionHostConfig config;
+                config.threadCount = 1;
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    SessionHost host(config);
+                    for (size_t s = 0; s < count; ++s) {
+                        host.CreateSession(program);
+                    }
+                    host.Tick(kHostFrame);
+                }
+                return iterations * count;
+            });
+        }
+
+        if (IsSelected(options, tickName)) {
+            auto load = std::make_shared<HostLoad>(program, SessionHostConfig());
+            load->Step();  // 所有会话执行到第一个等待点
+            runner.SetCounter(tickName, "threads", static_cast<double>(load->host.GetThreadCount()));
+            runner.SetCounter(tickName, "shards", static_cast<double>(load->host.GetShardCount()));
+            runner.AddMacro(tickName, "sessions", [load](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    load->Step();
+                }
+                return iterations * kSessionCount;
+            });
+        }
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
@@ -0,0 +1,47 @@
+#include "BenchmarkHarness.h"
+#include <thread>
+#include "Metrics.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    // 计数器写入自己线程的分片，多线程同时计数时吞吐量应随线程数线性增长
+    void RegisterMetricsBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions&) {
+        const MetricId counter = MetricsRegistry::Instance().RegisterCounter("benchmark.increments");
+        const MetricId timer = MetricsRegistry::Instance().RegisterTimer("benchmark.timer");
+
+        runner.Add("metrics/Increment", "increments", [counter](uint64_t iterations) {
+            MetricsRegistry& registry = MetricsRegistry::Instance();
+            for (uint64_t i = 0; i < iterations; ++i) {
+                registry.Increment(counter);
+            }
+            return iterations;
+        });
+
+        runner.Add("metrics/Increment/4threads", "increments", [counter](uint64_t iterations) {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t) {
+                threads.emplace_back([counter, iterations]() {
+                    MetricsRegistry& registry = MetricsRegistry::Instance();
+                    for (uint64_t i = 0; i < iterations; ++i) {
+                        registry.Increment(counter);
+                    }
+                });
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            return iterations * 4;
+        });
+
+        runner.Add("metrics/RecordTime", "samples", [timer](uint64_t iterations) {
+            MetricsRegistry& registry = MetricsRegistry::Instance();
+            for (uint64_t i = 0; i < iterations; ++i) {
+                registry.RecordTime(timer, i & 1023);
+            }
+            return iterations;
+        });
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
@@ -0,0 +1,45 @@
+#include "BenchmarkHarness.h"
+#include <sstream>
+#include "Profiler.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    // 追踪区域自身的开销：关闭时应接近空循环，开启时是一次写环形缓冲区
+    void RegisterProfilerBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions&) {
+        runner.Add("profiler/zone/disabled", "zones", [](uint64_t iterations) {
+            Profiler::Instance().SetEnabled(false);
+            for (uint64_t i = 0; i < iterations; ++i) {
+                VN_TRACE_ZONE(DIALOGUE, "benchmark");
+                DoNotOptimize(&i);
+            }
+            return iterations;
+        });
+
+        runner.Add("profiler/zone/enabled", "zones", [](uint64_t iterations) {
+            Profiler::Instance().SetEnabled(true);
+            for (uint64_t i = 0; i < iterations; ++i) {
+                VN_TRACE_ZONE(DIALOGUE, "benchmark");
+                DoNotOptimize(&i);
+            }
+            Profiler::Instance().SetEnabled(false);
+            return iterations;
+        });
+
+        runner.AddMacro("profiler/WriteChromeTrace", "events", [](uint64_t iterations) {
+            Profiler::Instance().SetEnabled(true);
+            for (size_t i = 0; i < TraceBuffer::kCapacity; ++i) {
+                VN_TRACE_ZONE(SCRIPT, "benchmark");
+            }
+            Profiler::Instance().SetEnabled(false);
+            for (uint64_t i = 0; i < iterations; ++i) {
+                std::ostringstream out;
+                Profiler::Instance().WriteChromeTrace(out);
+                DoNotOptimize(out.str().data());
+            }
+            return iterations * TraceBuffer::kCapacity;
+        });
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
@@ -0,0 +1,138 @@
+#include "BenchmarkHarness.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "ScriptGenerator.h"
+#include "ScriptProject.h"
+#include "HotReloader.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        const char* const kProjectDirectory = "bench_project";
+
+        // 章节文件互相串联：每章最后一段跳到下一章的第一个标签，只有链接后才能解析
+        size_t WriteProject(size_t chapters, size_t linesPerChapter) {
+            std::filesystem::remove_all(kProjectDirectory);
+            std::filesystem::create_directories(kProjectDirectory);
+            for (size_t c = 0; c < chapters; ++c) {
+                ScriptGeneratorOptions options;
+                options.lineCount = linesPerChapter;
+                options.seed = 1000 + c;
+                options.labelPrefix = "ch" + std::to_string(c) + "_";
+                if (c + 1 < chapters) {
+                    options.nextLabel = "ch" + std::to_string(c + 1) + "_0";
+                }
+                char name[32];
+                std::snprintf(name, sizeof(name), "chapter_%03zu.txt", c);
+                std::ofstream file(std::filesystem::path(kProjectDirectory) / name);
+                ScriptGenerator(options).GenerateScript(file);
+            }
+            return chapters * linesPerChapter;
+        }
+    }
+
+    namespace {
+        // 热重载分两半：监视线程中的解析（目标远低于50ms），更新线程中的替换（只应是微秒级）
+        void RegisterHotReloadBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+            const size_t lines = 10000;
+            const std::string compileName = "hotreload/Compile/" + std::to_string(lines);
+            const std::string adoptName = "hotreload/AdoptScript/" + std::to_string(lines);
+            if (!IsSelected(options, compileName) && !IsSelected(options, adoptName)) {
+                return;
+            }
+
+            const std::string path = "bench_hotreload.txt";
+            {
+                ScriptGeneratorOptions generatorOptions;
+                generatorOptions.lineCount = lines;
+                std::ofstream file(path);
+                ScriptGenerator(generatorOptions).GenerateScript(file);
+            }
+
+            runner.AddMacro(compileName, "reloads", [path](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    ScriptImage image;
+                    HotReloader::CompileScriptFile(path, image);
+                    DoNotOptimize(image.commands);
+                }
+                return iterations;
+            });
+
+            // 两份解析好的脚本来回替换，计时只包含更新线程上的交换和位置映射
+            struct AdoptState {
+                ScriptInterpreter interpreter;
+                ScriptImage spare;
+            };
+            auto state = std::make_shared<AdoptState>();
+            state->interpreter.LoadScript(path);
+            state->interpreter.Start();
+            state->interpreter.Update(0.0f);
+            HotReloader::CompileScriptFile(path, state->spare);
+            runner.Add(adoptName, "reloads", [state](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    state->spare = state->interpreter.AdoptScript(std::move(state->spare));
+                }
+                return iterations;
+            });
+        }
+    }
+
+    void RegisterProjectBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        RegisterHotReloadBenchmarks(runner, options);
+
+        const size_t chapters = 64;
+        const size_t linesPerChapter = options.quick ? 2000 : 10000;
+        const std::string suffix = std::to_string(chapters) + "x" + std::to_string(linesPerChapter);
+        if (!IsSelected(options, "project/Load/" + suffix) &&
+            !IsSelected(options, "project/Load/1thread/" + suffix) &&
+            !IsSelected(options, "project/Reload/1changed/" + suffix)) {
+            return;
+        }
+
+        const size_t totalLines = WriteProject(chapters, linesPerChapter);
+
+        // 冷加载：全部文件并行解析并链接
+        runner.AddMacro("project/Load/" + suffix, "lines", [totalLines, &runner, suffix](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                ScriptProject project;
+                if (!project.Load(kProjectDirectory)) {
+                    runner.Fail("project/Load/" + suffix, project.GetErrors().front());
+                }
+                DoNotOptimize(project.GetCommands().data());
+            }
+            return iterations * totalLines;
+        });
+
+        runner.AddMacro("project/Load/1thread/" + suffix, "lines", [totalLines](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                ScriptProject project(1);
+                project.Load(kProjectDirectory);
+                DoNotOptimize(project.GetCommands().data());
+            }
+            return iterations * totalLines;
+        });
+
+        // 增量重新加载：每次只改动一个章节，其余章节命中缓存
+        auto project = std::make_shared<ScriptProject>();
+        project->Load(kProjectDirectory);
+        runner.AddMacro("project/Reload/1changed/" + suffix, "reloads",
+            [project, chapters, &runner, suffix](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    char name[32];
+                    std::snprintf(name, sizeof(name), "chapter_%03zu.txt", static_cast<size_t>(i % chapters));
+                    std::ofstream(std::filesystem::path(kProjectDirectory) / name, std::ios::app) << "# edit\n";
+                    project->Reload();
+                    if (project->GetStats().compiled != 1) {
+                        runner.Fail("project/Reload/1changed/" + suffix,
+                                    "重新解析了 " + std::to_string(project->GetStats().compiled) + " 个文件");
+                    }
+                }
+                return iterations;
+            });
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
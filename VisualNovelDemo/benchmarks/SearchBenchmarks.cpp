@@ -0,0 +1,132 @@
+#include "BenchmarkHarness.h"
+#include <memory>
+#include <sstream>
+#include "ScriptGenerator.h"
+#include "ScriptParser.h"
+#include "TextSearchIndex.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        struct ScriptCorpus {
+            SceneArena arena;
+            ScriptCommandList* commands = nullptr;
+            std::map<std::string, ScriptLabel> labels;
+        };
+
+        std::shared_ptr<ScriptCorpus> MakeCorpus(size_t lines) {
+            ScriptGeneratorOptions options;
+            options.lineCount = lines;
+            std::ostringstream script;
+            ScriptGenerator(options).GenerateScript(script);
+
+            auto corpus = std::make_shared<ScriptCorpus>();
+            corpus->commands = corpus->arena.Make<ScriptCommandList>();
+            ScriptParser parser(*corpus->commands, corpus->labels);
+            parser.Parse(script.str());
+            return corpus;
+        }
+    }
+
+    // 全文检索：离线脚本索引的建立与查询，对比逐行扫描；历史记录的增量加入
+    void RegisterSearchBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        const size_t lines = 100000;
+        const std::string suffix = "/" + std::to_string(lines);
+        const std::string buildName = "search/Script/Build" + suffix;
+        const std::string keywordName = "search/Script/keyword" + suffix;
+        const std::string filteredName = "search/Script/keyword+speaker+label" + suffix;
+        const std::string scanName = "search/Script/linear-scan" + suffix;
+        const std::string historyName = "search/History/append+query";
+        if (!IsSelected(options, buildName) && !IsSelected(options, keywordName) &&
+            !IsSelected(options, filteredName) && !IsSelected(options, scanName) &&
+            !IsSelected(options, historyName)) {
+            return;
+        }
+
+        std::shared_ptr<ScriptCorpus> corpus = MakeCorpus(lines);
+        auto index = std::make_shared<TextSearchIndex>();
+        TextSearchIndex::IndexScript(*index, *corpus->commands, "generated.txt");
+
+        runner.AddMacro(buildName, "indexes", [corpus](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                TextSearchIndex built;
+                TextSearchIndex::IndexScript(built, *corpus->commands, "generated.txt");
+                DoNotOptimize(&built);
+            }
+            return iterations;
+        });
+
+        SearchQuery keyword;
+        keyword.text = "樱花开了";
+        runner.Add(keywordName, "queries", [index, keyword](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                std::vector<SearchHit> hits = index->Search(keyword);
+                DoNotOptimize(hits.data());
+            }
+            return iterations;
+        });
+
+        SearchQuery filtered;
+        filtered.text = "可丽饼";
+        filtered.speaker = "角色2";
+        filtered.label = "seg_500";
+        runner.Add(filteredName, "queries", [index, filtered](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                std::vector<SearchHit> hits = index->Search(filtered);
+                DoNotOptimize(hits.data());
+            }
+            return iterations;
+        });
+
+        // 不建索引时只能逐行比较，作为带过滤条件查询的对照
+        runner.AddMacro(scanName, "queries", [corpus, filtered](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                size_t found = 0;
+                std::string_view label;
+                for (const ScriptCommand& command : *corpus->commands) {
+                    const ArenaStringList& params = command.parameters;
+                    if (command.type == CommandType::LABEL && !params.empty()) {
+                        label = params[0];
+                    } else if (command.type == CommandType::DIALOGUE && params.size() > 2 && label == filtered.label &&
+                               params[0] == "char2" && params[2].find(filtered.text) != ArenaString::npos) {
+                        ++found;
+                    }
+                }
+                DoNotOptimize(&found);
+            }
+            return iterations;
+        });
+
+        // 历史记录：每推进一行加入一条、挤出最旧的一条，随后查询一次
+        struct HistoryState {
+            TextSearchIndex index;
+            std::vector<std::string> texts;
+            uint32_t next = 0;
+        };
+        auto history = std::make_shared<HistoryState>();
+        for (const ScriptCommand& command : *corpus->commands) {
+            if (command.type == CommandType::DIALOGUE && command.parameters.size() > 2) {
+                history->texts.emplace_back(command.parameters[2]);
+                if (history->texts.size() == 1000) break;
+            }
+        }
+        runner.Add(historyName, "lines", [history, keyword](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                SearchDocument document;
+                document.text = history->texts[history->next % history->texts.size()];
+                document.speaker = "char0";
+                history->index.Add(std::move(document));
+                ++history->next;
+                if (history->next > 100) {
+                    history->index.RemoveBefore(history->next - 100);
+                }
+                std::vector<SearchHit> hits = history->index.Search(keyword);
+                DoNotOptimize(hits.data());
+            }
+            return iterations;
+        });
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
@@ -0,0 +1,208 @@
+#include "BenchmarkHarness.h"
+#include <cmath>
+#include <functional>
+#include <memory>
+#include "AllocationCounter.h"
+#include "TweenSystem.h"
+
+namespace VisualNovel {
+namespace Benchmarks {
+
+    namespace {
+        const size_t kCastSize = 12;
+        const float kTweenFrame = 1.0f / 60.0f;
+        const int kFramesPerTransition = 30;  // 0.5 秒的过渡
+
+        // 与 CharacterSprite 中被补间驱动的字段相同
+        struct BenchSprite {
+            float x = 0.0f, y = 0.0f;
+            float targetX = 0.0f, targetY = 0.0f;
+            float scale = 1.0f, targetScale = 1.0f;
+            float opacity = 0.0f;
+        };
+
+        // 整个角色阵容淡入，同时每人移动并缩放：12 人 x 4 个通道
+        size_t StartCastTransition(TweenSystem& tweens, std::vector<BenchSprite>& cast, float direction) {
+            for (size_t i = 0; i < cast.size(); ++i) {
+                BenchSprite& sprite = cast[i];
+                auto add = [&](float* target, float* mirror, float to, Easing easing, float delay) {
+                    TweenDesc desc;
+                    desc.target = target;
+                    desc.mirror = mirror;
+                    desc.owner = &sprite;
+                    desc.from = *target;
+                    desc.to = to;
+                    desc.duration = 0.4f;
+                    desc.delay = delay;
+                    desc.easing = easing;
+                    desc.userData = i;
+                    tweens.Add(desc);
+                };
+                add(&sprite.opacity, nullptr, direction > 0.0f ? 1.0f : 0.0f, Easing::EASE_OUT_QUAD, 0.008f * i);
+                add(&sprite.x, &sprite.targetX, 100.0f * i * direction, Easing::EASE_IN_OUT_CUBIC, 0.0f);
+                add(&sprite.y, &sprite.targetY, 20.0f * direction, Easing::EASE_OUT_BACK, 0.0f);
+                add(&sprite.scale, &sprite.targetScale, 1.0f + 0.1f * direction, Easing::EASE_IN_OUT_QUAD, 0.0f);
+            }
+            return cast.size() * 4;
+        }
+
+        // 对照：改造前每个补间单独分配，带 std::function 完成回调，每帧用 pow 求缓动
+        struct LegacyTween {
+            float* target;
+            float* mirror;
+            float from;
+            float to;
+            float duration;
+            float elapsed;
+            int power;
+            std::function<void()> onComplete;
+        };
+
+        void AddLegacy(std::vector<std::unique_ptr<LegacyTween>>& tweens, float* target, float* mirror, float to,
+                       int power, float delay, uint64_t& completed) {
+            auto tween = std::make_unique<LegacyTween>();
+            tween->target = target;
+            tween->mirror = mirror;
+            tween->from = *target;
+            tween->to = to;
+            tween->duration = 0.4f;
+            tween->elapsed = -delay;
+            tween->power = power;
+            tween->onComplete = [&completed, target]() { completed += *target != 0.0f; };
+            tweens.push_back(std::move(tween));
+        }
+
+        void UpdateLegacy(std::vector<std::unique_ptr<LegacyTween>>& tweens, float deltaTime) {
+            for (size_t i = 0; i < tweens.size();) {
+                LegacyTween& tween = *tweens[i];
+                tween.elapsed += deltaTime;
+                if (tween.elapsed < 0.0f) {
+                    ++i;
+                    continue;
+                }
+                float t = std::min(tween.elapsed / tween.duration, 1.0f);
+                float eased = 1.0f - std::pow(1.0f - t, static_cast<float>(tween.power));
+                *tween.target = tween.from + (tween.to - tween.from) * eased;
+                if (tween.mirror) {
+                    *tween.mirror = *tween.target;
+                }
+                if (t >= 1.0f) {
+                    tween.onComplete();
+                    tweens.erase(tweens.begin() + i);
+                } else {
+                    ++i;
+                }
+            }
+        }
+    }
+
+    // 补间：一次角色阵容过渡（淡入淡出 + 移动 + 缩放）从开始到全部结束的耗时，与改造前的逐个分配实现对比；
+    // 另测 1000 个并发补间的单帧更新，并检查稳态下不分配
+    void RegisterTweenBenchmarks(BenchmarkRunner& runner, const BenchmarkOptions& options) {
+        const std::string bakedName = "tween/CastTransition/baked";
+        const std::string legacyName = "tween/CastTransition/legacy";
+        const std::string manyName = "tween/Update/1000";
+        const std::string allocName = "tween/SteadyState/zero-alloc";
+
+        if (IsSelected(options, bakedName)) {
+            struct State {
+                TweenSystem tweens;
+                std::vector<BenchSprite> cast = std::vector<BenchSprite>(kCastSize);
+                uint64_t completed = 0;
+            };
+            auto state = std::make_shared<State>();
+            runner.Add(bakedName, "transitions", [state](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    StartCastTransition(state->tweens, state->cast, (i & 1) ? -1.0f : 1.0f);
+                    for (int frame = 0; frame < kFramesPerTransition; ++frame) {
+                        state->tweens.Update(kTweenFrame);
+                        state->tweens.Drain([state](const TweenEvent& event) { state->completed += !event.cancelled; });
+                    }
+                }
+                DoNotOptimize(&state->completed);
+                return iterations;
+            });
+        }
+
+        if (IsSelected(options, legacyName)) {
+            struct State {
+                std::vector<std::unique_ptr<LegacyTween>> tweens;
+                std::vector<BenchSprite> cast = std::vector<BenchSprite>(kCastSize);
+                uint64_t completed = 0;
+            };
+            auto state = std::make_shared<State>();
+            runner.Add(legacyName, "transitions", [state](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    float direction = (i & 1) ? -1.0f : 1.0f;
+                    for (size_t s = 0; s < state->cast.size(); ++s) {
+                        BenchSprite& sprite = state->cast[s];
+                        AddLegacy(state->tweens, &sprite.opacity, nullptr, direction > 0.0f ? 1.0f : 0.0f, 2,
+                                  0.008f * s, state->completed);
+                        AddLegacy(state->tweens, &sprite.x, &sprite.targetX, 100.0f * s * direction, 3, 0.0f,
+                                  state->completed);
+                        AddLegacy(state->tweens, &sprite.y, &sprite.targetY, 20.0f * direction, 3, 0.0f,
+                                  state->completed);
+                        AddLegacy(state->tweens, &sprite.scale, &sprite.targetScale, 1.0f + 0.1f * direction, 2, 0.0f,
+                                  state->completed);
+                    }
+                    for (int frame = 0; frame < kFramesPerTransition; ++frame) {
+                        UpdateLegacy(state->tweens, kTweenFrame);
+                    }
+                }
+                DoNotOptimize(&state->completed);
+                return iterations;
+            });
+        }
+
+        if (IsSelected(options, manyName)) {
+            struct State {
+                TweenSystem tweens = TweenSystem(1024);
+                std::vector<float> values = std::vector<float>(1000);
+            };
+            auto state = std::make_shared<State>();
+            for (size_t i = 0; i < state->values.size(); ++i) {
+                TweenDesc desc;
+                desc.target = &state->values[i];
+                desc.to = 1.0f;
+                desc.duration = 1e9f;  // 测量期间不结束
+                desc.easing = static_cast<Easing>(i % static_cast<size_t>(Easing::Count));
+                state->tweens.Add(desc);
+            }
+            runner.Add(manyName, "frames", [state](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    state->tweens.Update(kTweenFrame);
+                }
+                DoNotOptimize(state->values.data());
+                return iterations;
+            });
+        }
+
+        // 容量足够时反复开始、推进、结束过渡都不应分配
+        if (IsSelected(options, allocName)) {
+            TweenSystem tweens;
+            std::vector<BenchSprite> cast(kCastSize);
+            // 第一轮让事件缓冲等增长到位
+            StartCastTransition(tweens, cast, 1.0f);
+            tweens.FinishAll();
+            tweens.Drain([](const TweenEvent&) {});
+            AllocationCounter::Snapshot before = AllocationCounter::GetThreadSnapshot();
+            uint64_t events = 0;
+            for (int round = 0; round < 100; ++round) {
+                StartCastTransition(tweens, cast, (round & 1) ? -1.0f : 1.0f);
+                for (int frame = 0; frame < kFramesPerTransition; ++frame) {
+                    tweens.Update(kTweenFrame);
+                    tweens.Drain([&events](const TweenEvent&) { ++events; });
+                }
+            }
+            AllocationCounter::Snapshot after = AllocationCounter::GetThreadSnapshot();
+            if (tweens.GetActiveCount() != 0 || events != 100 * kCastSize * 4) {
+                runner.Fail(allocName, "过渡没有在预期帧数内结束");
+            } else if (after.allocations != before.allocations) {
+                runner.Fail(allocName, "稳态补间发生了 " + std::to_string(after.allocations - before.allocations) +
+                                           " 次分配");
+            }
+        }
+    }
+
+} // namespace Benchmarks
+} // namespace VisualNovel
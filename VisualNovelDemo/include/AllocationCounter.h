@@ -0,0 +1,27 @@
+#pragma once
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace VisualNovel {
+
+    // 按线程统计全局 operator new 的调用次数和字节数
+    // 只有定义 VN_COUNT_ALLOCATIONS 编译时才会替换全局 operator new，否则计数恒为0
+    namespace AllocationCounter {
+
+        struct Snapshot {
+            uint64_t allocations;
+            uint64_t bytes;
+        };
+
+        bool IsInstalled();
+
+        // 当前线程自启动以来的分配次数
+        Snapshot GetThreadSnapshot();
+
+    } // namespace AllocationCounter
+
+} // namespace VisualNovel
+
+#endif // ALLOCATION_COUNTER_H
@@ -0,0 +1,115 @@
+#pragma once
+#ifndef ATOM_TABLE_H
+#define ATOM_TABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace VisualNovel {
+
+    // 驻留后的名字：角色 ID、表情、图层、位置预设这类在脚本中反复出现的短字符串。
+    // 同一个名字在进程内总是同一个值，比较和查找只比较整数；NONE 对应空名字
+    enum class Atom : uint32_t {
+        NONE = 0
+    };
+
+    // 全局驻留表
+    //
+    // 名字只增不删，进程结束前 GetName 返回的字符串一直有效。
+    // Intern 和 Find 可以在任意线程调用（已有的名字只加读锁）；GetName 不加锁。
+    // 脚本在解析时、预编译脚本在静态初始化时驻留名字，执行时只传递 Atom
+    namespace Atoms {
+
+        // 空名字返回 Atom::NONE
+        Atom Intern(std::string_view name);
+        // 没有驻留过的名字返回 Atom::NONE，不新增（查找玩家输入等不可信的名字时使用）
+        Atom Find(std::string_view name);
+        // 不认识的 Atom 返回空字符串
+        const std::string& GetName(Atom atom);
+        // 含 NONE
+        size_t GetCount();
+
+    } // namespace Atoms
+
+    // 以 Atom 为键的小映射
+    //
+    // 键和值各自连续存放，查找是对键数组的线性扫描：角色、表情、预设一般只有几个到几十个，
+    // 扫描几十个整数比 std::map 的字符串比较和节点跳转快得多。按插入顺序排列，Erase 时后面的前移
+    template <typename T>
+    class AtomMap {
+    private:
+        std::vector<Atom> keys;
+        std::vector<T> values;
+
+    public:
+        T* Find(Atom key) {
+            auto it = std::find(keys.begin(), keys.end(), key);
+            return it == keys.end() ? nullptr : &values[it - keys.begin()];
+        }
+
+        const T* Find(Atom key) const {
+            auto it = std::find(keys.begin(), keys.end(), key);
+            return it == keys.end() ? nullptr : &values[it - keys.begin()];
+        }
+
+        bool Contains(Atom key) const {
+            return std::find(keys.begin(), keys.end(), key) != keys.end();
+        }
+
+        // 没有时插入默认值
+        T& operator[](Atom key) {
+            if (T* value = Find(key)) {
+                return *value;
+            }
+            keys.push_back(key);
+            values.emplace_back();
+            return values.back();
+        }
+
+        // 已有时覆盖
+        T& Insert(Atom key, T value) {
+            if (T* existing = Find(key)) {
+                *existing = std::move(value);
+                return *existing;
+            }
+            keys.push_back(key);
+            values.push_back(std::move(value));
+            return values.back();
+        }
+
+        bool Erase(Atom key) {
+            auto it = std::find(keys.begin(), keys.end(), key);
+            if (it == keys.end()) {
+                return false;
+            }
+            values.erase(values.begin() + (it - keys.begin()));
+            keys.erase(it);
+            return true;
+        }
+
+        void Clear() {
+            keys.clear();
+            values.clear();
+        }
+
+        void Reserve(size_t capacity) {
+            keys.reserve(capacity);
+            values.reserve(capacity);
+        }
+
+        size_t GetSize() const { return keys.size(); }
+        bool IsEmpty() const { return keys.empty(); }
+        // 与 GetValues 下标一一对应
+        const std::vector<Atom>& GetKeys() const { return keys; }
+        std::vector<T>& GetValues() { return values; }
+        const std::vector<T>& GetValues() const { return values; }
+    };
+
+} // namespace VisualNovel
+
+#endif // ATOM_TABLE_H
@@ -0,0 +1,190 @@
+#pragma once
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SpscQueue.h"
+
+namespace VisualNovel {
+
+    // 混音总线，各自有独立音量；语音播放时 BGM 自动压低
+    enum class AudioBus : uint8_t {
+        BGM,
+        SE,
+        VOICE,
+        Count
+    };
+
+    // 混音结果的去处。Write 在混音线程中调用，实时后端应阻塞到设备能接收下一块为止
+    class AudioOutput {
+    public:
+        virtual ~AudioOutput() = default;
+        virtual bool Open(int sampleRate, int channels) = 0;
+        virtual void Write(const int16_t* samples, size_t frames) = 0;
+        virtual void Close() {}
+    };
+
+    // 丢弃输出，按实际时长节拍运行（无声卡的机器、测试）
+    class NullAudioOutput : public AudioOutput {
+    private:
+        int sampleRate;
+        std::chrono::steady_clock::time_point deadline;
+
+    public:
+        NullAudioOutput() : sampleRate(0) {}
+        bool Open(int rate, int channels) override;
+        void Write(const int16_t* samples, size_t frames) override;
+    };
+
+    // 写入 16 位 WAV 文件，同样按实际时长节拍运行，便于离线检查混音结果
+    class WavFileAudioOutput : public AudioOutput {
+    private:
+        std::string path;
+        std::ofstream file;
+        int sampleRate;
+        int channels;
+        uint64_t framesWritten;
+        std::chrono::steady_clock::time_point deadline;
+
+    public:
+        explicit WavFileAudioOutput(const std::string& path);
+        ~WavFileAudioOutput() override;
+        bool Open(int rate, int channelCount) override;
+        void Write(const int16_t* samples, size_t frames) override;
+        // 补写 WAV 头中的长度
+        void Close() override;
+    };
+
+    struct AudioConfig {
+        int sampleRate = 48000;
+        int bufferFrames = 512;       // 每次混音的帧数，也是语音起播的最大延迟
+        std::string assetRoot;        // 音频文件相对此目录
+        float duckLevel = 0.35f;      // 语音播放时 BGM 压低到的比例
+        float duckAttack = 0.08f;     // 压低用时（秒）
+        float duckRelease = 0.4f;     // 恢复用时（秒）
+    };
+
+    class AudioStream;
+
+    // 软件混音器
+    //
+    // 三个线程分工：
+    // - 调用线程（游戏更新线程）打开文件、预先解码第一段，然后通过无锁队列把命令交给混音线程；
+    // - 解码线程按块读文件、转换为输出采样率的浮点立体声，填进每个流自己的无锁环形缓冲；
+    // - 混音线程（或 SDL 音频回调中调用 MixBlock）只读环形缓冲、做乘加，不加锁、不分配、不读文件。
+    // 播完或被停止的流由混音线程放入回收队列，调用线程在 CollectFinished 中释放。
+    // 命令在下一块混音开始时生效，因此语音在 PlayVoice 之后一个缓冲之内开始发声。
+    //
+    // 解码器支持 PCM WAV（8/16 位，单声道或立体声，任意采样率）；
+    // 请求的文件不是 .wav 时，先尝试同名的 .wav 文件。
+    class AudioMixer {
+    public:
+        static const size_t kMaxVoices = 32;
+
+    private:
+        enum class CommandType : uint8_t {
+            PLAY,
+            STOP_BUS,
+            SET_VOLUME,
+        };
+
+        struct Command {
+            CommandType type;
+            AudioBus bus;
+            AudioStream* stream;
+            float value;       // 音量，或停止时的淡出秒数
+        };
+
+        // 混音线程独占的播放状态
+        struct Voice {
+            AudioStream* stream = nullptr;
+            float gain = 0.0f;        // 上一块结束时的增益，下一块从这里渐变
+            float fade = 1.0f;        // 淡出进度，1 为未淡出
+            float fadeStep = 0.0f;    // 每块减少的 fade，0 表示没有在停止
+        };
+
+        AudioConfig config;
+        std::vector<std::unique_ptr<AudioStream>> streams;   // 所有未回收的流，解码线程与调用线程共用
+        std::mutex streamMutex;
+
+        SpscQueue<Command, 256> commands;            // 调用线程 -> 混音线程
+        SpscQueue<AudioStream*, 64> finished;        // 混音线程 -> 调用线程
+
+        // 以下只在混音线程中访问
+        std::array<Voice, kMaxVoices> voices;
+        std::array<float, static_cast<size_t>(AudioBus::Count)> busVolumes;
+        float duckGain;
+        std::vector<float> mixBuffer;
+        bool useSimd;
+
+        std::atomic<uint64_t> mixedBlocks;
+        std::atomic<uint64_t> underruns;
+        std::atomic<uint32_t> activeVoices;
+
+        std::unique_ptr<AudioOutput> output;
+        std::thread mixThread;
+        std::thread decodeThread;
+        std::atomic<bool> running;
+        std::condition_variable decodeWake;
+        bool decodeStopping;
+
+    public:
+        explicit AudioMixer(const AudioConfig& config = AudioConfig());
+        ~AudioMixer();
+
+        AudioMixer(const AudioMixer&) = delete;
+        AudioMixer& operator=(const AudioMixer&) = delete;
+
+        // 启动解码线程；传入 output 时同时启动混音线程，否则由调用方自己按时调用 MixBlock
+        bool Start(std::unique_ptr<AudioOutput> audioOutput = nullptr);
+        void Stop();
+
+        // 以下在同一个调用线程中使用。返回 false 表示文件打不开或格式不支持
+        bool PlayBgm(const std::string& name, float fadeSeconds = 0.5f);  // 循环播放，淡出上一首
+        void StopBgm(float fadeSeconds = 0.5f);
+        bool PlaySound(const std::string& name, bool loop = false);       // loop 用于雨声等环境音
+        bool PlayVoice(const std::string& name);                          // 打断正在播放的语音
+        void StopVoice();
+        void StopSounds(float fadeSeconds = 0.0f);
+        void SetBusVolume(AudioBus bus, float volume);
+
+        // 释放播完的流，每帧调用一次
+        void CollectFinished();
+
+        // 混出一块 bufferFrames 帧的 16 位立体声，只在一个线程中调用
+        void MixBlock(int16_t* out);
+        // 没有 Start 时（离线渲染、测试）在 MixBlock 之前调用，代替解码线程
+        void Decode();
+
+        // 关闭后使用标量混音，用于核对 SIMD 路径；在混音开始前设置
+        void SetUseSimd(bool enabled) { useSimd = enabled; }
+
+        const AudioConfig& GetConfig() const { return config; }
+        uint64_t GetMixedBlocks() const { return mixedBlocks.load(std::memory_order_relaxed); }
+        // 解码跟不上、流的缓冲被读空的次数
+        uint64_t GetUnderrunCount() const { return underruns.load(std::memory_order_relaxed); }
+        uint32_t GetActiveVoiceCount() const { return activeVoices.load(std::memory_order_relaxed); }
+
+    private:
+        bool Play(AudioBus bus, const std::string& name, bool loop, float fadeSeconds);
+        void SendCommand(const Command& command);
+        void ApplyCommand(const Command& command);
+        void StopVoices(AudioBus bus, float fadeSeconds);
+        void Retire(Voice& voice);
+        void RunMixer();
+        void RunDecoder();
+    };
+
+} // namespace VisualNovel
+
+#endif // AUDIO_MIXER_H
@@ -6,7 +6,11 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <functional>
+#include <utility>
 #include <glm/glm.hpp>
+#include "AtomTable.h"
+#include "TweenSystem.h"
 
 namespace VisualNovel {
     
@@ -48,16 +52,34 @@ namespace VisualNovel {
         std::function<void()> onComplete;
     };
     
+    // 可以由 TweenSystem 驱动的精灵属性
+    enum class SpriteChannel : uint8_t {
+        POSITION_X,
+        POSITION_Y,
+        SCALE,
+        OPACITY,
+        EXPRESSION_BLEND    // 表情切换进度，0 为旧表情，1 为新表情
+    };
+
+    // CharacterRenderer 发起的补间的 tag，完成事件中用来区分
+    enum class SpriteTween : uint32_t {
+        MOVE = 1,
+        SCALE,
+        FADE,
+        EXPRESSION
+    };
+
     // 角色精灵
+    // 角色 ID、表情名和动画名都以 Atom 保存，字符串版本的接口只是驻留后转调
     class CharacterSprite {
     private:
-        std::string characterId;
-        std::string currentExpression;
+        Atom characterId;
+        Atom currentExpression;
         CharacterState currentState;
         CharacterPosition position;
         
-        std::map<std::string, CharacterExpression> expressions;
-        std::map<std::string, CharacterAnimation> animations;
+        AtomMap<CharacterExpression> expressions;
+        AtomMap<CharacterAnimation> animations;
         
         glm::vec2 currentPosition;
         glm::vec2 targetPosition;
@@ -69,6 +91,10 @@ namespace VisualNovel {
         int currentFrame;
         bool isAnimating;
         
+        // 由补间驱动
+        float opacity = 1.0f;
+        float expressionBlend = 1.0f;
+        
     public:
         CharacterSprite(const std::string& id);
         ~CharacterSprite();
@@ -81,13 +107,23 @@ namespace VisualNovel {
         void SetLayer(const std::string& layer);
         
         // 表情控制
-        void AddExpression(const std::string& name, const CharacterExpression& expr);
-        void SetExpression(const std::string& exprName);
+        void AddExpression(Atom name, const CharacterExpression& expr);
+        void AddExpression(const std::string& name, const CharacterExpression& expr) {
+            AddExpression(Atoms::Intern(name), expr);
+        }
+        // 没有这个表情时保持当前表情
+        void SetExpression(Atom exprName);
+        void SetExpression(const std::string& exprName) { SetExpression(Atoms::Find(exprName)); }
         void TransitionExpression(const std::string& exprName, float duration);
-        const std::string& GetCurrentExpression() const;
+        bool HasExpression(Atom exprName) const { return expressions.Contains(exprName); }
+        Atom GetExpressionAtom() const { return currentExpression; }
+        const std::string& GetCurrentExpression() const { return Atoms::GetName(currentExpression); }
         
         // 动画控制
-        void AddAnimation(const std::string& name, const CharacterAnimation& anim);
+        void AddAnimation(Atom name, const CharacterAnimation& anim);
+        void AddAnimation(const std::string& name, const CharacterAnimation& anim) {
+            AddAnimation(Atoms::Intern(name), anim);
+        }
         void PlayAnimation(const std::string& animName);
         void StopAnimation();
         bool IsAnimating() const;
@@ -106,9 +142,15 @@ namespace VisualNovel {
         std::string GetCurrentTexture() const;
         glm::vec2 GetUVOffset() const;
         glm::vec2 GetUVSize() const;
+        float GetOpacity() const { return opacity; }
+        float GetExpressionBlend() const { return expressionBlend; }
+        
+        // 补间写入的属性；位置和缩放同时写入目标值（mirror），逐帧移动不再与补间争夺
+        float* GetTweenChannel(SpriteChannel channel, float** mirror = nullptr);
         
         // 属性获取
-        const std::string& GetCharacterId() const;
+        Atom GetCharacterAtom() const { return characterId; }
+        const std::string& GetCharacterId() const { return Atoms::GetName(characterId); }
         const CharacterPosition& GetPositionInfo() const;
         
     private:
@@ -118,16 +160,20 @@ namespace VisualNovel {
     };
     
     // 角色渲染管理器
+    // 脚本命令在解析时就把角色、位置预设和表情名驻留成 Atom，执行时按 Atom 查找，不再比较字符串
     class CharacterRenderer {
     private:
-        std::map<std::string, std::unique_ptr<CharacterSprite>> characters;
-        std::vector<std::string> renderOrder;  // 渲染顺序
+        AtomMap<std::unique_ptr<CharacterSprite>> characters;
+        std::vector<Atom> renderOrder;  // 渲染顺序
         
         // 位置预设
-        std::map<std::string, CharacterPosition> positionPresets;
+        AtomMap<CharacterPosition> positionPresets;
         
         // 图层管理
-        std::map<std::string, std::vector<std::string>> layerGroups;
+        AtomMap<std::vector<Atom>> layerGroups;
+        
+        // 移动、缩放、淡入淡出和表情过渡共用的补间
+        TweenSystem tweens;
         
     public:
         CharacterRenderer();
@@ -136,16 +182,38 @@ namespace VisualNovel {
         // 角色管理
         CharacterSprite* CreateCharacter(const std::string& id, 
                                        const std::string& configPath);
-        CharacterSprite* GetCharacter(const std::string& id);
-        void RemoveCharacter(const std::string& id);
+        CharacterSprite* CreateCharacter(Atom id, const std::string& configPath) {
+            return CreateCharacter(Atoms::GetName(id), configPath);
+        }
+        // 按配置文件单独创建一个角色，不放进任何渲染器，可以在其他线程调用（热重载在监视线程中解析）
+        static std::unique_ptr<CharacterSprite> LoadCharacter(const std::string& id, const std::string& configPath);
+        // 放入已创建的角色；同名角色已存在时替换它，图层和渲染顺序不变，旧角色的补间取消
+        CharacterSprite* AdoptCharacter(Atom id, std::unique_ptr<CharacterSprite> sprite);
+        // 从渲染器中取出角色，连同补间、图层和渲染顺序一起移除
+        std::unique_ptr<CharacterSprite> ReleaseCharacter(Atom id);
+        CharacterSprite* GetCharacter(Atom id);
+        CharacterSprite* GetCharacter(const std::string& id) { return GetCharacter(Atoms::Find(id)); }
+        size_t GetCharacterCount() const { return characters.GetSize(); }
+        // 同时取消该角色的补间
+        void RemoveCharacter(Atom id);
+        void RemoveCharacter(const std::string& id) { RemoveCharacter(Atoms::Find(id)); }
         void ClearAllCharacters();
         
         // 位置预设
-        void AddPositionPreset(const std::string& name, const CharacterPosition& pos);
-        void SetCharacterPosition(const std::string& charId, const std::string& presetName);
+        void AddPositionPreset(Atom name, const CharacterPosition& pos);
+        void AddPositionPreset(const std::string& name, const CharacterPosition& pos) {
+            AddPositionPreset(Atoms::Intern(name), pos);
+        }
+        void SetCharacterPosition(Atom charId, Atom presetName);
+        void SetCharacterPosition(const std::string& charId, const std::string& presetName) {
+            SetCharacterPosition(Atoms::Find(charId), Atoms::Find(presetName));
+        }
         
         // 图层管理
-        void AddToLayer(const std::string& charId, const std::string& layer);
+        void AddToLayer(Atom charId, Atom layer);
+        void AddToLayer(const std::string& charId, const std::string& layer) {
+            AddToLayer(Atoms::Find(charId), Atoms::Intern(layer));
+        }
         void SetLayerOrder(const std::vector<std::string>& order);
         
         // 批量操作
@@ -157,6 +225,41 @@ namespace VisualNovel {
         // 更新
         void Update(float deltaTime);
         
+        // 补间版本的 MoveTo / SetScale / FadeInAll / FadeOutAll / TransitionExpression：
+        // 全部放进同一个 TweenSystem，每帧 UpdateTweens 一次批量求值。
+        // 返回补间编号，角色不存在时返回 0。stagger 为依次淡入时每个角色错开的秒数
+        uint32_t TweenMove(Atom charId, const glm::vec2& target, float duration,
+                           Easing easing = Easing::EASE_IN_OUT_CUBIC);
+        uint32_t TweenMove(const std::string& charId, const glm::vec2& target, float duration,
+                           Easing easing = Easing::EASE_IN_OUT_CUBIC) {
+            return TweenMove(Atoms::Find(charId), target, duration, easing);
+        }
+        uint32_t TweenScale(Atom charId, float scale, float duration, Easing easing = Easing::EASE_IN_OUT_QUAD);
+        uint32_t TweenScale(const std::string& charId, float scale, float duration,
+                            Easing easing = Easing::EASE_IN_OUT_QUAD) {
+            return TweenScale(Atoms::Find(charId), scale, duration, easing);
+        }
+        size_t TweenFadeInAll(float duration, float stagger = 0.0f);
+        size_t TweenFadeOutAll(float duration, float stagger = 0.0f);
+        uint32_t TweenExpression(Atom charId, Atom exprName, float duration);
+        uint32_t TweenExpression(const std::string& charId, const std::string& exprName, float duration) {
+            return TweenExpression(Atoms::Find(charId), Atoms::Find(exprName), duration);
+        }
+        // RemoveCharacter 会自动调用；ClearAllCharacters 之前需要先调用
+        void CancelTweens(Atom charId);
+        void CancelTweens(const std::string& charId) { CancelTweens(Atoms::Find(charId)); }
+        TweenSystem& GetTweens() { return tweens; }
+        
+        // 推进所有补间；结束（或被替换）的补间交给 onFinished，其 userData 为 CharacterSprite*
+        template <typename Handler>
+        void UpdateTweens(float deltaTime, Handler&& onFinished) {
+            tweens.Update(deltaTime);
+            tweens.Drain(std::forward<Handler>(onFinished));
+        }
+        void UpdateTweens(float deltaTime) {
+            UpdateTweens(deltaTime, [](const TweenEvent&) {});
+        }
+        
         // 获取渲染列表
         std::vector<CharacterSprite*> GetRenderList() const;
         
@@ -168,6 +271,7 @@ namespace VisualNovel {
         void LoadCharacterConfig(const std::string& charId, 
                                 const std::string& configPath);
         void UpdateRenderOrder();
+        size_t TweenFadeAll(float from, float to, float duration, float stagger, Easing easing);
     };
     
 } // namespace VisualNovel
@@ -0,0 +1,115 @@
+#pragma once
+#ifndef COMPILED_SCRIPT_H
+#define COMPILED_SCRIPT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "EngineEvents.h"
+
+namespace VisualNovel {
+
+    class ScriptInterpreter;
+    class CompiledScriptContext;
+
+    // 预编译脚本（script_compiler 生成的 C++）使用的静态数据
+    // 生成的代码只引用这里的类型和 CompiledScriptContext，不依赖解析器
+
+    struct CompiledMetadata {
+        std::string_view key;
+        std::string_view value;
+    };
+
+    struct CompiledDialogue {
+        std::string_view character;
+        std::string_view expression;
+        std::string_view text;
+        std::string_view voice;
+        std::string_view position;
+        uint64_t textId;
+        bool hasVariables;   // 含 ${...}，执行时替换
+        const CompiledMetadata* metadata;
+        uint32_t metadataCount;
+    };
+
+    struct CompiledChoice {
+        std::string_view text;
+        std::string_view target;
+        uint64_t textId;
+    };
+
+    struct CompiledLabel {
+        std::string_view name;
+        int position;
+    };
+
+    // 一份预编译脚本
+    // 位置与解释执行时的命令下标一致，存档、标签跳转和调用栈在两种方式之间通用
+    struct CompiledScript {
+        std::string_view source;      // 注册用的脚本路径，如 data/scripts/prologue.txt
+        uint64_t sourceHash;          // 编译时脚本文本的 HashScriptSource
+        int commandCount;
+        const int* lineNumbers;       // 每条命令的源码行号
+        const std::string_view* rawLines;
+        const CompiledLabel* labels;  // 按名字排序
+        size_t labelCount;
+        // 从 position 开始执行到下一个阻塞点，返回之后继续执行的位置
+        int (*run)(CompiledScriptContext& context, int position);
+    };
+
+    // 判断磁盘上的脚本是否还是编译时的版本
+    uint64_t HashScriptSource(std::string_view text);
+
+    // 生成的源文件在静态初始化时登记自己，ScriptInterpreter::LoadScript 按路径查找
+    class CompiledScriptRegistry {
+    public:
+        static void Register(const CompiledScript& script);
+        static const CompiledScript* Find(const std::string& path);
+    };
+
+    struct CompiledScriptRegistration {
+        explicit CompiledScriptRegistration(const CompiledScript& script) {
+            CompiledScriptRegistry::Register(script);
+        }
+    };
+
+    // 生成代码调用解释器的窄接口：产生对话和选项、读写变量、调用演出命令。
+    // 返回 bool 的方法返回 false 时，生成的代码在当前命令之后停下
+    class CompiledScriptContext {
+    private:
+        ScriptInterpreter& interpreter;
+
+    public:
+        explicit CompiledScriptContext(ScriptInterpreter& owner) : interpreter(owner) {}
+
+        void Dialogue(const CompiledDialogue& line);
+        void Choice(const CompiledChoice* options, size_t count);
+        // 等待玩家读完对话或做出选择
+        void WaitForPlayer();
+        bool Wait(float seconds);
+        // 演出命令的处理器可能跳转或停止脚本，返回 false 后应从 Position() 继续
+        bool Custom(const std::string& name, const std::string_view* args, size_t count, int next);
+        // @show / @hide 的事件，在同一条命令的 Custom 之前调用；atoms 在生成文件静态初始化时驻留
+        void Character(EngineEventType type, std::string_view name, const CharacterAtoms& atoms);
+        int Position() const;
+
+        // 变量和条件：数值比较在生成的代码中直接完成，复杂条件交给解释器求值
+        double Number(const std::string& name) const;
+        bool Truthy(const std::string& name) const;
+        bool Condition(const std::string& condition) const;
+        void Assign(const std::string& name, const std::string& value);
+        void AssignExpression(const std::string& name, const std::string& expression);
+        void SetFlag(const std::string& name, bool value);
+
+        void CountCondition();
+        void CountJump();
+        void Call(int returnAddress);
+        int Return();
+        void End();
+        bool IsRunning() const;
+    };
+
+} // namespace VisualNovel
+
+#endif // COMPILED_SCRIPT_H
@@ -6,54 +6,105 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <functional>
+#include <string_view>
+#include <cstdint>
+#include "SceneArena.h"
+#include "TextSearchIndex.h"
+#include "EngineEvents.h"
 
 namespace VisualNovel {
     
     // 对话行结构
+    // 分配器感知：放进 pmr 容器时字符串和容器成员都从容器的分配区分配
     struct DialogueLine {
-        std::string characterName;
-        std::string characterDisplayName;
-        std::string text;
-        std::string voiceFile;
-        std::string expression;
-        std::string position;  // left, center, right
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+        ArenaString characterName;
+        ArenaString characterDisplayName;
+        ArenaString text;
+        ArenaString voiceFile;
+        ArenaString expression;
+        ArenaString position;  // left, center, right
         int fontSize;
-        std::string textColor;
+        ArenaString textColor;
         float displaySpeed;
-        std::vector<std::string> effects;  // 特效列表
-        std::map<std::string, std::string> metadata;
+        ArenaStringList effects;  // 特效列表
+        ArenaStringMap metadata;
+        uint64_t textId;  // 语言表中的 ID，0 表示只有原文（如含变量替换的台词）
         
         DialogueLine();
+        explicit DialogueLine(const allocator_type& allocator);
+        DialogueLine(const DialogueLine& other, const allocator_type& allocator = {});
+        DialogueLine(DialogueLine&& other) = default;
+        DialogueLine(DialogueLine&& other, const allocator_type& allocator);
+        DialogueLine& operator=(const DialogueLine& other) = default;
+        DialogueLine& operator=(DialogueLine&& other) = default;
     };
     
     // 选择支结构
     struct ChoiceOption {
-        std::string text;
-        std::string targetLabel;
-        std::vector<std::string> conditions;  // 显示条件
-        std::vector<std::string> effects;     // 选择后的效果
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+        ArenaString text;
+        ArenaString targetLabel;
+        ArenaStringList conditions;  // 显示条件
+        ArenaStringList effects;     // 选择后的效果
+        uint64_t textId;
         
-        ChoiceOption(const std::string& t, const std::string& target);
+        ChoiceOption(std::string_view t, std::string_view target, const allocator_type& allocator = {});
+        ChoiceOption(const ChoiceOption& other, const allocator_type& allocator = {});
+        ChoiceOption(ChoiceOption&& other) = default;
+        ChoiceOption(ChoiceOption&& other, const allocator_type& allocator);
+        ChoiceOption& operator=(const ChoiceOption& other) = default;
+        ChoiceOption& operator=(ChoiceOption&& other) = default;
     };
+
+    using DialogueLineList = ArenaVector<DialogueLine>;
+    using ChoiceOptionList = ArenaVector<ChoiceOption>;
     
     // 对话历史记录
+    // 固定容量的环形缓冲区，槽位在构造时一次分配好。
+    // RecordLine 只记下当前场景中行的地址，推进对话时不复制也不分配；
+    // 场景的行被丢弃之前必须调用 Detach，把仍被引用的行复制到自己的槽位
     struct DialogueHistory {
-        std::vector<DialogueLine> lines;
+        std::vector<DialogueLine> lines;             // 自有副本
+        std::vector<const DialogueLine*> entries;    // 每个槽位实际指向的行
+        size_t head;   // 最旧一条所在的槽位
+        size_t count;
         int maxHistorySize;
+        uint32_t recordedCount;  // 累计记录过的行数，第 i 条（0 为最旧）的序号为 recordedCount - count + i
         
         DialogueHistory(int maxSize = 100);
         void AddLine(const DialogueLine& line);
+        void RecordLine(const DialogueLine& line);
+        void Detach();
         void Clear();
-        const std::vector<DialogueLine>& GetHistory() const;
+        size_t GetSize() const;
+        const DialogueLine& GetLine(size_t index) const;  // 0 为最旧的一条
+        std::vector<DialogueLine> GetHistory() const;
+
+    private:
+        size_t NextSlot();
     };
     
     // 对话系统核心类
     class DialogueSystem {
     private:
-        std::vector<DialogueLine> currentDialogue;
-        std::vector<ChoiceOption> currentChoices;
-        DialogueLine currentLine;
+        // 当前场景的对话与选项分别放在各自的分配区，StartDialogue/SetChoices 时整块丢弃
+        SceneArena dialogueArena;
+        SceneArena choiceArena;
+        DialogueLineList* currentDialogue;
+        ChoiceOptionList* currentChoices;
+        DialogueLine* currentLine;  // 指向 currentDialogue 中的行，不复制
+        std::string_view currentText;  // 当前语言的台词，指向行文本或映射的语言表
+        size_t currentLineCharacters;
+        uint64_t localizationGeneration;
         DialogueHistory history;
+        // 历史记录的全文索引，搜索时才补入新记录的行，推进对话本身不做额外工作
+        TextSearchIndex historyIndex;
+        uint64_t historyIndexGeneration;  // 建索引时的语言，切换后重建
+        EngineEventQueue* events;  // 非空时开始显示台词、出现选择支写入事件
         
         int currentLineIndex;
         bool isTyping;
@@ -61,11 +112,18 @@ namespace VisualNovel {
         float typingSpeed;
         bool autoPlay;
         float autoPlayTimer;
+        float autoPlayDelay;
+        size_t visibleBytes;  // 打字机效果当前显示出来的字节数
+
+        // 稳态零分配检查：开启后统计 Update/NextLine 期间的堆分配
+        bool allocationCheck;
+        bool insideAllocationCheck;
+        uint64_t steadyStateAllocations;
         
         // 文本效果处理器
         class TextEffectProcessor {
         private:
-            std::map<std::string, std::function<void(DialogueLine&, float)>> effects;
+            std::map<std::string, std::function<void(DialogueLine&, float)>, std::less<>> effects;
             
         public:
             TextEffectProcessor();
@@ -82,6 +140,7 @@ namespace VisualNovel {
         
         // 对话控制
         void StartDialogue(const std::vector<DialogueLine>& dialogue);
+        void StartDialogue(const DialogueLineList& dialogue);
         void NextLine();
         void PreviousLine();
         void JumpToLine(int index);
@@ -92,10 +151,16 @@ namespace VisualNovel {
         bool IsTypingComplete() const;
         void CompleteTyping();
         const DialogueLine& GetCurrentLine() const;
+        std::string_view GetVisibleText() const;
+        // 当前语言下的完整台词
+        std::string_view GetCurrentText() const;
         
         // 选择支
         void SetChoices(const std::vector<ChoiceOption>& choices);
-        const std::vector<ChoiceOption>& GetChoices() const;
+        void SetChoices(const ChoiceOptionList& choices);
+        const ChoiceOptionList& GetChoices() const;
+        // 选项在当前语言下的文字
+        std::string_view GetChoiceText(size_t index) const;
         void ClearChoices();
         bool HasChoices() const;
         
@@ -106,6 +171,9 @@ namespace VisualNovel {
         
         // 历史记录
         const DialogueHistory& GetHistory() const;
+        // 按关键词、角色搜索历史记录，结果从新到旧；标签条件对历史记录不适用。
+        // 与 Update 在同一线程调用，结果在下一次 Update 前有效
+        std::vector<SearchHit> SearchHistory(const SearchQuery& query);
         void ClearHistory();
         
         // 设置
@@ -115,8 +183,22 @@ namespace VisualNovel {
         // 特效
         void RegisterTextEffect(const std::string& name,
                               std::function<void(DialogueLine&, float)> effect);
+
+        // 场景载入之后，推进、打字和特效都不应再分配堆内存
+        // 需要以 VN_COUNT_ALLOCATIONS 编译，否则计数恒为0
+        void SetAllocationCheck(bool enabled);
+
+        // 台词和选择支写入宿主每帧读取的事件缓冲，传入 nullptr 停止写入
+        void SetEventQueue(EngineEventQueue* queue);
+        uint64_t GetSteadyStateAllocations() const;
         
     private:
+        class AllocationCheckScope;
+
+        void Advance();
+        void ShowCurrentLine(bool addToHistory);
+        void ResolveCurrentText();
+        void UpdateHistoryIndex();
         void ProcessTextEffects(float deltaTime);
         void FormatTextWithEffects();
     };
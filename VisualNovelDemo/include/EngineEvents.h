@@ -0,0 +1,80 @@
+#pragma once
+#ifndef ENGINE_EVENTS_H
+#define ENGINE_EVENTS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "AtomTable.h"
+
+namespace VisualNovel {
+
+    // 引擎通知宿主的事件
+    enum class EngineEventType : uint8_t {
+        TEXT,         // 开始显示一行台词，value 为当前语言的全文
+        BACKGROUND,   // value 为背景名
+        BGM,          // value 为曲名
+        BGM_STOP,
+        SOUND,        // value 为音效文件
+        CHOICE,       // 出现选择支，选项从 DialogueSystem::GetChoices 读取
+        VOICE,        // 与 TEXT 同时发出，value 为台词的语音文件；为空表示这一行没有语音
+        CHARACTER_SHOW,  // @show，value 为角色名，atoms 为角色、位置预设、表情
+        CHARACTER_HIDE,  // @hide，value 为角色名，atoms[0] 为角色
+        Count
+    };
+
+    // @show / @hide 的 角色、位置预设、表情，解析脚本时驻留；没有写出的为 Atom::NONE
+    using CharacterAtoms = std::array<Atom, 3>;
+
+    struct EngineEvent {
+        EngineEventType type;
+        // 指向脚本命令、对话行或语言表，在下一次 Update 之前有效
+        std::string_view value;
+        // 只有角色事件使用
+        CharacterAtoms atoms;
+    };
+
+    // 每帧的事件缓冲
+    //
+    // 引擎在一帧中把事件追加到这里，宿主每帧 Drain 一次，不再为每个事件调用一次回调、复制一次字符串。
+    // 同一帧内后来的事件覆盖前面同类的事件（跳过模式下连续切换的背景只留最后一个），
+    // 覆盖时保留第一次出现的位置；音效不合并，每一个都会播放。
+    // 只在更新线程中使用。
+    class EngineEventQueue {
+    private:
+        static constexpr size_t kNoEvent = static_cast<size_t>(-1);
+
+        std::vector<EngineEvent> events;
+        // 每种可合并事件在本帧缓冲中的位置；BGM 与 BGM_STOP 共用一个位置
+        std::array<size_t, static_cast<size_t>(EngineEventType::Count)> latest;
+        uint64_t coalescedCount;
+
+    public:
+        explicit EngineEventQueue(size_t capacity = 64);
+
+        void Push(EngineEventType type, std::string_view value = std::string_view(),
+                  const CharacterAtoms& atoms = CharacterAtoms());
+
+        // 按顺序交给 handler 后清空；handler 以 const EngineEvent& 为参数
+        template <typename Handler>
+        void Drain(Handler&& handler) {
+            for (const EngineEvent& event : events) {
+                handler(event);
+            }
+            Clear();
+        }
+
+        const std::vector<EngineEvent>& GetEvents() const { return events; }
+        bool IsEmpty() const { return events.empty(); }
+        void Clear();
+
+        // 累计被后来的事件覆盖而没有交给宿主的事件数
+        uint64_t GetCoalescedCount() const { return coalescedCount; }
+    };
+
+} // namespace VisualNovel
+
+#endif // ENGINE_EVENTS_H
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VisualNovel {
+
+    // 目录监视器
+    //
+    // 在后台线程中监视若干目录（含子目录），文件写完或被替换时以完整路径调用回调。
+    // Linux 上使用 inotify，只在有事件时唤醒；其他平台按修改时间轮询。
+    // 编辑器保存时常常连续产生多个事件，同一文件在 debounce 时间内的变化只通知一次。
+    // 回调在监视线程中执行，不要在其中直接访问引擎状态。
+    class FileWatcher {
+    public:
+        using ChangeCallback = std::function<void(const std::string& path)>;
+
+    private:
+        std::vector<std::string> directories;
+        ChangeCallback onChange;
+        std::chrono::milliseconds debounce;
+
+        std::thread watchThread;
+        std::atomic<bool> running;
+        int wakeFds[2];  // 停止时写入以唤醒阻塞的监视线程
+
+        // 轮询模式下记录的文件修改时间
+        std::map<std::string, std::filesystem::file_time_type> writeTimes;
+
+    public:
+        explicit FileWatcher(std::chrono::milliseconds debounce = std::chrono::milliseconds(30));
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        // 需在 Start 之前调用
+        void AddDirectory(const std::string& directory);
+
+        bool Start(ChangeCallback callback);
+        void Stop();
+        bool IsRunning() const { return running.load(std::memory_order_relaxed); }
+
+    private:
+        void RunInotify();
+        void RunPolling();
+        void ScanWriteTimes(std::vector<std::string>* changed);
+    };
+
+} // namespace VisualNovel
+
+#endif // FILE_WATCHER_H
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef HOT_RELOADER_H
+#define HOT_RELOADER_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "CharacterRenderer.h"
+#include "FileWatcher.h"
+#include "ScriptInterpreter.h"
+#include "ScriptProject.h"
+#include "Metrics.h"
+
+namespace VisualNovel {
+
+    // 脚本与角色配置的热重载
+    //
+    // 文件变化由 FileWatcher 在后台线程中发现，脚本也在该线程中重新解析（工程模式下只重新解析
+    // 改动的文件），解析出错时保留正在运行的旧脚本。更新线程每帧调用 Apply：拿不到锁或没有
+    // 新结果时立即返回，有结果时只交换脚本分配区并映射当前位置，不会等待解析。
+    // 角色配置同样在监视线程中读取和解析成精灵，Apply 把解析好的精灵交给处理器；
+    // 处理器在更新线程中执行，可以直接操作渲染器，只做替换而不碰文件。
+    class HotReloader {
+    public:
+        // sprite 为按新配置创建的角色（id 为配置文件名），配置无法载入时不会调用
+        using CharacterReloadHandler =
+            std::function<void(const std::string& configPath, std::unique_ptr<CharacterSprite> sprite)>;
+
+    private:
+        FileWatcher watcher;
+        std::string scriptPath;          // 单文件模式
+        std::string projectDirectory;    // 工程模式
+        std::string characterDirectory;
+        std::unique_ptr<ScriptProject> project;  // 只在监视线程中使用
+        CharacterReloadHandler characterHandler;
+
+        std::mutex mutex;
+        std::unique_ptr<ScriptImage> pendingScript;
+        std::vector<std::pair<std::string, std::unique_ptr<CharacterSprite>>> pendingCharacters;
+        std::vector<ScriptImage> retiredScripts;  // 被替换的旧脚本在监视线程中释放
+
+        std::atomic<uint64_t> reloadCount;
+        MetricId compileTimer;
+        MetricId applyTimer;
+
+    public:
+        HotReloader();
+        ~HotReloader();
+
+        HotReloader(const HotReloader&) = delete;
+        HotReloader& operator=(const HotReloader&) = delete;
+
+        // 以下需在 Start 之前调用
+        void WatchScript(const std::string& path);
+        void WatchProject(const std::string& directory);
+        void WatchCharacters(const std::string& directory);
+        void SetCharacterReloadHandler(CharacterReloadHandler handler);
+
+        bool Start();
+        void Stop();
+
+        // 更新线程每帧调用，应用了新脚本或交出了新角色配置时返回 true
+        bool Apply(ScriptInterpreter& interpreter);
+
+        uint64_t GetReloadCount() const { return reloadCount.load(std::memory_order_relaxed); }
+
+        // 解析单个脚本文件，失败时打印错误并返回 false
+        static bool CompileScriptFile(const std::string& path, ScriptImage& image);
+
+    private:
+        void OnFileChanged(const std::string& path);
+        void Publish(std::unique_ptr<ScriptImage> image);
+    };
+
+} // namespace VisualNovel
+
+#endif // HOT_RELOADER_H
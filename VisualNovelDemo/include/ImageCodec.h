@@ -0,0 +1,38 @@
+#pragma once
+#ifndef IMAGE_CODEC_H
+#define IMAGE_CODEC_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VisualNovel {
+
+    // RGBA8 图像，每像素4字节，按 R G B A 的字节顺序逐行存放
+    struct SoftwareImage {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;
+
+        SoftwareImage() = default;
+        SoftwareImage(int w, int h) : width(w), height(h), pixels(static_cast<size_t>(w) * h * 4) {}
+
+        uint8_t* Row(int y) { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+        const uint8_t* Row(int y) const { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+    };
+
+    // 不依赖 SDL 的图像读写，供无界面环境使用（存档缩略图、基准图像比对）
+    //
+    // 读取：PNG（非隔行，灰度/RGB/调色板/带 alpha，8 或 16 位；调色板和灰度也支持 1/2/4 位）、
+    //       PAM（P7）和 PPM（P6）。统一转换为 RGBA8，16 位取高字节。
+    // 写出：PNG（不压缩的 deflate 块，任何查看器都能打开）和 PAM（比对基准图像时逐字节一致）。
+    bool LoadImageFile(const std::string& path, SoftwareImage& image, std::string* error = nullptr);
+    bool DecodePng(const uint8_t* data, size_t size, SoftwareImage& image, std::string* error = nullptr);
+    bool SavePng(const std::string& path, const SoftwareImage& image);
+    bool SavePam(const std::string& path, const SoftwareImage& image);
+    // 按扩展名选择 .png 或 .pam
+    bool SaveImageFile(const std::string& path, const SoftwareImage& image);
+
+} // namespace VisualNovel
+
+#endif // IMAGE_CODEC_H
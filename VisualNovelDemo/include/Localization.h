@@ -0,0 +1,121 @@
+#pragma once
+#ifndef LOCALIZATION_H
+#define LOCALIZATION_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "MappedFile.h"
+
+namespace VisualNovel {
+
+    // 语言表文件（.vnst）
+    // 布局：头 | StringTableEntry[entryCount]（按 id 升序） | UTF-8 文本（不含结尾0）
+    // 按本机字节序（小端）写出，由 string_table 工具从 TSV 编译
+    struct StringTableHeader {
+        char magic[4];       // "VNST"
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t reserved;
+        uint64_t textBytes;
+        char language[8];    // 语言代码，不足补0
+    };
+
+    struct StringTableEntry {
+        uint64_t id;
+        uint32_t offset;   // 相对文本区的偏移
+        uint32_t length;
+    };
+
+    static_assert(sizeof(StringTableHeader) == 32, "StringTableHeader 是文件格式的一部分");
+    static_assert(sizeof(StringTableEntry) == 16, "StringTableEntry 是文件格式的一部分");
+
+    // 一种语言的字符串表，直接映射文件，查找结果指向映射的内存
+    class StringTable {
+    private:
+        MappedFile file;
+        const StringTableEntry* entries;
+        const char* text;
+        uint32_t entryCount;
+        uint64_t textBytes;
+        std::string language;
+
+    public:
+        static const uint32_t kVersion = 1;
+
+        StringTable();
+
+        StringTable(const StringTable&) = delete;
+        StringTable& operator=(const StringTable&) = delete;
+
+        // 只检查文件头和大小，条目在查找时才被访问
+        bool Open(const std::string& path);
+        void Close();
+        void Swap(StringTable& other);
+
+        bool IsOpen() const { return file.IsOpen(); }
+        const std::string& GetLanguage() const { return language; }
+        uint32_t GetEntryCount() const { return entryCount; }
+
+        // 找不到时返回空
+        std::string_view Find(uint64_t id) const;
+
+        // 写出语言表；entries 不必有序，重复的 id 保留第一条
+        static bool Write(const std::string& path, const std::string& language,
+                          std::vector<std::pair<uint64_t, std::string>> entries);
+
+        // 台词的稳定 ID：所在标签 + 角色 + 原文，脚本其他位置的增删不影响它
+        static uint64_t MakeTextId(std::string_view section, std::string_view character, std::string_view text);
+        // 作者用 id=名称 显式指定时，原文修改后仍保持同一个 ID
+        static uint64_t MakeExplicitId(std::string_view name);
+    };
+
+    // 当前语言的本地化管理
+    //
+    // 只有当前语言的表被映射在内存中，切换语言时先打开新表、成功后再关闭旧表。
+    // 查找和切换都在更新线程中进行；其他线程（如控制台）通过 RequestLanguage 提出切换，
+    // 由更新线程在 ApplyPendingLanguage 中执行。
+    // 对话系统记住 GetGeneration 的值，变化时重新解析当前台词，脚本无需重新载入。
+    class Localization {
+    private:
+        std::string directory;
+        StringTable table;
+        uint64_t generation;
+
+        std::mutex requestMutex;
+        std::string requestedLanguage;
+        std::atomic<bool> hasRequest;
+
+        Localization();
+
+    public:
+        static Localization& Instance();
+
+        // 语言表所在目录，表文件名为 <语言>.vnst
+        void SetDirectory(const std::string& path);
+
+        // 立即切换；空字符串或找不到表时回到脚本原文
+        bool SetLanguage(const std::string& language);
+        const std::string& GetLanguage() const { return table.GetLanguage(); }
+        uint64_t GetGeneration() const { return generation; }
+
+        void RequestLanguage(const std::string& language);
+        bool ApplyPendingLanguage();
+
+        // 有译文时返回译文，否则返回原文
+        std::string_view Resolve(uint64_t id, std::string_view source) const {
+            if (id == 0 || !table.IsOpen()) {
+                return source;
+            }
+            std::string_view translated = table.Find(id);
+            return translated.empty() ? source : translated;
+        }
+    };
+
+} // namespace VisualNovel
+
+#endif // LOCALIZATION_H
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace VisualNovel {
+
+    // 只读文件映射：页面由操作系统在第一次访问时载入，关闭后立即归还
+    class MappedFile {
+    private:
+        const char* base;
+        size_t length;
+#ifdef _WIN32
+        void* file;     // HANDLE，头文件中不引入 windows.h
+        void* mapping;
+#endif
+
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::string& path);
+        void Close();
+
+        bool IsOpen() const { return base != nullptr; }
+        const char* GetData() const { return base; }
+        size_t GetSize() const { return length; }
+
+        // 交换两个映射，用于“先打开新文件、成功后再替换旧文件”
+        void Swap(MappedFile& other);
+    };
+
+} // namespace VisualNovel
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,184 @@
+#pragma once
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ScriptInterpreter.h"
+
+namespace VisualNovel {
+
+    enum class MetricKind : uint8_t {
+        COUNTER,    // 只增不减的计数，按线程分片
+        GAUGE,      // 当前值，如存活精灵数
+        TIMER       // 次数、总耗时、最大耗时
+    };
+
+    // 指标在存储中的槽位编号，注册后不变
+    using MetricId = uint16_t;
+
+    struct TimerStats {
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+
+        double AverageMs() const { return count ? totalNs / 1e6 / static_cast<double>(count) : 0.0; }
+    };
+
+    struct MetricSample {
+        std::string name;
+        MetricKind kind;
+        uint64_t counter = 0;
+        int64_t gauge = 0;
+        TimerStats timer;
+    };
+
+    // 常驻的指标注册表
+    //
+    // 计数器和计时器写入当前线程自己的分片（单写者，无锁前缀指令），读取时汇总所有分片；
+    // 线程退出时分片中的值并入汇总区，分片回收给之后的线程使用。
+    class MetricsRegistry {
+    public:
+        static const size_t kMaxSlots = 512;
+
+    private:
+        struct Shard {
+            std::atomic<uint64_t> slots[kMaxSlots];
+            Shard();
+        };
+
+        struct MetricInfo {
+            std::string name;
+            MetricKind kind;
+            MetricId id;
+        };
+
+        mutable std::mutex mutex;
+        std::vector<MetricInfo> metrics;
+        std::map<std::string, size_t> metricIndex;
+        size_t nextSlot;
+        size_t nextGauge;
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::vector<Shard*> freeShards;
+        uint64_t retired[kMaxSlots];
+        std::atomic<int64_t> gauges[kMaxSlots];
+
+        // 周期性导出
+        std::thread dumpThread;
+        std::mutex dumpMutex;
+        std::condition_variable dumpSignal;
+        bool dumpStopping;
+
+        MetricsRegistry();
+
+    public:
+        ~MetricsRegistry();
+        static MetricsRegistry& Instance();
+
+        // 同名指标重复注册时返回已有的编号；槽位用尽时抛出 std::length_error
+        MetricId RegisterCounter(const std::string& name);
+        MetricId RegisterGauge(const std::string& name);
+        MetricId RegisterTimer(const std::string& name);
+        bool FindMetric(const std::string& name, MetricId& id, MetricKind& kind) const;
+
+        // 热路径
+        void Increment(MetricId counter, uint64_t amount = 1) {
+            std::atomic<uint64_t>& slot = GetThreadShard().slots[counter];
+            slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+        void SetGauge(MetricId gauge, int64_t value) {
+            gauges[gauge].store(value, std::memory_order_relaxed);
+        }
+        void AddGauge(MetricId gauge, int64_t delta) {
+            gauges[gauge].fetch_add(delta, std::memory_order_relaxed);
+        }
+        void RecordTime(MetricId timer, uint64_t durationNs);
+
+        // 查询
+        uint64_t GetCounter(MetricId counter) const;
+        int64_t GetGauge(MetricId gauge) const;
+        TimerStats GetTimer(MetricId timer) const;
+        std::vector<MetricSample> GetSnapshot() const;
+        void WriteJson(std::ostream& out) const;
+
+        // 每隔 intervalSeconds 向 path 追加一行 JSON 快照
+        void StartPeriodicDump(const std::string& path, double intervalSeconds);
+        void StopPeriodicDump();
+
+    private:
+        MetricId Register(const std::string& name, MetricKind kind);
+        Shard& GetThreadShard();
+        void ReleaseShard(Shard* shard);
+        uint64_t SumSlot(size_t slot) const;
+
+        friend struct MetricsShardHandle;
+    };
+
+    // 作用域计时，析构时写入计时器
+    class ScopedMetricTimer {
+    private:
+        MetricId timer;
+        uint64_t startNs;
+
+    public:
+        explicit ScopedMetricTimer(MetricId timerId);
+        ~ScopedMetricTimer();
+
+        ScopedMetricTimer(const ScopedMetricTimer&) = delete;
+        ScopedMetricTimer& operator=(const ScopedMetricTimer&) = delete;
+    };
+
+    // 引擎各子系统使用的指标
+    struct EngineMetrics {
+        static const size_t kCommandTypeCount = static_cast<size_t>(CommandType::END) + 1;
+
+        MetricId commandsExecuted[kCommandTypeCount];   // commands.<类型>
+        MetricId labelJumps;
+        MetricId conditionEvaluations;
+        MetricId scriptLinesParsed;
+        MetricId historySize;           // 仪表：最近写入的对话历史的条数
+        MetricId liveSprites;           // 仪表：主循环每帧写入渲染器中的角色数
+        MetricId assetCacheHits;
+        MetricId assetCacheMisses;
+        MetricId assetBytes;            // 仪表：所有合成器纹理缓存的字节数之和
+        MetricId saveLatency;           // 计时器
+        MetricId loadLatency;           // 计时器
+        MetricId frameAllocations;      // 仪表：上一帧的分配次数
+        MetricId frameAllocatedBytes;   // 仪表：上一帧的分配字节数
+        MetricId frames;
+
+        static const EngineMetrics& Get();
+
+        static void CountCommand(CommandType type) {
+            const EngineMetrics& m = Get();
+            MetricsRegistry::Instance().Increment(m.commandsExecuted[static_cast<size_t>(type)]);
+        }
+
+    private:
+        EngineMetrics();
+    };
+
+    // 记录一帧的分配次数，由主循环在帧首尾调用
+    class FrameAllocationTracker {
+    private:
+        uint64_t startAllocations;
+        uint64_t startBytes;
+
+    public:
+        FrameAllocationTracker();
+        void BeginFrame();
+        void EndFrame();
+    };
+
+} // namespace VisualNovel
+
+#endif // METRICS_H
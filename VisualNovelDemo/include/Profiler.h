@@ -0,0 +1,194 @@
+#pragma once
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace VisualNovel {
+
+    // 追踪区域所属的子系统，帧耗时直方图按子系统统计
+    enum class TraceSubsystem : uint8_t {
+        ENGINE,       // VisualNovelEngine::Update 等整体流程
+        SCRIPT,       // ScriptInterpreter
+        DIALOGUE,     // DialogueSystem
+        RENDERER,     // CharacterRenderer
+        ASSETS,       // 脚本、角色配置、贴图等资源加载
+        CALLBACK,     // onTextDisplay 等用户回调
+        COUNT
+    };
+
+    const size_t kTraceSubsystemCount = static_cast<size_t>(TraceSubsystem::COUNT);
+
+    // 一段追踪记录，时间单位为纳秒
+    struct TraceEvent {
+        const char* name;   // 必须是字符串字面量或生命周期足够长的字符串
+        uint64_t startNs;
+        uint64_t durationNs;
+        uint32_t threadIndex;
+        TraceSubsystem subsystem;
+    };
+
+    // 滚动窗口内某个子系统每帧耗时的分布
+    struct FrameHistogram {
+        // 桶上界（毫秒）：0.5 1 2 4 8 16 33 以及更长
+        static const size_t kBucketCount = 8;
+        static const double kBucketLimitsMs[kBucketCount - 1];
+
+        std::array<uint32_t, kBucketCount> buckets{};
+        uint32_t frames = 0;
+        double averageMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    // 单线程写入的环形缓冲区，写满后覆盖最旧的记录
+    // 写入端只有所属线程，导出时其他线程读取，不需要加锁
+    class TraceBuffer {
+    public:
+        static const size_t kCapacity = 1 << 14;
+
+    private:
+        struct Slot {
+            std::atomic<const char*> name{nullptr};
+            std::atomic<uint64_t> startNs{0};
+            std::atomic<uint64_t> durationNs{0};
+            std::atomic<uint8_t> subsystem{0};
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<uint64_t> head;
+        uint32_t threadIndex;
+
+    public:
+        explicit TraceBuffer(uint32_t threadIndex);
+
+        void Push(const char* name, TraceSubsystem subsystem, uint64_t startNs, uint64_t durationNs);
+        // 复制当前仍有效的记录；与写入并发时丢弃可能被覆盖的部分
+        void Snapshot(std::vector<TraceEvent>& out) const;
+        uint32_t GetThreadIndex() const { return threadIndex; }
+    };
+
+    // 进程内唯一的追踪器与帧分析器
+    //
+    // 追踪区域用 VN_TRACE_ZONE 宏标注。未定义 VN_ENABLE_TRACING 时宏展开为空；
+    // 定义后在运行时关闭的情况下，每个区域只有一次 relaxed 原子读取。
+    // 主循环每帧调用 BeginFrame/EndFrame，帧超出预算时可自动导出追踪文件。
+    class Profiler {
+    private:
+        static std::atomic<bool> enabled;
+
+        // 每个记录过的线程占用一个缓冲区，线程退出后回收给之后的线程，线程反复创建时总数不增长
+        mutable std::mutex buffersMutex;
+        std::vector<std::unique_ptr<TraceBuffer>> buffers;
+        std::vector<TraceBuffer*> freeBuffers;
+
+        // 本帧各子系统累计耗时（只统计最外层区域，嵌套不重复计算）
+        std::array<std::atomic<uint64_t>, kTraceSubsystemCount> frameAccumNs;
+        uint64_t frameStartNs;
+        uint64_t frameIndex;
+
+        // 滚动窗口：每个子系统最近 kWindowFrames 帧的耗时
+        static constexpr size_t kWindowFrames = 600;
+        mutable std::mutex historyMutex;
+        std::array<std::vector<uint32_t>, kTraceSubsystemCount> historyUs;
+        std::vector<uint32_t> frameHistoryUs;
+        size_t historyCursor;
+        size_t historySize;
+
+        // 超预算自动导出
+        std::atomic<uint64_t> frameBudgetNs;
+        std::string overBudgetPath;
+        uint64_t lastDumpNs;
+
+        Profiler();
+
+    public:
+        static Profiler& Instance();
+
+        static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+        void SetEnabled(bool value);
+
+        static uint64_t NowNs();
+
+        // 由 TraceZone 调用
+        void Record(const char* name, TraceSubsystem subsystem, uint64_t startNs, uint64_t endNs, bool outermost);
+
+        // 帧边界，由主循环调用
+        void BeginFrame();
+        void EndFrame();
+
+        // 帧耗时超过 budgetMs 时把追踪写到 path（0 表示不检查），两次导出至少间隔一秒
+        void SetFrameBudget(double budgetMs, const std::string& path);
+
+        // Chrome trace-event JSON，可直接用 chrome://tracing 或 Perfetto 打开
+        void WriteChromeTrace(std::ostream& out);
+        bool DumpChromeTrace(const std::string& path);
+
+        FrameHistogram GetHistogram(TraceSubsystem subsystem) const;
+        FrameHistogram GetFrameHistogram() const;
+        void PrintSummary(std::ostream& out) const;
+
+        static const char* GetSubsystemName(TraceSubsystem subsystem);
+
+        size_t GetBufferCount() const;
+
+    private:
+        TraceBuffer& GetThreadBuffer();
+        void ReleaseBuffer(TraceBuffer* buffer);
+        FrameHistogram BuildHistogram(const std::vector<uint32_t>& samples) const;
+
+        friend struct TraceBufferHandle;
+    };
+
+    // RAII 追踪区域，构造时记录开始时间，析构时写入本线程的缓冲区
+    // 关闭时的判断内联在调用处，开启后才进入 Begin/End
+    class TraceZone {
+    private:
+        const char* name;
+        uint64_t startNs;
+        TraceSubsystem subsystem;
+        bool active;
+        bool outermost;
+
+    public:
+        TraceZone(TraceSubsystem zoneSubsystem, const char* zoneName)
+            : name(zoneName), startNs(0), subsystem(zoneSubsystem),
+              active(Profiler::IsEnabled()), outermost(false) {
+            if (active) Begin();
+        }
+
+        ~TraceZone() {
+            if (active) End();
+        }
+
+        TraceZone(const TraceZone&) = delete;
+        TraceZone& operator=(const TraceZone&) = delete;
+
+    private:
+        void Begin();
+        void End();
+    };
+
+} // namespace VisualNovel
+
+#define VN_TRACE_CONCAT_INNER(a, b) a##b
+#define VN_TRACE_CONCAT(a, b) VN_TRACE_CONCAT_INNER(a, b)
+
+#ifdef VN_ENABLE_TRACING
+// 用法：VN_TRACE_ZONE(DIALOGUE, "DialogueSystem::Update");
+#define VN_TRACE_ZONE(subsystem, name) \
+    ::VisualNovel::TraceZone VN_TRACE_CONCAT(vnTraceZone_, __LINE__)(::VisualNovel::TraceSubsystem::subsystem, name)
+#else
+#define VN_TRACE_ZONE(subsystem, name) ((void)0)
+#endif
+
+#endif // PROFILER_H
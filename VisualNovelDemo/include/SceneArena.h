@@ -0,0 +1,98 @@
+#pragma once
+#ifndef SCENE_ARENA_H
+#define SCENE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace VisualNovel {
+
+    // 场景数据使用的容器：分配器来自构造时传入的 memory_resource，默认是全局堆
+    using ArenaString = std::pmr::string;
+    using ArenaStringList = std::pmr::vector<std::pmr::string>;
+    using ArenaStringMap = std::pmr::map<std::pmr::string, std::pmr::string, std::less<>>;
+    template <typename T>
+    using ArenaVector = std::pmr::vector<T>;
+
+    // 缓存上游内存块的资源
+    // 场景切换时单调缓冲区把所有块还回来，下一个场景按同样的大小申请时直接复用，不再经过 malloc
+    class ChunkCache : public std::pmr::memory_resource {
+    private:
+        struct Chunk {
+            void* pointer;
+            size_t bytes;
+            size_t alignment;
+        };
+
+        std::pmr::memory_resource* upstream;
+        std::vector<Chunk> freeChunks;
+        size_t cachedBytes;
+        size_t maxCachedBytes;
+        size_t outstandingBytes;
+
+    public:
+        explicit ChunkCache(size_t maxCachedBytes = 8 * 1024 * 1024,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~ChunkCache() override;
+
+        ChunkCache(const ChunkCache&) = delete;
+        ChunkCache& operator=(const ChunkCache&) = delete;
+
+        // 归还所有缓存的空闲块
+        void Trim();
+        size_t GetOutstandingBytes() const { return outstandingBytes; }
+        size_t GetCachedBytes() const { return cachedBytes; }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    // 场景作用域的单调分配区
+    //
+    // 一个场景（一段对话、一份脚本）的短生命周期数据都从这里分配：分配只是移动指针，
+    // 单个对象的释放是空操作，Reset 把整个场景的内存一次性交还。
+    // 用 Make 创建的对象在 Reset 时不调用析构函数，只能用于析构只释放内存的类型
+    // （字符串、pmr 容器以及由它们组成的结构），这样场景拆除与对象数量无关。
+    class SceneArena {
+    private:
+        ChunkCache cache;
+        std::pmr::monotonic_buffer_resource resource;
+        uint64_t generation;
+
+    public:
+        explicit SceneArena(size_t initialChunkBytes = 16 * 1024);
+
+        SceneArena(const SceneArena&) = delete;
+        SceneArena& operator=(const SceneArena&) = delete;
+
+        std::pmr::memory_resource* GetResource() { return &resource; }
+
+        // 在分配区中构造对象，pmr 容器及分配器感知的类型会自动使用本分配区
+        template <typename T, typename... Args>
+        T* Make(Args&&... args) {
+            std::pmr::polymorphic_allocator<T> allocator(&resource);
+            T* object = allocator.allocate(1);
+            allocator.construct(object, std::forward<Args>(args)...);
+            return object;
+        }
+
+        // 丢弃本场景分配的全部对象，之前 Make 得到的指针全部失效
+        void Reset();
+
+        // 每次 Reset 加一，可用来检查是否持有过期的指针
+        uint64_t GetGeneration() const { return generation; }
+        // 当前从上游占用的字节数
+        size_t GetReservedBytes() const { return cache.GetOutstandingBytes(); }
+    };
+
+} // namespace VisualNovel
+
+#endif // SCENE_ARENA_H
@@ -0,0 +1,57 @@
+#pragma once
+#ifndef SCRIPT_COMPILER_H
+#define SCRIPT_COMPILER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include "ScriptInterpreter.h"
+
+namespace VisualNovel {
+
+    // 脚本预编译器：把定稿的脚本翻译成 C++ 源文件，随游戏一起编译
+    //
+    // 生成的代码是一个可以从任意位置恢复执行的 switch，每条命令一个 case，
+    // case 编号就是解释执行时的命令下标，存档中的位置和调用栈在两种方式之间通用。
+    // 台词、选项、演出参数放在静态常量表中，简单的条件（变量 比较 数值、变量、!变量）
+    // 翻译成原生比较，其余条件和表达式仍交给解释器求值。
+    class ScriptCompiler {
+    private:
+        ScriptCommandList* commands;
+        std::map<std::string, ScriptLabel> labels;
+        SceneArena arena;
+        std::string sourcePath;
+        uint64_t sourceHash;
+        std::vector<std::string> errors;
+
+        // 生成过程中收集的常量表
+        std::vector<std::string> names;
+        std::map<std::string, size_t> nameIndices;
+        std::vector<std::string> atomNames;       // 生成的代码在静态初始化时驻留
+        std::map<std::string, size_t> atomIndices;
+
+    public:
+        ScriptCompiler();
+
+        // sourcePath 是运行时 LoadScript 使用的路径，生成的脚本以此登记
+        bool Parse(const std::string& content, const std::string& sourcePath);
+        // 解析失败或存在未定义的跳转目标时返回 false，不输出
+        bool Generate(std::ostream& out);
+
+        const std::vector<std::string>& GetErrors() const;
+
+        // 转换为 C++ 字符串字面量（含引号）
+        static std::string Quote(std::string_view text);
+
+    private:
+        size_t Name(const std::string& name);
+        size_t AtomName(const std::string& name);
+        int FindLabel(const std::string& label, int lineNumber);
+        std::string CompileCondition(const std::string& condition);
+        void AddError(int lineNumber, const std::string& message);
+    };
+
+} // namespace VisualNovel
+
+#endif // SCRIPT_COMPILER_H
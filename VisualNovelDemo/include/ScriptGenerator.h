@@ -0,0 +1,55 @@
+#pragma once
+#ifndef SCRIPT_GENERATOR_H
+#define SCRIPT_GENERATOR_H
+
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+namespace VisualNovel {
+
+    // 生成参数
+    struct ScriptGeneratorOptions {
+        size_t lineCount = 10000;      // 输出的总行数（近似）
+        int branchingFactor = 3;       // 每个选择支的选项数
+        double labelDensity = 0.02;    // 每行对应的标签数，决定段落长度
+        double choiceRatio = 0.5;      // 段落以选择支结束的比例，其余以 @goto 结束
+        double variableUsage = 0.05;   // 每行是 @set 的概率
+        double conditionUsage = 0.02;  // 每行是 @if 的概率
+        double stagingUsage = 0.03;    // 每行是 @show/@hide/@bg 的概率
+        int variableCount = 16;
+        int castSize = 4;
+        uint64_t seed = 1;
+        std::string labelPrefix = "seg_";  // 多个章节文件放进同一工程时用不同前缀避免标签重名
+        std::string nextLabel;             // 非空时最后一段 @goto 到该标签（通常在下一章节文件中）而不是 @end
+    };
+
+    // 合成脚本与角色配置生成器，用于压力测试和基准测试
+    // 使用自带的 SplitMix64 而不是标准库分布，同一个种子在任何平台和编译器上都得到同样的输出
+    class ScriptGenerator {
+    private:
+        ScriptGeneratorOptions options;
+        uint64_t state;
+
+    public:
+        explicit ScriptGenerator(const ScriptGeneratorOptions& options);
+
+        // 生成 @label/@choice/@goto/@if/@set/@show 及对话行组成的脚本
+        void GenerateScript(std::ostream& out);
+        std::string GenerateScript();
+
+        // 与 data/characters/sakura.json 结构相同的角色配置
+        std::string GenerateCharacterConfig(int index);
+        static std::string GetCharacterId(int index);
+
+        const ScriptGeneratorOptions& GetOptions() const;
+
+    private:
+        uint64_t Next();
+        uint32_t Below(uint32_t bound);
+        bool Chance(double probability);
+    };
+
+} // namespace VisualNovel
+
+#endif // SCRIPT_GENERATOR_H
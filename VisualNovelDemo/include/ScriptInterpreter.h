@@ -6,7 +6,10 @@
 #include <vector>
 #include <map>
 #include <functional>
+#include <memory>
 #include "DialogueSystem.h"
+#include "CompiledScript.h"
+#include "ScriptScheduler.h"
 
 namespace VisualNovel {
     
@@ -35,14 +38,27 @@ namespace VisualNovel {
     
     // 脚本命令
     struct ScriptCommand {
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
         CommandType type;
-        std::vector<std::string> parameters;
-        std::string rawLine;
+        ArenaStringList parameters;
+        ArenaString rawLine;
         int lineNumber;
+        // 可翻译文本的 ID：对话一条，选择支每个选项一条（见 StringTable::MakeTextId）
+        ArenaVector<uint64_t> textIds;
+        // @show / @hide 的角色、位置预设、表情，解析时驻留，执行时不再查字符串
+        CharacterAtoms atoms;
         
         ScriptCommand(CommandType t, const std::vector<std::string>& params, 
-                     const std::string& raw, int line);
+                     const std::string& raw, int line, const allocator_type& allocator = {});
+        ScriptCommand(const ScriptCommand& other, const allocator_type& allocator = {});
+        ScriptCommand(ScriptCommand&& other) = default;
+        ScriptCommand(ScriptCommand&& other, const allocator_type& allocator);
+        ScriptCommand& operator=(const ScriptCommand& other) = default;
+        ScriptCommand& operator=(ScriptCommand&& other) = default;
     };
+
+    using ScriptCommandList = ArenaVector<ScriptCommand>;
     
     // 脚本标签
     struct ScriptLabel {
@@ -71,20 +87,65 @@ namespace VisualNovel {
         void Clear();
     };
     
+    // 一份解析好的脚本：命令在自己的分配区中，整体可以在线程间移交
+    struct ScriptImage {
+        std::unique_ptr<SceneArena> arena;
+        ScriptCommandList* commands = nullptr;
+        std::map<std::string, ScriptLabel> labels;
+    };
+
+    class ScriptProject;
+    class ScriptStream;
+
+    // 脚本挂起时等待的事件
+    enum class ScriptAwait {
+        NONE,
+        PLAYER,    // 玩家读完对话、做出选择，或同步命令要求暂停；由 Resume/JumpToLabel 恢复
+        TIMER,     // @wait，由调度器的计时器恢复
+        COMMAND    // 异步命令，由 ScriptContinuation 恢复
+    };
+
+    // 异步命令：处理器开始工作后立即返回，完成时调用 continuation.Resume()
+    using AsyncCommandHandler = std::function<void(const std::vector<std::string>&, ScriptContinuation)>;
+    
     // 脚本解释器
     class ScriptInterpreter {
     private:
-        std::vector<ScriptCommand> commands;
+        // 命令放在脚本分配区，ClearScript 时整块丢弃，热重载时整个分配区替换。
+        // 第一次解析脚本时才创建；共用脚本、预编译脚本不需要它
+        std::unique_ptr<SceneArena> scriptArena;
+        size_t arenaChunkBytes;
+        ScriptCommandList* commands;  // 没有脚本时指向共用的空命令表
         std::map<std::string, ScriptLabel> labels;
+        // 非空时 commands 指向与其他解释器共用的只读脚本，labels 为空
+        std::shared_ptr<const ScriptImage> sharedScript;
+        // 非空时脚本还在后台解析，命令从这里读取，解析完后换成普通的 commands 和 labels
+        std::unique_ptr<ScriptStream> stream;
+        // 跳转目标还没解析到时记下，找到前脚本停在原处
+        std::string pendingLabel;
+        bool pendingCall;
         std::map<std::string, std::function<bool(const std::vector<std::string>&)>> customCommands;
+        std::map<std::string, AsyncCommandHandler> asyncCommands;
+        // 非空时执行预编译脚本，commands 为空，位置含义不变
+        const CompiledScript* compiled;
+        bool useCompiledScripts;
         
         VariableScope* currentScope;
         std::vector<VariableScope*> scopeStack;
         
         int programCounter;
         bool isRunning;
-        bool isWaiting;
-        float waitTimer;
+        bool isPaused;
+
+        // 挂起状态：脚本停在某条命令之后，等待的事件发生前 Update 不做任何工作
+        ScriptAwait awaiting;
+        uint64_t awaitTicket;  // 计时器和异步命令在调度器中的编号
+        // 第一次需要等待时才创建；SetScheduler 共用调度器的解释器不会创建
+        std::unique_ptr<ScriptScheduler> ownScheduler;
+        ScriptScheduler* scheduler;  // 为空表示使用自己的调度器
+
+        // 非空时背景、BGM、音效命令写入事件，参数直接指向脚本中的文本
+        EngineEventQueue* events;
         
         // 调用栈
         struct CallStackFrame {
@@ -94,12 +155,37 @@ namespace VisualNovel {
         std::vector<CallStackFrame> callStack;
         
     public:
-        ScriptInterpreter();
+        // arenaChunkBytes 为脚本和每批对话分配区的首块大小；同时运行大量解释器时调小
+        explicit ScriptInterpreter(size_t arenaChunkBytes = 16 * 1024);
         ~ScriptInterpreter();
+
+        ScriptInterpreter(const ScriptInterpreter&) = delete;
+        ScriptInterpreter& operator=(const ScriptInterpreter&) = delete;
         
         // 脚本加载
+        // 有同一路径的预编译脚本、且磁盘上的文件不存在或未被改动时直接使用预编译版本，不解析
         bool LoadScript(const std::string& scriptPath);
         bool LoadScriptFromString(const std::string& scriptContent);
+        // 后台边读边解析，前 chunkLines 行解析完就可以开始执行，不必等整个文件。
+        // 执行到还没解析到的位置、跳转到还没解析到的标签时脚本在原处等待，不阻塞 Update。
+        // 只在文件无法打开时返回 false，解析错误在解析完时输出
+        bool LoadScriptStreaming(const std::string& scriptPath, size_t chunkLines = 256);
+        bool IsStreaming() const;
+        // 阻塞到后台解析完（读档、热重载前调用）
+        void WaitForStream();
+        // 载入整个工程链接后的命令表，跳转可以跨文件；之后工程重新加载不影响已载入的命令
+        void LoadProject(const ScriptProject& project);
+        // 热重载：换上新解析的脚本，变量、作用域和调用栈保持不变，
+        // 当前位置按所在标签和源码行映射到新脚本中。只交换指针，不复制命令。
+        // 返回被替换下来的旧脚本，调用方可以把它交给其他线程释放
+        ScriptImage AdoptScript(ScriptImage image);
+        // 载入 script_compiler 生成的脚本，执行时不再逐条分派命令
+        void LoadCompiled(const CompiledScript& script);
+        // 与其他解释器共用一份解析好的脚本，不复制命令和标签（服务端同时运行大量存档时使用）
+        void LoadShared(std::shared_ptr<const ScriptImage> image);
+        // 关闭后 LoadScript 总是解析脚本文件（模组和开发时使用）
+        void SetUseCompiledScripts(bool use);
+        bool IsCompiled() const;
         void ClearScript();
         
         // 执行控制
@@ -107,7 +193,12 @@ namespace VisualNovel {
         void Stop();
         void Pause();
         void Resume();
+        // 使用自己的调度器时先推进它的时钟；挂起中或暂停时直接返回
         void Update(float deltaTime);
+        // 多个解释器共用一个调度器时由调用方推进调度器，传入 nullptr 恢复使用自己的调度器。
+        // 切换时正在进行的 @wait 以剩余时间在新调度器上继续，正在等待的异步命令视为已完成
+        void SetScheduler(ScriptScheduler* shared);
+        ScriptScheduler& GetScheduler();
         
         // 跳转控制
         void JumpToLabel(const std::string& label);
@@ -124,40 +215,79 @@ namespace VisualNovel {
         // 自定义命令
         void RegisterCustomCommand(const std::string& commandName,
                                  std::function<bool(const std::vector<std::string>&)> handler);
+        // 需要等待资源就绪、动画播完等外部事件的命令；执行到它时脚本挂起，直到 Resume 被调用
+        void RegisterAsyncCommand(const std::string& commandName, AsyncCommandHandler handler);
+        // 同名处理器照常执行；事件供宿主每帧统一处理
+        void SetEventQueue(EngineEventQueue* queue);
         
         // 状态查询
         bool IsRunning() const;
         bool IsWaiting() const;
+        ScriptAwait GetAwait() const;
         int GetCurrentLine() const;
+        // 命令文本在脚本分配区中，这里复制一份返回，下一次调用前有效。
+        // 副本比上次长时会分配，只供调试和控制台显示，不要在每帧的路径上调用
         const std::string& GetCurrentCommand() const;
         
-        // 获取解析结果
-        const std::vector<DialogueLine>& GetDialogueLines() const;
-        const std::vector<ChoiceOption>& GetChoiceOptions() const;
+        // 最近一次 Update 执行到阻塞命令为止产生的对话和选项，下一次 Update 前有效
+        const DialogueLineList& GetDialogueLines() const;
+        const ChoiceOptionList& GetChoiceOptions() const;
         
     private:
-        bool ParseLine(const std::string& line, int lineNumber);
-        ScriptCommand CreateCommand(const std::string& line, int lineNumber);
+        friend class CompiledScriptContext;
+        friend class ScriptScheduler;
+
         bool ExecuteCommand(const ScriptCommand& command);
         
         // 命令处理器
-        bool HandleDialogue(const std::vector<std::string>& params);
-        bool HandleJump(const std::vector<std::string>& params);
-        bool HandleCondition(const std::vector<std::string>& params);
-        bool HandleChoice(const std::vector<std::string>& params);
-        bool HandleSetVariable(const std::vector<std::string>& params);
-        bool HandleSetFlag(const std::vector<std::string>& params);
-        bool HandleWait(const std::vector<std::string>& params);
+        bool HandleDialogue(const ScriptCommand& command);
+        bool HandleJump(const ArenaStringList& params);
+        bool HandleCondition(const ArenaStringList& params);
+        bool HandleChoice(const ScriptCommand& command);
+        bool HandleSetVariable(const ArenaStringList& params);
+        bool HandleSetFlag(const ArenaStringList& params);
+        bool HandleWait(const ArenaStringList& params);
+        bool HandleCustom(const std::string& name, const ArenaStringList& params, size_t first);
+        void EmitStagingEvent(EngineEventType type, std::string_view value,
+                              const CharacterAtoms& atoms = CharacterAtoms());
+        bool HasCustom(const std::string& name) const;
+        bool RunCustom(const std::string& name, std::vector<std::string>& args);
+        void AssignVariable(const std::string& name, std::string value);
         
         // 工具函数
         std::string EvaluateExpression(const std::string& expr) const;
         bool EvaluateCondition(const std::string& condition) const;
         void PushScope();
         void PopScope();
+
+        // 挂起与恢复
+        void AwaitPlayer();
+        void AwaitTimer(double seconds);
+        void CancelAwait();
+        void OnAwaitComplete(uint64_t ticket);
+        int RemapPosition(const ScriptImage& previous, int position) const;
+        int RemapCompiledPosition(const CompiledScript& previous, int position) const;
+        // 标签的命令下标，不存在时返回 -1
+        int FindLabel(const std::string& label) const;
+
+        // 清空后的可写命令表，需要时创建脚本分配区
+        ScriptCommandList& OwnCommands();
+
+        // 流式载入时只能访问已解析的命令
+        size_t CommandCount() const;
+        const ScriptCommand& CommandAt(size_t index) const;
+        // 换上后台解析完的脚本，未解析完时等待
+        void FinishStream();
+        // 目标已找到或确定不存在时返回 true
+        bool ResolvePendingJump();
         
-        // 解析状态
-        std::vector<DialogueLine> parsedDialogue;
-        std::vector<ChoiceOption> parsedChoices;
+        // 执行状态：每次 Update 产生的对话和选项放在批次分配区，下一次 Update 开始时丢弃
+        SceneArena batchArena;
+        DialogueLineList* parsedDialogue;
+        ChoiceOptionList* parsedChoices;
+        void ResetBatch();
+
+        mutable std::string currentCommandText;  // GetCurrentCommand 返回的副本
     };
     
 } // namespace VisualNovel
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef SCRIPT_PARSER_H
+#define SCRIPT_PARSER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "ScriptInterpreter.h"
+
+namespace VisualNovel {
+
+    // 脚本解析器：把脚本文本逐行翻译成 ScriptCommand
+    // 不依赖解释器的运行状态，解释器、分析工具和编译工具共用同一套语法
+    //
+    //   # 注释
+    //   @label name            -> LABEL
+    //   @goto name             -> JUMP
+    //   @call name / @return   -> CALL / RETURN
+    //   @if 条件 name          -> CONDITION（条件成立时跳转）
+    //   @choice                -> CHOICE，参数为 文本,标签,文本,标签...
+    //       "文本" -> name
+    //   @set / @flag / @wait / @bg / @show / @hide / @bgm / @se / @anim / @end
+    //   @其他                   -> SPECIAL_EFFECT，第一个参数是命令名
+    //   角色 表情 "台词"        -> DIALOGUE，参数为 角色,表情,台词
+    //
+    // 对话和选项文本同时生成翻译用的 ID（ScriptCommand::textIds），台词后写 id=名称 可以固定 ID
+    class ScriptParser {
+    private:
+        ScriptCommandList& commands;
+        std::map<std::string, ScriptLabel>& labels;
+        std::vector<std::string> errors;
+        std::string currentSection;  // 最近的 @label，参与生成文本 ID
+
+        // 正在收集选项的 @choice
+        bool inChoice;
+        std::vector<std::string> choiceParams;
+        std::string choiceRaw;
+        int choiceLine;
+
+    public:
+        ScriptParser(ScriptCommandList& commands,
+                     std::map<std::string, ScriptLabel>& labels);
+
+        // 逐行输入，行号从1开始
+        void FeedLine(const std::string& line, int lineNumber);
+        // 输入结束，提交尚未结束的多行命令
+        void Finish();
+        // 解析整份脚本
+        bool Parse(const std::string& content);
+
+        const std::vector<std::string>& GetErrors() const;
+
+        // 按空白切分，双引号内的内容作为一个参数（不含引号）
+        static std::vector<std::string> Tokenize(const std::string& line);
+        static CommandType ResolveCommand(const std::string& keyword);
+
+    private:
+        void FlushChoice();
+        uint64_t DialogueTextId(const std::vector<std::string>& params) const;
+        void AddError(int lineNumber, const std::string& message);
+    };
+
+} // namespace VisualNovel
+
+#endif // SCRIPT_PARSER_H
@@ -0,0 +1,95 @@
+#pragma once
+#ifndef SCRIPT_PROJECT_H
+#define SCRIPT_PROJECT_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ScriptInterpreter.h"
+
+namespace VisualNovel {
+
+    // 一个脚本文件在链接后的命令表中占据的区间
+    struct ScriptModule {
+        std::string path;
+        int firstCommand;
+        int commandCount;  // 不含链接时补在文件末尾的 @end
+    };
+
+    struct ScriptProjectStats {
+        size_t files = 0;
+        size_t compiled = 0;   // 本次重新解析的文件数
+        size_t reused = 0;     // 命中缓存的文件数
+        size_t commands = 0;
+        size_t labels = 0;
+        double compileMs = 0.0;
+        double linkMs = 0.0;
+    };
+
+    // 多文件脚本工程
+    //
+    // 递归收集目录下的全部 .txt 脚本，多线程并行解析，再把所有文件链接成一张命令表和
+    // 一张全局标签表，@goto / @call / @if / 选择支可以直接跳到其他章节的标签。
+    // 每个文件的解析结果按修改时间和大小缓存，再次 Load 时只重新解析改动过的文件。
+    //
+    // 文件不以 @goto/@end/@return 结尾时链接器补一条 @end，执行到文件结尾的行为与单独加载该文件时一致。
+    class ScriptProject {
+    private:
+        // 单个文件的解析结果，命令放在文件自己的分配区里
+        struct CompiledScript {
+            std::string path;
+            std::filesystem::file_time_type writeTime;
+            uintmax_t fileSize = 0;
+            SceneArena arena;
+            ScriptCommandList* commands = nullptr;
+            std::map<std::string, ScriptLabel> labels;
+            std::vector<std::string> errors;
+        };
+
+        std::string rootDirectory;
+        unsigned workerCount;
+        std::map<std::string, std::unique_ptr<CompiledScript>> cache;
+
+        // 链接结果
+        SceneArena linkArena;
+        ScriptCommandList* commands;
+        std::map<std::string, ScriptLabel> labels;
+        std::vector<ScriptModule> modules;
+        std::vector<std::string> errors;
+        ScriptProjectStats stats;
+
+    public:
+        // workerCount 为0时使用硬件线程数
+        explicit ScriptProject(unsigned workerCount = 0);
+
+        ScriptProject(const ScriptProject&) = delete;
+        ScriptProject& operator=(const ScriptProject&) = delete;
+
+        // 加载目录下的全部脚本；对同一目录再次调用即为增量重新加载
+        // 返回 false 表示存在解析错误、重复标签或未定义的跳转目标
+        bool Load(const std::string& directory = "data/scripts");
+        bool Reload();
+
+        const ScriptCommandList& GetCommands() const { return *commands; }
+        const std::map<std::string, ScriptLabel>& GetLabels() const { return labels; }
+        const std::vector<ScriptModule>& GetModules() const { return modules; }
+        const std::vector<std::string>& GetErrors() const { return errors; }
+        const ScriptProjectStats& GetStats() const { return stats; }
+
+        // 命令所在的文件，用于报错时定位
+        const ScriptModule* FindModule(int commandIndex) const;
+
+    private:
+        std::vector<std::string> DiscoverScripts(const std::string& directory) const;
+        void Compile(std::vector<CompiledScript*>& stale);
+        static void CompileScript(CompiledScript& script);
+        void Link(const std::vector<std::string>& files);
+        void CheckTargets();
+    };
+
+} // namespace VisualNovel
+
+#endif // SCRIPT_PROJECT_H
@@ -0,0 +1,101 @@
+#pragma once
+#ifndef SCRIPT_SCHEDULER_H
+#define SCRIPT_SCHEDULER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace VisualNovel {
+
+    class ScriptInterpreter;
+
+    // 异步命令完成后投递到这里，任意线程都可以写入
+    struct ScriptCompletionQueue {
+        std::mutex mutex;
+        std::vector<uint64_t> tickets;
+    };
+
+    // 挂起的脚本的恢复句柄，交给异步命令的处理器
+    //
+    // 处理器开始加载资源、播放动画后立即返回，完成时调用 Resume()（可以在任意线程），
+    // 脚本在下一次 ScriptScheduler::Advance 时继续执行。可以复制，重复调用只生效一次；
+    // 也可以直接赋给 CharacterAnimation::onComplete 这类 std::function<void()> 回调。
+    // 脚本在完成前被停止或销毁时，Resume() 什么也不做。
+    class ScriptContinuation {
+    private:
+        std::shared_ptr<ScriptCompletionQueue> queue;
+        uint64_t ticket;
+
+    public:
+        ScriptContinuation() : ticket(0) {}
+        ScriptContinuation(std::shared_ptr<ScriptCompletionQueue> completions, uint64_t id)
+            : queue(std::move(completions)), ticket(id) {}
+
+        void Resume() const;
+        void operator()() const { Resume(); }
+        explicit operator bool() const { return queue != nullptr; }
+    };
+
+    // 脚本调度器
+    //
+    // 解释器在 @wait 和异步命令处挂起，在这里登记等待的事件：计时器放进按到期时间排序的堆，
+    // 异步命令的完成从投递队列取出。Advance 只处理到期和已完成的事件，挂起中的脚本不占用
+    // 每帧的更新时间，多个解释器可以共用一个调度器。只在更新线程中调用（Resume 除外）。
+    // 取消的计时器留在堆中，到期时跳过；数量超过仍有效的计时器时整体清理一次。
+    class ScriptScheduler {
+    private:
+        struct Timer {
+            double deadline;
+            uint64_t ticket;
+            bool operator>(const Timer& other) const { return deadline > other.deadline; }
+        };
+
+        struct Waiter {
+            ScriptInterpreter* interpreter;
+            double deadline;  // 异步命令为负
+        };
+
+        std::vector<Timer> timers;  // 按到期时间的最小堆
+        size_t cancelledTimers;     // 堆中已取消的计时器数
+        std::unordered_map<uint64_t, Waiter> waiting;
+        std::shared_ptr<ScriptCompletionQueue> completions;
+        std::vector<uint64_t> draining;
+        double now;
+        uint64_t nextTicket;
+
+    public:
+        ScriptScheduler();
+
+        ScriptScheduler(const ScriptScheduler&) = delete;
+        ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+
+        // 等待 seconds 秒后恢复
+        uint64_t SleepFor(ScriptInterpreter& interpreter, double seconds);
+        // 等待 ScriptContinuation::Resume
+        uint64_t Suspend(ScriptInterpreter& interpreter);
+        ScriptContinuation MakeContinuation(uint64_t ticket) const;
+        // 取消等待，之后该事件发生时不再恢复
+        void Cancel(uint64_t ticket);
+        // 计时器距到期还剩的秒数；不是等待中的计时器时返回负数
+        double GetRemainingTime(uint64_t ticket) const;
+
+        // 推进时钟，恢复计时器到期和异步命令已完成的脚本
+        void Advance(double deltaTime);
+
+        double GetTime() const { return now; }
+        size_t GetWaitingCount() const { return waiting.size(); }
+        size_t GetTimerHeapSize() const { return timers.size(); }
+
+    private:
+        // 不在等待中（已取消或已恢复）时返回 false
+        bool Wake(uint64_t ticket);
+        void PurgeCancelledTimers();
+    };
+
+} // namespace VisualNovel
+
+#endif // SCRIPT_SCHEDULER_H
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef SCRIPT_STREAM_H
+#define SCRIPT_STREAM_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ScriptInterpreter.h"
+
+namespace VisualNovel {
+
+    // 边解析边执行的脚本
+    //
+    // 后台线程逐行读文件、解析，每 chunkLines 行发布一次：之前的命令和标签对执行线程可见。
+    // 命令按段存放，段一旦分配就不再移动，执行线程读已发布的命令不加锁；标签表加锁查找。
+    // 解析完后后台线程再把各段整理成一份连续的 ScriptImage，解释器在帧间整体换上，
+    // 此后与一次性载入的脚本完全相同。
+    // 除 Open 和析构外只在一个执行线程中调用
+    class ScriptStream {
+    private:
+        static constexpr size_t kSegmentBits = 10;
+        static constexpr size_t kSegmentSize = size_t(1) << kSegmentBits;
+        static constexpr size_t kMaxSegments = 4096;  // 最多约四百万条命令
+
+        std::string path;
+        std::ifstream file;
+        size_t chunkLines;
+
+        // 以下由解析线程写入；段在解析线程自己的分配区中，整理后的脚本另有分配区
+        std::unique_ptr<SceneArena> arena;
+        std::vector<ScriptCommandList*> segmentLists;
+        std::array<std::atomic<const ScriptCommand*>, kMaxSegments> segments;  // 各段的首元素，执行线程读取
+        std::atomic<size_t> readyCount;
+        std::atomic<bool> complete;
+        std::atomic<bool> cancelled;
+        ScriptImage image;  // complete 之后有效
+        std::vector<std::string> errors;
+
+        mutable std::mutex mutex;
+        std::condition_variable progress;
+        std::map<std::string, ScriptLabel> labels;  // 已发布的标签
+
+        std::thread parseThread;
+
+    public:
+        // 打开失败时返回 nullptr；成功后立即开始在后台解析
+        static std::unique_ptr<ScriptStream> Open(const std::string& path, size_t chunkLines = 256);
+
+        ScriptStream(const std::string& path, std::ifstream file, size_t chunkLines);
+        // 没有解析完时放弃剩余部分
+        ~ScriptStream();
+
+        ScriptStream(const ScriptStream&) = delete;
+        ScriptStream& operator=(const ScriptStream&) = delete;
+
+        // 已可以执行的命令数，只增不减
+        size_t GetReadyCount() const { return readyCount.load(std::memory_order_acquire); }
+        // index 必须小于 GetReadyCount()
+        const ScriptCommand& At(size_t index) const {
+            return segments[index >> kSegmentBits].load(std::memory_order_acquire)[index & (kSegmentSize - 1)];
+        }
+        bool IsComplete() const { return complete.load(std::memory_order_acquire); }
+
+        // 已发布的标签中查找，没有时返回 -1（可能还没解析到）
+        int FindLabel(const std::string& label) const;
+        // 阻塞到整份脚本解析完
+        void WaitUntilComplete();
+
+        // 解析完后取走整理好的连续脚本，只能调用一次
+        ScriptImage TakeImage();
+        // 解析完后有效
+        const std::vector<std::string>& GetErrors() const { return errors; }
+        const std::string& GetPath() const { return path; }
+
+    private:
+        void Run();
+        // 把暂存的新命令移入段中并发布，失败（命令过多）时返回 false
+        bool Publish(ScriptCommandList& staging);
+        void Finish();
+    };
+
+} // namespace VisualNovel
+
+#endif // SCRIPT_STREAM_H
@@ -0,0 +1,189 @@
+#pragma once
+#ifndef SESSION_HOST_H
+#define SESSION_HOST_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "AtomTable.h"
+#include "EngineEvents.h"
+#include "ScriptInterpreter.h"
+#include "ScriptScheduler.h"
+
+namespace VisualNovel {
+
+    // 所有会话共用的只读程序数据
+    //
+    // 脚本只载入、解析一次，会话通过 shared_ptr 引用，最后一个会话结束后释放。
+    // 有同一路径的预编译脚本且文件未被改动时直接使用预编译版本，它的常量表本就在程序映像中。
+    // 角色、表情、位置等名字在解析时驻留为 Atom（全局驻留表），会话中只保存 Atom
+    class SharedProgram {
+    private:
+        std::string path;
+        const CompiledScript* compiled;
+        std::shared_ptr<const ScriptImage> image;
+
+    public:
+        SharedProgram();
+
+        // 失败时返回 nullptr
+        static std::shared_ptr<const SharedProgram> Load(const std::string& path, bool useCompiled = true);
+        static std::shared_ptr<const SharedProgram> FromString(const std::string& content, const std::string& name);
+
+        // 让解释器执行这份程序，不复制命令和标签
+        void Attach(ScriptInterpreter& interpreter) const;
+
+        const std::string& GetPath() const { return path; }
+        bool IsCompiled() const { return compiled != nullptr; }
+    };
+
+    // 玩家的操作，由网络线程投递，在会话所在分片的下一次 Tick 中生效
+    enum class SessionInputType : uint8_t {
+        ADVANCE,    // 读完当前台词
+        CHOOSE      // 选择第 choice 个选项
+    };
+
+    struct SessionInput {
+        uint64_t session;
+        SessionInputType type;
+        uint32_t choice;
+    };
+
+    // 舞台上一个角色的状态，客户端据此绘制
+    struct SessionSprite {
+        Atom position;
+        Atom expression;
+    };
+
+    // 一名玩家的全部可变状态：解释器的位置、调用栈和变量，当前一批台词中读到的位置，舞台状态。
+    // 不持有渲染器、对话系统和音频，这些由客户端负责；只在所在分片的线程中访问
+    class PlayerSession {
+    private:
+        uint64_t id;
+        std::shared_ptr<const SharedProgram> program;
+        ScriptInterpreter interpreter;
+        EngineEventQueue events;
+
+        AtomMap<SessionSprite> sprites;
+        std::string_view background;  // 指向共用的脚本数据
+        std::string_view bgm;
+        size_t lineCursor;             // 当前批次中正在显示的台词
+        uint64_t revision;             // 每次状态变化加一，客户端据此判断是否需要同步
+        bool changed;
+
+    public:
+        PlayerSession(uint64_t id, std::shared_ptr<const SharedProgram> program, ScriptScheduler& scheduler,
+                      size_t arenaChunkBytes);
+
+        PlayerSession(const PlayerSession&) = delete;
+        PlayerSession& operator=(const PlayerSession&) = delete;
+
+        void Apply(const SessionInput& input);
+        // 执行到下一个等待玩家的位置；返回自上次 Update 以来状态是否变化
+        bool Update(float deltaTime);
+
+        uint64_t GetId() const { return id; }
+        uint64_t GetRevision() const { return revision; }
+        bool IsFinished() const { return !interpreter.IsRunning(); }
+        // 没有台词时返回 nullptr；在下一次 Update 前有效
+        const DialogueLine* GetCurrentLine() const;
+        const ChoiceOptionList& GetChoices() const { return interpreter.GetChoiceOptions(); }
+        const AtomMap<SessionSprite>& GetSprites() const { return sprites; }
+        std::string_view GetBackground() const { return background; }
+        std::string_view GetBgm() const { return bgm; }
+        // 最近一次 Update 产生的事件（含音效等一次性事件），在下一次 Update 前有效
+        const std::vector<EngineEvent>& GetEvents() const { return events.GetEvents(); }
+        ScriptInterpreter& GetInterpreter() { return interpreter; }
+
+    private:
+        void ApplyEvent(const EngineEvent& event);
+    };
+
+    struct SessionHostConfig {
+        size_t threadCount = 0;       // 0 表示按 CPU 核数；1 表示只在调用 Tick 的线程中执行
+        size_t shardCount = 0;        // 0 表示线程数的 4 倍，便于负载均衡
+        size_t arenaChunkBytes = 256; // 每个会话的解释器分配区首块大小
+    };
+
+    // 多会话宿主：一个进程中同时运行大量玩家的剧情
+    //
+    // 会话按编号分到若干分片，每个分片有自己的锁、调度器（@wait 计时器和异步命令）和输入队列。
+    // Tick 把分片分给线程池并行推进，返回时全部完成；同一分片中的会话总在同一时刻只被一个线程访问。
+    // CreateSession / DestroySession / Post 可以在任意线程调用，只锁目标分片。
+    class SessionHost {
+    private:
+        struct Shard {
+            std::mutex mutex;
+            ScriptScheduler scheduler;
+            std::vector<std::unique_ptr<PlayerSession>> sessions;
+            std::unordered_map<uint64_t, size_t> indices;
+            std::vector<SessionInput> inbox;
+            std::vector<SessionInput> applying;
+            std::vector<PlayerSession*> updated;   // 上一次 Tick 中有变化的会话
+        };
+
+        SessionHostConfig config;
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::atomic<uint64_t> nextId;
+        std::atomic<size_t> sessionCount;
+
+        // 线程池：每次 Tick 增加 generation 唤醒工作线程，各线程从 nextShard 领取分片
+        std::vector<std::thread> workers;
+        std::mutex poolMutex;
+        std::condition_variable poolWake;
+        std::condition_variable poolDone;
+        uint64_t generation;
+        float pendingDelta;
+        std::atomic<size_t> nextShard;
+        size_t finishedShards;
+        size_t busyWorkers;
+        bool stopping;
+
+    public:
+        explicit SessionHost(const SessionHostConfig& config = SessionHostConfig());
+        ~SessionHost();
+
+        SessionHost(const SessionHost&) = delete;
+        SessionHost& operator=(const SessionHost&) = delete;
+
+        // 返回会话编号，脚本在下一次 Tick 中开始执行
+        uint64_t CreateSession(std::shared_ptr<const SharedProgram> program);
+        void DestroySession(uint64_t id);
+        void Post(const SessionInput& input);
+
+        // 推进所有会话，只在一个线程中调用
+        void Tick(float deltaTime);
+
+        // 把上一次 Tick 中有变化的会话交给 handler（参数为 const PlayerSession&）；与 Tick 在同一线程调用
+        template <typename Handler>
+        void Drain(Handler&& handler) {
+            for (const std::unique_ptr<Shard>& shard : shards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                for (const PlayerSession* session : shard->updated) {
+                    handler(*session);
+                }
+                shard->updated.clear();
+            }
+        }
+
+        size_t GetSessionCount() const { return sessionCount.load(std::memory_order_relaxed); }
+        size_t GetShardCount() const { return shards.size(); }
+        size_t GetThreadCount() const { return workers.size() + 1; }
+
+    private:
+        Shard& ShardOf(uint64_t id) { return *shards[id % shards.size()]; }
+        void TickShard(Shard& shard, float deltaTime);
+        void RunShards(float deltaTime);
+        void RunWorker();
+    };
+
+} // namespace VisualNovel
+
+#endif // SESSION_HOST_H
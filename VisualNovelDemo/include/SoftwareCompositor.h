@@ -0,0 +1,119 @@
+#pragma once
+#ifndef SOFTWARE_COMPOSITOR_H
+#define SOFTWARE_COMPOSITOR_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "ImageCodec.h"
+
+namespace VisualNovel {
+
+    // 一个要绘制的精灵，数值与 CharacterSprite 的渲染数据一致
+    struct SceneSprite {
+        std::string texture;
+        float x = 0.5f;          // 精灵中心，归一化坐标 0-1
+        float y = 0.5f;
+        float depth = 0.0f;      // 小的先画
+        float scale = 1.0f;      // 相对参考分辨率的缩放
+        float u = 0.0f;          // 纹理中的区域，归一化坐标
+        float v = 0.0f;
+        float uw = 1.0f;
+        float vh = 1.0f;
+    };
+
+    // 某一时刻画面的完整描述，不引用引擎对象，可以交给其他线程
+    struct SceneSnapshot {
+        std::string background;  // 铺满画面；为空时为黑色
+        std::vector<SceneSprite> sprites;
+    };
+
+    // 从 CharacterRenderer::GetRenderList() 的结果生成快照（模板避免本头文件依赖 glm）
+    template <typename RenderList>
+    SceneSnapshot CaptureScene(const RenderList& renderList, const std::string& background) {
+        SceneSnapshot snapshot;
+        snapshot.background = background;
+        snapshot.sprites.reserve(renderList.size());
+        for (const auto* sprite : renderList) {
+            SceneSprite entry;
+            entry.texture = sprite->GetCurrentTexture();
+            auto position = sprite->GetRenderPosition();
+            auto uvOffset = sprite->GetUVOffset();
+            auto uvSize = sprite->GetUVSize();
+            entry.x = position.x;
+            entry.y = position.y;
+            entry.depth = sprite->GetRenderDepth();
+            entry.scale = sprite->GetRenderScale();
+            entry.u = uvOffset.x;
+            entry.v = uvOffset.y;
+            entry.uw = uvSize.x;
+            entry.vh = uvSize.y;
+            snapshot.sprites.push_back(std::move(entry));
+        }
+        return snapshot;
+    }
+
+    // 不依赖 GPU 的精灵合成器
+    //
+    // 把背景和精灵按深度合成到 RGBA8 图像，用于存档缩略图和无 GPU 环境下的基准图像比对。
+    // 纹理读入后转为预乘 alpha 并生成 mip 链，缩小时先选最接近的 mip 层再双线性采样；
+    // 采样和混合全部是整数定点运算，SSE2 路径与标量路径逐字节一致，结果不随机器变化。
+    // 纹理缓存不加锁，一个合成器只在一个线程中使用。
+    class SoftwareCompositor {
+    public:
+        using TextureLoader = std::function<bool(const std::string& name, SoftwareImage& image)>;
+
+    private:
+        struct Texture {
+            std::vector<SoftwareImage> levels;  // 第0层为原图，之后每层宽高减半
+        };
+
+        // 一列（或一行）目标像素对应的两个源像素和第二个的权重（0-255）
+        struct Sample {
+            int32_t first;
+            int32_t second;
+            int32_t weight;
+        };
+
+        int referenceWidth;
+        std::string assetRoot;
+        TextureLoader loader;
+        bool useSimd;
+        std::map<std::string, std::unique_ptr<Texture>> cache;
+        size_t cachedBytes;  // cache 中各层像素的字节数，计入 assets.cached_bytes
+        std::set<std::string> missingTextures;
+        std::vector<Sample> columns;
+        std::vector<const SceneSprite*> drawOrder;
+
+    public:
+        // 精灵的 scale 以宽 referenceWidth 的画面为准，输出宽度不同时等比缩放（缩略图）
+        explicit SoftwareCompositor(int referenceWidth = 1280);
+        ~SoftwareCompositor();
+
+        // 纹理名相对 assetRoot；没有扩展名时依次尝试 .png 和 .pam
+        void SetAssetRoot(const std::string& root) { assetRoot = root; }
+        // 替换默认的文件读取（测试、内存中的资源包）
+        void SetTextureLoader(TextureLoader textureLoader) { loader = std::move(textureLoader); }
+        // 关闭后使用标量路径，用于核对两条路径一致
+        void SetUseSimd(bool enabled) { useSimd = enabled; }
+        bool IsSimdAvailable() const;
+
+        // 按 target 的尺寸绘制；找不到的纹理跳过并记入 GetMissingTextures
+        void Render(const SceneSnapshot& scene, SoftwareImage& target);
+
+        const std::set<std::string>& GetMissingTextures() const { return missingTextures; }
+        void ClearCache();
+
+    private:
+        const Texture* GetTexture(const std::string& name);
+        bool LoadTexture(const std::string& name, SoftwareImage& image) const;
+        void DrawSprite(const Texture& texture, const SceneSprite& sprite, SoftwareImage& target,
+                        double left, double top, double width, double height);
+    };
+
+} // namespace VisualNovel
+
+#endif // SOFTWARE_COMPOSITOR_H
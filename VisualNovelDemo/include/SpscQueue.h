@@ -0,0 +1,59 @@
+#pragma once
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace VisualNovel {
+
+    // 单生产者单消费者的无锁环形队列
+    //
+    // Push 只在一个线程中调用，Pop 只在另一个线程中调用；两边都不加锁、不分配，
+    // 可以在音频线程这类不能阻塞的线程中使用。满了 Push 返回 false，由调用方决定丢弃还是重试。
+    template <typename T, size_t Capacity>
+    class SpscQueue {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "容量必须是2的幂");
+
+    private:
+        std::array<T, Capacity> items;
+        // 读写位置分开在不同的缓存行，避免两个线程互相使对方的缓存失效
+        alignas(64) std::atomic<size_t> head;  // 消费者写
+        alignas(64) std::atomic<size_t> tail;  // 生产者写
+
+    public:
+        SpscQueue() : items(), head(0), tail(0) {}
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        bool Push(const T& item) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            if (position - head.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+            items[position & (Capacity - 1)] = item;
+            tail.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Pop(T& item) {
+            size_t position = head.load(std::memory_order_relaxed);
+            if (position == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = items[position & (Capacity - 1)];
+            head.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // 只是近似值，另一端可能同时在改
+        size_t GetSize() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+    };
+
+} // namespace VisualNovel
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef STORY_GRAPH_ANALYZER_H
+#define STORY_GRAPH_ANALYZER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include "ScriptInterpreter.h"
+
+namespace VisualNovel {
+
+    // 路线数量：十进制大整数（1e9 进制，低位在前），多结局剧本的路线数会远超64位
+    class PathCount {
+    private:
+        std::vector<uint32_t> limbs;
+
+    public:
+        PathCount(uint32_t value = 0);
+
+        void Add(const PathCount& other);
+        bool IsZero() const;
+        std::string ToString() const;
+    };
+
+    // 剧情控制流图，以基本块为节点，CSR 存储
+    struct StoryGraph {
+        std::vector<std::string> names;      // 标签名，或 "行 N"
+        std::vector<int> sourceLines;        // 块首命令的行号
+        std::vector<uint32_t> lineCounts;    // 块内对话行数
+        std::vector<uint8_t> isExit;         // @end、@return 或脚本结尾
+        std::vector<uint32_t> edgeOffsets;   // 流程边，大小为节点数+1
+        std::vector<uint32_t> edges;
+        std::vector<uint32_t> callOffsets;   // @call 边，只参与可达性
+        std::vector<uint32_t> calls;
+        std::vector<std::string> danglingLabels;
+        uint32_t entry = 0;
+
+        uint32_t NodeCount() const;
+
+        static StoryGraph FromCommands(const ScriptCommandList& commands,
+                                       const std::map<std::string, ScriptLabel>& labels);
+    };
+
+    // 分析结果
+    struct StoryGraphReport {
+        uint32_t reachableCount = 0;
+        std::vector<uint32_t> unreachable;
+        std::vector<std::vector<uint32_t>> loops;  // 含环的强连通分量
+        bool unboundedPaths = false;               // 通往结局的路上有环
+        PathCount pathCount;                       // 从入口到结局的不同路线数
+        bool hasRoute = false;
+        uint64_t shortestRoute = 0;                // 以对话行数计
+        uint64_t longestRoute = 0;                 // unboundedPaths 时无意义
+    };
+
+    // 剧情图分析器：各项分析都是线性时间的图遍历，互不依赖的部分并行执行
+    class StoryGraphAnalyzer {
+    public:
+        static StoryGraphReport Analyze(const StoryGraph& graph);
+        static std::string FormatReport(const StoryGraph& graph, const StoryGraphReport& report);
+
+    private:
+        static std::vector<uint8_t> ComputeReachable(const StoryGraph& graph);
+        static std::vector<std::vector<uint32_t>> ComputeComponents(const StoryGraph& graph);
+        static bool ComputeShortestRoute(const StoryGraph& graph, uint64_t& length);
+        static bool CountPaths(const StoryGraph& graph,
+                               const std::vector<std::vector<uint32_t>>& components,
+                               const std::vector<uint32_t>& componentOf,
+                               PathCount& count);
+        static bool ComputeLongestRoute(const StoryGraph& graph,
+                                        const std::vector<std::vector<uint32_t>>& components,
+                                        const std::vector<uint32_t>& componentOf,
+                                        uint64_t& length);
+    };
+
+} // namespace VisualNovel
+
+#endif // STORY_GRAPH_ANALYZER_H
@@ -0,0 +1,92 @@
+#pragma once
+#ifndef TEXT_SEARCH_INDEX_H
+#define TEXT_SEARCH_INDEX_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "SceneArena.h"
+
+namespace VisualNovel {
+
+    struct ScriptCommand;
+    class ScriptProject;
+
+    // 被索引的一行文本
+    struct SearchDocument {
+        std::string text;
+        std::string speaker;        // 角色 ID，选择支为 "@choice"
+        std::string speakerName;    // 显示名，为空时与 speaker 相同
+        std::string label;          // 所在标签
+        std::string source;         // 来源文件
+        int line = 0;               // 来源文件中的行号
+    };
+
+    // 查询条件，空字段不参与过滤；三者至少给出一个
+    struct SearchQuery {
+        std::string text;       // 关键词，不区分 ASCII 大小写
+        std::string speaker;    // 角色 ID 或显示名
+        std::string label;
+        size_t limit = 50;
+    };
+
+    struct SearchHit {
+        uint32_t document;              // 文档编号，按加入顺序递增
+        const SearchDocument* entry;    // 在下一次修改索引之前有效
+        size_t offset;                  // 关键词在 text 中的字节偏移
+    };
+
+    // 倒排索引
+    //
+    // 按 UTF-8 码点切分，每个码点和每对相邻码点各是一个词元，中文等不分词的文本也能检索。
+    // 查询时取关键词全部词元的倒排表求交集，再对候选行做一次子串比较排除误命中。
+    // 文档只能在末尾追加、从开头移除，倒排表天然有序，增量加入不需要重排。
+    class TextSearchIndex {
+    private:
+        std::deque<SearchDocument> documents;
+        uint32_t firstDocument;     // documents.front() 的编号
+        uint32_t compactedBefore;   // 倒排表中小于此编号的条目已清理
+        std::unordered_map<uint64_t, std::vector<uint32_t>> grams;
+        std::unordered_map<std::string, std::vector<uint32_t>> speakers;
+        std::unordered_map<std::string, std::vector<uint32_t>> labels;
+
+        const std::vector<uint32_t>* FindPostings(uint64_t gram) const;
+        void Compact();
+        static void IndexCommands(TextSearchIndex& index, const ScriptCommand* first, const ScriptCommand* last,
+                                  const std::string& source);
+
+    public:
+        TextSearchIndex();
+
+        uint32_t Add(SearchDocument document);
+        // 移除编号小于 document 的全部文档（如被挤出历史记录的行）；索引为空时之后的文档从 document 开始编号
+        void RemoveBefore(uint32_t document);
+        void Clear();
+
+        // 按编号升序返回，最多 query.limit 条
+        std::vector<SearchHit> Search(const SearchQuery& query) const;
+
+        size_t GetDocumentCount() const { return documents.size(); }
+        uint32_t GetEndDocument() const { return firstDocument + static_cast<uint32_t>(documents.size()); }
+        const SearchDocument* GetDocument(uint32_t document) const;
+
+        // 脚本的离线索引：对每条对话和选项建立文档，记录所在标签和行号
+        static void IndexScript(TextSearchIndex& index, const ArenaVector<ScriptCommand>& commands,
+                                const std::string& source);
+        static void IndexProject(TextSearchIndex& index, const ScriptProject& project);
+
+        // 保存为二进制文件，载入时直接恢复倒排表而不重新切分文本
+        bool Save(const std::string& path) const;
+        bool Load(const std::string& path);
+
+        // 切分文本得到词元：每个码点一个，每对相邻码点一个（ASCII 转为小写）
+        static void Tokenize(std::string_view text, std::vector<uint64_t>& out);
+    };
+
+} // namespace VisualNovel
+
+#endif // TEXT_SEARCH_INDEX_H
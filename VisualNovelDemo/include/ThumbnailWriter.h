@@ -0,0 +1,66 @@
+#pragma once
+#ifndef THUMBNAIL_WRITER_H
+#define THUMBNAIL_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include "SoftwareCompositor.h"
+
+namespace VisualNovel {
+
+    // 存档缩略图写入器
+    //
+    // 存档时只把画面快照交给后台线程，合成和写文件都不占用存档本身的时间。
+    // 同一文件还没写出又提交了新快照时只写最新的（快速连续存同一个栏位）。
+    // 后台线程独占一个 SoftwareCompositor，纹理缓存在多次存档之间复用。
+    class ThumbnailWriter {
+    private:
+        struct Job {
+            SceneSnapshot scene;
+            std::string path;
+            int width;
+            int height;
+        };
+
+        SoftwareCompositor compositor;
+        std::set<std::string> reportedMissing;  // 每个缺失的纹理只报告一次
+        std::deque<Job> pending;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        bool busy;
+        bool stopping;
+        uint64_t writtenCount;
+        uint64_t failedCount;
+        std::thread worker;
+
+    public:
+        explicit ThumbnailWriter(const std::string& assetRoot = std::string(), int referenceWidth = 1280);
+        // 纹理由 loader 提供（在后台线程中调用）
+        explicit ThumbnailWriter(SoftwareCompositor::TextureLoader loader, int referenceWidth = 1280);
+        // 写完所有已提交的缩略图后退出
+        ~ThumbnailWriter();
+
+        ThumbnailWriter(const ThumbnailWriter&) = delete;
+        ThumbnailWriter& operator=(const ThumbnailWriter&) = delete;
+
+        // 立即返回；按扩展名写出 .png 或 .pam
+        void Submit(SceneSnapshot scene, const std::string& path, int width = 320, int height = 180);
+        // 等待已提交的缩略图全部写出
+        void Flush();
+
+        uint64_t GetWrittenCount();
+        uint64_t GetFailedCount();
+
+    private:
+        void Run();
+    };
+
+} // namespace VisualNovel
+
+#endif // THUMBNAIL_WRITER_H
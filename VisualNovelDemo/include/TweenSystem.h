@@ -0,0 +1,109 @@
+#pragma once
+#ifndef TWEEN_SYSTEM_H
+#define TWEEN_SYSTEM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VisualNovel {
+
+    // 缓动曲线，编译期烘焙成查找表
+    enum class Easing : uint8_t {
+        LINEAR,
+        EASE_IN_QUAD,
+        EASE_OUT_QUAD,
+        EASE_IN_OUT_QUAD,
+        EASE_IN_CUBIC,
+        EASE_OUT_CUBIC,
+        EASE_IN_OUT_CUBIC,
+        EASE_OUT_BACK,      // 略微越过终点再回来，适合角色登场
+        SMOOTHSTEP,
+        Count
+    };
+
+    // 按查找表求缓动值，t 在 [0, 1]
+    float EvaluateEasing(Easing easing, float t);
+
+    // 补间结束时产生的事件；userData 由调用方在 Add 时给出（如精灵指针、命令编号）
+    struct TweenEvent {
+        uint32_t id;
+        uint32_t tag;
+        uint64_t userData;
+        bool cancelled;
+    };
+
+    struct TweenDesc {
+        float* target = nullptr;     // 每帧写入的值
+        float* mirror = nullptr;     // 可选，同时写入（如 targetPosition，避免逐帧移动与补间争夺）
+        const void* owner = nullptr; // 对象销毁前用 CancelOwner 取消其全部补间
+        float from = 0.0f;
+        float to = 0.0f;
+        float duration = 0.0f;       // 秒；0 表示下一次 Update 直接到终点
+        float delay = 0.0f;          // 秒，依次淡入一排角色时错开
+        Easing easing = Easing::LINEAR;
+        uint32_t tag = 0;
+        uint64_t userData = 0;
+    };
+
+    // 补间系统
+    //
+    // 所有进行中的补间按列存放在连续数组中，每帧 Update 一次遍历求值并写回目标；
+    // 缓动曲线查表插值，不调用 pow/sin。结束的补间写入事件缓冲，宿主用 Drain 取出，
+    // 不为每个补间保存 std::function。预留容量后稳态下 Add/Update 不分配。
+    // 同一个 target 上同时只有一个补间，新的替换旧的（旧的产生 cancelled 事件）。
+    class TweenSystem {
+    private:
+        // 按列存放，Update 只读写需要的列
+        std::vector<float*> targets;
+        std::vector<float*> mirrors;
+        std::vector<const void*> owners;
+        std::vector<float> from;
+        std::vector<float> delta;        // to - from
+        std::vector<float> elapsed;      // 负值表示还在延迟中
+        std::vector<float> inverseDuration;
+        std::vector<Easing> easings;
+        std::vector<uint32_t> ids;
+        std::vector<uint32_t> tags;
+        std::vector<uint64_t> userData;
+
+        std::vector<TweenEvent> events;
+        uint32_t nextId;
+
+    public:
+        explicit TweenSystem(size_t capacity = 256);
+
+        // 返回补间编号，从 1 开始
+        uint32_t Add(const TweenDesc& desc);
+        // 从目标当前值补间到 to
+        uint32_t To(float* target, float to, float duration, Easing easing = Easing::EASE_IN_OUT_QUAD);
+
+        bool Cancel(uint32_t id);
+        size_t CancelTarget(const float* target);
+        size_t CancelOwner(const void* owner);
+        // 立即跳到终点，产生正常的完成事件（跳过演出时使用）
+        void FinishAll();
+        void Clear();
+
+        void Update(float deltaTime);
+
+        // 按结束顺序交给 handler 后清空；handler 以 const TweenEvent& 为参数
+        template <typename Handler>
+        void Drain(Handler&& handler) {
+            for (const TweenEvent& event : events) {
+                handler(event);
+            }
+            events.clear();
+        }
+
+        bool IsActive(uint32_t id) const;
+        size_t GetActiveCount() const { return ids.size(); }
+        const std::vector<TweenEvent>& GetEvents() const { return events; }
+
+    private:
+        void Remove(size_t index, bool cancelled);
+    };
+
+} // namespace VisualNovel
+
+#endif // TWEEN_SYSTEM_H
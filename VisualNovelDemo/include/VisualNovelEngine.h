@@ -10,6 +10,7 @@
 #include "DialogueSystem.h"
 #include "CharacterRenderer.h"
 #include "ScriptInterpreter.h"
+#include "EngineEvents.h"
 
 namespace VisualNovel {
     
@@ -65,6 +66,9 @@ namespace VisualNovel {
         std::function<void(const std::string&)> onBackgroundChange;
         std::function<void(const std::string&)> onBgmPlay;
         std::function<void()> onChoicePresent;
+
+        // 每帧的事件缓冲，EnableEventStream 后由脚本和对话系统写入
+        EngineEventQueue events;
         
     public:
         VisualNovelEngine();
@@ -97,12 +101,26 @@ namespace VisualNovel {
         void SetBackgroundCallback(std::function<void(const std::string&)> callback);
         void SetBgmCallback(std::function<void(const std::string&)> callback);
         void SetChoiceCallback(std::function<void()> callback);
+
+        // 事件流：背景、BGM、音效、台词和选择支写入每帧的事件缓冲，宿主每帧在 Update 之后
+        // DrainEvents 一次，代替上面逐个事件的回调。同一帧内被覆盖的事件只交出最后一个
+        void EnableEventStream() {
+            scriptInterpreter->SetEventQueue(&events);
+            dialogueSystem->SetEventQueue(&events);
+        }
+        template <typename Handler>
+        void DrainEvents(Handler&& handler) { events.Drain(std::forward<Handler>(handler)); }
         
         // 状态获取
         GameState GetCurrentState() const;
         const GameSettings& GetSettings() const;
         void UpdateSettings(const GameSettings& newSettings);
         
+        // 子系统访问（热重载等工具在更新线程中使用）
+        ScriptInterpreter& GetScriptInterpreter() { return *scriptInterpreter; }
+        CharacterRenderer& GetCharacterRenderer() { return *characterRenderer; }
+        DialogueSystem& GetDialogueSystem() { return *dialogueSystem; }
+        
         // 变量操作
         void SetVariable(const std::string& name, const std::string& value);
         std::string GetVariable(const std::string& name) const;
@@ -0,0 +1,120 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace VisualNovel {
+
+    namespace {
+        // 平凡类型的 thread_local 不需要构造和析构，可以在 operator new 里安全使用
+        thread_local uint64_t threadAllocations = 0;
+        thread_local uint64_t threadBytes = 0;
+    }
+
+    namespace AllocationCounter {
+
+        bool IsInstalled() {
+#ifdef VN_COUNT_ALLOCATIONS
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        Snapshot GetThreadSnapshot() {
+            return {threadAllocations, threadBytes};
+        }
+
+    } // namespace AllocationCounter
+
+#ifdef VN_COUNT_ALLOCATIONS
+    namespace {
+        void* CountedAllocate(std::size_t size) {
+            ++threadAllocations;
+            threadBytes += size;
+            return std::malloc(size ? size : 1);
+        }
+
+        // SpscQueue 等 alignas 超过默认对齐的类型，以及 std::pmr::new_delete_resource
+        // （SceneArena 的每个块都经由它向上游申请）走这一组；不替换的话这些分配不计数，
+        // 会话内存预算和稳态检查都会漏掉分配区
+        void* CountedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+            std::size_t align = static_cast<std::size_t>(alignment);
+            ++threadAllocations;
+            threadBytes += size;
+#ifdef _WIN32
+            return _aligned_malloc(size ? size : 1, align);
+#else
+            // aligned_alloc 要求大小是对齐的整数倍
+            std::size_t rounded = (size + align - 1) / align * align;
+            return std::aligned_alloc(align, rounded ? rounded : align);
+#endif
+        }
+
+        void FreeAligned(void* p) {
+#ifdef _WIN32
+            _aligned_free(p);
+#else
+            std::free(p);
+#endif
+        }
+    }
+#endif
+
+} // namespace VisualNovel
+
+#ifdef VN_COUNT_ALLOCATIONS
+
+void* operator new(std::size_t size) {
+    if (void* p = VisualNovel::CountedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = VisualNovel::CountedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return VisualNovel::CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return VisualNovel::CountedAllocate(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = VisualNovel::CountedAllocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* p = VisualNovel::CountedAllocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return VisualNovel::CountedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return VisualNovel::CountedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { VisualNovel::FreeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { VisualNovel::FreeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { VisualNovel::FreeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { VisualNovel::FreeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { VisualNovel::FreeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { VisualNovel::FreeAligned(p); }
+
+#endif // VN_COUNT_ALLOCATIONS
@@ -0,0 +1,109 @@
+#include "AtomTable.h"
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace VisualNovel {
+
+    namespace {
+        // 名字按块存放，块一旦分配就不再移动，GetName 可以不加锁直接按下标读取
+        constexpr uint32_t kChunkBits = 10;
+        constexpr uint32_t kChunkSize = 1u << kChunkBits;
+        constexpr uint32_t kMaxChunks = 4096;  // 最多约四百万个名字
+
+        struct AtomTableState {
+            std::shared_mutex mutex;
+            std::unordered_map<std::string_view, Atom> lookup;  // 键指向块中的字符串
+            std::array<std::atomic<std::string*>, kMaxChunks> chunks;
+            std::atomic<uint32_t> count;
+
+            AtomTableState() : count(1) {
+                for (std::atomic<std::string*>& chunk : chunks) {
+                    chunk.store(nullptr, std::memory_order_relaxed);
+                }
+                // 0 号是 NONE，对应空字符串
+                chunks[0].store(new std::string[kChunkSize], std::memory_order_release);
+            }
+            // 块不释放：静态析构阶段仍可能有对象按 Atom 取名字
+        };
+
+        // 首次使用时构造，预编译脚本在静态初始化中驻留名字也是安全的
+        AtomTableState& State() {
+            static AtomTableState state;
+            return state;
+        }
+
+        const std::string& EmptyName() {
+            static const std::string empty;
+            return empty;
+        }
+    }
+
+    namespace Atoms {
+
+        Atom Intern(std::string_view name) {
+            if (name.empty()) {
+                return Atom::NONE;
+            }
+            AtomTableState& state = State();
+            {
+                std::shared_lock<std::shared_mutex> lock(state.mutex);
+                auto it = state.lookup.find(name);
+                if (it != state.lookup.end()) {
+                    return it->second;
+                }
+            }
+
+            std::unique_lock<std::shared_mutex> lock(state.mutex);
+            auto it = state.lookup.find(name);
+            if (it != state.lookup.end()) {
+                return it->second;  // 另一个线程刚刚驻留
+            }
+            uint32_t index = state.count.load(std::memory_order_relaxed);
+            uint32_t chunkIndex = index >> kChunkBits;
+            if (chunkIndex >= kMaxChunks) {
+                std::cerr << "[驻留表] 名字过多，无法驻留: " << name << std::endl;
+                return Atom::NONE;
+            }
+            std::string* chunk = state.chunks[chunkIndex].load(std::memory_order_relaxed);
+            if (!chunk) {
+                chunk = new std::string[kChunkSize];
+                state.chunks[chunkIndex].store(chunk, std::memory_order_release);
+            }
+            std::string& entry = chunk[index & (kChunkSize - 1)];
+            entry.assign(name);
+            Atom atom = static_cast<Atom>(index);
+            state.lookup.emplace(std::string_view(entry), atom);
+            state.count.store(index + 1, std::memory_order_release);
+            return atom;
+        }
+
+        Atom Find(std::string_view name) {
+            if (name.empty()) {
+                return Atom::NONE;
+            }
+            AtomTableState& state = State();
+            std::shared_lock<std::shared_mutex> lock(state.mutex);
+            auto it = state.lookup.find(name);
+            return it == state.lookup.end() ? Atom::NONE : it->second;
+        }
+
+        const std::string& GetName(Atom atom) {
+            AtomTableState& state = State();
+            uint32_t index = static_cast<uint32_t>(atom);
+            if (index >= state.count.load(std::memory_order_acquire)) {
+                return EmptyName();
+            }
+            return state.chunks[index >> kChunkBits].load(std::memory_order_acquire)[index & (kChunkSize - 1)];
+        }
+
+        size_t GetCount() {
+            return State().count.load(std::memory_order_acquire);
+        }
+
+    } // namespace Atoms
+
+} // namespace VisualNovel
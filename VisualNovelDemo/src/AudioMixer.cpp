@@ -0,0 +1,601 @@
+#include "AudioMixer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace VisualNovel {
+
+    namespace {
+        uint32_t ReadLittleEndian32(const uint8_t* p) {
+            return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+        }
+
+        uint16_t ReadLittleEndian16(const uint8_t* p) {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+
+        void WriteLittleEndian(std::ofstream& file, uint32_t value, int bytes) {
+            for (int i = 0; i < bytes; ++i) {
+                file.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+            }
+        }
+
+        void WriteWavHeader(std::ofstream& file, int sampleRate, int channels, uint64_t frames) {
+            uint32_t dataBytes = static_cast<uint32_t>(std::min<uint64_t>(frames * channels * 2, 0xFFFFFFDBu));
+            file.write("RIFF", 4);
+            WriteLittleEndian(file, 36 + dataBytes, 4);
+            file.write("WAVEfmt ", 8);
+            WriteLittleEndian(file, 16, 4);
+            WriteLittleEndian(file, 1, 2);                          // PCM
+            WriteLittleEndian(file, static_cast<uint32_t>(channels), 2);
+            WriteLittleEndian(file, static_cast<uint32_t>(sampleRate), 4);
+            WriteLittleEndian(file, static_cast<uint32_t>(sampleRate * channels * 2), 4);
+            WriteLittleEndian(file, static_cast<uint32_t>(channels * 2), 2);
+            WriteLittleEndian(file, 16, 2);
+            file.write("data", 4);
+            WriteLittleEndian(file, dataBytes, 4);
+        }
+
+        // dst[f] += src[f] * (gain + step * (firstFrame + f))，立体声交错，每帧两个采样
+        void MixRamp(float* dst, const float* src, size_t frames, float gain, float step, size_t firstFrame,
+                     bool useSimd) {
+            size_t f = 0;
+#if defined(__SSE2__)
+            if (useSimd) {
+                // 一次两帧：增益按帧计算，与标量路径的运算顺序相同
+                __m128i base = _mm_set_epi32(1, 1, 0, 0);
+                __m128 index = _mm_add_ps(_mm_cvtepi32_ps(base), _mm_set1_ps(static_cast<float>(firstFrame)));
+                const __m128 two = _mm_set1_ps(2.0f);
+                const __m128 gainStart = _mm_set1_ps(gain);
+                const __m128 gainStep = _mm_set1_ps(step);
+                for (; f + 2 <= frames; f += 2) {
+                    __m128 g = _mm_add_ps(gainStart, _mm_mul_ps(gainStep, index));
+                    __m128 mixed = _mm_add_ps(_mm_loadu_ps(dst + f * 2), _mm_mul_ps(_mm_loadu_ps(src + f * 2), g));
+                    _mm_storeu_ps(dst + f * 2, mixed);
+                    index = _mm_add_ps(index, two);
+                }
+            }
+#else
+            (void)useSimd;
+#endif
+            for (; f < frames; ++f) {
+                float g = gain + step * static_cast<float>(firstFrame + f);
+                dst[f * 2] += src[f * 2] * g;
+                dst[f * 2 + 1] += src[f * 2 + 1] * g;
+            }
+        }
+
+        // 限制到 [-1, 1] 后转为 16 位，四舍五入到最近的偶数
+        void ToPcm16(const float* in, int16_t* out, size_t samples, bool useSimd) {
+            size_t i = 0;
+#if defined(__SSE2__)
+            if (useSimd) {
+                const __m128 low = _mm_set1_ps(-1.0f);
+                const __m128 high = _mm_set1_ps(1.0f);
+                const __m128 scale = _mm_set1_ps(32767.0f);
+                for (; i + 8 <= samples; i += 8) {
+                    __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), low), high), scale);
+                    __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), low), high), scale);
+                    __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+                }
+            }
+#endif
+            for (; i < samples; ++i) {
+                float value = std::min(std::max(in[i], -1.0f), 1.0f) * 32767.0f;
+                out[i] = static_cast<int16_t>(std::lrint(value));
+            }
+        }
+    }
+
+    // ==================== AudioStream ====================
+
+    // 一个正在播放的音频文件
+    // 解码线程按块读入并转换为输出采样率的浮点立体声，写进环形缓冲；混音线程从中读取。
+    // 两端各自只写自己的位置，不需要加锁
+    class AudioStream {
+    public:
+        static const size_t kCapacityFrames = 1 << 14;
+        static const size_t kChunkFrames = 2048;
+
+        const AudioBus bus;
+        const bool loop;
+
+    private:
+        std::ifstream file;
+        int channels;
+        int bitsPerSample;
+        uint64_t dataStart;
+        uint64_t dataSize;
+        uint64_t dataRead;
+
+        // 重采样：pending 中是还没用完的源帧，position 为下一输出帧在其中的位置
+        double step;
+        double position;
+        std::vector<float> pending;
+        std::vector<uint8_t> raw;
+
+        std::vector<float> ring;
+        std::atomic<uint64_t> written;
+        std::atomic<uint64_t> consumed;
+        std::atomic<bool> ended;
+
+    public:
+        AudioStream(AudioBus bus, bool loop)
+            : bus(bus), loop(loop), channels(0), bitsPerSample(0), dataStart(0), dataSize(0), dataRead(0),
+              step(1.0), position(0.0), ring(kCapacityFrames * 2), written(0), consumed(0), ended(false) {}
+
+        bool Open(const std::string& path, int outputRate, std::string& error) {
+            file.open(path, std::ios::binary);
+            if (!file) {
+                error = "找不到音频文件: " + path;
+                return false;
+            }
+            uint8_t header[12];
+            if (!file.read(reinterpret_cast<char*>(header), 12) || std::memcmp(header, "RIFF", 4) != 0 ||
+                std::memcmp(header + 8, "WAVE", 4) != 0) {
+                error = "不支持的音频格式（只支持 WAV）: " + path;
+                return false;
+            }
+            int sourceRate = 0;
+            int format = 0;
+            for (;;) {
+                uint8_t chunk[8];
+                if (!file.read(reinterpret_cast<char*>(chunk), 8)) {
+                    error = "WAV 文件缺少数据块: " + path;
+                    return false;
+                }
+                uint32_t size = ReadLittleEndian32(chunk + 4);
+                if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+                    uint8_t fmt[16];
+                    file.read(reinterpret_cast<char*>(fmt), 16);
+                    format = ReadLittleEndian16(fmt);
+                    channels = ReadLittleEndian16(fmt + 2);
+                    sourceRate = static_cast<int>(ReadLittleEndian32(fmt + 4));
+                    bitsPerSample = ReadLittleEndian16(fmt + 14);
+                    file.seekg(size - 16 + (size & 1), std::ios::cur);
+                } else if (std::memcmp(chunk, "data", 4) == 0) {
+                    dataStart = static_cast<uint64_t>(file.tellg());
+                    dataSize = size;
+                    break;
+                } else {
+                    file.seekg(size + (size & 1), std::ios::cur);
+                }
+            }
+            // 0xFFFE 为 WAVE_FORMAT_EXTENSIBLE，这里只按位深处理为整数 PCM
+            if ((format != 1 && format != 0xFFFE) || (channels != 1 && channels != 2) ||
+                (bitsPerSample != 8 && bitsPerSample != 16) || sourceRate <= 0) {
+                error = "不支持的 WAV 格式（只支持 8/16 位 PCM 单声道或立体声）: " + path;
+                return false;
+            }
+            dataSize -= dataSize % static_cast<uint64_t>(channels * bitsPerSample / 8);
+            step = static_cast<double>(sourceRate) / outputRate;
+            return true;
+        }
+
+        // 解码线程：把环形缓冲的空位填满，或读到文件末尾
+        void Refill() {
+            while (!ended.load(std::memory_order_relaxed)) {
+                uint64_t end = written.load(std::memory_order_relaxed);
+                size_t space = kCapacityFrames - static_cast<size_t>(end - consumed.load(std::memory_order_acquire));
+                if (space < kChunkFrames) {
+                    return;
+                }
+                size_t produced = Produce(end, kChunkFrames);
+                written.store(end + produced, std::memory_order_release);
+                if (produced < kChunkFrames) {
+                    ended.store(true, std::memory_order_release);
+                }
+            }
+        }
+
+        // 混音线程：先看 IsEnded 再看 GetAvailable，结束标志之前写入的数据一定可见
+        bool IsEnded() const { return ended.load(std::memory_order_acquire); }
+        size_t GetAvailable() const {
+            return static_cast<size_t>(written.load(std::memory_order_acquire) - consumed.load(std::memory_order_relaxed));
+        }
+        uint64_t GetReadPosition() const { return consumed.load(std::memory_order_relaxed); }
+        const float* Frame(uint64_t index) const { return ring.data() + (index & (kCapacityFrames - 1)) * 2; }
+        void Consume(size_t frames) {
+            consumed.store(consumed.load(std::memory_order_relaxed) + frames, std::memory_order_release);
+        }
+
+    private:
+        // 读入最多 frames 个源帧追加到 pending，返回读到的帧数；循环播放时读完从头再读
+        size_t DecodeSource(size_t frames) {
+            size_t bytesPerFrame = static_cast<size_t>(channels * bitsPerSample / 8);
+            if (dataRead >= dataSize) {
+                if (!loop || dataSize == 0) {
+                    return 0;
+                }
+                file.clear();
+                file.seekg(static_cast<std::streamoff>(dataStart));
+                dataRead = 0;
+            }
+            size_t count = static_cast<size_t>(std::min<uint64_t>(frames, (dataSize - dataRead) / bytesPerFrame));
+            raw.resize(count * bytesPerFrame);
+            file.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+            count = static_cast<size_t>(file.gcount()) / bytesPerFrame;
+            if (count == 0) {
+                dataRead = dataSize;  // 文件比头中记录的短
+                return 0;
+            }
+            dataRead += count * bytesPerFrame;
+
+            size_t offset = pending.size();
+            pending.resize(offset + count * 2);
+            float* out = pending.data() + offset;
+            const uint8_t* in = raw.data();
+            for (size_t i = 0; i < count; ++i, out += 2) {
+                float left, right;
+                if (bitsPerSample == 16) {
+                    left = static_cast<int16_t>(ReadLittleEndian16(in)) * (1.0f / 32768.0f);
+                    right = channels == 2 ? static_cast<int16_t>(ReadLittleEndian16(in + 2)) * (1.0f / 32768.0f) : left;
+                } else {
+                    left = (in[0] - 128) * (1.0f / 128.0f);
+                    right = channels == 2 ? (in[1] - 128) * (1.0f / 128.0f) : left;
+                }
+                in += bytesPerFrame;
+                out[0] = left;
+                out[1] = right;
+            }
+            return count;
+        }
+
+        // 从 end 处开始写最多 frames 个输出帧，线性插值重采样；返回写入的帧数
+        size_t Produce(uint64_t end, size_t frames) {
+            size_t needed = static_cast<size_t>(position + frames * step) + 2;
+            while (pending.size() / 2 < needed) {
+                if (DecodeSource(std::max(needed - pending.size() / 2, kChunkFrames)) == 0) {
+                    break;
+                }
+            }
+
+            size_t available = pending.size() / 2;
+            size_t produced = 0;
+            for (; produced < frames; ++produced) {
+                size_t index = static_cast<size_t>(position);
+                float* out = ring.data() + ((end + produced) & (kCapacityFrames - 1)) * 2;
+                if (step == 1.0) {
+                    if (index >= available) break;
+                    out[0] = pending[index * 2];
+                    out[1] = pending[index * 2 + 1];
+                } else {
+                    if (index + 1 >= available) break;
+                    float t = static_cast<float>(position - index);
+                    out[0] = pending[index * 2] + (pending[index * 2 + 2] - pending[index * 2]) * t;
+                    out[1] = pending[index * 2 + 1] + (pending[index * 2 + 3] - pending[index * 2 + 1]) * t;
+                }
+                position += step;
+            }
+
+            size_t drop = std::min(static_cast<size_t>(position), available);
+            pending.erase(pending.begin(), pending.begin() + drop * 2);
+            position -= drop;
+            return produced;
+        }
+    };
+
+    // ==================== 输出后端 ====================
+
+    bool NullAudioOutput::Open(int rate, int) {
+        sampleRate = rate;
+        deadline = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void NullAudioOutput::Write(const int16_t*, size_t frames) {
+        deadline += std::chrono::microseconds(frames * 1000000 / sampleRate);
+        std::this_thread::sleep_until(deadline);
+    }
+
+    WavFileAudioOutput::WavFileAudioOutput(const std::string& path)
+        : path(path), sampleRate(0), channels(0), framesWritten(0) {}
+
+    WavFileAudioOutput::~WavFileAudioOutput() {
+        Close();
+    }
+
+    bool WavFileAudioOutput::Open(int rate, int channelCount) {
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "[音频] 无法写入 " << path << std::endl;
+            return false;
+        }
+        sampleRate = rate;
+        channels = channelCount;
+        framesWritten = 0;
+        WriteWavHeader(file, sampleRate, channels, 0);
+        deadline = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void WavFileAudioOutput::Write(const int16_t* samples, size_t frames) {
+        if (file.is_open()) {
+            // 按小端写出，与 WAV 的字节序一致
+            for (size_t i = 0; i < frames * channels; ++i) {
+                WriteLittleEndian(file, static_cast<uint16_t>(samples[i]), 2);
+            }
+            framesWritten += frames;
+        }
+        deadline += std::chrono::microseconds(frames * 1000000 / sampleRate);
+        std::this_thread::sleep_until(deadline);
+    }
+
+    void WavFileAudioOutput::Close() {
+        if (!file.is_open()) {
+            return;
+        }
+        file.seekp(0);
+        WriteWavHeader(file, sampleRate, channels, framesWritten);
+        file.close();
+    }
+
+    // ==================== AudioMixer ====================
+
+    AudioMixer::AudioMixer(const AudioConfig& config)
+        : config(config), duckGain(1.0f), mixBuffer(static_cast<size_t>(config.bufferFrames) * 2), useSimd(true),
+          mixedBlocks(0), underruns(0), activeVoices(0), running(false), decodeStopping(false) {
+        busVolumes.fill(1.0f);
+    }
+
+    AudioMixer::~AudioMixer() {
+        Stop();
+    }
+
+    bool AudioMixer::Start(std::unique_ptr<AudioOutput> audioOutput) {
+        if (running.load()) {
+            return true;
+        }
+        if (audioOutput && !audioOutput->Open(config.sampleRate, 2)) {
+            return false;
+        }
+        output = std::move(audioOutput);
+        running.store(true);
+        decodeStopping = false;
+        decodeThread = std::thread([this]() { RunDecoder(); });
+        if (output) {
+            mixThread = std::thread([this]() { RunMixer(); });
+        }
+        return true;
+    }
+
+    void AudioMixer::Stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        if (mixThread.joinable()) {
+            mixThread.join();
+        }
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            decodeStopping = true;
+        }
+        decodeWake.notify_one();
+        decodeThread.join();
+        if (output) {
+            output->Close();
+            output.reset();
+        }
+    }
+
+    bool AudioMixer::PlayBgm(const std::string& name, float fadeSeconds) {
+        return Play(AudioBus::BGM, name, true, fadeSeconds);
+    }
+
+    void AudioMixer::StopBgm(float fadeSeconds) {
+        SendCommand(Command{CommandType::STOP_BUS, AudioBus::BGM, nullptr, fadeSeconds});
+    }
+
+    bool AudioMixer::PlaySound(const std::string& name, bool loop) {
+        return Play(AudioBus::SE, name, loop, 0.0f);
+    }
+
+    bool AudioMixer::PlayVoice(const std::string& name) {
+        return Play(AudioBus::VOICE, name, false, 0.0f);
+    }
+
+    void AudioMixer::StopVoice() {
+        SendCommand(Command{CommandType::STOP_BUS, AudioBus::VOICE, nullptr, 0.0f});
+    }
+
+    void AudioMixer::StopSounds(float fadeSeconds) {
+        SendCommand(Command{CommandType::STOP_BUS, AudioBus::SE, nullptr, fadeSeconds});
+    }
+
+    void AudioMixer::SetBusVolume(AudioBus bus, float volume) {
+        SendCommand(Command{CommandType::SET_VOLUME, bus, nullptr, std::max(0.0f, volume)});
+    }
+
+    bool AudioMixer::Play(AudioBus bus, const std::string& name, bool loop, float fadeSeconds) {
+        std::filesystem::path path = config.assetRoot.empty() ? std::filesystem::path(name)
+                                                              : std::filesystem::path(config.assetRoot) / name;
+        if (path.extension() != ".wav" && !std::filesystem::exists(path)) {
+            path.replace_extension(".wav");
+        }
+
+        auto stream = std::make_unique<AudioStream>(bus, loop);
+        std::string error;
+        if (!stream->Open(path.string(), config.sampleRate, error)) {
+            std::cerr << "[音频] " << error << std::endl;
+            return false;
+        }
+        // 先解码第一段，混音线程拿到命令时已经有数据可播
+        stream->Refill();
+
+        AudioStream* playing = stream.get();
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            streams.push_back(std::move(stream));
+        }
+        if (!commands.Push(Command{CommandType::PLAY, bus, playing, fadeSeconds})) {
+            std::cerr << "[音频] 命令队列已满，丢弃 " << name << std::endl;
+            std::lock_guard<std::mutex> lock(streamMutex);
+            streams.pop_back();
+            return false;
+        }
+        return true;
+    }
+
+    void AudioMixer::SendCommand(const Command& command) {
+        if (!commands.Push(command)) {
+            std::cerr << "[音频] 命令队列已满" << std::endl;
+        }
+    }
+
+    void AudioMixer::CollectFinished() {
+        AudioStream* stream;
+        while (finished.Pop(stream)) {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            auto it = std::find_if(streams.begin(), streams.end(),
+                                   [stream](const std::unique_ptr<AudioStream>& s) { return s.get() == stream; });
+            if (it != streams.end()) {
+                streams.erase(it);
+            }
+        }
+    }
+
+    void AudioMixer::StopVoices(AudioBus bus, float fadeSeconds) {
+        // 至少用一块淡出，避免爆音
+        float blocks = std::max(1.0f, fadeSeconds * config.sampleRate / config.bufferFrames);
+        for (Voice& voice : voices) {
+            if (voice.stream && voice.stream->bus == bus && voice.fadeStep == 0.0f) {
+                voice.fadeStep = 1.0f / blocks;
+            }
+        }
+    }
+
+    void AudioMixer::Retire(Voice& voice) {
+        // 回收队列满时保留到下一块再试
+        if (finished.Push(voice.stream)) {
+            voice.stream = nullptr;
+        } else {
+            voice.fade = 0.0f;
+            voice.fadeStep = 1.0f;
+        }
+    }
+
+    void AudioMixer::ApplyCommand(const Command& command) {
+        switch (command.type) {
+            case CommandType::PLAY: {
+                // BGM 和语音同时只有一个：新的开始时旧的淡出
+                if (command.bus == AudioBus::BGM || command.bus == AudioBus::VOICE) {
+                    StopVoices(command.bus, command.value);
+                }
+                auto slot = std::find_if(voices.begin(), voices.end(), [](const Voice& v) { return !v.stream; });
+                if (slot == voices.end()) {
+                    Voice rejected;
+                    rejected.stream = command.stream;
+                    Retire(rejected);
+                    break;
+                }
+                *slot = Voice();
+                slot->stream = command.stream;
+                break;
+            }
+            case CommandType::STOP_BUS:
+                StopVoices(command.bus, command.value);
+                break;
+            case CommandType::SET_VOLUME:
+                busVolumes[static_cast<size_t>(command.bus)] = command.value;
+                break;
+        }
+    }
+
+    void AudioMixer::MixBlock(int16_t* out) {
+        Command command;
+        while (commands.Pop(command)) {
+            ApplyCommand(command);
+        }
+
+        const size_t frames = static_cast<size_t>(config.bufferFrames);
+        const float blockSeconds = static_cast<float>(frames) / config.sampleRate;
+
+        // 有语音在播时 BGM 向 duckLevel 渐变，语音结束后恢复
+        bool speaking = std::any_of(voices.begin(), voices.end(), [](const Voice& v) {
+            return v.stream && v.stream->bus == AudioBus::VOICE && v.fadeStep == 0.0f;
+        });
+        float range = 1.0f - config.duckLevel;
+        if (speaking) {
+            duckGain = std::max(config.duckLevel, duckGain - range * blockSeconds / std::max(config.duckAttack, blockSeconds));
+        } else {
+            duckGain = std::min(1.0f, duckGain + range * blockSeconds / std::max(config.duckRelease, blockSeconds));
+        }
+
+        std::fill(mixBuffer.begin(), mixBuffer.end(), 0.0f);
+        uint32_t active = 0;
+        for (Voice& voice : voices) {
+            if (!voice.stream) {
+                continue;
+            }
+            if (voice.fadeStep > 0.0f && voice.fade <= 0.0f) {
+                Retire(voice);
+                continue;
+            }
+            AudioStream& stream = *voice.stream;
+            float fadeEnd = std::max(0.0f, voice.fade - voice.fadeStep);
+            float target = busVolumes[static_cast<size_t>(stream.bus)] * fadeEnd;
+            if (stream.bus == AudioBus::BGM) {
+                target *= duckGain;
+            }
+            float step = (target - voice.gain) / static_cast<float>(frames);
+
+            bool ended = stream.IsEnded();
+            size_t count = std::min(stream.GetAvailable(), frames);
+            if (count < frames && !ended) {
+                underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+            uint64_t position = stream.GetReadPosition();
+            size_t first = std::min(count, AudioStream::kCapacityFrames -
+                                           static_cast<size_t>(position & (AudioStream::kCapacityFrames - 1)));
+            MixRamp(mixBuffer.data(), stream.Frame(position), first, voice.gain, step, 0, useSimd);
+            MixRamp(mixBuffer.data() + first * 2, stream.Frame(position + first), count - first, voice.gain, step,
+                    first, useSimd);
+            stream.Consume(count);
+
+            voice.gain = target;
+            voice.fade = fadeEnd;
+            if ((ended && stream.GetAvailable() == 0) || (voice.fadeStep > 0.0f && fadeEnd <= 0.0f)) {
+                Retire(voice);
+            } else {
+                ++active;
+            }
+        }
+
+        ToPcm16(mixBuffer.data(), out, mixBuffer.size(), useSimd);
+        activeVoices.store(active, std::memory_order_relaxed);
+        mixedBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AudioMixer::Decode() {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        for (const std::unique_ptr<AudioStream>& stream : streams) {
+            stream->Refill();
+        }
+    }
+
+    void AudioMixer::RunMixer() {
+        std::vector<int16_t> block(static_cast<size_t>(config.bufferFrames) * 2);
+        while (running.load(std::memory_order_relaxed)) {
+            MixBlock(block.data());
+            output->Write(block.data(), static_cast<size_t>(config.bufferFrames));
+        }
+    }
+
+    void AudioMixer::RunDecoder() {
+        // 缓冲约 0.3 秒，每 5 毫秒补一次足够跟上
+        std::unique_lock<std::mutex> lock(streamMutex);
+        while (!decodeStopping) {
+            for (const std::unique_ptr<AudioStream>& stream : streams) {
+                stream->Refill();
+            }
+            decodeWake.wait_for(lock, std::chrono::milliseconds(5));
+        }
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,116 @@
+#include "CharacterRenderer.h"
+#include <algorithm>
+
+namespace VisualNovel {
+
+    // CharacterSprite / CharacterRenderer 中按 Atom 查找的部分，字符串版本在头文件中驻留后转调
+
+    void CharacterSprite::AddExpression(Atom name, const CharacterExpression& expr) {
+        if (name == Atom::NONE) {
+            return;
+        }
+        expressions.Insert(name, expr);
+    }
+
+    void CharacterSprite::SetExpression(Atom exprName) {
+        if (!expressions.Contains(exprName)) {
+            return;
+        }
+        currentExpression = exprName;
+    }
+
+    void CharacterSprite::AddAnimation(Atom name, const CharacterAnimation& anim) {
+        if (name == Atom::NONE) {
+            return;
+        }
+        animations.Insert(name, anim);
+    }
+
+    CharacterSprite* CharacterRenderer::GetCharacter(Atom id) {
+        std::unique_ptr<CharacterSprite>* sprite = characters.Find(id);
+        return sprite ? sprite->get() : nullptr;
+    }
+
+    void CharacterRenderer::RemoveCharacter(Atom id) {
+        ReleaseCharacter(id);
+    }
+
+    std::unique_ptr<CharacterSprite> CharacterRenderer::LoadCharacter(const std::string& id,
+                                                                      const std::string& configPath) {
+        // 临时的渲染器只用来复用 CreateCharacter 读取和解析配置，不涉及调用方的渲染器
+        CharacterRenderer scratch;
+        if (!scratch.CreateCharacter(id, configPath)) {
+            return nullptr;
+        }
+        return scratch.ReleaseCharacter(Atoms::Find(id));
+    }
+
+    CharacterSprite* CharacterRenderer::AdoptCharacter(Atom id, std::unique_ptr<CharacterSprite> sprite) {
+        if (id == Atom::NONE || !sprite) {
+            return nullptr;
+        }
+        CharacterSprite* adopted = sprite.get();
+        if (std::unique_ptr<CharacterSprite>* existing = characters.Find(id)) {
+            tweens.CancelOwner(existing->get());
+            *existing = std::move(sprite);
+        } else {
+            characters.Insert(id, std::move(sprite));
+            renderOrder.push_back(id);
+        }
+        UpdateRenderOrder();
+        return adopted;
+    }
+
+    std::unique_ptr<CharacterSprite> CharacterRenderer::ReleaseCharacter(Atom id) {
+        std::unique_ptr<CharacterSprite>* slot = characters.Find(id);
+        if (!slot) {
+            return nullptr;
+        }
+        std::unique_ptr<CharacterSprite> sprite = std::move(*slot);
+        tweens.CancelOwner(sprite.get());
+        for (std::vector<Atom>& members : layerGroups.GetValues()) {
+            members.erase(std::remove(members.begin(), members.end(), id), members.end());
+        }
+        renderOrder.erase(std::remove(renderOrder.begin(), renderOrder.end(), id), renderOrder.end());
+        characters.Erase(id);
+        return sprite;
+    }
+
+    void CharacterRenderer::AddPositionPreset(Atom name, const CharacterPosition& pos) {
+        if (name == Atom::NONE) {
+            return;
+        }
+        positionPresets.Insert(name, pos);
+    }
+
+    void CharacterRenderer::SetCharacterPosition(Atom charId, Atom presetName) {
+        CharacterSprite* sprite = GetCharacter(charId);
+        const CharacterPosition* preset = positionPresets.Find(presetName);
+        if (!sprite || !preset) {
+            return;
+        }
+        sprite->SetPosition(preset->screenPosition);
+        sprite->SetDepth(preset->depth);
+        sprite->SetScale(preset->scale);
+        if (!preset->layer.empty()) {
+            AddToLayer(charId, Atoms::Intern(preset->layer));
+        } else {
+            UpdateRenderOrder();
+        }
+    }
+
+    void CharacterRenderer::AddToLayer(Atom charId, Atom layer) {
+        CharacterSprite* sprite = GetCharacter(charId);
+        if (!sprite || layer == Atom::NONE) {
+            return;
+        }
+        // 一个角色只属于一个图层
+        for (std::vector<Atom>& members : layerGroups.GetValues()) {
+            members.erase(std::remove(members.begin(), members.end(), charId), members.end());
+        }
+        layerGroups[layer].push_back(charId);
+        sprite->SetLayer(Atoms::GetName(layer));
+        UpdateRenderOrder();
+    }
+
+} // namespace VisualNovel
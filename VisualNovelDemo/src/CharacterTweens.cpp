@@ -0,0 +1,110 @@
+#include "CharacterRenderer.h"
+#include <cstdint>
+
+namespace VisualNovel {
+
+    // CharacterSprite / CharacterRenderer 中与补间相关的部分
+
+    float* CharacterSprite::GetTweenChannel(SpriteChannel channel, float** mirror) {
+        float* ignored = nullptr;
+        float*& second = mirror ? *mirror : ignored;
+        second = nullptr;
+        switch (channel) {
+            case SpriteChannel::POSITION_X:
+                second = &targetPosition.x;
+                return &currentPosition.x;
+            case SpriteChannel::POSITION_Y:
+                second = &targetPosition.y;
+                return &currentPosition.y;
+            case SpriteChannel::SCALE:
+                second = &targetScale;
+                return &currentScale;
+            case SpriteChannel::OPACITY:
+                return &opacity;
+            case SpriteChannel::EXPRESSION_BLEND:
+                return &expressionBlend;
+        }
+        return nullptr;
+    }
+
+    namespace {
+        uint32_t AddSpriteTween(TweenSystem& tweens, CharacterSprite& sprite, SpriteChannel channel, float from,
+                                float to, float duration, float delay, Easing easing, SpriteTween tag) {
+            TweenDesc desc;
+            desc.target = sprite.GetTweenChannel(channel, &desc.mirror);
+            desc.owner = &sprite;
+            desc.from = from;
+            desc.to = to;
+            desc.duration = duration;
+            desc.delay = delay;
+            desc.easing = easing;
+            desc.tag = static_cast<uint32_t>(tag);
+            desc.userData = reinterpret_cast<uintptr_t>(&sprite);
+            return tweens.Add(desc);
+        }
+    }
+
+    uint32_t CharacterRenderer::TweenMove(Atom charId, const glm::vec2& target, float duration, Easing easing) {
+        CharacterSprite* sprite = GetCharacter(charId);
+        if (!sprite) {
+            return 0;
+        }
+        glm::vec2 start = sprite->GetRenderPosition();
+        uint32_t id = AddSpriteTween(tweens, *sprite, SpriteChannel::POSITION_X, start.x, target.x, duration, 0.0f,
+                                     easing, SpriteTween::MOVE);
+        AddSpriteTween(tweens, *sprite, SpriteChannel::POSITION_Y, start.y, target.y, duration, 0.0f, easing,
+                       SpriteTween::MOVE);
+        return id;
+    }
+
+    uint32_t CharacterRenderer::TweenScale(Atom charId, float scale, float duration, Easing easing) {
+        CharacterSprite* sprite = GetCharacter(charId);
+        if (!sprite) {
+            return 0;
+        }
+        return AddSpriteTween(tweens, *sprite, SpriteChannel::SCALE, sprite->GetRenderScale(), scale, duration, 0.0f,
+                              easing, SpriteTween::SCALE);
+    }
+
+    size_t CharacterRenderer::TweenFadeInAll(float duration, float stagger) {
+        return TweenFadeAll(0.0f, 1.0f, duration, stagger, Easing::EASE_OUT_QUAD);
+    }
+
+    size_t CharacterRenderer::TweenFadeOutAll(float duration, float stagger) {
+        return TweenFadeAll(-1.0f, 0.0f, duration, stagger, Easing::EASE_IN_QUAD);
+    }
+
+    // from 为负时从当前不透明度开始（淡出中途再淡出不会闪一下）
+    size_t CharacterRenderer::TweenFadeAll(float from, float to, float duration, float stagger, Easing easing) {
+        size_t count = 0;
+        for (Atom id : renderOrder) {
+            std::unique_ptr<CharacterSprite>* found = characters.Find(id);
+            if (!found) {
+                continue;
+            }
+            CharacterSprite& sprite = **found;
+            float start = from < 0.0f ? sprite.GetOpacity() : from;
+            AddSpriteTween(tweens, sprite, SpriteChannel::OPACITY, start, to, duration, stagger * count, easing,
+                           SpriteTween::FADE);
+            ++count;
+        }
+        return count;
+    }
+
+    uint32_t CharacterRenderer::TweenExpression(Atom charId, Atom exprName, float duration) {
+        CharacterSprite* sprite = GetCharacter(charId);
+        if (!sprite || !sprite->HasExpression(exprName)) {
+            return 0;
+        }
+        sprite->SetExpression(exprName);
+        return AddSpriteTween(tweens, *sprite, SpriteChannel::EXPRESSION_BLEND, 0.0f, 1.0f, duration, 0.0f,
+                              Easing::SMOOTHSTEP, SpriteTween::EXPRESSION);
+    }
+
+    void CharacterRenderer::CancelTweens(Atom charId) {
+        if (CharacterSprite* sprite = GetCharacter(charId)) {
+            tweens.CancelOwner(sprite);
+        }
+    }
+
+} // namespace VisualNovel
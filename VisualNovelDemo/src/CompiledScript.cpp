@@ -0,0 +1,41 @@
+#include "CompiledScript.h"
+#include <filesystem>
+#include <map>
+
+namespace VisualNovel {
+
+    namespace {
+        std::map<std::string, const CompiledScript*>& Registry() {
+            // 函数内静态变量：生成文件的静态初始化顺序不确定，第一次登记时才构造
+            static std::map<std::string, const CompiledScript*> scripts;
+            return scripts;
+        }
+
+        std::string NormalizeScriptPath(const std::string& path) {
+            return std::filesystem::path(path).lexically_normal().generic_string();
+        }
+    }
+
+    uint64_t HashScriptSource(std::string_view text) {
+        uint64_t hash = 1469598103934665603ull;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    void CompiledScriptRegistry::Register(const CompiledScript& script) {
+        Registry()[NormalizeScriptPath(std::string(script.source))] = &script;
+    }
+
+    const CompiledScript* CompiledScriptRegistry::Find(const std::string& path) {
+        auto& scripts = Registry();
+        if (scripts.empty()) {
+            return nullptr;
+        }
+        auto it = scripts.find(NormalizeScriptPath(path));
+        return it == scripts.end() ? nullptr : it->second;
+    }
+
+} // namespace VisualNovel
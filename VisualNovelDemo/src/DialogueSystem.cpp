@@ -0,0 +1,516 @@
+#include "DialogueSystem.h"
+#include "AllocationCounter.h"
+#include "Localization.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <iostream>
+
+namespace VisualNovel {
+
+    namespace {
+        // UTF-8 文本的字符数，打字机效果按字符而不是字节推进
+        size_t CountCharacters(std::string_view text) {
+            size_t count = 0;
+            for (unsigned char c : text) {
+                if ((c & 0xC0) != 0x80) ++count;
+            }
+            return count;
+        }
+
+        // 前 characters 个字符占用的字节数
+        size_t PrefixBytes(std::string_view text, size_t characters) {
+            size_t bytes = 0;
+            while (bytes < text.size()) {
+                if ((static_cast<unsigned char>(text[bytes]) & 0xC0) != 0x80) {
+                    if (characters == 0) break;
+                    --characters;
+                }
+                ++bytes;
+            }
+            return bytes;
+        }
+    }
+
+    // ==================== DialogueLine ====================
+
+    DialogueLine::DialogueLine()
+        : DialogueLine(allocator_type()) {
+    }
+
+    DialogueLine::DialogueLine(const allocator_type& allocator)
+        : characterName(allocator), characterDisplayName(allocator), text(allocator), voiceFile(allocator),
+          expression(allocator), position(allocator), fontSize(24), textColor("#FFFFFF", allocator),
+          displaySpeed(1.0f), effects(allocator), metadata(allocator), textId(0) {
+    }
+
+    DialogueLine::DialogueLine(const DialogueLine& other, const allocator_type& allocator)
+        : characterName(other.characterName, allocator),
+          characterDisplayName(other.characterDisplayName, allocator),
+          text(other.text, allocator),
+          voiceFile(other.voiceFile, allocator),
+          expression(other.expression, allocator),
+          position(other.position, allocator),
+          fontSize(other.fontSize),
+          textColor(other.textColor, allocator),
+          displaySpeed(other.displaySpeed),
+          effects(other.effects, allocator),
+          metadata(other.metadata, allocator),
+          textId(other.textId) {
+    }
+
+    DialogueLine::DialogueLine(DialogueLine&& other, const allocator_type& allocator)
+        : characterName(std::move(other.characterName), allocator),
+          characterDisplayName(std::move(other.characterDisplayName), allocator),
+          text(std::move(other.text), allocator),
+          voiceFile(std::move(other.voiceFile), allocator),
+          expression(std::move(other.expression), allocator),
+          position(std::move(other.position), allocator),
+          fontSize(other.fontSize),
+          textColor(std::move(other.textColor), allocator),
+          displaySpeed(other.displaySpeed),
+          effects(std::move(other.effects), allocator),
+          metadata(std::move(other.metadata), allocator),
+          textId(other.textId) {
+    }
+
+    // ==================== ChoiceOption ====================
+
+    ChoiceOption::ChoiceOption(std::string_view t, std::string_view target, const allocator_type& allocator)
+        : text(t, allocator), targetLabel(target, allocator), conditions(allocator), effects(allocator), textId(0) {
+    }
+
+    ChoiceOption::ChoiceOption(const ChoiceOption& other, const allocator_type& allocator)
+        : text(other.text, allocator), targetLabel(other.targetLabel, allocator),
+          conditions(other.conditions, allocator), effects(other.effects, allocator), textId(other.textId) {
+    }
+
+    ChoiceOption::ChoiceOption(ChoiceOption&& other, const allocator_type& allocator)
+        : text(std::move(other.text), allocator), targetLabel(std::move(other.targetLabel), allocator),
+          conditions(std::move(other.conditions), allocator), effects(std::move(other.effects), allocator),
+          textId(other.textId) {
+    }
+
+    // ==================== DialogueHistory ====================
+
+    DialogueHistory::DialogueHistory(int maxSize)
+        : head(0), count(0), maxHistorySize(std::max(1, maxSize)), recordedCount(0) {
+        lines.resize(static_cast<size_t>(maxHistorySize));
+        entries.assign(static_cast<size_t>(maxHistorySize), nullptr);
+    }
+
+    size_t DialogueHistory::NextSlot() {
+        size_t slot = (head + count) % entries.size();
+        ++recordedCount;
+        if (count < entries.size()) {
+            ++count;
+        } else {
+            head = (head + 1) % entries.size();  // 已满，覆盖最旧的一条
+        }
+        MetricsRegistry::Instance().SetGauge(EngineMetrics::Get().historySize, static_cast<int64_t>(count));
+        return slot;
+    }
+
+    void DialogueHistory::AddLine(const DialogueLine& line) {
+        size_t slot = NextSlot();
+        lines[slot] = line;
+        entries[slot] = &lines[slot];
+    }
+
+    void DialogueHistory::RecordLine(const DialogueLine& line) {
+        entries[NextSlot()] = &line;
+    }
+
+    void DialogueHistory::Detach() {
+        for (size_t i = 0; i < count; ++i) {
+            size_t slot = (head + i) % entries.size();
+            if (entries[slot] != &lines[slot]) {
+                lines[slot] = *entries[slot];
+                entries[slot] = &lines[slot];
+            }
+        }
+    }
+
+    void DialogueHistory::Clear() {
+        head = 0;
+        count = 0;
+        recordedCount = 0;
+        MetricsRegistry::Instance().SetGauge(EngineMetrics::Get().historySize, 0);
+    }
+
+    size_t DialogueHistory::GetSize() const {
+        return count;
+    }
+
+    const DialogueLine& DialogueHistory::GetLine(size_t index) const {
+        return *entries[(head + index) % entries.size()];
+    }
+
+    std::vector<DialogueLine> DialogueHistory::GetHistory() const {
+        std::vector<DialogueLine> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            result.push_back(GetLine(i));
+        }
+        return result;
+    }
+
+    // ==================== TextEffectProcessor ====================
+
+    DialogueSystem::TextEffectProcessor::TextEffectProcessor() {
+    }
+
+    void DialogueSystem::TextEffectProcessor::RegisterEffect(const std::string& name,
+                                                             std::function<void(DialogueLine&, float)> effect) {
+        effects[name] = std::move(effect);
+    }
+
+    void DialogueSystem::TextEffectProcessor::ApplyEffects(DialogueLine& line, float deltaTime) {
+        for (const ArenaString& name : line.effects) {
+            auto it = effects.find(std::string_view(name));
+            if (it != effects.end() && it->second) {
+                it->second(line, deltaTime);
+            }
+        }
+    }
+
+    // ==================== DialogueSystem ====================
+
+    // 统计作用域内当前线程的堆分配；嵌套调用（自动播放时 Update 调用 NextLine）只在最外层统计
+    class DialogueSystem::AllocationCheckScope {
+    private:
+        DialogueSystem& system;
+        bool active;
+        uint64_t startAllocations;
+
+    public:
+        explicit AllocationCheckScope(DialogueSystem& owner)
+            : system(owner), active(owner.allocationCheck && !owner.insideAllocationCheck), startAllocations(0) {
+            if (active) {
+                system.insideAllocationCheck = true;
+                startAllocations = AllocationCounter::GetThreadSnapshot().allocations;
+            }
+        }
+
+        ~AllocationCheckScope() {
+            if (!active) {
+                return;
+            }
+            system.insideAllocationCheck = false;
+            uint64_t allocations = AllocationCounter::GetThreadSnapshot().allocations - startAllocations;
+            if (allocations > 0) {
+                if (system.steadyStateAllocations == 0) {
+                    std::cerr << "[DialogueSystem] 稳态推进对话时发生了 " << allocations << " 次堆分配" << std::endl;
+                }
+                system.steadyStateAllocations += allocations;
+            }
+        }
+    };
+
+    DialogueSystem::DialogueSystem()
+        : currentDialogue(nullptr), currentChoices(nullptr), currentLine(nullptr), currentLineCharacters(0),
+          localizationGeneration(0), history(100), historyIndexGeneration(0), events(nullptr),
+          currentLineIndex(0), isTyping(false), typingProgress(0.0f), typingSpeed(50.0f),
+          autoPlay(false), autoPlayTimer(0.0f), autoPlayDelay(3.0f), visibleBytes(0),
+          allocationCheck(false), insideAllocationCheck(false), steadyStateAllocations(0) {
+        currentDialogue = dialogueArena.Make<DialogueLineList>();
+        currentChoices = choiceArena.Make<ChoiceOptionList>();
+    }
+
+    DialogueSystem::~DialogueSystem() {
+        // 对话和选项随分配区一起释放
+    }
+
+    void DialogueSystem::StartDialogue(const std::vector<DialogueLine>& dialogue) {
+        // 历史中引用的旧场景行先复制出来，再把上一个场景的对话整块丢弃
+        history.Detach();
+        currentLine = nullptr;
+        dialogueArena.Reset();
+        currentDialogue = dialogueArena.Make<DialogueLineList>(dialogue.begin(), dialogue.end());
+        currentLineIndex = 0;
+        ShowCurrentLine(true);
+    }
+
+    void DialogueSystem::StartDialogue(const DialogueLineList& dialogue) {
+        if (&dialogue != currentDialogue) {
+            history.Detach();
+            currentLine = nullptr;
+            dialogueArena.Reset();
+            currentDialogue = dialogueArena.Make<DialogueLineList>(dialogue.begin(), dialogue.end());
+        }
+        currentLineIndex = 0;
+        ShowCurrentLine(true);
+    }
+
+    void DialogueSystem::ShowCurrentLine(bool addToHistory) {
+        if (currentLineIndex < 0 || static_cast<size_t>(currentLineIndex) >= currentDialogue->size()) {
+            isTyping = false;
+            return;
+        }
+
+        currentLine = &(*currentDialogue)[currentLineIndex];
+        ResolveCurrentText();
+        if (addToHistory) {
+            history.RecordLine(*currentLine);
+        }
+        if (events) {
+            events->Push(EngineEventType::TEXT, currentText);
+            events->Push(EngineEventType::VOICE, currentLine->voiceFile);
+        }
+        isTyping = true;
+        typingProgress = 0.0f;
+        autoPlayTimer = 0.0f;
+        FormatTextWithEffects();
+    }
+
+    void DialogueSystem::ResolveCurrentText() {
+        // 显示时才查语言表，切换语言不需要重新载入脚本或对话
+        Localization& localization = Localization::Instance();
+        localizationGeneration = localization.GetGeneration();
+        currentText = currentLine ? localization.Resolve(currentLine->textId, currentLine->text) : std::string_view();
+        currentLineCharacters = CountCharacters(currentText);
+    }
+
+    void DialogueSystem::NextLine() {
+        AllocationCheckScope check(*this);
+        Advance();
+    }
+
+    void DialogueSystem::Advance() {
+        // 正在打字时先显示完整文本
+        if (isTyping) {
+            CompleteTyping();
+            return;
+        }
+
+        if (static_cast<size_t>(currentLineIndex + 1) < currentDialogue->size()) {
+            ++currentLineIndex;
+            ShowCurrentLine(true);
+        } else {
+            currentLineIndex = static_cast<int>(currentDialogue->size());
+            isTyping = false;
+        }
+    }
+
+    void DialogueSystem::PreviousLine() {
+        if (currentLineIndex > 0) {
+            currentLineIndex = std::min(currentLineIndex - 1, static_cast<int>(currentDialogue->size()) - 1);
+            ShowCurrentLine(false);
+        }
+    }
+
+    void DialogueSystem::JumpToLine(int index) {
+        if (index < 0 || static_cast<size_t>(index) >= currentDialogue->size()) {
+            return;
+        }
+        currentLineIndex = index;
+        ShowCurrentLine(true);
+    }
+
+    void DialogueSystem::SkipToEnd() {
+        if (currentDialogue->empty()) {
+            return;
+        }
+        // 跳过的行也记入历史
+        int last = static_cast<int>(currentDialogue->size()) - 1;
+        for (int i = currentLineIndex + 1; i < last; ++i) {
+            history.RecordLine((*currentDialogue)[i]);
+        }
+        currentLineIndex = last;
+        ShowCurrentLine(true);
+        CompleteTyping();
+    }
+
+    void DialogueSystem::Update(float deltaTime) {
+        // 区域先于分配检查开始、晚于它结束，线程第一次记录时领取追踪缓冲区的分配不计入稳态
+        VN_TRACE_ZONE(DIALOGUE, "DialogueSystem::Update");
+        AllocationCheckScope check(*this);
+
+        if (localizationGeneration != Localization::Instance().GetGeneration()) {
+            // 语言切换后按新文本重新计算，已经打出的字数保持不变
+            ResolveCurrentText();
+            typingProgress = std::min(typingProgress, static_cast<float>(currentLineCharacters));
+            FormatTextWithEffects();
+            if (events && currentLine) {
+                events->Push(EngineEventType::TEXT, currentText);
+            }
+        }
+
+        if (isTyping) {
+            typingProgress += typingSpeed * currentLine->displaySpeed * deltaTime;
+            if (typingProgress >= static_cast<float>(currentLineCharacters)) {
+                CompleteTyping();
+            } else {
+                FormatTextWithEffects();
+            }
+        }
+
+        ProcessTextEffects(deltaTime);
+
+        if (autoPlay && !isTyping && static_cast<size_t>(currentLineIndex) < currentDialogue->size()) {
+            autoPlayTimer += deltaTime;
+            if (autoPlayTimer >= autoPlayDelay) {
+                autoPlayTimer = 0.0f;
+                Advance();
+            }
+        }
+    }
+
+    bool DialogueSystem::IsTypingComplete() const {
+        return !isTyping;
+    }
+
+    void DialogueSystem::CompleteTyping() {
+        typingProgress = static_cast<float>(currentLineCharacters);
+        isTyping = false;
+        FormatTextWithEffects();
+    }
+
+    const DialogueLine& DialogueSystem::GetCurrentLine() const {
+        static const DialogueLine emptyLine;
+        return currentLine ? *currentLine : emptyLine;
+    }
+
+    std::string_view DialogueSystem::GetVisibleText() const {
+        return currentText.substr(0, visibleBytes);
+    }
+
+    std::string_view DialogueSystem::GetCurrentText() const {
+        return currentText;
+    }
+
+    void DialogueSystem::UpdateHistoryIndex() {
+        // 索引按当前语言的文本建立；历史被清空或语言切换后从头重建
+        uint64_t generation = Localization::Instance().GetGeneration();
+        if (history.recordedCount < historyIndex.GetEndDocument() || generation != historyIndexGeneration) {
+            historyIndex.Clear();
+            historyIndexGeneration = generation;
+        }
+
+        uint32_t oldest = history.recordedCount - static_cast<uint32_t>(history.GetSize());
+        historyIndex.RemoveBefore(oldest);
+        for (uint32_t sequence = std::max(oldest, historyIndex.GetEndDocument()); sequence < history.recordedCount;
+             ++sequence) {
+            const DialogueLine& line = history.GetLine(sequence - oldest);
+            SearchDocument document;
+            document.text = Localization::Instance().Resolve(line.textId, line.text);
+            document.speaker = line.characterName;
+            document.speakerName = line.characterDisplayName;
+            historyIndex.Add(std::move(document));  // 文档编号与记录序号一致
+        }
+    }
+
+    std::vector<SearchHit> DialogueSystem::SearchHistory(const SearchQuery& query) {
+        UpdateHistoryIndex();
+        SearchQuery historyQuery = query;
+        historyQuery.label.clear();
+        historyQuery.limit = static_cast<size_t>(-1);
+        std::vector<SearchHit> hits = historyIndex.Search(historyQuery);
+        std::reverse(hits.begin(), hits.end());
+        if (hits.size() > query.limit) {
+            hits.resize(query.limit);
+        }
+        return hits;
+    }
+
+    void DialogueSystem::SetChoices(const std::vector<ChoiceOption>& choices) {
+        choiceArena.Reset();
+        currentChoices = choiceArena.Make<ChoiceOptionList>(choices.begin(), choices.end());
+        if (events && !currentChoices->empty()) {
+            events->Push(EngineEventType::CHOICE);
+        }
+    }
+
+    void DialogueSystem::SetChoices(const ChoiceOptionList& choices) {
+        if (&choices == currentChoices) {
+            return;
+        }
+        choiceArena.Reset();
+        currentChoices = choiceArena.Make<ChoiceOptionList>(choices.begin(), choices.end());
+        if (events && !currentChoices->empty()) {
+            events->Push(EngineEventType::CHOICE);
+        }
+    }
+
+    const ChoiceOptionList& DialogueSystem::GetChoices() const {
+        return *currentChoices;
+    }
+
+    std::string_view DialogueSystem::GetChoiceText(size_t index) const {
+        if (!currentChoices || index >= currentChoices->size()) {
+            return std::string_view();
+        }
+        const ChoiceOption& option = (*currentChoices)[index];
+        return Localization::Instance().Resolve(option.textId, option.text);
+    }
+
+    void DialogueSystem::ClearChoices() {
+        choiceArena.Reset();
+        currentChoices = choiceArena.Make<ChoiceOptionList>();
+    }
+
+    bool DialogueSystem::HasChoices() const {
+        return !currentChoices->empty();
+    }
+
+    void DialogueSystem::SetAutoPlay(bool enabled) {
+        autoPlay = enabled;
+        autoPlayTimer = 0.0f;
+    }
+
+    bool DialogueSystem::IsAutoPlaying() const {
+        return autoPlay;
+    }
+
+    void DialogueSystem::SetAutoPlayDelay(float delay) {
+        autoPlayDelay = std::max(0.0f, delay);
+    }
+
+    const DialogueHistory& DialogueSystem::GetHistory() const {
+        return history;
+    }
+
+    void DialogueSystem::ClearHistory() {
+        history.Clear();
+        // 记录序号从 0 重新开始，旧索引的文档编号会与新记录重叠，不能等到下次搜索时再判断
+        historyIndex.Clear();
+    }
+
+    void DialogueSystem::SetTypingSpeed(float speed) {
+        typingSpeed = std::max(1.0f, speed);
+    }
+
+    float DialogueSystem::GetTypingSpeed() const {
+        return typingSpeed;
+    }
+
+    void DialogueSystem::RegisterTextEffect(const std::string& name,
+                                            std::function<void(DialogueLine&, float)> effect) {
+        effectProcessor.RegisterEffect(name, std::move(effect));
+    }
+
+    void DialogueSystem::SetEventQueue(EngineEventQueue* queue) {
+        events = queue;
+    }
+
+    void DialogueSystem::SetAllocationCheck(bool enabled) {
+        allocationCheck = enabled;
+        steadyStateAllocations = 0;
+    }
+
+    uint64_t DialogueSystem::GetSteadyStateAllocations() const {
+        return steadyStateAllocations;
+    }
+
+    void DialogueSystem::ProcessTextEffects(float deltaTime) {
+        if (currentLine && !currentLine->effects.empty()) {
+            effectProcessor.ApplyEffects(*currentLine, deltaTime);
+        }
+    }
+
+    void DialogueSystem::FormatTextWithEffects() {
+        // 只记录可见前缀的长度，显示时直接引用行文本，不再拼出新字符串
+        visibleBytes = PrefixBytes(currentText, static_cast<size_t>(typingProgress));
+    }
+
+} // namespace VisualNovel
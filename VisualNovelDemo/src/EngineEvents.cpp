@@ -0,0 +1,51 @@
+#include "EngineEvents.h"
+
+namespace VisualNovel {
+
+    namespace {
+        constexpr size_t kNoSlot = static_cast<size_t>(-1);
+
+        // 每种事件合并到哪个位置，kNoSlot 表示不合并
+        constexpr size_t kCoalesceSlot[] = {
+            static_cast<size_t>(EngineEventType::TEXT),
+            static_cast<size_t>(EngineEventType::BACKGROUND),
+            static_cast<size_t>(EngineEventType::BGM),
+            static_cast<size_t>(EngineEventType::BGM),   // 停止 BGM 与播放 BGM 互相覆盖
+            kNoSlot,                                     // 音效
+            static_cast<size_t>(EngineEventType::CHOICE),
+            static_cast<size_t>(EngineEventType::VOICE),  // 跳过的台词不再播放语音
+            kNoSlot,                                     // 登场、退场：不同角色互不覆盖
+            kNoSlot,
+        };
+        static_assert(sizeof(kCoalesceSlot) / sizeof(kCoalesceSlot[0]) ==
+                      static_cast<size_t>(EngineEventType::Count), "每种事件都需要合并规则");
+    }
+
+    EngineEventQueue::EngineEventQueue(size_t capacity)
+        : coalescedCount(0) {
+        // 预留容量后稳态下追加事件不分配
+        events.reserve(capacity);
+        latest.fill(kNoEvent);
+    }
+
+    void EngineEventQueue::Push(EngineEventType type, std::string_view value, const CharacterAtoms& atoms) {
+        size_t slot = kCoalesceSlot[static_cast<size_t>(type)];
+        if (slot == kNoSlot) {
+            events.push_back(EngineEvent{type, value, atoms});
+            return;
+        }
+        if (latest[slot] != kNoEvent) {
+            events[latest[slot]] = EngineEvent{type, value, atoms};
+            ++coalescedCount;
+            return;
+        }
+        latest[slot] = events.size();
+        events.push_back(EngineEvent{type, value, atoms});
+    }
+
+    void EngineEventQueue::Clear() {
+        events.clear();
+        latest.fill(kNoEvent);
+    }
+
+} // namespace VisualNovel
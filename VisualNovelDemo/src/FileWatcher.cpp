@@ -0,0 +1,196 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace VisualNovel {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+        const std::chrono::milliseconds kPollInterval(250);
+    }
+
+    FileWatcher::FileWatcher(std::chrono::milliseconds debounceTime)
+        : debounce(debounceTime), running(false), wakeFds{-1, -1} {
+    }
+
+    FileWatcher::~FileWatcher() {
+        Stop();
+    }
+
+    void FileWatcher::AddDirectory(const std::string& directory) {
+        directories.push_back(directory);
+    }
+
+    bool FileWatcher::Start(ChangeCallback callback) {
+        if (running.load()) {
+            return false;
+        }
+        onChange = std::move(callback);
+        running.store(true);
+
+#ifdef __linux__
+        if (pipe(wakeFds) != 0) {
+            running.store(false);
+            return false;
+        }
+        watchThread = std::thread([this]() { RunInotify(); });
+#else
+        ScanWriteTimes(nullptr);
+        watchThread = std::thread([this]() { RunPolling(); });
+#endif
+        return true;
+    }
+
+    void FileWatcher::Stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+#ifdef __linux__
+        char wake = 0;
+        ssize_t written = write(wakeFds[1], &wake, 1);
+        (void)written;
+#endif
+        if (watchThread.joinable()) {
+            watchThread.join();
+        }
+#ifdef __linux__
+        close(wakeFds[0]);
+        close(wakeFds[1]);
+        wakeFds[0] = wakeFds[1] = -1;
+#endif
+    }
+
+    void FileWatcher::RunInotify() {
+#ifdef __linux__
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "[FileWatcher] inotify 不可用，改为轮询" << std::endl;
+            ScanWriteTimes(nullptr);
+            RunPolling();
+            return;
+        }
+
+        // 编辑器保存时通常是“写临时文件再改名”，所以同时关注 CLOSE_WRITE 和 MOVED_TO
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+        std::map<int, std::string> watches;
+        auto addWatch = [&](const std::string& directory) {
+            int wd = inotify_add_watch(fd, directory.c_str(), mask);
+            if (wd >= 0) {
+                watches[wd] = directory;
+            }
+        };
+        for (const std::string& directory : directories) {
+            addWatch(directory);
+            std::error_code error;
+            for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+                 !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+                if (it->is_directory()) {
+                    addWatch(it->path().string());
+                }
+            }
+        }
+
+        std::map<std::string, Clock::time_point> pending;
+        alignas(inotify_event) char buffer[4096];
+
+        while (running.load(std::memory_order_relaxed)) {
+            // 有待通知的文件时只等到最早的去抖截止时间
+            int timeout = -1;
+            Clock::time_point now = Clock::now();
+            for (const auto& entry : pending) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(entry.second - now).count();
+                int remaining = static_cast<int>(std::max<long long>(0, wait));
+                timeout = timeout < 0 ? remaining : std::min(timeout, remaining);
+            }
+
+            pollfd fds[2] = {{fd, POLLIN, 0}, {wakeFds[0], POLLIN, 0}};
+            if (poll(fds, 2, timeout) < 0) {
+                continue;
+            }
+            if (fds[1].revents & POLLIN) {
+                break;
+            }
+
+            if (fds[0].revents & POLLIN) {
+                ssize_t length;
+                while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + length;) {
+                        const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                        p += sizeof(inotify_event) + event->len;
+                        auto watch = watches.find(event->wd);
+                        if (watch == watches.end() || event->len == 0) {
+                            continue;
+                        }
+                        std::string path = watch->second + "/" + event->name;
+                        if (event->mask & IN_ISDIR) {
+                            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                                addWatch(path);
+                            }
+                            continue;
+                        }
+                        // IN_CREATE 之后还会有 CLOSE_WRITE，只在内容写完时通知
+                        if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                            pending[path] = Clock::now() + debounce;
+                        }
+                    }
+                }
+            }
+
+            now = Clock::now();
+            for (auto it = pending.begin(); it != pending.end();) {
+                if (it->second <= now) {
+                    onChange(it->first);
+                    it = pending.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        close(fd);
+#else
+        RunPolling();
+#endif
+    }
+
+    void FileWatcher::RunPolling() {
+        std::vector<std::string> changed;
+        while (running.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(kPollInterval);
+            changed.clear();
+            ScanWriteTimes(&changed);
+            for (const std::string& path : changed) {
+                onChange(path);
+            }
+        }
+    }
+
+    void FileWatcher::ScanWriteTimes(std::vector<std::string>* changed) {
+        for (const std::string& directory : directories) {
+            std::error_code error;
+            for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+                 !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+                if (!it->is_regular_file()) {
+                    continue;
+                }
+                std::string path = it->path().string();
+                std::filesystem::file_time_type writeTime = it->last_write_time(error);
+                auto known = writeTimes.find(path);
+                if (known == writeTimes.end() || known->second != writeTime) {
+                    // 首次扫描只建立基准，之后新增和修改的文件都算变化
+                    if (changed) {
+                        changed->push_back(path);
+                    }
+                    writeTimes[path] = writeTime;
+                }
+            }
+        }
+    }
+
+} // namespace VisualNovel
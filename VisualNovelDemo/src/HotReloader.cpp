@@ -0,0 +1,190 @@
+#include "HotReloader.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "ScriptParser.h"
+#include "Profiler.h"
+
+namespace VisualNovel {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        // inotify 给出的路径与调用方传入的写法可能不同，比较前统一格式
+        std::string NormalizePath(const std::string& path) {
+            return std::filesystem::path(path).lexically_normal().generic_string();
+        }
+
+        bool IsInside(const std::string& path, const std::string& directory) {
+            return !directory.empty() && path.compare(0, directory.size(), directory) == 0 &&
+                   (path.size() == directory.size() || path[directory.size()] == '/');
+        }
+
+        uint64_t ElapsedNs(Clock::time_point start) {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+    }
+
+    HotReloader::HotReloader()
+        : reloadCount(0) {
+        MetricsRegistry& registry = MetricsRegistry::Instance();
+        compileTimer = registry.RegisterTimer("hotreload.compile");
+        applyTimer = registry.RegisterTimer("hotreload.apply");
+    }
+
+    HotReloader::~HotReloader() {
+        Stop();
+    }
+
+    void HotReloader::WatchScript(const std::string& path) {
+        scriptPath = NormalizePath(path);
+        std::string directory = std::filesystem::path(scriptPath).parent_path().generic_string();
+        watcher.AddDirectory(directory.empty() ? "." : directory);
+    }
+
+    void HotReloader::WatchProject(const std::string& directory) {
+        projectDirectory = NormalizePath(directory);
+        // 先完整加载一次，之后每次变化只重新解析改动的文件
+        project = std::make_unique<ScriptProject>();
+        project->Load(projectDirectory);
+        watcher.AddDirectory(projectDirectory);
+    }
+
+    void HotReloader::WatchCharacters(const std::string& directory) {
+        characterDirectory = NormalizePath(directory);
+        watcher.AddDirectory(characterDirectory);
+    }
+
+    void HotReloader::SetCharacterReloadHandler(CharacterReloadHandler handler) {
+        characterHandler = std::move(handler);
+    }
+
+    bool HotReloader::Start() {
+        return watcher.Start([this](const std::string& path) { OnFileChanged(path); });
+    }
+
+    void HotReloader::Stop() {
+        watcher.Stop();
+    }
+
+    bool HotReloader::CompileScriptFile(const std::string& path, ScriptImage& image) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "[热重载] 无法打开 " << path << std::endl;
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+
+        image.arena = std::make_unique<SceneArena>();
+        image.commands = image.arena->Make<ScriptCommandList>();
+        image.labels.clear();
+        ScriptParser parser(*image.commands, image.labels);
+        bool ok = parser.Parse(buffer.str());
+        for (const std::string& error : parser.GetErrors()) {
+            std::cerr << "[热重载] " << path << ": " << error << std::endl;
+        }
+        return ok;
+    }
+
+    void HotReloader::OnFileChanged(const std::string& changedPath) {
+        VN_TRACE_ZONE(ASSETS, "HotReloader::OnFileChanged");
+        std::string path = NormalizePath(changedPath);
+
+        {
+            // 上次被替换下来的脚本在这里释放，不占用更新线程的时间
+            std::vector<ScriptImage> retired;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                retired.swap(retiredScripts);
+            }
+        }
+
+        if (IsInside(path, characterDirectory) && std::filesystem::path(path).extension() == ".json") {
+            std::string id = std::filesystem::path(path).stem().string();
+            std::unique_ptr<CharacterSprite> sprite = CharacterRenderer::LoadCharacter(id, path);
+            if (!sprite) {
+                std::cerr << "[热重载] 角色配置载入失败，继续使用旧配置: " << path << std::endl;
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingCharacters.emplace_back(path, std::move(sprite));
+            return;
+        }
+
+        Clock::time_point start = Clock::now();
+        if (path == scriptPath) {
+            auto image = std::make_unique<ScriptImage>();
+            if (!CompileScriptFile(path, *image)) {
+                std::cerr << "[热重载] 脚本有错误，继续运行旧版本" << std::endl;
+                return;
+            }
+            MetricsRegistry::Instance().RecordTime(compileTimer, ElapsedNs(start));
+            Publish(std::move(image));
+        } else if (project && IsInside(path, projectDirectory) && std::filesystem::path(path).extension() == ".txt") {
+            if (!project->Reload()) {
+                for (const std::string& error : project->GetErrors()) {
+                    std::cerr << "[热重载] " << error << std::endl;
+                }
+                std::cerr << "[热重载] 工程有错误，继续运行旧版本" << std::endl;
+                return;
+            }
+            auto image = std::make_unique<ScriptImage>();
+            image->arena = std::make_unique<SceneArena>();
+            const ScriptCommandList& linked = project->GetCommands();
+            image->commands = image->arena->Make<ScriptCommandList>(linked.begin(), linked.end());
+            image->labels = project->GetLabels();
+            MetricsRegistry::Instance().RecordTime(compileTimer, ElapsedNs(start));
+            Publish(std::move(image));
+        }
+    }
+
+    void HotReloader::Publish(std::unique_ptr<ScriptImage> image) {
+        std::unique_ptr<ScriptImage> superseded;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // 还没被应用的旧结果直接作废，只应用最新的一版
+            superseded = std::move(pendingScript);
+            pendingScript = std::move(image);
+        }
+    }
+
+    bool HotReloader::Apply(ScriptInterpreter& interpreter) {
+        std::unique_ptr<ScriptImage> image;
+        std::vector<std::pair<std::string, std::unique_ptr<CharacterSprite>>> characters;
+        {
+            std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+            if (!lock.owns_lock() || (!pendingScript && pendingCharacters.empty())) {
+                return false;
+            }
+            image = std::move(pendingScript);
+            characters.swap(pendingCharacters);
+        }
+
+        bool applied = false;
+        if (characterHandler) {
+            for (auto& character : characters) {
+                characterHandler(character.first, std::move(character.second));
+                applied = true;
+            }
+        }
+        if (!image) {
+            return applied;
+        }
+
+        Clock::time_point start = Clock::now();
+        ScriptImage previous = interpreter.AdoptScript(std::move(*image));
+        MetricsRegistry::Instance().RecordTime(applyTimer, ElapsedNs(start));
+        reloadCount.fetch_add(1, std::memory_order_relaxed);
+
+        // 必须交给监视线程释放，否则整个旧分配区在更新线程中析构；
+        // 监视线程持锁时只做交换和追加，这里等待的时间可以忽略
+        std::lock_guard<std::mutex> lock(mutex);
+        retiredScripts.push_back(std::move(previous));
+        return true;
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,519 @@
+#include "ImageCodec.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace VisualNovel {
+
+    namespace {
+        bool Fail(std::string* error, const std::string& message) {
+            if (error) *error = message;
+            return false;
+        }
+
+        uint32_t ReadBigEndian32(const uint8_t* p) {
+            return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+        }
+
+        void WriteBigEndian32(std::string& out, uint32_t value) {
+            out += static_cast<char>(value >> 24);
+            out += static_cast<char>(value >> 16);
+            out += static_cast<char>(value >> 8);
+            out += static_cast<char>(value);
+        }
+
+        // ==================== inflate ====================
+
+        // 范式哈夫曼码表：按码长计数，同码长的符号按大小排列
+        struct Huffman {
+            std::array<uint16_t, 16> counts{};
+            std::array<uint16_t, 288> symbols{};
+
+            bool Build(const uint8_t* lengths, size_t count) {
+                counts.fill(0);
+                for (size_t i = 0; i < count; ++i) ++counts[lengths[i]];
+                counts[0] = 0;
+                std::array<uint16_t, 16> offsets{};
+                for (size_t len = 1; len < 16; ++len) offsets[len] = offsets[len - 1] + counts[len - 1];
+                for (size_t i = 0; i < count; ++i) {
+                    if (lengths[i]) symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+                }
+                return true;
+            }
+        };
+
+        class Inflater {
+        private:
+            const uint8_t* data;
+            size_t size;
+            size_t position;
+            uint32_t bitBuffer;
+            int bitCount;
+            std::vector<uint8_t>& out;
+
+        public:
+            Inflater(const uint8_t* input, size_t length, std::vector<uint8_t>& output)
+                : data(input), size(length), position(0), bitBuffer(0), bitCount(0), out(output) {}
+
+            bool Run() {
+                bool last = false;
+                while (!last) {
+                    int header;
+                    if (!Bits(3, header)) return false;
+                    last = header & 1;
+                    switch (header >> 1) {
+                        case 0: if (!Stored()) return false; break;
+                        case 1: if (!FixedBlock()) return false; break;
+                        case 2: if (!DynamicBlock()) return false; break;
+                        default: return false;
+                    }
+                }
+                return true;
+            }
+
+        private:
+            bool Bits(int count, int& value) {
+                while (bitCount < count) {
+                    if (position >= size) return false;
+                    bitBuffer |= uint32_t(data[position++]) << bitCount;
+                    bitCount += 8;
+                }
+                value = static_cast<int>(bitBuffer & ((1u << count) - 1));
+                bitBuffer >>= count;
+                bitCount -= count;
+                return true;
+            }
+
+            bool Decode(const Huffman& table, int& symbol) {
+                // 逐位比较：first 为当前码长第一个码字，index 为其在符号表中的位置
+                int code = 0, first = 0, index = 0;
+                for (int len = 1; len < 16; ++len) {
+                    int bit;
+                    if (!Bits(1, bit)) return false;
+                    code |= bit;
+                    int count = table.counts[len];
+                    if (code - count < first) {
+                        symbol = table.symbols[index + (code - first)];
+                        return true;
+                    }
+                    index += count;
+                    first += count;
+                    first <<= 1;
+                    code <<= 1;
+                }
+                return false;
+            }
+
+            bool Stored() {
+                bitBuffer = 0;
+                bitCount = 0;
+                if (position + 4 > size) return false;
+                uint16_t length = uint16_t(data[position] | (data[position + 1] << 8));
+                uint16_t complement = uint16_t(data[position + 2] | (data[position + 3] << 8));
+                position += 4;
+                if (length != uint16_t(~complement) || position + length > size) return false;
+                out.insert(out.end(), data + position, data + position + length);
+                position += length;
+                return true;
+            }
+
+            bool FixedBlock() {
+                static const std::pair<Huffman, Huffman> tables = [] {
+                    uint8_t lengths[288];
+                    for (int i = 0; i < 144; ++i) lengths[i] = 8;
+                    for (int i = 144; i < 256; ++i) lengths[i] = 9;
+                    for (int i = 256; i < 280; ++i) lengths[i] = 7;
+                    for (int i = 280; i < 288; ++i) lengths[i] = 8;
+                    std::pair<Huffman, Huffman> built;
+                    built.first.Build(lengths, 288);
+                    uint8_t distances[30];
+                    std::memset(distances, 5, sizeof(distances));
+                    built.second.Build(distances, 30);
+                    return built;
+                }();
+                return Codes(tables.first, tables.second);
+            }
+
+            bool DynamicBlock() {
+                int literalCount, distanceCount, codeCount;
+                if (!Bits(5, literalCount) || !Bits(5, distanceCount) || !Bits(4, codeCount)) return false;
+                literalCount += 257;
+                distanceCount += 1;
+                codeCount += 4;
+
+                static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+                uint8_t lengths[288 + 32] = {};
+                for (int i = 0; i < codeCount; ++i) {
+                    int length;
+                    if (!Bits(3, length)) return false;
+                    lengths[order[i]] = static_cast<uint8_t>(length);
+                }
+                Huffman lengthCodes;
+                lengthCodes.Build(lengths, 19);
+
+                int total = literalCount + distanceCount;
+                std::memset(lengths, 0, sizeof(lengths));
+                for (int i = 0; i < total;) {
+                    int symbol;
+                    if (!Decode(lengthCodes, symbol)) return false;
+                    if (symbol < 16) {
+                        lengths[i++] = static_cast<uint8_t>(symbol);
+                        continue;
+                    }
+                    int repeat = 0, value = 0, extra;
+                    if (symbol == 16) {
+                        if (i == 0 || !Bits(2, extra)) return false;
+                        value = lengths[i - 1];
+                        repeat = 3 + extra;
+                    } else if (symbol == 17) {
+                        if (!Bits(3, extra)) return false;
+                        repeat = 3 + extra;
+                    } else {
+                        if (!Bits(7, extra)) return false;
+                        repeat = 11 + extra;
+                    }
+                    if (i + repeat > total) return false;
+                    while (repeat--) lengths[i++] = static_cast<uint8_t>(value);
+                }
+                Huffman literals, distances;
+                literals.Build(lengths, literalCount);
+                distances.Build(lengths + literalCount, distanceCount);
+                return Codes(literals, distances);
+            }
+
+            bool Codes(const Huffman& literals, const Huffman& distances) {
+                static const uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+                static const uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+                static const uint16_t distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                                          193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                                          6145, 8193, 12289, 16385, 24577};
+                static const uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                                          7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+                for (;;) {
+                    int symbol;
+                    if (!Decode(literals, symbol)) return false;
+                    if (symbol < 256) {
+                        out.push_back(static_cast<uint8_t>(symbol));
+                        continue;
+                    }
+                    if (symbol == 256) return true;
+                    symbol -= 257;
+                    if (symbol >= 29) return false;
+                    int extra;
+                    if (!Bits(lengthExtra[symbol], extra)) return false;
+                    size_t length = lengthBase[symbol] + extra;
+                    int distanceSymbol;
+                    if (!Decode(distances, distanceSymbol) || distanceSymbol >= 30) return false;
+                    if (!Bits(distanceExtra[distanceSymbol], extra)) return false;
+                    size_t distance = distanceBase[distanceSymbol] + extra;
+                    if (distance > out.size()) return false;
+                    // 距离可能小于长度（重复最近的几个字节），只能逐字节复制
+                    size_t from = out.size() - distance;
+                    for (size_t i = 0; i < length; ++i) out.push_back(out[from + i]);
+                }
+            }
+        };
+
+        // ==================== PNG ====================
+
+        uint8_t Paeth(int a, int b, int c) {
+            int p = a + b - c;
+            int pa = p > a ? p - a : a - p;
+            int pb = p > b ? p - b : b - p;
+            int pc = p > c ? p - c : c - p;
+            if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+            return static_cast<uint8_t>(pb <= pc ? b : c);
+        }
+
+        uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+            static const std::array<uint32_t, 256> table = [] {
+                std::array<uint32_t, 256> built{};
+                for (uint32_t n = 0; n < 256; ++n) {
+                    uint32_t c = n;
+                    for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    built[n] = c;
+                }
+                return built;
+            }();
+            crc = ~crc;
+            for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        void WriteChunk(std::string& out, const char* type, const std::string& payload) {
+            WriteBigEndian32(out, static_cast<uint32_t>(payload.size()));
+            std::string body(type, 4);
+            body += payload;
+            out += body;
+            WriteBigEndian32(out, Crc32(reinterpret_cast<const uint8_t*>(body.data()), body.size()));
+        }
+
+        // ==================== Netpbm ====================
+
+        bool LoadNetpbm(const std::string& content, SoftwareImage& image, std::string* error) {
+            std::istringstream in(content);
+            std::string magic;
+            in >> magic;
+            int width = 0, height = 0, depth = 0, maxValue = 0;
+            if (magic == "P6") {
+                in >> width >> height >> maxValue;
+                depth = 3;
+                in.get();
+            } else if (magic == "P7") {
+                std::string key;
+                while (in >> key && key != "ENDHDR") {
+                    if (key == "WIDTH") in >> width;
+                    else if (key == "HEIGHT") in >> height;
+                    else if (key == "DEPTH") in >> depth;
+                    else if (key == "MAXVAL") in >> maxValue;
+                    else std::getline(in, key);  // TUPLTYPE 等
+                }
+                in.get();
+            } else {
+                return Fail(error, "不支持的图像格式");
+            }
+            if (width <= 0 || height <= 0 || maxValue != 255 || depth < 1 || depth > 4) {
+                return Fail(error, "Netpbm 头无效或不是8位图像");
+            }
+            size_t offset = static_cast<size_t>(in.tellg());
+            size_t count = static_cast<size_t>(width) * height;
+            if (content.size() < offset + count * depth) {
+                return Fail(error, "图像数据不完整");
+            }
+            image = SoftwareImage(width, height);
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(content.data()) + offset;
+            for (size_t i = 0; i < count; ++i, src += depth) {
+                uint8_t* dst = image.pixels.data() + i * 4;
+                if (depth >= 3) {
+                    dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2];
+                    dst[3] = depth == 4 ? src[3] : 255;
+                } else {
+                    dst[0] = dst[1] = dst[2] = src[0];
+                    dst[3] = depth == 2 ? src[1] : 255;
+                }
+            }
+            return true;
+        }
+    }
+
+    bool DecodePng(const uint8_t* data, size_t size, SoftwareImage& image, std::string* error) {
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        if (size < 8 || std::memcmp(data, signature, 8) != 0) {
+            return Fail(error, "不是 PNG 文件");
+        }
+
+        uint32_t width = 0, height = 0;
+        int bitDepth = 0, colorType = -1, interlace = 0;
+        std::vector<uint8_t> compressed;
+        std::vector<uint8_t> palette(256 * 4, 255);
+        bool hasTransparentKey = false;
+        uint16_t transparentKey[3] = {};
+
+        size_t position = 8;
+        while (position + 12 <= size) {
+            uint32_t length = ReadBigEndian32(data + position);
+            const uint8_t* type = data + position + 4;
+            const uint8_t* payload = data + position + 8;
+            if (length > size - position - 12) {
+                return Fail(error, "PNG 数据块越界");
+            }
+            if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+                width = ReadBigEndian32(payload);
+                height = ReadBigEndian32(payload + 4);
+                bitDepth = payload[8];
+                colorType = payload[9];
+                interlace = payload[12];
+            } else if (std::memcmp(type, "PLTE", 4) == 0) {
+                for (uint32_t i = 0; i < length / 3 && i < 256; ++i) {
+                    std::memcpy(&palette[i * 4], payload + i * 3, 3);
+                }
+            } else if (std::memcmp(type, "tRNS", 4) == 0) {
+                if (colorType == 3) {
+                    for (uint32_t i = 0; i < length && i < 256; ++i) palette[i * 4 + 3] = payload[i];
+                } else if (colorType == 0 && length >= 2) {
+                    hasTransparentKey = true;
+                    transparentKey[0] = uint16_t(payload[0] << 8 | payload[1]);
+                } else if (colorType == 2 && length >= 6) {
+                    hasTransparentKey = true;
+                    for (int c = 0; c < 3; ++c) transparentKey[c] = uint16_t(payload[c * 2] << 8 | payload[c * 2 + 1]);
+                }
+            } else if (std::memcmp(type, "IDAT", 4) == 0) {
+                compressed.insert(compressed.end(), payload, payload + length);
+            } else if (std::memcmp(type, "IEND", 4) == 0) {
+                break;
+            }
+            position += 12 + length;
+        }
+
+        static const int channelsByType[7] = {1, 0, 3, 1, 2, 0, 4};
+        int channels = colorType >= 0 && colorType <= 6 ? channelsByType[colorType] : 0;
+        bool depthValid = bitDepth == 8 || bitDepth == 16 ||
+                          ((colorType == 0 || colorType == 3) && (bitDepth == 1 || bitDepth == 2 || bitDepth == 4));
+        if (width == 0 || height == 0 || width > 16384 || height > 16384 || channels == 0 || !depthValid ||
+            (colorType == 3 && bitDepth == 16)) {
+            return Fail(error, "不支持的 PNG 格式");
+        }
+        if (interlace != 0) {
+            return Fail(error, "不支持隔行扫描的 PNG");
+        }
+        if (compressed.size() < 2 || (compressed[0] & 0x0F) != 8) {
+            return Fail(error, "PNG 压缩数据无效");
+        }
+
+        std::vector<uint8_t> raw;
+        size_t bitsPerPixel = static_cast<size_t>(channels) * bitDepth;
+        size_t stride = (width * bitsPerPixel + 7) / 8;
+        raw.reserve((stride + 1) * height);
+        Inflater inflater(compressed.data() + 2, compressed.size() - 2, raw);
+        if (!inflater.Run() || raw.size() < (stride + 1) * height) {
+            return Fail(error, "PNG 解压失败");
+        }
+
+        // 反滤波：bpp 为一个像素的字节数，不足1字节按1计
+        size_t bpp = std::max<size_t>(1, bitsPerPixel / 8);
+        std::vector<uint8_t> previous(stride, 0);
+        image = SoftwareImage(static_cast<int>(width), static_cast<int>(height));
+        for (uint32_t y = 0; y < height; ++y) {
+            uint8_t filter = raw[y * (stride + 1)];
+            uint8_t* line = raw.data() + y * (stride + 1) + 1;
+            for (size_t i = 0; i < stride; ++i) {
+                int a = i >= bpp ? line[i - bpp] : 0;
+                int b = previous[i];
+                int c = i >= bpp ? previous[i - bpp] : 0;
+                switch (filter) {
+                    case 0: break;
+                    case 1: line[i] = uint8_t(line[i] + a); break;
+                    case 2: line[i] = uint8_t(line[i] + b); break;
+                    case 3: line[i] = uint8_t(line[i] + ((a + b) >> 1)); break;
+                    case 4: line[i] = uint8_t(line[i] + Paeth(a, b, c)); break;
+                    default: return Fail(error, "PNG 滤波类型无效");
+                }
+            }
+            std::memcpy(previous.data(), line, stride);
+
+            uint8_t* out = image.Row(static_cast<int>(y));
+            for (uint32_t x = 0; x < width; ++x, out += 4) {
+                // 取第 x 个像素的第 c 个通道，16 位取高字节，不足8位的按比例扩展
+                auto sample = [&](int c) -> uint16_t {
+                    if (bitDepth == 16) {
+                        const uint8_t* p = line + (x * channels + c) * 2;
+                        return uint16_t(p[0] << 8 | p[1]);
+                    }
+                    if (bitDepth == 8) return line[x * channels + c];
+                    size_t bit = static_cast<size_t>(x) * bitDepth;
+                    return uint16_t((line[bit / 8] >> (8 - bitDepth - bit % 8)) & ((1 << bitDepth) - 1));
+                };
+                auto to8 = [&](uint16_t v) -> uint8_t {
+                    if (bitDepth == 16) return uint8_t(v >> 8);
+                    if (bitDepth == 8) return uint8_t(v);
+                    return uint8_t(v * 255 / ((1 << bitDepth) - 1));
+                };
+                switch (colorType) {
+                    case 0: {
+                        uint16_t v = sample(0);
+                        out[0] = out[1] = out[2] = to8(v);
+                        out[3] = hasTransparentKey && v == transparentKey[0] ? 0 : 255;
+                        break;
+                    }
+                    case 2: {
+                        uint16_t r = sample(0), g = sample(1), b = sample(2);
+                        out[0] = to8(r); out[1] = to8(g); out[2] = to8(b);
+                        out[3] = hasTransparentKey && r == transparentKey[0] && g == transparentKey[1] &&
+                                 b == transparentKey[2] ? 0 : 255;
+                        break;
+                    }
+                    case 3:
+                        std::memcpy(out, &palette[sample(0) * 4], 4);
+                        break;
+                    case 4:
+                        out[0] = out[1] = out[2] = to8(sample(0));
+                        out[3] = to8(sample(1));
+                        break;
+                    case 6:
+                        out[0] = to8(sample(0)); out[1] = to8(sample(1));
+                        out[2] = to8(sample(2)); out[3] = to8(sample(3));
+                        break;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool LoadImageFile(const std::string& path, SoftwareImage& image, std::string* error) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return Fail(error, "无法打开 " + path);
+        }
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (content.size() >= 8 && static_cast<uint8_t>(content[0]) == 0x89 && content.compare(1, 3, "PNG") == 0) {
+            return DecodePng(reinterpret_cast<const uint8_t*>(content.data()), content.size(), image, error);
+        }
+        return LoadNetpbm(content, image, error);
+    }
+
+    bool SavePng(const std::string& path, const SoftwareImage& image) {
+        // 每行前加滤波类型0，整体放进不压缩的 deflate 块（每块最多 65535 字节）
+        std::string raw;
+        size_t stride = static_cast<size_t>(image.width) * 4;
+        raw.reserve((stride + 1) * image.height);
+        for (int y = 0; y < image.height; ++y) {
+            raw += '\0';
+            raw.append(reinterpret_cast<const char*>(image.Row(y)), stride);
+        }
+
+        std::string zlib = "\x78\x01";
+        for (size_t offset = 0; offset < raw.size() || offset == 0; offset += 65535) {
+            size_t length = std::min<size_t>(65535, raw.size() - offset);
+            bool last = offset + length >= raw.size();
+            zlib += static_cast<char>(last ? 1 : 0);
+            zlib += static_cast<char>(length & 0xFF);
+            zlib += static_cast<char>(length >> 8);
+            zlib += static_cast<char>(~length & 0xFF);
+            zlib += static_cast<char>((~length >> 8) & 0xFF);
+            zlib.append(raw, offset, length);
+            if (last) break;
+        }
+        uint32_t a = 1, b = 0;
+        for (unsigned char c : raw) {
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+        WriteBigEndian32(zlib, (b << 16) | a);
+
+        std::string header;
+        WriteBigEndian32(header, static_cast<uint32_t>(image.width));
+        WriteBigEndian32(header, static_cast<uint32_t>(image.height));
+        header += "\x08\x06";       // 8位 RGBA
+        header += std::string(3, '\0');
+
+        std::string png("\x89PNG\r\n\x1A\n", 8);
+        WriteChunk(png, "IHDR", header);
+        WriteChunk(png, "IDAT", zlib);
+        WriteChunk(png, "IEND", std::string());
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(png.data(), static_cast<std::streamsize>(png.size()));
+        return static_cast<bool>(file);
+    }
+
+    bool SavePam(const std::string& path, const SoftwareImage& image) {
+        std::ofstream file(path, std::ios::binary);
+        file << "P7\nWIDTH " << image.width << "\nHEIGHT " << image.height
+             << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+        file.write(reinterpret_cast<const char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+        return static_cast<bool>(file);
+    }
+
+    bool SaveImageFile(const std::string& path, const SoftwareImage& image) {
+        if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".pam") == 0) {
+            return SavePam(path, image);
+        }
+        return SavePng(path, image);
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,194 @@
+#include "Localization.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace VisualNovel {
+
+    namespace {
+        const uint64_t kFnvOffset = 1469598103934665603ull;
+        const uint64_t kFnvPrime = 1099511628211ull;
+
+        uint64_t Fnv1a(uint64_t hash, std::string_view text) {
+            for (unsigned char c : text) {
+                hash ^= c;
+                hash *= kFnvPrime;
+            }
+            return hash;
+        }
+
+        uint64_t Separate(uint64_t hash) {
+            // 字段之间插入 0x1F，避免 ("ab","c") 与 ("a","bc") 得到同一个 ID
+            hash ^= 0x1F;
+            return hash * kFnvPrime;
+        }
+    }
+
+    // ==================== StringTable ====================
+
+    StringTable::StringTable()
+        : entries(nullptr), text(nullptr), entryCount(0), textBytes(0) {
+    }
+
+    bool StringTable::Open(const std::string& path) {
+        Close();
+        if (!file.Open(path)) {
+            return false;
+        }
+
+        const char* data = file.GetData();
+        size_t size = file.GetSize();
+        StringTableHeader header;
+        if (size < sizeof(header)) {
+            Close();
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        uint64_t expected = sizeof(header) + static_cast<uint64_t>(header.entryCount) * sizeof(StringTableEntry) +
+                            header.textBytes;
+        if (std::memcmp(header.magic, "VNST", 4) != 0 || header.version != kVersion || expected > size) {
+            std::cerr << "[本地化] 语言表格式不正确: " << path << std::endl;
+            Close();
+            return false;
+        }
+
+        entries = reinterpret_cast<const StringTableEntry*>(data + sizeof(header));
+        entryCount = header.entryCount;
+        text = data + sizeof(header) + static_cast<size_t>(header.entryCount) * sizeof(StringTableEntry);
+        textBytes = header.textBytes;
+        language.assign(header.language, std::find(header.language, header.language + sizeof(header.language), '\0'));
+        return true;
+    }
+
+    void StringTable::Close() {
+        file.Close();
+        entries = nullptr;
+        text = nullptr;
+        entryCount = 0;
+        textBytes = 0;
+        language.clear();
+    }
+
+    void StringTable::Swap(StringTable& other) {
+        file.Swap(other.file);
+        std::swap(entries, other.entries);
+        std::swap(text, other.text);
+        std::swap(entryCount, other.entryCount);
+        std::swap(textBytes, other.textBytes);
+        language.swap(other.language);
+    }
+
+    std::string_view StringTable::Find(uint64_t id) const {
+        const StringTableEntry* end = entries + entryCount;
+        const StringTableEntry* it = std::lower_bound(entries, end, id,
+            [](const StringTableEntry& entry, uint64_t key) { return entry.id < key; });
+        if (it == end || it->id != id) {
+            return std::string_view();
+        }
+        // 条目在第一次被访问时才检查范围，打开大表不需要扫描全部条目
+        if (static_cast<uint64_t>(it->offset) + it->length > textBytes) {
+            return std::string_view();
+        }
+        return std::string_view(text + it->offset, it->length);
+    }
+
+    bool StringTable::Write(const std::string& path, const std::string& languageCode,
+                            std::vector<std::pair<uint64_t, std::string>> items) {
+        std::stable_sort(items.begin(), items.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+        items.erase(std::unique(items.begin(), items.end(),
+            [](const auto& a, const auto& b) { return a.first == b.first; }), items.end());
+
+        std::vector<StringTableEntry> tableEntries;
+        std::string blob;
+        tableEntries.reserve(items.size());
+        for (const auto& item : items) {
+            tableEntries.push_back({item.first, static_cast<uint32_t>(blob.size()),
+                                    static_cast<uint32_t>(item.second.size())});
+            blob += item.second;
+        }
+
+        StringTableHeader header = {};
+        std::memcpy(header.magic, "VNST", 4);
+        header.version = kVersion;
+        header.entryCount = static_cast<uint32_t>(tableEntries.size());
+        header.textBytes = blob.size();
+        std::memcpy(header.language, languageCode.data(), std::min(languageCode.size(), sizeof(header.language)));
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(tableEntries.data()),
+                  static_cast<std::streamsize>(tableEntries.size() * sizeof(StringTableEntry)));
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+        return static_cast<bool>(out);
+    }
+
+    uint64_t StringTable::MakeTextId(std::string_view section, std::string_view character, std::string_view source) {
+        uint64_t hash = Fnv1a(kFnvOffset, section);
+        hash = Fnv1a(Separate(hash), character);
+        hash = Fnv1a(Separate(hash), source);
+        return hash ? hash : 1;  // 0 表示“没有 ID”
+    }
+
+    uint64_t StringTable::MakeExplicitId(std::string_view name) {
+        uint64_t hash = Fnv1a(Fnv1a(kFnvOffset, "id:"), name);
+        return hash ? hash : 1;
+    }
+
+    // ==================== Localization ====================
+
+    Localization::Localization()
+        : directory("data/lang"), generation(0), hasRequest(false) {
+    }
+
+    Localization& Localization::Instance() {
+        static Localization instance;
+        return instance;
+    }
+
+    void Localization::SetDirectory(const std::string& path) {
+        directory = path;
+    }
+
+    bool Localization::SetLanguage(const std::string& languageCode) {
+        if (languageCode.empty()) {
+            table.Close();
+            ++generation;
+            return true;
+        }
+
+        StringTable next;
+        if (!next.Open(directory + "/" + languageCode + ".vnst")) {
+            std::cerr << "[本地化] 找不到语言表: " << languageCode << std::endl;
+            return false;
+        }
+        // 新表打开成功后再替换，旧表随 next 一起关闭，内存中始终只保留当前语言
+        table.Swap(next);
+        ++generation;
+        return true;
+    }
+
+    void Localization::RequestLanguage(const std::string& languageCode) {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        requestedLanguage = languageCode;
+        hasRequest.store(true, std::memory_order_release);
+    }
+
+    bool Localization::ApplyPendingLanguage() {
+        if (!hasRequest.load(std::memory_order_acquire)) {
+            return false;
+        }
+        std::string languageCode;
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            languageCode.swap(requestedLanguage);
+            hasRequest.store(false, std::memory_order_relaxed);
+        }
+        return SetLanguage(languageCode);
+    }
+
+} // namespace VisualNovel
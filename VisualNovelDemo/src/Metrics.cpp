@@ -0,0 +1,333 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include "AllocationCounter.h"
+
+namespace VisualNovel {
+
+    namespace {
+        uint64_t NowNs() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        const char* const kCommandNames[EngineMetrics::kCommandTypeCount] = {
+            "DIALOGUE", "JUMP", "LABEL", "CONDITION", "CHOICE", "SET_VARIABLE", "SET_FLAG",
+            "PLAY_SOUND", "PLAY_BGM", "STOP_BGM", "SHOW_CHARACTER", "HIDE_CHARACTER",
+            "CHANGE_BACKGROUND", "WAIT", "ANIMATION", "SPECIAL_EFFECT", "CALL", "RETURN", "END"
+        };
+
+        // 计时器占用连续三个槽位
+        const size_t kTimerCount = 0;
+        const size_t kTimerTotal = 1;
+        const size_t kTimerMax = 2;
+    }
+
+    // 线程退出时把分片交还给注册表
+    struct MetricsShardHandle {
+        MetricsRegistry::Shard* shard = nullptr;
+
+        ~MetricsShardHandle() {
+            if (shard) {
+                MetricsRegistry::Instance().ReleaseShard(shard);
+            }
+        }
+    };
+
+    namespace {
+        thread_local MetricsShardHandle threadShard;
+    }
+
+    // ==================== MetricsRegistry ====================
+
+    MetricsRegistry::Shard::Shard() {
+        for (auto& slot : slots) {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    MetricsRegistry::MetricsRegistry()
+        : nextSlot(0), nextGauge(0), dumpStopping(false) {
+        for (size_t i = 0; i < kMaxSlots; ++i) {
+            retired[i] = 0;
+            gauges[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    MetricsRegistry::~MetricsRegistry() {
+        StopPeriodicDump();
+    }
+
+    MetricsRegistry& MetricsRegistry::Instance() {
+        static MetricsRegistry instance;
+        return instance;
+    }
+
+    MetricId MetricsRegistry::Register(const std::string& name, MetricKind kind) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto existing = metricIndex.find(name);
+        if (existing != metricIndex.end()) {
+            const MetricInfo& info = metrics[existing->second];
+            if (info.kind != kind) {
+                throw std::invalid_argument("指标类型不一致: " + name);
+            }
+            return info.id;
+        }
+
+        size_t id;
+        if (kind == MetricKind::GAUGE) {
+            if (nextGauge >= kMaxSlots) throw std::length_error("仪表数量超出上限: " + name);
+            id = nextGauge++;
+        } else {
+            size_t width = kind == MetricKind::TIMER ? 3 : 1;
+            if (nextSlot + width > kMaxSlots) throw std::length_error("计数器数量超出上限: " + name);
+            id = nextSlot;
+            nextSlot += width;
+        }
+
+        metricIndex[name] = metrics.size();
+        metrics.push_back({name, kind, static_cast<MetricId>(id)});
+        return static_cast<MetricId>(id);
+    }
+
+    MetricId MetricsRegistry::RegisterCounter(const std::string& name) {
+        return Register(name, MetricKind::COUNTER);
+    }
+
+    MetricId MetricsRegistry::RegisterGauge(const std::string& name) {
+        return Register(name, MetricKind::GAUGE);
+    }
+
+    MetricId MetricsRegistry::RegisterTimer(const std::string& name) {
+        return Register(name, MetricKind::TIMER);
+    }
+
+    bool MetricsRegistry::FindMetric(const std::string& name, MetricId& id, MetricKind& kind) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = metricIndex.find(name);
+        if (it == metricIndex.end()) {
+            return false;
+        }
+        id = metrics[it->second].id;
+        kind = metrics[it->second].kind;
+        return true;
+    }
+
+    MetricsRegistry::Shard& MetricsRegistry::GetThreadShard() {
+        if (!threadShard.shard) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!freeShards.empty()) {
+                threadShard.shard = freeShards.back();
+                freeShards.pop_back();
+            } else {
+                shards.push_back(std::unique_ptr<Shard>(new Shard()));
+                threadShard.shard = shards.back().get();
+            }
+        }
+        return *threadShard.shard;
+    }
+
+    void MetricsRegistry::ReleaseShard(Shard* shard) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t values[kMaxSlots];
+        for (size_t i = 0; i < kMaxSlots; ++i) {
+            values[i] = shard->slots[i].exchange(0, std::memory_order_relaxed);
+        }
+        // 计时器的最大值槽位取最大，其他槽位累加
+        for (const MetricInfo& info : metrics) {
+            if (info.kind == MetricKind::TIMER) {
+                size_t slot = info.id + kTimerMax;
+                retired[slot] = std::max(retired[slot], values[slot]);
+                values[slot] = 0;
+            }
+        }
+        for (size_t i = 0; i < kMaxSlots; ++i) {
+            retired[i] += values[i];
+        }
+        freeShards.push_back(shard);
+    }
+
+    void MetricsRegistry::RecordTime(MetricId timer, uint64_t durationNs) {
+        Shard& shard = GetThreadShard();
+        std::atomic<uint64_t>& count = shard.slots[timer + kTimerCount];
+        std::atomic<uint64_t>& total = shard.slots[timer + kTimerTotal];
+        std::atomic<uint64_t>& max = shard.slots[timer + kTimerMax];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        total.store(total.load(std::memory_order_relaxed) + durationNs, std::memory_order_relaxed);
+        if (durationNs > max.load(std::memory_order_relaxed)) {
+            max.store(durationNs, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t MetricsRegistry::SumSlot(size_t slot) const {
+        uint64_t sum = retired[slot];
+        for (const auto& shard : shards) {
+            sum += shard->slots[slot].load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    uint64_t MetricsRegistry::GetCounter(MetricId counter) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return SumSlot(counter);
+    }
+
+    int64_t MetricsRegistry::GetGauge(MetricId gauge) const {
+        return gauges[gauge].load(std::memory_order_relaxed);
+    }
+
+    TimerStats MetricsRegistry::GetTimer(MetricId timer) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        TimerStats stats;
+        stats.count = SumSlot(timer + kTimerCount);
+        stats.totalNs = SumSlot(timer + kTimerTotal);
+        stats.maxNs = retired[timer + kTimerMax];
+        for (const auto& shard : shards) {
+            stats.maxNs = std::max(stats.maxNs, shard->slots[timer + kTimerMax].load(std::memory_order_relaxed));
+        }
+        return stats;
+    }
+
+    std::vector<MetricSample> MetricsRegistry::GetSnapshot() const {
+        std::vector<MetricInfo> infos;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            infos = metrics;
+        }
+
+        std::vector<MetricSample> samples;
+        samples.reserve(infos.size());
+        for (const MetricInfo& info : infos) {
+            MetricSample sample;
+            sample.name = info.name;
+            sample.kind = info.kind;
+            switch (info.kind) {
+                case MetricKind::COUNTER: sample.counter = GetCounter(info.id); break;
+                case MetricKind::GAUGE: sample.gauge = GetGauge(info.id); break;
+                case MetricKind::TIMER: sample.timer = GetTimer(info.id); break;
+            }
+            samples.push_back(sample);
+        }
+        std::sort(samples.begin(), samples.end(), [](const MetricSample& a, const MetricSample& b) {
+            return a.name < b.name;
+        });
+        return samples;
+    }
+
+    void MetricsRegistry::WriteJson(std::ostream& out) const {
+        std::vector<MetricSample> samples = GetSnapshot();
+        long long timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        out << std::fixed << std::setprecision(3);
+        out << "{\"timestamp_ms\":" << timestamp << ",\"metrics\":{";
+        for (size_t i = 0; i < samples.size(); ++i) {
+            const MetricSample& s = samples[i];
+            out << (i ? "," : "") << "\"" << s.name << "\":";
+            switch (s.kind) {
+                case MetricKind::COUNTER: out << s.counter; break;
+                case MetricKind::GAUGE: out << s.gauge; break;
+                case MetricKind::TIMER:
+                    out << "{\"count\":" << s.timer.count << ",\"avg_ms\":" << s.timer.AverageMs()
+                        << ",\"max_ms\":" << s.timer.maxNs / 1e6 << "}";
+                    break;
+            }
+        }
+        out << "}}\n";
+    }
+
+    void MetricsRegistry::StartPeriodicDump(const std::string& path, double intervalSeconds) {
+        StopPeriodicDump();
+        {
+            std::lock_guard<std::mutex> lock(dumpMutex);
+            dumpStopping = false;
+        }
+        auto interval = std::chrono::milliseconds(static_cast<long long>(std::max(0.01, intervalSeconds) * 1000));
+        dumpThread = std::thread([this, path, interval]() {
+            std::ofstream file(path, std::ios::app);
+            if (!file) {
+                std::cerr << "无法写入指标文件: " << path << std::endl;
+                return;
+            }
+            std::unique_lock<std::mutex> lock(dumpMutex);
+            while (!dumpSignal.wait_for(lock, interval, [this]() { return dumpStopping; })) {
+                WriteJson(file);
+                file.flush();
+            }
+        });
+    }
+
+    void MetricsRegistry::StopPeriodicDump() {
+        {
+            std::lock_guard<std::mutex> lock(dumpMutex);
+            dumpStopping = true;
+        }
+        dumpSignal.notify_all();
+        if (dumpThread.joinable()) {
+            dumpThread.join();
+        }
+    }
+
+    // ==================== ScopedMetricTimer ====================
+
+    ScopedMetricTimer::ScopedMetricTimer(MetricId timerId)
+        : timer(timerId), startNs(NowNs()) {
+    }
+
+    ScopedMetricTimer::~ScopedMetricTimer() {
+        MetricsRegistry::Instance().RecordTime(timer, NowNs() - startNs);
+    }
+
+    // ==================== EngineMetrics ====================
+
+    EngineMetrics::EngineMetrics() {
+        MetricsRegistry& registry = MetricsRegistry::Instance();
+        for (size_t i = 0; i < kCommandTypeCount; ++i) {
+            commandsExecuted[i] = registry.RegisterCounter(std::string("script.commands.") + kCommandNames[i]);
+        }
+        labelJumps = registry.RegisterCounter("script.label_jumps");
+        conditionEvaluations = registry.RegisterCounter("script.condition_evaluations");
+        scriptLinesParsed = registry.RegisterCounter("script.lines_parsed");
+        historySize = registry.RegisterGauge("dialogue.history_size");
+        liveSprites = registry.RegisterGauge("renderer.live_sprites");
+        assetCacheHits = registry.RegisterCounter("assets.cache_hits");
+        assetCacheMisses = registry.RegisterCounter("assets.cache_misses");
+        assetBytes = registry.RegisterGauge("assets.cached_bytes");
+        saveLatency = registry.RegisterTimer("save.save_latency");
+        loadLatency = registry.RegisterTimer("save.load_latency");
+        frameAllocations = registry.RegisterGauge("frame.allocations");
+        frameAllocatedBytes = registry.RegisterGauge("frame.allocated_bytes");
+        frames = registry.RegisterCounter("frame.count");
+    }
+
+    const EngineMetrics& EngineMetrics::Get() {
+        static const EngineMetrics instance;
+        return instance;
+    }
+
+    // ==================== FrameAllocationTracker ====================
+
+    FrameAllocationTracker::FrameAllocationTracker()
+        : startAllocations(0), startBytes(0) {
+    }
+
+    void FrameAllocationTracker::BeginFrame() {
+        AllocationCounter::Snapshot snapshot = AllocationCounter::GetThreadSnapshot();
+        startAllocations = snapshot.allocations;
+        startBytes = snapshot.bytes;
+    }
+
+    void FrameAllocationTracker::EndFrame() {
+        AllocationCounter::Snapshot snapshot = AllocationCounter::GetThreadSnapshot();
+        const EngineMetrics& m = EngineMetrics::Get();
+        MetricsRegistry& registry = MetricsRegistry::Instance();
+        registry.SetGauge(m.frameAllocations, static_cast<int64_t>(snapshot.allocations - startAllocations));
+        registry.SetGauge(m.frameAllocatedBytes, static_cast<int64_t>(snapshot.bytes - startBytes));
+        registry.Increment(m.frames);
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,330 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace VisualNovel {
+
+    // 线程退出时把缓冲区交还给追踪器
+    struct TraceBufferHandle {
+        TraceBuffer* buffer = nullptr;
+
+        ~TraceBufferHandle() {
+            if (buffer) {
+                Profiler::Instance().ReleaseBuffer(buffer);
+            }
+        }
+    };
+
+    namespace {
+        // 每个线程各子系统的区域嵌套深度，用于只累计最外层区域
+        thread_local uint32_t zoneDepth[kTraceSubsystemCount] = {};
+        thread_local TraceBufferHandle threadBuffer;
+
+        const uint64_t kDumpIntervalNs = 1000000000ull;
+
+        uint32_t ToMicroseconds(uint64_t ns) {
+            return static_cast<uint32_t>(std::min<uint64_t>(ns / 1000, UINT32_MAX));
+        }
+
+        void WriteJsonString(std::ostream& out, const char* text) {
+            out << '"';
+            for (const char* c = text ? text : ""; *c; ++c) {
+                if (*c == '"' || *c == '\\') out << '\\';
+                out << *c;
+            }
+            out << '"';
+        }
+    }
+
+    const double FrameHistogram::kBucketLimitsMs[FrameHistogram::kBucketCount - 1] = {
+        0.5, 1.0, 2.0, 4.0, 8.0, 16.0, 33.0
+    };
+
+    // ==================== TraceBuffer ====================
+
+    TraceBuffer::TraceBuffer(uint32_t index)
+        : slots(new Slot[kCapacity]), head(0), threadIndex(index) {
+    }
+
+    void TraceBuffer::Push(const char* name, TraceSubsystem subsystem, uint64_t startNs, uint64_t durationNs) {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        // 读取方看到本条数据时必然也能看到之前发布的 head，从而识别出被覆盖的槽位
+        std::atomic_thread_fence(std::memory_order_release);
+        Slot& slot = slots[index & (kCapacity - 1)];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.startNs.store(startNs, std::memory_order_relaxed);
+        slot.durationNs.store(durationNs, std::memory_order_relaxed);
+        slot.subsystem.store(static_cast<uint8_t>(subsystem), std::memory_order_relaxed);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    void TraceBuffer::Snapshot(std::vector<TraceEvent>& out) const {
+        uint64_t end = head.load(std::memory_order_acquire);
+        uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+
+        size_t first = out.size();
+        for (uint64_t i = begin; i < end; ++i) {
+            const Slot& slot = slots[i & (kCapacity - 1)];
+            TraceEvent event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.startNs = slot.startNs.load(std::memory_order_relaxed);
+            event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+            event.subsystem = static_cast<TraceSubsystem>(slot.subsystem.load(std::memory_order_relaxed));
+            event.threadIndex = threadIndex;
+            out.push_back(event);
+        }
+
+        // 复制期间写入方可能已经绕回，正在写的那一条也不可信
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = head.load(std::memory_order_relaxed);
+        uint64_t validBegin = after + 1 > kCapacity ? after + 1 - kCapacity : 0;
+        if (validBegin > begin) {
+            size_t drop = static_cast<size_t>(std::min(validBegin - begin, end - begin));
+            out.erase(out.begin() + first, out.begin() + first + drop);
+        }
+    }
+
+    // ==================== Profiler ====================
+
+    std::atomic<bool> Profiler::enabled(false);
+
+    Profiler::Profiler()
+        : frameStartNs(0), frameIndex(0), historyCursor(0), historySize(0),
+          frameBudgetNs(0), lastDumpNs(0) {
+        for (auto& accum : frameAccumNs) {
+            accum.store(0, std::memory_order_relaxed);
+        }
+        for (auto& history : historyUs) {
+            history.assign(kWindowFrames, 0);
+        }
+        frameHistoryUs.assign(kWindowFrames, 0);
+    }
+
+    Profiler& Profiler::Instance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    void Profiler::SetEnabled(bool value) {
+        enabled.store(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Profiler::NowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    TraceBuffer& Profiler::GetThreadBuffer() {
+        if (!threadBuffer.buffer) {
+            // 线程第一次记录时领取。回收的缓冲区保留上一个线程的记录，直到被新记录覆盖，
+            // 所以导出时仍能看到已结束线程的记录；追踪中的线程号对应缓冲区，先后的线程可能共用
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            if (!freeBuffers.empty()) {
+                threadBuffer.buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+            } else {
+                buffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(static_cast<uint32_t>(buffers.size()))));
+                threadBuffer.buffer = buffers.back().get();
+            }
+        }
+        return *threadBuffer.buffer;
+    }
+
+    void Profiler::ReleaseBuffer(TraceBuffer* buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        freeBuffers.push_back(buffer);
+    }
+
+    size_t Profiler::GetBufferCount() const {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        return buffers.size();
+    }
+
+    void Profiler::Record(const char* name, TraceSubsystem subsystem, uint64_t startNs, uint64_t endNs, bool outermost) {
+        uint64_t duration = endNs - startNs;
+        GetThreadBuffer().Push(name, subsystem, startNs, duration);
+        if (outermost) {
+            frameAccumNs[static_cast<size_t>(subsystem)].fetch_add(duration, std::memory_order_relaxed);
+        }
+    }
+
+    void Profiler::BeginFrame() {
+        frameStartNs = NowNs();
+    }
+
+    void Profiler::EndFrame() {
+        if (!IsEnabled() || frameStartNs == 0) {
+            return;
+        }
+
+        uint64_t now = NowNs();
+        uint64_t frameNs = now - frameStartNs;
+        GetThreadBuffer().Push("Frame", TraceSubsystem::ENGINE, frameStartNs, frameNs);
+        ++frameIndex;
+
+        {
+            std::lock_guard<std::mutex> lock(historyMutex);
+            for (size_t s = 0; s < kTraceSubsystemCount; ++s) {
+                historyUs[s][historyCursor] = ToMicroseconds(frameAccumNs[s].exchange(0, std::memory_order_relaxed));
+            }
+            frameHistoryUs[historyCursor] = ToMicroseconds(frameNs);
+            historyCursor = (historyCursor + 1) % kWindowFrames;
+            historySize = std::min(historySize + 1, kWindowFrames);
+        }
+
+        uint64_t budget = frameBudgetNs.load(std::memory_order_relaxed);
+        if (budget > 0 && frameNs > budget && !overBudgetPath.empty() && now - lastDumpNs > kDumpIntervalNs) {
+            lastDumpNs = now;
+            if (DumpChromeTrace(overBudgetPath)) {
+                std::cerr << "[性能] 第 " << frameIndex << " 帧耗时 " << frameNs / 1000000.0
+                          << "ms，追踪已写入 " << overBudgetPath << std::endl;
+            }
+        }
+    }
+
+    void Profiler::SetFrameBudget(double budgetMs, const std::string& path) {
+        overBudgetPath = path;
+        frameBudgetNs.store(static_cast<uint64_t>(std::max(0.0, budgetMs) * 1e6), std::memory_order_relaxed);
+    }
+
+    void Profiler::WriteChromeTrace(std::ostream& out) {
+        std::vector<TraceEvent> events;
+        size_t threadCount;
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            threadCount = buffers.size();
+            for (const auto& buffer : buffers) {
+                buffer->Snapshot(events);
+            }
+        }
+        std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+            return a.startNs < b.startNs;
+        });
+
+        uint64_t base = events.empty() ? 0 : events.front().startNs;
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        for (size_t t = 0; t < threadCount; ++t) {
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+                << ",\"args\":{\"name\":\"thread " << t << "\"}},\n";
+        }
+        for (size_t i = 0; i < events.size(); ++i) {
+            const TraceEvent& e = events[i];
+            out << "{\"name\":";
+            WriteJsonString(out, e.name);
+            out << ",\"cat\":\"" << GetSubsystemName(e.subsystem) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << e.threadIndex << ",\"ts\":" << (e.startNs - base) / 1000.0
+                << ",\"dur\":" << e.durationNs / 1000.0 << "}" << (i + 1 < events.size() ? ",\n" : "\n");
+        }
+        out << "]}\n";
+    }
+
+    bool Profiler::DumpChromeTrace(const std::string& path) {
+        std::ofstream file(path);
+        if (!file) {
+            std::cerr << "无法写入追踪文件: " << path << std::endl;
+            return false;
+        }
+        WriteChromeTrace(file);
+        return true;
+    }
+
+    FrameHistogram Profiler::BuildHistogram(const std::vector<uint32_t>& samples) const {
+        FrameHistogram histogram;
+        histogram.frames = static_cast<uint32_t>(samples.size());
+        if (samples.empty()) {
+            return histogram;
+        }
+
+        double total = 0.0;
+        for (uint32_t us : samples) {
+            double ms = us / 1000.0;
+            total += ms;
+            size_t bucket = 0;
+            while (bucket < FrameHistogram::kBucketCount - 1 && ms >= FrameHistogram::kBucketLimitsMs[bucket]) {
+                ++bucket;
+            }
+            ++histogram.buckets[bucket];
+        }
+
+        std::vector<uint32_t> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+            return sorted[index] / 1000.0;
+        };
+        histogram.averageMs = total / static_cast<double>(samples.size());
+        histogram.p50Ms = percentile(0.50);
+        histogram.p95Ms = percentile(0.95);
+        histogram.p99Ms = percentile(0.99);
+        histogram.maxMs = sorted.back() / 1000.0;
+        return histogram;
+    }
+
+    FrameHistogram Profiler::GetHistogram(TraceSubsystem subsystem) const {
+        std::vector<uint32_t> samples;
+        {
+            std::lock_guard<std::mutex> lock(historyMutex);
+            const std::vector<uint32_t>& history = historyUs[static_cast<size_t>(subsystem)];
+            samples.assign(history.begin(), history.begin() + historySize);
+        }
+        return BuildHistogram(samples);
+    }
+
+    FrameHistogram Profiler::GetFrameHistogram() const {
+        std::vector<uint32_t> samples;
+        {
+            std::lock_guard<std::mutex> lock(historyMutex);
+            samples.assign(frameHistoryUs.begin(), frameHistoryUs.begin() + historySize);
+        }
+        return BuildHistogram(samples);
+    }
+
+    void Profiler::PrintSummary(std::ostream& out) const {
+        auto printRow = [&out](const char* name, const FrameHistogram& h) {
+            out << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+                << std::setw(10) << h.averageMs << std::setw(10) << h.p50Ms << std::setw(10) << h.p95Ms
+                << std::setw(10) << h.p99Ms << std::setw(10) << h.maxMs << "\n";
+        };
+
+        FrameHistogram frame = GetFrameHistogram();
+        out << "最近 " << frame.frames << " 帧（毫秒）\n";
+        out << std::left << std::setw(10) << "子系统" << std::right << std::setw(10) << "平均"
+            << std::setw(10) << "p50" << std::setw(10) << "p95" << std::setw(10) << "p99" << std::setw(10) << "最大"
+            << "\n";
+        printRow("frame", frame);
+        for (size_t s = 0; s < kTraceSubsystemCount; ++s) {
+            TraceSubsystem subsystem = static_cast<TraceSubsystem>(s);
+            printRow(GetSubsystemName(subsystem), GetHistogram(subsystem));
+        }
+    }
+
+    const char* Profiler::GetSubsystemName(TraceSubsystem subsystem) {
+        switch (subsystem) {
+            case TraceSubsystem::ENGINE: return "engine";
+            case TraceSubsystem::SCRIPT: return "script";
+            case TraceSubsystem::DIALOGUE: return "dialogue";
+            case TraceSubsystem::RENDERER: return "renderer";
+            case TraceSubsystem::ASSETS: return "assets";
+            case TraceSubsystem::CALLBACK: return "callback";
+            default: return "unknown";
+        }
+    }
+
+    // ==================== TraceZone ====================
+
+    void TraceZone::Begin() {
+        outermost = zoneDepth[static_cast<size_t>(subsystem)]++ == 0;
+        startNs = Profiler::NowNs();
+    }
+
+    void TraceZone::End() {
+        uint64_t endNs = Profiler::NowNs();
+        --zoneDepth[static_cast<size_t>(subsystem)];
+        Profiler::Instance().Record(name, subsystem, startNs, endNs, outermost);
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,65 @@
+#include "SceneArena.h"
+
+namespace VisualNovel {
+
+    // ==================== ChunkCache ====================
+
+    ChunkCache::ChunkCache(size_t maxCached, std::pmr::memory_resource* upstreamResource)
+        : upstream(upstreamResource), cachedBytes(0), maxCachedBytes(maxCached), outstandingBytes(0) {
+    }
+
+    ChunkCache::~ChunkCache() {
+        Trim();
+    }
+
+    void ChunkCache::Trim() {
+        for (const Chunk& chunk : freeChunks) {
+            upstream->deallocate(chunk.pointer, chunk.bytes, chunk.alignment);
+        }
+        freeChunks.clear();
+        cachedBytes = 0;
+    }
+
+    void* ChunkCache::do_allocate(size_t bytes, size_t alignment) {
+        // 单调缓冲区的块大小按固定倍数增长，同样的场景会申请同样的序列，精确匹配即可
+        for (size_t i = freeChunks.size(); i-- > 0;) {
+            if (freeChunks[i].bytes == bytes && freeChunks[i].alignment == alignment) {
+                void* pointer = freeChunks[i].pointer;
+                freeChunks[i] = freeChunks.back();
+                freeChunks.pop_back();
+                cachedBytes -= bytes;
+                outstandingBytes += bytes;
+                return pointer;
+            }
+        }
+        void* pointer = upstream->allocate(bytes, alignment);
+        outstandingBytes += bytes;
+        return pointer;
+    }
+
+    void ChunkCache::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+        outstandingBytes -= bytes;
+        if (cachedBytes + bytes > maxCachedBytes) {
+            upstream->deallocate(pointer, bytes, alignment);
+            return;
+        }
+        freeChunks.push_back({pointer, bytes, alignment});
+        cachedBytes += bytes;
+    }
+
+    bool ChunkCache::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    // ==================== SceneArena ====================
+
+    SceneArena::SceneArena(size_t initialChunkBytes)
+        : cache(), resource(initialChunkBytes, &cache), generation(0) {
+    }
+
+    void SceneArena::Reset() {
+        resource.release();
+        ++generation;
+    }
+
+} // namespace VisualNovel
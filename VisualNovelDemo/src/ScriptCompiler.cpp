@@ -0,0 +1,440 @@
+#include "ScriptCompiler.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include "ScriptParser.h"
+
+namespace VisualNovel {
+
+    namespace {
+        std::string_view Trim(std::string_view text) {
+            size_t begin = text.find_first_not_of(" \t");
+            if (begin == std::string_view::npos) return std::string_view();
+            size_t end = text.find_last_not_of(" \t");
+            return text.substr(begin, end - begin + 1);
+        }
+
+        // 与解释器的数值规则一致：整个字符串都是数字才算数值
+        bool ParseNumber(const std::string& text, double& value) {
+            if (text.empty()) return false;
+            char* end = nullptr;
+            value = std::strtod(text.c_str(), &end);
+            return end == text.c_str() + text.size();
+        }
+
+        bool IsTruthy(std::string_view value) {
+            return !value.empty() && value != "0" && value != "false" && value != "off";
+        }
+
+        std::string NumberLiteral(double value) {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+            std::string literal = buffer;
+            if (literal.find_first_of(".e") == std::string::npos) {
+                literal += ".0";
+            }
+            return literal;
+        }
+
+        // 演出命令对应的处理器名，与 ScriptInterpreter::ExecuteCommand 一致
+        const char* CustomCommandName(CommandType type) {
+            switch (type) {
+                case CommandType::PLAY_SOUND:        return "se";
+                case CommandType::PLAY_BGM:          return "bgm";
+                case CommandType::STOP_BGM:          return "bgm_stop";
+                case CommandType::SHOW_CHARACTER:    return "show";
+                case CommandType::HIDE_CHARACTER:    return "hide";
+                case CommandType::CHANGE_BACKGROUND: return "bg";
+                case CommandType::ANIMATION:         return "anim";
+                default:                             return nullptr;
+            }
+        }
+    }
+
+    ScriptCompiler::ScriptCompiler()
+        : commands(nullptr), sourceHash(0) {}
+
+    bool ScriptCompiler::Parse(const std::string& content, const std::string& path) {
+        arena.Reset();
+        commands = arena.Make<ScriptCommandList>();
+        labels.clear();
+        errors.clear();
+        sourcePath = path;
+        sourceHash = HashScriptSource(content);
+
+        ScriptParser parser(*commands, labels);
+        parser.Parse(content);
+        errors = parser.GetErrors();
+        return errors.empty();
+    }
+
+    bool ScriptCompiler::Generate(std::ostream& out) {
+        if (!commands || !errors.empty()) {
+            return false;
+        }
+        names.clear();
+        nameIndices.clear();
+        atomNames.clear();
+        atomIndices.clear();
+
+        std::ostringstream body;
+        std::ostringstream dialogue;
+        std::ostringstream metadata;
+        std::ostringstream choices;
+        std::ostringstream args;
+        size_t dialogueCount = 0;
+        size_t metadataCount = 0;
+        size_t choiceCount = 0;
+        size_t argCount = 0;
+
+        const int count = static_cast<int>(commands->size());
+        for (int i = 0; i < count; ++i) {
+            const ScriptCommand& command = (*commands)[i];
+            const ArenaStringList& params = command.parameters;
+            const int next = i + 1;
+            body << "                case " << i << ":  // " << command.lineNumber << "\n";
+
+            switch (command.type) {
+                case CommandType::LABEL:
+                    break;
+
+                case CommandType::DIALOGUE: {
+                    std::string_view text = params.size() > 2 ? std::string_view(params[2]) : std::string_view();
+                    std::string_view voice;
+                    std::string_view position;
+                    size_t firstMetadata = metadataCount;
+                    for (size_t p = 3; p < params.size(); ++p) {
+                        size_t eq = params[p].find('=');
+                        if (eq == ArenaString::npos) continue;
+                        std::string_view key = std::string_view(params[p]).substr(0, eq);
+                        std::string_view value = std::string_view(params[p]).substr(eq + 1);
+                        if (key == "voice") voice = value;
+                        else if (key == "position") position = value;
+                        else {
+                            metadata << "        {" << Quote(key) << ", " << Quote(value) << "},\n";
+                            ++metadataCount;
+                        }
+                    }
+                    dialogue << "        {" << Quote(params.size() > 0 ? std::string_view(params[0]) : "") << ", "
+                             << Quote(params.size() > 1 ? std::string_view(params[1]) : "") << ", "
+                             << Quote(text) << ", " << Quote(voice) << ", " << Quote(position) << ", "
+                             << (command.textIds.empty() ? 0 : command.textIds[0]) << "ull, "
+                             << (text.find("${") != std::string_view::npos ? "true" : "false") << ", ";
+                    if (metadataCount > firstMetadata) {
+                        dialogue << "kMetadata + " << firstMetadata << ", " << metadataCount - firstMetadata << "},\n";
+                    } else {
+                        dialogue << "nullptr, 0},\n";
+                    }
+                    body << "                    context.Dialogue(kDialogue[" << dialogueCount++ << "]);\n";
+                    // 连续的对话行作为一批交给对话系统，最后一行之后等待玩家读完
+                    if (next >= count || (*commands)[next].type != CommandType::DIALOGUE) {
+                        body << "                    context.WaitForPlayer();\n"
+                             << "                    return " << next << ";\n";
+                    }
+                    break;
+                }
+
+                case CommandType::JUMP: {
+                    int target = FindLabel(std::string(params[0]), command.lineNumber);
+                    body << "                    context.CountJump();\n"
+                         << "                    position = " << target << ";\n"
+                         << "                    continue;\n";
+                    break;
+                }
+
+                case CommandType::CONDITION: {
+                    std::string condition;
+                    for (size_t p = 0; p + 1 < params.size(); ++p) {
+                        if (p) condition += ' ';
+                        condition += params[p];
+                    }
+                    int target = FindLabel(std::string(params.back()), command.lineNumber);
+                    body << "                    context.CountCondition();\n"
+                         << "                    if (" << CompileCondition(condition) << ") {\n"
+                         << "                        context.CountJump();\n"
+                         << "                        position = " << target << ";\n"
+                         << "                        continue;\n"
+                         << "                    }\n";
+                    break;
+                }
+
+                case CommandType::CHOICE: {
+                    size_t firstChoice = choiceCount;
+                    for (size_t p = 0; p + 1 < params.size(); p += 2) {
+                        FindLabel(std::string(params[p + 1]), command.lineNumber);
+                        uint64_t textId = p / 2 < command.textIds.size() ? command.textIds[p / 2] : 0;
+                        choices << "        {" << Quote(params[p]) << ", " << Quote(params[p + 1]) << ", "
+                                << textId << "ull},\n";
+                        ++choiceCount;
+                    }
+                    if (choiceCount > firstChoice) {
+                        body << "                    context.Choice(kChoices + " << firstChoice << ", "
+                             << choiceCount - firstChoice << ");\n";
+                    }
+                    body << "                    context.WaitForPlayer();\n"
+                         << "                    return " << next << ";\n";
+                    break;
+                }
+
+                case CommandType::SET_VARIABLE: {
+                    if (params.empty()) break;
+                    size_t valueIndex = params.size() > 2 && params[1] == "=" ? 2 : 1;
+                    std::string value = valueIndex < params.size() ? std::string(params[valueIndex]) : "";
+                    double number = 0.0;
+                    // 数值字面量（含 +N/-N）直接赋值，其他值可能引用变量，执行时求值
+                    bool literal = value.empty() || ParseNumber(value, number);
+                    body << "                    context." << (literal ? "Assign" : "AssignExpression")
+                         << "(kNames[" << Name(std::string(params[0])) << "], kNames[" << Name(value) << "]);\n";
+                    break;
+                }
+
+                case CommandType::SET_FLAG: {
+                    if (params.empty()) break;
+                    bool value = params.size() < 2 || IsTruthy(params[1]);
+                    body << "                    context.SetFlag(kNames[" << Name(std::string(params[0])) << "], "
+                         << (value ? "true" : "false") << ");\n";
+                    break;
+                }
+
+                case CommandType::WAIT: {
+                    double seconds = 0.0;
+                    if (params.empty() || !ParseNumber(std::string(params[0]), seconds) || !(seconds > 0.0) ||
+                        !std::isfinite(seconds)) {
+                        break;
+                    }
+                    body << "                    context.Wait(" << NumberLiteral(seconds) << "f);\n"
+                         << "                    return " << next << ";\n";
+                    break;
+                }
+
+                case CommandType::CALL: {
+                    int target = FindLabel(std::string(params[0]), command.lineNumber);
+                    body << "                    context.Call(" << next << ");\n"
+                         << "                    context.CountJump();\n"
+                         << "                    position = " << target << ";\n"
+                         << "                    continue;\n";
+                    break;
+                }
+
+                case CommandType::RETURN:
+                    body << "                    position = context.Return();\n"
+                         << "                    if (!context.IsRunning()) return position;\n"
+                         << "                    continue;\n";
+                    break;
+
+                case CommandType::END:
+                    body << "                    context.End();\n"
+                         << "                    return " << next << ";\n";
+                    break;
+
+                default: {
+                    // 演出命令：按名字调用注册的处理器，参数放在常量表中
+                    const char* fixedName = CustomCommandName(command.type);
+                    size_t first = fixedName ? 0 : 1;
+                    if (!fixedName && params.empty()) break;
+                    std::string name = fixedName ? fixedName : std::string(params[0]);
+                    size_t firstArg = argCount;
+                    for (size_t p = first; p < params.size(); ++p) {
+                        args << "        " << Quote(params[p]) << ",\n";
+                        ++argCount;
+                    }
+                    if ((command.type == CommandType::SHOW_CHARACTER ||
+                         command.type == CommandType::HIDE_CHARACTER) && !params.empty()) {
+                        // 角色名等在载入时驻留一次，执行时直接传 Atom
+                        body << "                    context.Character(EngineEventType::"
+                             << (command.type == CommandType::SHOW_CHARACTER ? "CHARACTER_SHOW" : "CHARACTER_HIDE")
+                             << ", kArgs[" << firstArg << "], CharacterAtoms{";
+                        for (size_t a = 0; a < command.atoms.size(); ++a) {
+                            body << (a ? ", " : "");
+                            if (a < params.size() && !params[a].empty()) {
+                                body << "kAtoms[" << AtomName(std::string(params[a])) << "]";
+                            } else {
+                                body << "Atom::NONE";
+                            }
+                        }
+                        body << "});\n";
+                    }
+                    body << "                    if (!context.Custom(kNames[" << Name(name) << "], ";
+                    if (argCount > firstArg) {
+                        body << "kArgs + " << firstArg << ", " << argCount - firstArg;
+                    } else {
+                        body << "nullptr, 0";
+                    }
+                    body << ", " << next << ")) return context.Position();\n";
+                    break;
+                }
+            }
+            body << "                    [[fallthrough]];\n";
+        }
+
+        if (!errors.empty()) {
+            return false;
+        }
+
+        out << "// 由 script_compiler 从 " << sourcePath << " 生成，请勿手动修改\n"
+            << "#include \"CompiledScript.h\"\n\n"
+            << "namespace VisualNovel {\n"
+            << "namespace {\n\n";
+        if (!names.empty()) {
+            // 变量名和表达式只构造一次，执行时不再分配
+            out << "    const std::string kNames[] = {\n";
+            for (const std::string& name : names) {
+                out << "        " << Quote(name) << ",\n";
+            }
+            out << "    };\n\n";
+        }
+        if (!atomNames.empty()) {
+            out << "    const Atom kAtoms[] = {\n";
+            for (const std::string& name : atomNames) {
+                out << "        Atoms::Intern(" << Quote(name) << "),\n";
+            }
+            out << "    };\n\n";
+        }
+        if (metadataCount) {
+            out << "    constexpr CompiledMetadata kMetadata[] = {\n" << metadata.str() << "    };\n\n";
+        }
+        if (dialogueCount) {
+            out << "    constexpr CompiledDialogue kDialogue[] = {\n" << dialogue.str() << "    };\n\n";
+        }
+        if (choiceCount) {
+            out << "    constexpr CompiledChoice kChoices[] = {\n" << choices.str() << "    };\n\n";
+        }
+        if (argCount) {
+            out << "    constexpr std::string_view kArgs[] = {\n" << args.str() << "    };\n\n";
+        }
+        if (count) {
+            out << "    constexpr int kLineNumbers[] = {\n";
+            for (int i = 0; i < count; ++i) {
+                out << ((i % 16) ? " " : "        ") << (*commands)[i].lineNumber << ","
+                    << ((i % 16 == 15 || i + 1 == count) ? "\n" : "");
+            }
+            out << "    };\n\n";
+            out << "    constexpr std::string_view kRawLines[] = {\n";
+            for (const ScriptCommand& command : *commands) {
+                out << "        " << Quote(command.rawLine) << ",\n";
+            }
+            out << "    };\n\n";
+        }
+        if (!labels.empty()) {
+            out << "    constexpr CompiledLabel kLabels[] = {\n";
+            for (const auto& entry : labels) {
+                out << "        {" << Quote(entry.first) << ", " << entry.second.position << "},\n";
+            }
+            out << "    };\n\n";
+        }
+
+        out << "    int Run(CompiledScriptContext& context, int position) {\n"
+            << "        for (;;) {\n"
+            << "            switch (position) {\n"
+            << body.str()
+            << "                default:\n"
+            << "                    context.End();\n"
+            << "                    return position;\n"
+            << "            }\n"
+            << "        }\n"
+            << "    }\n\n";
+
+        out << "    const CompiledScript kScript{\n"
+            << "        " << Quote(sourcePath) << ",\n"
+            << "        " << sourceHash << "ull,\n"
+            << "        " << count << ",\n"
+            << "        " << (count ? "kLineNumbers" : "nullptr") << ",\n"
+            << "        " << (count ? "kRawLines" : "nullptr") << ",\n"
+            << "        " << (labels.empty() ? "nullptr" : "kLabels") << ",\n"
+            << "        " << labels.size() << ",\n"
+            << "        Run,\n"
+            << "    };\n\n"
+            << "    const CompiledScriptRegistration kRegistration(kScript);\n\n"
+            << "} // namespace\n"
+            << "} // namespace VisualNovel\n";
+        return true;
+    }
+
+    const std::vector<std::string>& ScriptCompiler::GetErrors() const {
+        return errors;
+    }
+
+    std::string ScriptCompiler::Quote(std::string_view text) {
+        std::string literal = "\"";
+        for (unsigned char c : text) {
+            switch (c) {
+                case '"':  literal += "\\\""; break;
+                case '\\': literal += "\\\\"; break;
+                case '\n': literal += "\\n"; break;
+                case '\r': literal += "\\r"; break;
+                case '\t': literal += "\\t"; break;
+                case '?':  literal += "\\?"; break;
+                default:
+                    if (c < 0x20 || c == 0x7f) {
+                        // 八进制转义固定三位，不会吞掉后面的数字
+                        char escape[8];
+                        std::snprintf(escape, sizeof(escape), "\\%03o", c);
+                        literal += escape;
+                    } else {
+                        literal += static_cast<char>(c);
+                    }
+            }
+        }
+        literal += '"';
+        return literal;
+    }
+
+    size_t ScriptCompiler::Name(const std::string& name) {
+        auto it = nameIndices.find(name);
+        if (it != nameIndices.end()) {
+            return it->second;
+        }
+        names.push_back(name);
+        nameIndices.emplace(name, names.size() - 1);
+        return names.size() - 1;
+    }
+
+    size_t ScriptCompiler::AtomName(const std::string& name) {
+        auto it = atomIndices.find(name);
+        if (it != atomIndices.end()) {
+            return it->second;
+        }
+        atomNames.push_back(name);
+        atomIndices.emplace(name, atomNames.size() - 1);
+        return atomNames.size() - 1;
+    }
+
+    int ScriptCompiler::FindLabel(const std::string& label, int lineNumber) {
+        auto it = labels.find(label);
+        if (it == labels.end()) {
+            AddError(lineNumber, "未定义的标签: " + label);
+            return 0;
+        }
+        return it->second.position;
+    }
+
+    std::string ScriptCompiler::CompileCondition(const std::string& condition) {
+        // 求值规则与 ScriptInterpreter::EvaluateCondition 相同：先取反，再按顺序找第一个比较运算符
+        std::string_view text = Trim(condition);
+        if (!text.empty() && text[0] == '!') {
+            return "!(" + CompileCondition(std::string(text.substr(1))) + ")";
+        }
+
+        static const char* const operators[] = {">=", "<=", "==", "!=", ">", "<"};
+        for (const char* op : operators) {
+            size_t at = text.find(op);
+            if (at == std::string_view::npos) continue;
+
+            std::string lhs(Trim(text.substr(0, at)));
+            std::string rhs(Trim(text.substr(at + std::char_traits<char>::length(op))));
+            double value = 0.0;
+            if (rhs.find("${") == std::string::npos && ParseNumber(rhs, value) && std::isfinite(value)) {
+                // 右边是数值时左边总按数值比较，未赋值的变量为0
+                return "context.Number(kNames[" + std::to_string(Name(lhs)) + "]) " + op + " " + NumberLiteral(value);
+            }
+            return "context.Condition(kNames[" + std::to_string(Name(std::string(text))) + "])";
+        }
+        return "context.Truthy(kNames[" + std::to_string(Name(std::string(text))) + "])";
+    }
+
+    void ScriptCompiler::AddError(int lineNumber, const std::string& message) {
+        errors.push_back("第 " + std::to_string(lineNumber) + " 行: " + message);
+    }
+
+} // namespace VisualNovel
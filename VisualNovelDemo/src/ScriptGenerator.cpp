@@ -0,0 +1,177 @@
+#include "ScriptGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace VisualNovel {
+
+    namespace {
+        const char* const kExpressions[] = {"normal", "happy", "sad", "angry", "surprised", "shy"};
+        const char* const kBackgrounds[] = {"classroom_day", "school_gate_afternoon", "park_evening",
+                                            "sakura_house_night", "shopping_street", "rooftop_sunset"};
+        const char* const kPositions[] = {"left", "center", "right"};
+        const char* const kPhrases[] = {
+            "早上好！", "今天天气真好呢~", "我们一起去上学吧", "那个...", "你看窗外的樱花开了！",
+            "作业写完了吗？", "最后一题有点难呢", "谢谢你！", "真的吗？", "好困...该睡觉了",
+            "放学后去吃可丽饼吧", "这道题其实是这样解的", "嘿嘿~", "要保密哦", "明天见！"
+        };
+        const char* const kChoices[] = {
+            "一起回家", "去图书馆", "帮忙打扫", "买点心", "去社团看看", "早点休息", "转移话题", "问问老师"
+        };
+
+        template <typename T, size_t N>
+        constexpr uint32_t CountOf(const T (&)[N]) { return static_cast<uint32_t>(N); }
+    }
+
+    ScriptGenerator::ScriptGenerator(const ScriptGeneratorOptions& opts)
+        : options(opts), state(opts.seed) {
+        options.branchingFactor = std::max(1, options.branchingFactor);
+        options.castSize = std::max(1, options.castSize);
+        options.variableCount = std::max(1, options.variableCount);
+    }
+
+    uint64_t ScriptGenerator::Next() {
+        // SplitMix64
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t ScriptGenerator::Below(uint32_t bound) {
+        return bound == 0 ? 0 : static_cast<uint32_t>(Next() % bound);
+    }
+
+    bool ScriptGenerator::Chance(double probability) {
+        // 取高53位转成 [0,1)，与平台的浮点随机实现无关
+        return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0) < probability;
+    }
+
+    void ScriptGenerator::GenerateScript(std::ostream& out) {
+        const size_t segments = std::max<size_t>(
+            2, static_cast<size_t>(std::llround(static_cast<double>(options.lineCount) * options.labelDensity)));
+        const size_t header = static_cast<size_t>(options.castSize) + 3;
+        size_t remainingBody = options.lineCount > header ? options.lineCount - header : 0;
+        const uint32_t window = static_cast<uint32_t>(options.branchingFactor) * 2;
+
+        out << "# 自动生成的脚本 seed=" << options.seed << " lines=" << options.lineCount << "\n";
+        for (int c = 0; c < options.castSize; ++c) {
+            out << "@character " << GetCharacterId(c) << " name=\"角色" << c << "\"\n";
+        }
+        out << "@bg " << kBackgrounds[0] << "\n";
+        out << "@show " << GetCharacterId(0) << " center normal\n";
+
+        auto forwardLabel = [&](size_t segment) {
+            size_t remaining = segments - 1 - segment;
+            return segment + 1 + Below(static_cast<uint32_t>(std::min<size_t>(remaining, window)));
+        };
+
+        for (size_t s = 0; s < segments; ++s) {
+            out << "@label " << options.labelPrefix << s << "\n";
+
+            const bool last = s + 1 == segments;
+            const bool choice = !last && Chance(options.choiceRatio);
+            const size_t terminatorLines = last ? 1 : choice ? 1 + static_cast<size_t>(options.branchingFactor) : 1;
+            // 剩余行数平均分给剩余段落，总行数与目标一致
+            const size_t budget = std::max<size_t>(terminatorLines + 2, remainingBody / (segments - s));
+            const size_t lines = budget - terminatorLines - 1;
+            remainingBody -= std::min(remainingBody, budget);
+
+            for (size_t l = 0; l < lines; ++l) {
+                if (!last && Chance(options.conditionUsage)) {
+                    out << "@if var_" << Below(options.variableCount) << ">=" << Below(10)
+                        << " " << options.labelPrefix << forwardLabel(s) << "\n";
+                } else if (Chance(options.variableUsage)) {
+                    out << "@set var_" << Below(options.variableCount) << " " << Below(20) << "\n";
+                } else if (Chance(options.stagingUsage)) {
+                    switch (Below(3)) {
+                        case 0:
+                            out << "@bg " << kBackgrounds[Below(CountOf(kBackgrounds))] << "\n";
+                            break;
+                        case 1:
+                            out << "@show " << GetCharacterId(Below(options.castSize)) << " "
+                                << kPositions[Below(CountOf(kPositions))] << " "
+                                << kExpressions[Below(CountOf(kExpressions))] << "\n";
+                            break;
+                        default:
+                            out << "@hide " << GetCharacterId(Below(options.castSize)) << "\n";
+                            break;
+                    }
+                } else {
+                    out << GetCharacterId(Below(options.castSize)) << " "
+                        << kExpressions[Below(CountOf(kExpressions))] << " \"";
+                    uint32_t fragments = 1 + Below(3);
+                    for (uint32_t f = 0; f < fragments; ++f) {
+                        out << kPhrases[Below(CountOf(kPhrases))];
+                    }
+                    out << "\"\n";
+                }
+            }
+
+            if (last && !options.nextLabel.empty()) {
+                out << "@goto " << options.nextLabel << "\n";
+            } else if (last) {
+                out << "@end\n";
+            } else if (choice) {
+                out << "@choice\n";
+                // 第一个选项总是通往下一段，保证每一段都可达
+                for (int o = 0; o < options.branchingFactor; ++o) {
+                    out << "    \"" << kChoices[Below(CountOf(kChoices))] << "\" -> " << options.labelPrefix
+                        << (o == 0 ? s + 1 : forwardLabel(s)) << "\n";
+                }
+            } else {
+                out << "@goto " << options.labelPrefix << (s + 1) << "\n";
+            }
+        }
+    }
+
+    std::string ScriptGenerator::GenerateScript() {
+        std::ostringstream out;
+        GenerateScript(out);
+        return out.str();
+    }
+
+    std::string ScriptGenerator::GenerateCharacterConfig(int index) {
+        const std::string id = GetCharacterId(index);
+        std::ostringstream out;
+        out << "{\n";
+        out << "    \"id\": \"" << id << "\",\n";
+        out << "    \"name\": \"角色" << index << "\",\n";
+        out << "    \"description\": \"自动生成的角色\",\n";
+        out << "    \"expressions\": {\n";
+        for (uint32_t e = 0; e < CountOf(kExpressions); ++e) {
+            out << "        \"" << kExpressions[e] << "\": {\n"
+                << "            \"texture\": \"characters/" << id << "_" << kExpressions[e] << ".png\",\n"
+                << "            \"uv_offset\": [0, 0],\n"
+                << "            \"uv_size\": [1, 1]\n"
+                << "        }" << (e + 1 < CountOf(kExpressions) ? "," : "") << "\n";
+        }
+        out << "    },\n";
+        out << "    \"animations\": {\n"
+            << "        \"idle\": {\n"
+            << "            \"frames\": [\"" << id << "_idle_1.png\", \"" << id << "_idle_2.png\"],\n"
+            << "            \"frame_rate\": " << (2 + Below(4)) << ",\n"
+            << "            \"loop\": true\n"
+            << "        }\n"
+            << "    },\n";
+        out << "    \"positions\": {\n"
+            << "        \"left\": {\"x\": 0.2, \"y\": 0.5, \"depth\": 0.5, \"scale\": 1.0},\n"
+            << "        \"center\": {\"x\": 0.5, \"y\": 0.5, \"depth\": 0.3, \"scale\": 1.0},\n"
+            << "        \"right\": {\"x\": 0.8, \"y\": 0.5, \"depth\": 0.5, \"scale\": 1.0}\n"
+            << "    },\n";
+        out << "    \"voice_clips\": {\n"
+            << "        \"greeting\": \"voice/" << id << "_greeting.ogg\"\n"
+            << "    }\n";
+        out << "}\n";
+        return out.str();
+    }
+
+    std::string ScriptGenerator::GetCharacterId(int index) {
+        return "char" + std::to_string(index);
+    }
+
+    const ScriptGeneratorOptions& ScriptGenerator::GetOptions() const {
+        return options;
+    }
+
+} // namespace VisualNovel
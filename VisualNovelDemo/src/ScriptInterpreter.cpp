@@ -0,0 +1,1089 @@
+#include "ScriptInterpreter.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "ScriptParser.h"
+#include "ScriptProject.h"
+#include "ScriptStream.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "Localization.h"
+
+namespace VisualNovel {
+
+    namespace {
+        std::string_view Trim(std::string_view text) {
+            size_t begin = text.find_first_not_of(" \t");
+            if (begin == std::string_view::npos) return std::string_view();
+            size_t end = text.find_last_not_of(" \t");
+            return text.substr(begin, end - begin + 1);
+        }
+
+        bool ParseNumber(const std::string& text, double& value) {
+            if (text.empty()) return false;
+            char* end = nullptr;
+            value = std::strtod(text.c_str(), &end);
+            return end == text.c_str() + text.size();
+        }
+
+        std::string FormatNumber(double value) {
+            std::ostringstream out;
+            out << value;
+            return out.str();
+        }
+
+        bool IsTruthy(const std::string& value) {
+            return !value.empty() && value != "0" && value != "false" && value != "off";
+        }
+
+        // 还没有自己脚本的解释器都指向这里，只读
+        ScriptCommandList& EmptyCommands() {
+            static ScriptCommandList empty;
+            return empty;
+        }
+    }
+
+    // ==================== VariableScope ====================
+
+    VariableScope::VariableScope(VariableScope* parentScope)
+        : parent(parentScope) {
+    }
+
+    void VariableScope::SetVariable(const std::string& name, const std::string& value) {
+        // 外层已有同名变量时写回外层，否则作为本作用域的局部变量
+        if (!variables.count(name) && parent && parent->HasVariable(name)) {
+            parent->SetVariable(name, value);
+            return;
+        }
+        variables[name] = value;
+    }
+
+    std::string VariableScope::GetVariable(const std::string& name) const {
+        auto it = variables.find(name);
+        if (it != variables.end()) return it->second;
+        return parent ? parent->GetVariable(name) : std::string();
+    }
+
+    bool VariableScope::HasVariable(const std::string& name) const {
+        return variables.count(name) > 0 || (parent && parent->HasVariable(name));
+    }
+
+    void VariableScope::SetFlag(const std::string& name, bool value) {
+        if (!flags.count(name) && parent && parent->HasFlag(name)) {
+            parent->SetFlag(name, value);
+            return;
+        }
+        flags[name] = value;
+    }
+
+    bool VariableScope::GetFlag(const std::string& name) const {
+        auto it = flags.find(name);
+        if (it != flags.end()) return it->second;
+        return parent ? parent->GetFlag(name) : false;
+    }
+
+    bool VariableScope::HasFlag(const std::string& name) const {
+        return flags.count(name) > 0 || (parent && parent->HasFlag(name));
+    }
+
+    void VariableScope::Clear() {
+        variables.clear();
+        flags.clear();
+    }
+
+    // ==================== ScriptInterpreter ====================
+
+    ScriptInterpreter::ScriptInterpreter(size_t chunkBytes)
+        : arenaChunkBytes(chunkBytes), commands(&EmptyCommands()), pendingCall(false), compiled(nullptr),
+          useCompiledScripts(true), currentScope(nullptr), programCounter(0),
+          isRunning(false), isPaused(false),
+          awaiting(ScriptAwait::NONE), awaitTicket(0), scheduler(nullptr),
+          events(nullptr), batchArena(chunkBytes), parsedDialogue(nullptr), parsedChoices(nullptr) {
+        scopeStack.push_back(new VariableScope());
+        currentScope = scopeStack.back();
+        ResetBatch();
+    }
+
+    ScriptInterpreter::~ScriptInterpreter() {
+        CancelAwait();
+        for (VariableScope* scope : scopeStack) {
+            delete scope;
+        }
+    }
+
+    bool ScriptInterpreter::LoadScript(const std::string& scriptPath) {
+        const CompiledScript* precompiled = useCompiledScripts ? CompiledScriptRegistry::Find(scriptPath) : nullptr;
+        std::ifstream file(scriptPath, std::ios::binary);
+        if (!file) {
+            if (precompiled) {
+                LoadCompiled(*precompiled);
+                return true;
+            }
+            std::cerr << "无法打开脚本文件: " << scriptPath << std::endl;
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string content = buffer.str();
+        // 文件被改过（模组、开发中）时以文件为准
+        if (precompiled && HashScriptSource(content) == precompiled->sourceHash) {
+            LoadCompiled(*precompiled);
+            return true;
+        }
+        return LoadScriptFromString(content);
+    }
+
+    bool ScriptInterpreter::LoadScriptFromString(const std::string& scriptContent) {
+        ClearScript();
+        ScriptParser parser(OwnCommands(), labels);
+        bool ok = parser.Parse(scriptContent);
+        for (const std::string& error : parser.GetErrors()) {
+            std::cerr << "[脚本错误] " << error << std::endl;
+        }
+        return ok;
+    }
+
+    bool ScriptInterpreter::LoadScriptStreaming(const std::string& scriptPath, size_t chunkLines) {
+        // 预编译脚本不需要解析
+        if (useCompiledScripts && CompiledScriptRegistry::Find(scriptPath)) {
+            return LoadScript(scriptPath);
+        }
+        std::unique_ptr<ScriptStream> opened = ScriptStream::Open(scriptPath, chunkLines);
+        if (!opened) {
+            return false;
+        }
+        ClearScript();
+        stream = std::move(opened);
+        return true;
+    }
+
+    bool ScriptInterpreter::IsStreaming() const {
+        return stream != nullptr;
+    }
+
+    void ScriptInterpreter::WaitForStream() {
+        if (stream) {
+            FinishStream();
+        }
+    }
+
+    void ScriptInterpreter::FinishStream() {
+        // 整理好的脚本与各段中的命令一一对应，位置和调用栈不用映射
+        ScriptImage image = stream->TakeImage();
+        stream.reset();
+        scriptArena = std::move(image.arena);
+        commands = image.commands;
+        labels = std::move(image.labels);
+    }
+
+    size_t ScriptInterpreter::CommandCount() const {
+        return stream ? stream->GetReadyCount() : commands->size();
+    }
+
+    const ScriptCommand& ScriptInterpreter::CommandAt(size_t index) const {
+        return stream ? stream->At(index) : (*commands)[index];
+    }
+
+    void ScriptInterpreter::LoadProject(const ScriptProject& project) {
+        ClearScript();
+        const ScriptCommandList& linked = project.GetCommands();
+        OwnCommands().assign(linked.begin(), linked.end());
+        labels = project.GetLabels();
+    }
+
+    void ScriptInterpreter::LoadCompiled(const CompiledScript& script) {
+        ClearScript();
+        // 标签直接在生成的常量表中查找，不复制
+        compiled = &script;
+    }
+
+    void ScriptInterpreter::LoadShared(std::shared_ptr<const ScriptImage> image) {
+        ClearScript();
+        if (!image || !image->commands) {
+            return;
+        }
+        sharedScript = std::move(image);
+        commands = sharedScript->commands;
+    }
+
+    void ScriptInterpreter::SetUseCompiledScripts(bool use) {
+        useCompiledScripts = use;
+    }
+
+    bool ScriptInterpreter::IsCompiled() const {
+        return compiled != nullptr;
+    }
+
+    ScriptImage ScriptInterpreter::AdoptScript(ScriptImage image) {
+        if (stream) {
+            FinishStream();
+        }
+        if (sharedScript) {
+            // 共用的脚本不归本解释器所有：按它映射位置后放手，交回的只有自己的空分配区
+            std::shared_ptr<const ScriptImage> shared = std::move(sharedScript);
+            sharedScript.reset();
+            ScriptImage own;
+            own.arena = std::move(scriptArena);
+            scriptArena = std::move(image.arena);
+            commands = image.commands;
+            labels = std::move(image.labels);
+            programCounter = RemapPosition(*shared, programCounter);
+            for (CallStackFrame& frame : callStack) {
+                frame.returnAddress = RemapPosition(*shared, frame.returnAddress);
+            }
+            return own;
+        }
+        if (compiled) {
+            // 预编译脚本被热重载替换：没有旧命令可比，按源码行号找回位置
+            const CompiledScript& previous = *compiled;
+            compiled = nullptr;
+            ScriptImage empty;
+            empty.arena = std::move(scriptArena);
+            empty.commands = commands;
+            scriptArena = std::move(image.arena);
+            commands = image.commands;
+            labels = std::move(image.labels);
+            programCounter = RemapCompiledPosition(previous, programCounter);
+            for (CallStackFrame& frame : callStack) {
+                frame.returnAddress = RemapCompiledPosition(previous, frame.returnAddress);
+            }
+            return empty;
+        }
+
+        ScriptImage previous;
+        previous.arena = std::move(scriptArena);
+        previous.commands = commands;
+        previous.labels = std::move(labels);
+
+        scriptArena = std::move(image.arena);
+        commands = image.commands;
+        labels = std::move(image.labels);
+
+        // 等待中的对话和选项已经交给了对话系统，重新映射后从下一条命令继续
+        programCounter = RemapPosition(previous, programCounter);
+        for (CallStackFrame& frame : callStack) {
+            frame.returnAddress = RemapPosition(previous, frame.returnAddress);
+        }
+        return previous;
+    }
+
+    int ScriptInterpreter::RemapPosition(const ScriptImage& previous, int position) const {
+        const ScriptCommandList& oldCommands = *previous.commands;
+        if (position <= 0 || oldCommands.empty()) {
+            return 0;
+        }
+        int anchor = std::min(position, static_cast<int>(oldCommands.size())) - 1;
+        const ScriptCommand& current = oldCommands[anchor];
+
+        // 找到当前命令所在的标签段
+        const ScriptLabel* section = nullptr;
+        for (const auto& entry : previous.labels) {
+            if (entry.second.position <= anchor && (!section || entry.second.position > section->position)) {
+                section = &entry.second;
+            }
+        }
+        auto target = section ? labels.find(section->name) : labels.end();
+
+        if (target != labels.end()) {
+            int begin = target->second.position;
+            int end = static_cast<int>(commands->size());
+            for (const auto& entry : labels) {
+                if (entry.second.position > begin && entry.second.position < end) {
+                    end = entry.second.position;
+                }
+            }
+            // 段内优先找原样保留的同一行，找不到时按在段内的偏移
+            int offset = anchor - section->position;
+            int best = -1;
+            for (int i = begin; i < end; ++i) {
+                if ((*commands)[i].rawLine == current.rawLine &&
+                    (best < 0 || std::abs(i - begin - offset) < std::abs(best - begin - offset))) {
+                    best = i;
+                }
+            }
+            if (best < 0) {
+                best = std::min(begin + offset, end - 1);
+            }
+            return best + (position - anchor);
+        }
+
+        // 标签被删掉或脚本没有标签时按源码行号
+        for (size_t i = 0; i < commands->size(); ++i) {
+            if ((*commands)[i].lineNumber >= current.lineNumber) {
+                return static_cast<int>(i) + (position - anchor);
+            }
+        }
+        return static_cast<int>(commands->size());
+    }
+
+    int ScriptInterpreter::FindLabel(const std::string& label) const {
+        if (compiled) {
+            // 生成的标签表按名字排序
+            const CompiledLabel* begin = compiled->labels;
+            const CompiledLabel* end = begin + compiled->labelCount;
+            const CompiledLabel* it = std::lower_bound(begin, end, std::string_view(label),
+                [](const CompiledLabel& entry, std::string_view name) { return entry.name < name; });
+            return it != end && it->name == label ? it->position : -1;
+        }
+        if (stream) {
+            return stream->FindLabel(label);
+        }
+        const std::map<std::string, ScriptLabel>& table = sharedScript ? sharedScript->labels : labels;
+        auto it = table.find(label);
+        return it == table.end() ? -1 : it->second.position;
+    }
+
+    int ScriptInterpreter::RemapCompiledPosition(const CompiledScript& previous, int position) const {
+        if (position <= 0 || previous.commandCount == 0) {
+            return 0;
+        }
+        int anchor = std::min(position, previous.commandCount) - 1;
+        int line = previous.lineNumbers[anchor];
+        for (size_t i = 0; i < commands->size(); ++i) {
+            if ((*commands)[i].lineNumber >= line) {
+                return static_cast<int>(i) + (position - anchor);
+            }
+        }
+        return static_cast<int>(commands->size());
+    }
+
+    void ScriptInterpreter::ClearScript() {
+        // 整份脚本的命令随分配区一次性丢弃，与命令数量无关
+        compiled = nullptr;
+        sharedScript.reset();
+        stream.reset();
+        pendingLabel.clear();
+        pendingCall = false;
+        if (scriptArena) {
+            scriptArena->Reset();
+        }
+        commands = &EmptyCommands();
+        labels.clear();
+        ResetBatch();
+
+        callStack.clear();
+        while (scopeStack.size() > 1) {
+            PopScope();
+        }
+        programCounter = 0;
+        isRunning = false;
+        isPaused = false;
+        CancelAwait();
+    }
+
+    ScriptCommandList& ScriptInterpreter::OwnCommands() {
+        if (!scriptArena) {
+            scriptArena = std::make_unique<SceneArena>(arenaChunkBytes);
+        }
+        commands = scriptArena->Make<ScriptCommandList>();
+        return *commands;
+    }
+
+    void ScriptInterpreter::ResetBatch() {
+        batchArena.Reset();
+        parsedDialogue = batchArena.Make<DialogueLineList>();
+        parsedChoices = batchArena.Make<ChoiceOptionList>();
+    }
+
+    void ScriptInterpreter::Start() {
+        programCounter = 0;
+        isRunning = true;
+        isPaused = false;
+        pendingLabel.clear();
+        pendingCall = false;
+        CancelAwait();
+        ResetBatch();
+    }
+
+    void ScriptInterpreter::Stop() {
+        isRunning = false;
+        CancelAwait();
+    }
+
+    void ScriptInterpreter::Pause() {
+        isPaused = true;
+    }
+
+    void ScriptInterpreter::Resume() {
+        // 同时解除暂停和对“玩家读完对话”的等待
+        isPaused = false;
+        if (awaiting == ScriptAwait::PLAYER) {
+            awaiting = ScriptAwait::NONE;
+        }
+    }
+
+    void ScriptInterpreter::Update(float deltaTime) {
+        VN_TRACE_ZONE(SCRIPT, "ScriptInterpreter::Update");
+        if (!scheduler && ownScheduler) {
+            ownScheduler->Advance(deltaTime);
+        }
+        if (!isRunning || isPaused || awaiting != ScriptAwait::NONE) {
+            return;
+        }
+
+        // 执行到下一个阻塞命令为止，本批次的对话和选项在下一批开始时丢弃
+        ResetBatch();
+        if (stream && stream->IsComplete()) {
+            FinishStream();
+        }
+        if (!pendingLabel.empty() && !ResolvePendingJump()) {
+            return;
+        }
+        if (compiled) {
+            CompiledScriptContext context(*this);
+            programCounter = compiled->run(context, programCounter);
+            return;
+        }
+        while (isRunning && awaiting == ScriptAwait::NONE && !isPaused && pendingLabel.empty()) {
+            // 先看是否解析完再取命令数，解析完时取到的一定是最终的数目
+            bool parsed = !stream || stream->IsComplete();
+            if (programCounter < 0 || static_cast<size_t>(programCounter) >= CommandCount()) {
+                if (!parsed && programCounter >= 0) {
+                    break;  // 还没解析到，下一次 Update 再继续
+                }
+                isRunning = false;
+                break;
+            }
+            const ScriptCommand& command = CommandAt(programCounter++);
+            if (!ExecuteCommand(command)) {
+                break;
+            }
+        }
+    }
+
+    void ScriptInterpreter::JumpToLabel(const std::string& label) {
+        bool parsed = !stream || stream->IsComplete();
+        int position = FindLabel(label);
+        if (position < 0 && !parsed) {
+            // 目标可能在还没解析到的部分：脚本停在这里，每次 Update 再找
+            pendingLabel = label;
+            pendingCall = false;
+            if (awaiting == ScriptAwait::PLAYER) {
+                awaiting = ScriptAwait::NONE;
+            }
+            return;
+        }
+        if (position < 0) {
+            std::cerr << "[脚本错误] 未定义的标签: " << label << std::endl;
+            return;
+        }
+        pendingLabel.clear();
+        MetricsRegistry::Instance().Increment(EngineMetrics::Get().labelJumps);
+        programCounter = position;
+        // 选择支通过跳转来恢复执行
+        if (awaiting == ScriptAwait::PLAYER) {
+            awaiting = ScriptAwait::NONE;
+        }
+    }
+
+    void ScriptInterpreter::JumpToLine(int lineNumber) {
+        if (stream) {
+            FinishStream();
+        }
+        if (compiled) {
+            const int* lines = compiled->lineNumbers;
+            programCounter = static_cast<int>(std::lower_bound(lines, lines + compiled->commandCount, lineNumber) - lines);
+            return;
+        }
+        for (size_t i = 0; i < commands->size(); ++i) {
+            if ((*commands)[i].lineNumber >= lineNumber) {
+                programCounter = static_cast<int>(i);
+                return;
+            }
+        }
+        programCounter = static_cast<int>(commands->size());
+    }
+
+    void ScriptInterpreter::CallLabel(const std::string& label) {
+        bool parsed = !stream || stream->IsComplete();
+        if (parsed && FindLabel(label) < 0) {
+            std::cerr << "[脚本错误] 未定义的标签: " << label << std::endl;
+            return;
+        }
+        callStack.push_back({programCounter, currentScope});
+        PushScope();
+        JumpToLabel(label);
+        pendingCall = !pendingLabel.empty();
+    }
+
+    bool ScriptInterpreter::ResolvePendingJump() {
+        bool parsed = !stream || stream->IsComplete();
+        int position = FindLabel(pendingLabel);
+        if (position < 0 && !parsed) {
+            return false;
+        }
+        if (position < 0) {
+            std::cerr << "[脚本错误] 未定义的标签: " << pendingLabel << std::endl;
+            if (pendingCall) {
+                // 撤销 CallLabel 压入的调用帧，从 @call 之后继续
+                callStack.pop_back();
+                PopScope();
+            }
+        } else {
+            MetricsRegistry::Instance().Increment(EngineMetrics::Get().labelJumps);
+            programCounter = position;
+        }
+        pendingLabel.clear();
+        pendingCall = false;
+        return true;
+    }
+
+    void ScriptInterpreter::Return() {
+        if (callStack.empty()) {
+            isRunning = false;
+            return;
+        }
+        CallStackFrame frame = callStack.back();
+        callStack.pop_back();
+        while (scopeStack.size() > 1 && currentScope != frame.scope) {
+            PopScope();
+        }
+        programCounter = frame.returnAddress;
+    }
+
+    void ScriptInterpreter::SetVariable(const std::string& name, const std::string& value) {
+        currentScope->SetVariable(name, value);
+    }
+
+    std::string ScriptInterpreter::GetVariable(const std::string& name) const {
+        return currentScope->GetVariable(name);
+    }
+
+    void ScriptInterpreter::SetFlag(const std::string& name, bool value) {
+        currentScope->SetFlag(name, value);
+    }
+
+    bool ScriptInterpreter::GetFlag(const std::string& name) const {
+        return currentScope->GetFlag(name);
+    }
+
+    void ScriptInterpreter::RegisterCustomCommand(const std::string& commandName,
+                                                  std::function<bool(const std::vector<std::string>&)> handler) {
+        customCommands[commandName] = std::move(handler);
+    }
+
+    void ScriptInterpreter::RegisterAsyncCommand(const std::string& commandName, AsyncCommandHandler handler) {
+        asyncCommands[commandName] = std::move(handler);
+    }
+
+    void ScriptInterpreter::SetEventQueue(EngineEventQueue* queue) {
+        events = queue;
+    }
+
+    void ScriptInterpreter::EmitStagingEvent(EngineEventType type, std::string_view value,
+                                             const CharacterAtoms& atoms) {
+        if (events) {
+            events->Push(type, value, atoms);
+        }
+    }
+
+    void ScriptInterpreter::SetScheduler(ScriptScheduler* shared) {
+        if (shared == scheduler) {
+            return;
+        }
+        // 进行中的 @wait 把剩余时间转到新调度器上继续等
+        double remaining = awaiting == ScriptAwait::TIMER ? GetScheduler().GetRemainingTime(awaitTicket) : -1.0;
+        if (awaiting == ScriptAwait::TIMER || awaiting == ScriptAwait::COMMAND) {
+            CancelAwait();
+        }
+        scheduler = shared;
+        if (remaining >= 0.0) {
+            AwaitTimer(remaining);
+        }
+    }
+
+    ScriptScheduler& ScriptInterpreter::GetScheduler() {
+        if (scheduler) {
+            return *scheduler;
+        }
+        if (!ownScheduler) {
+            ownScheduler = std::make_unique<ScriptScheduler>();
+        }
+        return *ownScheduler;
+    }
+
+    bool ScriptInterpreter::IsRunning() const {
+        return isRunning;
+    }
+
+    bool ScriptInterpreter::IsWaiting() const {
+        return awaiting != ScriptAwait::NONE;
+    }
+
+    ScriptAwait ScriptInterpreter::GetAwait() const {
+        return awaiting;
+    }
+
+    int ScriptInterpreter::GetCurrentLine() const {
+        if (compiled) {
+            return programCounter > 0 && programCounter <= compiled->commandCount
+                ? compiled->lineNumbers[programCounter - 1] : 0;
+        }
+        if (programCounter <= 0 || static_cast<size_t>(programCounter) > CommandCount()) {
+            return 0;
+        }
+        return CommandAt(programCounter - 1).lineNumber;
+    }
+
+    const std::string& ScriptInterpreter::GetCurrentCommand() const {
+        std::string_view text;
+        if (compiled) {
+            if (programCounter > 0 && programCounter <= compiled->commandCount) {
+                text = compiled->rawLines[programCounter - 1];
+            }
+        } else if (programCounter > 0 && static_cast<size_t>(programCounter) <= CommandCount()) {
+            text = CommandAt(programCounter - 1).rawLine;
+        }
+        currentCommandText.assign(text);
+        return currentCommandText;
+    }
+
+    const DialogueLineList& ScriptInterpreter::GetDialogueLines() const {
+        return *parsedDialogue;
+    }
+
+    const ChoiceOptionList& ScriptInterpreter::GetChoiceOptions() const {
+        return *parsedChoices;
+    }
+
+    // 返回 false 表示本批次在这条命令之后停下
+    bool ScriptInterpreter::ExecuteCommand(const ScriptCommand& command) {
+        EngineMetrics::CountCommand(command.type);
+        const ArenaStringList& params = command.parameters;
+
+        switch (command.type) {
+            case CommandType::DIALOGUE:       return HandleDialogue(command);
+            case CommandType::JUMP:           return HandleJump(params);
+            case CommandType::CONDITION:      return HandleCondition(params);
+            case CommandType::CHOICE:         return HandleChoice(command);
+            case CommandType::SET_VARIABLE:   return HandleSetVariable(params);
+            case CommandType::SET_FLAG:       return HandleSetFlag(params);
+            case CommandType::WAIT:           return HandleWait(params);
+            case CommandType::LABEL:          return true;
+            case CommandType::PLAY_SOUND:
+                EmitStagingEvent(EngineEventType::SOUND, params.empty() ? std::string_view() : params[0]);
+                return HandleCustom("se", params, 0);
+            case CommandType::PLAY_BGM:
+                EmitStagingEvent(EngineEventType::BGM, params.empty() ? std::string_view() : params[0]);
+                return HandleCustom("bgm", params, 0);
+            case CommandType::STOP_BGM:
+                EmitStagingEvent(EngineEventType::BGM_STOP, std::string_view());
+                return HandleCustom("bgm_stop", params, 0);
+            case CommandType::SHOW_CHARACTER:
+                EmitStagingEvent(EngineEventType::CHARACTER_SHOW, params.empty() ? std::string_view() : params[0],
+                                 command.atoms);
+                return HandleCustom("show", params, 0);
+            case CommandType::HIDE_CHARACTER:
+                EmitStagingEvent(EngineEventType::CHARACTER_HIDE, params.empty() ? std::string_view() : params[0],
+                                 command.atoms);
+                return HandleCustom("hide", params, 0);
+            case CommandType::CHANGE_BACKGROUND:
+                EmitStagingEvent(EngineEventType::BACKGROUND, params.empty() ? std::string_view() : params[0]);
+                return HandleCustom("bg", params, 0);
+            case CommandType::ANIMATION:      return HandleCustom("anim", params, 0);
+            case CommandType::SPECIAL_EFFECT:
+                return params.empty() ? true : HandleCustom(std::string(params[0]), params, 1);
+            case CommandType::CALL:
+                if (!params.empty()) CallLabel(std::string(params[0]));
+                return true;
+            case CommandType::RETURN:
+                Return();
+                return isRunning;
+            case CommandType::END:
+                isRunning = false;
+                return false;
+        }
+        return true;
+    }
+
+    bool ScriptInterpreter::HandleDialogue(const ScriptCommand& command) {
+        const ArenaStringList& params = command.parameters;
+        if (parsedDialogue->empty()) {
+            // 批次分配区不回收旧缓冲区，逐行扩容会留下 1+2+4+... 行的空洞；按这一批连续的对话行数一次预留
+            size_t run = 1;
+            while (static_cast<size_t>(programCounter) + run - 1 < CommandCount() &&
+                   CommandAt(programCounter + run - 1).type == CommandType::DIALOGUE) {
+                ++run;
+            }
+            parsedDialogue->reserve(run);
+        }
+        DialogueLine& line = parsedDialogue->emplace_back();
+        line.textId = command.textIds.empty() ? 0 : command.textIds[0];
+        if (params.size() > 0) {
+            line.characterName = params[0];
+            line.characterDisplayName = params[0];
+        }
+        if (params.size() > 1) line.expression = params[1];
+        if (params.size() > 2) {
+            line.text = params[2];
+            if (line.text.find("${") != ArenaString::npos) {
+                // 含变量的台词在执行时按当前语言替换，结果不再查表
+                std::string_view source = Localization::Instance().Resolve(line.textId, params[2]);
+                line.text = EvaluateExpression(std::string(source));
+                line.textId = 0;
+            }
+        }
+        // 之后的 key=value 参数，如 voice=... position=...
+        for (size_t i = 3; i < params.size(); ++i) {
+            size_t eq = params[i].find('=');
+            if (eq == ArenaString::npos) continue;
+            std::string_view key = std::string_view(params[i]).substr(0, eq);
+            std::string_view value = std::string_view(params[i]).substr(eq + 1);
+            if (key == "voice") line.voiceFile = value;
+            else if (key == "position") line.position = value;
+            else line.metadata.emplace(key, value);
+        }
+
+        // 连续的对话行作为一批交给对话系统，之后等待玩家读完；
+        // 流式载入时下一行还没解析到则这一批先到此为止
+        if (static_cast<size_t>(programCounter) < CommandCount() &&
+            CommandAt(programCounter).type == CommandType::DIALOGUE) {
+            return true;
+        }
+        AwaitPlayer();
+        return false;
+    }
+
+    bool ScriptInterpreter::HandleJump(const ArenaStringList& params) {
+        if (!params.empty()) {
+            JumpToLabel(std::string(params[0]));
+        }
+        return true;
+    }
+
+    bool ScriptInterpreter::HandleCondition(const ArenaStringList& params) {
+        if (params.size() < 2) {
+            return true;
+        }
+        // 条件中可能含空格：@if affection >= 10 label
+        std::string condition;
+        for (size_t i = 0; i + 1 < params.size(); ++i) {
+            if (i) condition += ' ';
+            condition += params[i];
+        }
+        MetricsRegistry::Instance().Increment(EngineMetrics::Get().conditionEvaluations);
+        if (EvaluateCondition(condition)) {
+            JumpToLabel(std::string(params.back()));
+        }
+        return true;
+    }
+
+    bool ScriptInterpreter::HandleChoice(const ScriptCommand& command) {
+        const ArenaStringList& params = command.parameters;
+        for (size_t i = 0; i + 1 < params.size(); i += 2) {
+            ChoiceOption& option = parsedChoices->emplace_back(params[i], params[i + 1]);
+            if (i / 2 < command.textIds.size()) {
+                option.textId = command.textIds[i / 2];
+            }
+        }
+        // 等待玩家选择，选择后由 JumpToLabel 恢复
+        AwaitPlayer();
+        return false;
+    }
+
+    bool ScriptInterpreter::HandleSetVariable(const ArenaStringList& params) {
+        if (params.empty()) {
+            return true;
+        }
+        std::string name(params[0]);
+        size_t valueIndex = params.size() > 2 && params[1] == "=" ? 2 : 1;
+        std::string value = valueIndex < params.size() ? EvaluateExpression(std::string(params[valueIndex])) : "";
+        AssignVariable(name, std::move(value));
+        return true;
+    }
+
+    void ScriptInterpreter::AssignVariable(const std::string& name, std::string value) {
+        // +N / -N 在原数值上增减
+        double current = 0.0;
+        double delta = 0.0;
+        if (!value.empty() && (value[0] == '+' || value[0] == '-') && ParseNumber(value, delta) &&
+            ParseNumber(currentScope->GetVariable(name), current)) {
+            value = FormatNumber(current + delta);
+        }
+        currentScope->SetVariable(name, value);
+    }
+
+    bool ScriptInterpreter::HandleSetFlag(const ArenaStringList& params) {
+        if (params.empty()) {
+            return true;
+        }
+        bool value = params.size() < 2 || IsTruthy(std::string(params[1]));
+        currentScope->SetFlag(std::string(params[0]), value);
+        return true;
+    }
+
+    bool ScriptInterpreter::HandleWait(const ArenaStringList& params) {
+        double seconds = 0.0;
+        if (params.empty() || !ParseNumber(std::string(params[0]), seconds) || seconds <= 0.0) {
+            return true;
+        }
+        AwaitTimer(seconds);
+        return false;
+    }
+
+    bool ScriptInterpreter::HandleCustom(const std::string& name, const ArenaStringList& params, size_t first) {
+        if (!HasCustom(name)) {
+            // 没有注册处理器的演出命令直接跳过
+            return true;
+        }
+        std::vector<std::string> args;
+        args.reserve(params.size() - std::min(first, params.size()));
+        for (size_t i = first; i < params.size(); ++i) {
+            args.emplace_back(params[i]);
+        }
+        return RunCustom(name, args);
+    }
+
+    bool ScriptInterpreter::HasCustom(const std::string& name) const {
+        auto it = customCommands.find(name);
+        if (it != customCommands.end() && it->second) {
+            return true;
+        }
+        auto async = asyncCommands.find(name);
+        return async != asyncCommands.end() && async->second;
+    }
+
+    bool ScriptInterpreter::RunCustom(const std::string& name, std::vector<std::string>& args) {
+        auto it = customCommands.find(name);
+        if (it != customCommands.end() && it->second) {
+            // 处理器返回 false 时暂停，直到 Resume
+            if (!it->second(args)) {
+                AwaitPlayer();
+                return false;
+            }
+            return true;
+        }
+
+        // 先挂起再调用处理器：处理器可能同步完成并立即调用 Resume
+        awaiting = ScriptAwait::COMMAND;
+        ScriptScheduler& active = GetScheduler();
+        awaitTicket = active.Suspend(*this);
+        asyncCommands.find(name)->second(args, active.MakeContinuation(awaitTicket));
+        return false;
+    }
+
+    std::string ScriptInterpreter::EvaluateExpression(const std::string& expr) const {
+        // ${name} 替换为变量值，单独的变量名直接取值
+        if (expr.find("${") == std::string::npos) {
+            if (currentScope->HasVariable(expr)) {
+                return currentScope->GetVariable(expr);
+            }
+            return expr;
+        }
+
+        std::string result;
+        size_t pos = 0;
+        while (pos < expr.size()) {
+            size_t open = expr.find("${", pos);
+            size_t close = open == std::string::npos ? std::string::npos : expr.find('}', open + 2);
+            if (close == std::string::npos) {
+                result.append(expr, pos, std::string::npos);
+                break;
+            }
+            result.append(expr, pos, open - pos);
+            result += currentScope->GetVariable(expr.substr(open + 2, close - open - 2));
+            pos = close + 1;
+        }
+        return result;
+    }
+
+    bool ScriptInterpreter::EvaluateCondition(const std::string& condition) const {
+        std::string_view text = Trim(condition);
+        if (!text.empty() && text[0] == '!') {
+            return !EvaluateCondition(std::string(text.substr(1)));
+        }
+
+        static const char* const operators[] = {">=", "<=", "==", "!=", ">", "<"};
+        for (const char* op : operators) {
+            size_t at = text.find(op);
+            if (at == std::string_view::npos) continue;
+
+            std::string lhs = EvaluateExpression(std::string(Trim(text.substr(0, at))));
+            std::string rhs = EvaluateExpression(std::string(Trim(text.substr(at + std::char_traits<char>::length(op)))));
+            std::string oper(op);
+
+            double a = 0.0;
+            double b = 0.0;
+            bool lhsNumber = ParseNumber(lhs, a);
+            bool rhsNumber = ParseNumber(rhs, b);
+            if (lhsNumber || rhsNumber) {
+                // 未赋值的变量按0比较
+                if (!lhsNumber) a = 0.0;
+                if (!rhsNumber) b = 0.0;
+                if (oper == ">=") return a >= b;
+                if (oper == "<=") return a <= b;
+                if (oper == "==") return a == b;
+                if (oper == "!=") return a != b;
+                if (oper == ">") return a > b;
+                return a < b;
+            }
+            if (oper == "==") return lhs == rhs;
+            if (oper == "!=") return lhs != rhs;
+            return false;
+        }
+
+        std::string name(text);
+        return currentScope->GetFlag(name) || IsTruthy(currentScope->GetVariable(name));
+    }
+
+    void ScriptInterpreter::AwaitPlayer() {
+        awaiting = ScriptAwait::PLAYER;
+    }
+
+    void ScriptInterpreter::AwaitTimer(double seconds) {
+        awaiting = ScriptAwait::TIMER;
+        awaitTicket = GetScheduler().SleepFor(*this, seconds);
+    }
+
+    void ScriptInterpreter::CancelAwait() {
+        if (awaiting == ScriptAwait::TIMER || awaiting == ScriptAwait::COMMAND) {
+            GetScheduler().Cancel(awaitTicket);
+        }
+        awaiting = ScriptAwait::NONE;
+        awaitTicket = 0;
+    }
+
+    void ScriptInterpreter::OnAwaitComplete(uint64_t ticket) {
+        // 调度器只会用当前的编号唤醒：取消过的编号已从它的等待表中移除
+        if (ticket == awaitTicket) {
+            awaiting = ScriptAwait::NONE;
+            awaitTicket = 0;
+        }
+    }
+
+    void ScriptInterpreter::PushScope() {
+        scopeStack.push_back(new VariableScope(currentScope));
+        currentScope = scopeStack.back();
+    }
+
+    void ScriptInterpreter::PopScope() {
+        if (scopeStack.size() <= 1) {
+            return;
+        }
+        delete scopeStack.back();
+        scopeStack.pop_back();
+        currentScope = scopeStack.back();
+    }
+
+    // ==================== CompiledScriptContext ====================
+
+    void CompiledScriptContext::Dialogue(const CompiledDialogue& source) {
+        DialogueLine& line = interpreter.parsedDialogue->emplace_back();
+        line.textId = source.textId;
+        line.characterName = source.character;
+        line.characterDisplayName = source.character;
+        line.expression = source.expression;
+        line.voiceFile = source.voice;
+        line.position = source.position;
+        if (source.hasVariables) {
+            std::string_view text = Localization::Instance().Resolve(source.textId, source.text);
+            line.text = interpreter.EvaluateExpression(std::string(text));
+            line.textId = 0;
+        } else {
+            line.text = source.text;
+        }
+        for (uint32_t i = 0; i < source.metadataCount; ++i) {
+            line.metadata.emplace(source.metadata[i].key, source.metadata[i].value);
+        }
+    }
+
+    void CompiledScriptContext::Choice(const CompiledChoice* options, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            ChoiceOption& option = interpreter.parsedChoices->emplace_back(options[i].text, options[i].target);
+            option.textId = options[i].textId;
+        }
+    }
+
+    void CompiledScriptContext::WaitForPlayer() {
+        interpreter.AwaitPlayer();
+    }
+
+    bool CompiledScriptContext::Wait(float seconds) {
+        if (seconds <= 0.0f) {
+            return true;
+        }
+        interpreter.AwaitTimer(seconds);
+        return false;
+    }
+
+    bool CompiledScriptContext::Custom(const std::string& name, const std::string_view* args, size_t count, int next) {
+        if (interpreter.events) {
+            std::string_view first = count ? args[0] : std::string_view();
+            if (name == "bg") interpreter.EmitStagingEvent(EngineEventType::BACKGROUND, first);
+            else if (name == "bgm") interpreter.EmitStagingEvent(EngineEventType::BGM, first);
+            else if (name == "bgm_stop") interpreter.EmitStagingEvent(EngineEventType::BGM_STOP, std::string_view());
+            else if (name == "se") interpreter.EmitStagingEvent(EngineEventType::SOUND, first);
+        }
+        if (!interpreter.HasCustom(name)) {
+            return true;
+        }
+        std::vector<std::string> values(args, args + count);
+        interpreter.programCounter = next;
+        bool proceed = interpreter.RunCustom(name, values);
+        return proceed && interpreter.isRunning && !interpreter.isPaused &&
+               interpreter.awaiting == ScriptAwait::NONE && interpreter.programCounter == next;
+    }
+
+    void CompiledScriptContext::Character(EngineEventType type, std::string_view name, const CharacterAtoms& atoms) {
+        interpreter.EmitStagingEvent(type, name, atoms);
+    }
+
+    int CompiledScriptContext::Position() const {
+        return interpreter.programCounter;
+    }
+
+    double CompiledScriptContext::Number(const std::string& name) const {
+        // 与 EvaluateCondition 一致：未赋值或非数值的变量按0比较
+        double value = 0.0;
+        return ParseNumber(interpreter.EvaluateExpression(name), value) ? value : 0.0;
+    }
+
+    bool CompiledScriptContext::Truthy(const std::string& name) const {
+        return interpreter.currentScope->GetFlag(name) || IsTruthy(interpreter.currentScope->GetVariable(name));
+    }
+
+    bool CompiledScriptContext::Condition(const std::string& condition) const {
+        return interpreter.EvaluateCondition(condition);
+    }
+
+    void CompiledScriptContext::Assign(const std::string& name, const std::string& value) {
+        interpreter.AssignVariable(name, value);
+    }
+
+    void CompiledScriptContext::AssignExpression(const std::string& name, const std::string& expression) {
+        interpreter.AssignVariable(name, interpreter.EvaluateExpression(expression));
+    }
+
+    void CompiledScriptContext::SetFlag(const std::string& name, bool value) {
+        interpreter.currentScope->SetFlag(name, value);
+    }
+
+    void CompiledScriptContext::CountCondition() {
+        MetricsRegistry::Instance().Increment(EngineMetrics::Get().conditionEvaluations);
+    }
+
+    void CompiledScriptContext::CountJump() {
+        MetricsRegistry::Instance().Increment(EngineMetrics::Get().labelJumps);
+    }
+
+    void CompiledScriptContext::Call(int returnAddress) {
+        interpreter.callStack.push_back({returnAddress, interpreter.currentScope});
+        interpreter.PushScope();
+    }
+
+    int CompiledScriptContext::Return() {
+        interpreter.Return();
+        return interpreter.programCounter;
+    }
+
+    void CompiledScriptContext::End() {
+        interpreter.isRunning = false;
+    }
+
+    bool CompiledScriptContext::IsRunning() const {
+        return interpreter.isRunning;
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,245 @@
+#include "ScriptParser.h"
+#include <sstream>
+#include "Profiler.h"
+#include "Metrics.h"
+#include "Localization.h"
+
+namespace VisualNovel {
+
+    ScriptCommand::ScriptCommand(CommandType t, const std::vector<std::string>& params,
+                                 const std::string& raw, int line, const allocator_type& allocator)
+        : type(t), parameters(params.begin(), params.end(), allocator), rawLine(raw, allocator), lineNumber(line),
+          textIds(allocator), atoms() {}
+
+    ScriptCommand::ScriptCommand(const ScriptCommand& other, const allocator_type& allocator)
+        : type(other.type), parameters(other.parameters, allocator), rawLine(other.rawLine, allocator),
+          lineNumber(other.lineNumber), textIds(other.textIds, allocator), atoms(other.atoms) {}
+
+    ScriptCommand::ScriptCommand(ScriptCommand&& other, const allocator_type& allocator)
+        : type(other.type), parameters(std::move(other.parameters), allocator),
+          rawLine(std::move(other.rawLine), allocator), lineNumber(other.lineNumber),
+          textIds(std::move(other.textIds), allocator), atoms(other.atoms) {}
+
+    ScriptParser::ScriptParser(ScriptCommandList& commands,
+                               std::map<std::string, ScriptLabel>& labels)
+        : commands(commands), labels(labels), inChoice(false), choiceLine(0) {}
+
+    void ScriptParser::FeedLine(const std::string& rawLine, int lineNumber) {
+        std::string line = rawLine;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#') {
+            // 空行和注释不会打断选项列表
+            return;
+        }
+
+        // @choice 之后缩进的 "文本" -> 标签
+        if (inChoice) {
+            if (first > 0 && line[first] == '"') {
+                std::vector<std::string> tokens = Tokenize(line);
+                if (tokens.size() >= 3 && tokens[1] == "->") {
+                    choiceParams.push_back(tokens[0]);
+                    choiceParams.push_back(tokens[2]);
+                } else {
+                    AddError(lineNumber, "选项格式应为 \"文本\" -> 标签");
+                }
+                return;
+            }
+            FlushChoice();
+        }
+
+        std::vector<std::string> tokens = Tokenize(line);
+        if (tokens.empty()) return;
+
+        if (line[first] != '@') {
+            // 对话：角色 表情 "台词"，或只有 "台词" 的旁白
+            std::vector<std::string> params;
+            if (tokens.size() == 1) {
+                params = {"", "", tokens[0]};
+            } else if (tokens.size() == 2) {
+                params = {tokens[0], "", tokens[1]};
+            } else {
+                params = {tokens[0], tokens[1], tokens[2]};
+                params.insert(params.end(), tokens.begin() + 3, tokens.end());
+            }
+            commands.emplace_back(CommandType::DIALOGUE, params, line, lineNumber);
+            commands.back().textIds.push_back(DialogueTextId(params));
+            return;
+        }
+
+        std::string keyword = tokens[0].substr(1);
+        std::vector<std::string> params(tokens.begin() + 1, tokens.end());
+        CommandType type = ResolveCommand(keyword);
+
+        switch (type) {
+            case CommandType::CHOICE:
+                inChoice = true;
+                choiceParams.clear();
+                choiceRaw = line;
+                choiceLine = lineNumber;
+                return;
+
+            case CommandType::LABEL:
+                if (params.empty()) {
+                    AddError(lineNumber, "@label 缺少标签名");
+                    return;
+                }
+                if (labels.count(params[0])) {
+                    AddError(lineNumber, "标签重复定义: " + params[0]);
+                    return;
+                }
+                labels[params[0]] = ScriptLabel{params[0], static_cast<int>(commands.size())};
+                currentSection = params[0];
+                break;
+
+            case CommandType::JUMP:
+            case CommandType::CALL:
+                if (params.empty()) {
+                    AddError(lineNumber, "@" + keyword + " 缺少目标标签");
+                    return;
+                }
+                break;
+
+            case CommandType::CONDITION:
+                if (params.size() < 2) {
+                    AddError(lineNumber, "@if 格式应为 @if 条件 标签");
+                    return;
+                }
+                break;
+
+            case CommandType::PLAY_BGM:
+                if (!params.empty() && params[0] == "stop") {
+                    type = CommandType::STOP_BGM;
+                    params.erase(params.begin());
+                }
+                break;
+
+            case CommandType::SPECIAL_EFFECT:
+                if (keyword != "effect") {
+                    params.insert(params.begin(), keyword);
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        commands.emplace_back(type, params, line, lineNumber);
+        if (type == CommandType::SHOW_CHARACTER || type == CommandType::HIDE_CHARACTER) {
+            CharacterAtoms& atoms = commands.back().atoms;
+            for (size_t i = 0; i < atoms.size() && i < params.size(); ++i) {
+                atoms[i] = Atoms::Intern(params[i]);
+            }
+        }
+    }
+
+    void ScriptParser::Finish() {
+        if (inChoice) {
+            FlushChoice();
+        }
+    }
+
+    bool ScriptParser::Parse(const std::string& content) {
+        VN_TRACE_ZONE(ASSETS, "ScriptParser::Parse");
+        std::istringstream stream(content);
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(stream, line)) {
+            FeedLine(line, ++lineNumber);
+        }
+        Finish();
+        MetricsRegistry::Instance().Increment(EngineMetrics::Get().scriptLinesParsed, lineNumber);
+        return errors.empty();
+    }
+
+    const std::vector<std::string>& ScriptParser::GetErrors() const {
+        return errors;
+    }
+
+    std::vector<std::string> ScriptParser::Tokenize(const std::string& line) {
+        std::vector<std::string> tokens;
+        size_t i = 0;
+        while (i < line.size()) {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+            if (i >= line.size()) break;
+
+            std::string token;
+            if (line[i] == '"') {
+                size_t close = line.find('"', i + 1);
+                if (close == std::string::npos) close = line.size();
+                token = line.substr(i + 1, close - i - 1);
+                i = close + 1;
+            } else {
+                // key="带 空格 的值" 也作为一个参数，引号去掉
+                while (i < line.size() && line[i] != ' ' && line[i] != '\t') {
+                    if (line[i] == '"') {
+                        size_t close = line.find('"', i + 1);
+                        if (close == std::string::npos) close = line.size();
+                        token.append(line, i + 1, close - i - 1);
+                        i = close + 1;
+                    } else {
+                        token.push_back(line[i++]);
+                    }
+                }
+            }
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    CommandType ScriptParser::ResolveCommand(const std::string& keyword) {
+        static const std::map<std::string, CommandType> keywords = {
+            {"label", CommandType::LABEL},
+            {"goto", CommandType::JUMP},
+            {"jump", CommandType::JUMP},
+            {"if", CommandType::CONDITION},
+            {"choice", CommandType::CHOICE},
+            {"set", CommandType::SET_VARIABLE},
+            {"flag", CommandType::SET_FLAG},
+            {"se", CommandType::PLAY_SOUND},
+            {"sound", CommandType::PLAY_SOUND},
+            {"bgm", CommandType::PLAY_BGM},
+            {"show", CommandType::SHOW_CHARACTER},
+            {"hide", CommandType::HIDE_CHARACTER},
+            {"bg", CommandType::CHANGE_BACKGROUND},
+            {"wait", CommandType::WAIT},
+            {"anim", CommandType::ANIMATION},
+            {"animation", CommandType::ANIMATION},
+            {"call", CommandType::CALL},
+            {"return", CommandType::RETURN},
+            {"end", CommandType::END}
+        };
+
+        auto it = keywords.find(keyword);
+        return it != keywords.end() ? it->second : CommandType::SPECIAL_EFFECT;
+    }
+
+    void ScriptParser::FlushChoice() {
+        inChoice = false;
+        if (choiceParams.empty()) {
+            AddError(choiceLine, "@choice 没有任何选项");
+            return;
+        }
+        commands.emplace_back(CommandType::CHOICE, choiceParams, choiceRaw, choiceLine);
+        for (size_t i = 0; i < choiceParams.size(); i += 2) {
+            commands.back().textIds.push_back(StringTable::MakeTextId(currentSection, "@choice", choiceParams[i]));
+        }
+        choiceParams.clear();
+    }
+
+    uint64_t ScriptParser::DialogueTextId(const std::vector<std::string>& params) const {
+        // 显式的 id=名称 优先，否则由所在标签、角色和原文决定
+        for (size_t i = 3; i < params.size(); ++i) {
+            if (params[i].compare(0, 3, "id=") == 0) {
+                return StringTable::MakeExplicitId(std::string_view(params[i]).substr(3));
+            }
+        }
+        return StringTable::MakeTextId(currentSection, params[0], params[2]);
+    }
+
+    void ScriptParser::AddError(int lineNumber, const std::string& message) {
+        errors.push_back("第 " + std::to_string(lineNumber) + " 行: " + message);
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,231 @@
+#include "ScriptProject.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "ScriptParser.h"
+#include "Profiler.h"
+
+namespace VisualNovel {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        double ElapsedMs(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+    }
+
+    ScriptProject::ScriptProject(unsigned workers)
+        : workerCount(workers), commands(nullptr) {
+        if (workerCount == 0) {
+            workerCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        commands = linkArena.Make<ScriptCommandList>();
+    }
+
+    bool ScriptProject::Load(const std::string& directory) {
+        VN_TRACE_ZONE(ASSETS, "ScriptProject::Load");
+        rootDirectory = directory;
+        stats = ScriptProjectStats();
+
+        std::vector<std::string> files = DiscoverScripts(directory);
+
+        // 删除的文件不再保留缓存
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (!std::binary_search(files.begin(), files.end(), it->first)) {
+                it = cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // 修改时间和大小都没变的文件沿用上次的解析结果
+        std::vector<CompiledScript*> stale;
+        for (const std::string& file : files) {
+            std::error_code error;
+            std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(file, error);
+            uintmax_t fileSize = std::filesystem::file_size(file, error);
+
+            std::unique_ptr<CompiledScript>& script = cache[file];
+            if (script && script->commands && script->writeTime == writeTime && script->fileSize == fileSize) {
+                ++stats.reused;
+                continue;
+            }
+            if (!script) {
+                script = std::make_unique<CompiledScript>();
+                script->path = file;
+            }
+            script->writeTime = writeTime;
+            script->fileSize = fileSize;
+            stale.push_back(script.get());
+        }
+
+        Clock::time_point compileStart = Clock::now();
+        Compile(stale);
+        stats.compileMs = ElapsedMs(compileStart);
+        stats.compiled = stale.size();
+        stats.files = files.size();
+
+        Clock::time_point linkStart = Clock::now();
+        Link(files);
+        stats.linkMs = ElapsedMs(linkStart);
+        stats.commands = commands->size();
+        stats.labels = labels.size();
+        return errors.empty();
+    }
+
+    bool ScriptProject::Reload() {
+        return Load(rootDirectory);
+    }
+
+    const ScriptModule* ScriptProject::FindModule(int commandIndex) const {
+        // 模块按 firstCommand 递增排列
+        auto it = std::upper_bound(modules.begin(), modules.end(), commandIndex,
+            [](int index, const ScriptModule& module) { return index < module.firstCommand; });
+        if (it == modules.begin()) {
+            return nullptr;
+        }
+        --it;
+        return commandIndex <= it->firstCommand + it->commandCount ? &*it : nullptr;
+    }
+
+    std::vector<std::string> ScriptProject::DiscoverScripts(const std::string& directory) const {
+        std::vector<std::string> files;
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+             !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            if (it->is_regular_file() && it->path().extension() == ".txt") {
+                files.push_back(it->path().generic_string());
+            }
+        }
+        // 排序后链接顺序与目录遍历顺序无关，同一工程总是得到相同的命令表
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    void ScriptProject::Compile(std::vector<CompiledScript*>& stale) {
+        if (stale.empty()) {
+            return;
+        }
+        // 大文件先解析，避免最后只剩一个线程在处理大章节
+        std::sort(stale.begin(), stale.end(), [](const CompiledScript* a, const CompiledScript* b) {
+            return a->fileSize > b->fileSize;
+        });
+
+        // 各文件的分配区互相独立，工作线程只通过下标领取任务
+        std::atomic<size_t> next(0);
+        auto worker = [&stale, &next]() {
+            for (size_t i = next.fetch_add(1); i < stale.size(); i = next.fetch_add(1)) {
+                CompileScript(*stale[i]);
+            }
+        };
+
+        unsigned threadCount = static_cast<unsigned>(std::min<size_t>(workerCount, stale.size()));
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < threadCount; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void ScriptProject::CompileScript(CompiledScript& script) {
+        script.arena.Reset();
+        script.commands = script.arena.Make<ScriptCommandList>();
+        script.labels.clear();
+        script.errors.clear();
+
+        std::ifstream file(script.path, std::ios::binary);
+        if (!file) {
+            script.errors.push_back(script.path + ": 无法打开文件");
+            return;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+
+        ScriptParser parser(*script.commands, script.labels);
+        parser.Parse(buffer.str());
+        for (const std::string& error : parser.GetErrors()) {
+            script.errors.push_back(script.path + ": " + error);
+        }
+    }
+
+    void ScriptProject::Link(const std::vector<std::string>& files) {
+        linkArena.Reset();
+        commands = linkArena.Make<ScriptCommandList>();
+        labels.clear();
+        modules.clear();
+        errors.clear();
+
+        size_t total = 0;
+        for (const std::string& file : files) {
+            total += cache[file]->commands->size() + 1;
+        }
+        commands->reserve(total);
+
+        std::map<std::string, std::string> labelOwners;
+        for (const std::string& file : files) {
+            const CompiledScript& script = *cache[file];
+            errors.insert(errors.end(), script.errors.begin(), script.errors.end());
+
+            int base = static_cast<int>(commands->size());
+            modules.push_back({file, base, static_cast<int>(script.commands->size())});
+            commands->insert(commands->end(), script.commands->begin(), script.commands->end());
+            // 文件结尾不是无条件跳转时补一条 @end，不会落到下一个文件里继续执行
+            CommandType last = script.commands->empty() ? CommandType::LABEL : script.commands->back().type;
+            if (last != CommandType::JUMP && last != CommandType::END && last != CommandType::RETURN) {
+                commands->emplace_back(CommandType::END, std::vector<std::string>(), std::string(), 0);
+            }
+
+            for (const auto& entry : script.labels) {
+                auto owner = labelOwners.emplace(entry.first, file);
+                if (!owner.second) {
+                    errors.push_back(file + ": 标签 " + entry.first + " 已在 " + owner.first->second + " 中定义");
+                    continue;
+                }
+                labels[entry.first] = {entry.first, base + entry.second.position};
+            }
+        }
+
+        CheckTargets();
+    }
+
+    void ScriptProject::CheckTargets() {
+        auto check = [this](const ScriptCommand& command, int index, const ArenaString& target) {
+            if (labels.find(std::string(target)) != labels.end()) {
+                return;
+            }
+            const ScriptModule* module = FindModule(index);
+            errors.push_back((module ? module->path : std::string("?")) + ": 第" +
+                             std::to_string(command.lineNumber) + "行: 未定义的标签 " + std::string(target));
+        };
+
+        for (size_t i = 0; i < commands->size(); ++i) {
+            const ScriptCommand& command = (*commands)[i];
+            const ArenaStringList& params = command.parameters;
+            int index = static_cast<int>(i);
+            switch (command.type) {
+                case CommandType::JUMP:
+                case CommandType::CALL:
+                    if (!params.empty()) check(command, index, params[0]);
+                    break;
+                case CommandType::CONDITION:
+                    if (params.size() >= 2) check(command, index, params.back());
+                    break;
+                case CommandType::CHOICE:
+                    for (size_t p = 1; p < params.size(); p += 2) {
+                        check(command, index, params[p]);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+} // namespace VisualNovel
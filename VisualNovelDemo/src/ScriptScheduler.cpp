@@ -0,0 +1,107 @@
+#include "ScriptScheduler.h"
+#include <algorithm>
+#include <functional>
+#include "ScriptInterpreter.h"
+
+namespace VisualNovel {
+
+    // ==================== ScriptContinuation ====================
+
+    void ScriptContinuation::Resume() const {
+        if (!queue) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tickets.push_back(ticket);
+    }
+
+    // ==================== ScriptScheduler ====================
+
+    ScriptScheduler::ScriptScheduler()
+        : cancelledTimers(0), completions(std::make_shared<ScriptCompletionQueue>()), now(0.0), nextTicket(1) {}
+
+    uint64_t ScriptScheduler::SleepFor(ScriptInterpreter& interpreter, double seconds) {
+        uint64_t ticket = nextTicket++;
+        double deadline = now + std::max(0.0, seconds);
+        waiting[ticket] = Waiter{&interpreter, deadline};
+        timers.push_back(Timer{deadline, ticket});
+        std::push_heap(timers.begin(), timers.end(), std::greater<Timer>());
+        return ticket;
+    }
+
+    uint64_t ScriptScheduler::Suspend(ScriptInterpreter& interpreter) {
+        uint64_t ticket = nextTicket++;
+        waiting[ticket] = Waiter{&interpreter, -1.0};
+        return ticket;
+    }
+
+    ScriptContinuation ScriptScheduler::MakeContinuation(uint64_t ticket) const {
+        return ScriptContinuation(completions, ticket);
+    }
+
+    void ScriptScheduler::Cancel(uint64_t ticket) {
+        // 堆中的计时器不逐个删除，到期时发现已不在等待表中即跳过；
+        // 反复进出 @wait 的脚本被停止时，失效的计时器可能积累，超过有效的一半后整体清理
+        auto it = waiting.find(ticket);
+        if (it == waiting.end()) {
+            return;
+        }
+        bool timer = it->second.deadline >= 0.0;
+        waiting.erase(it);
+        if (timer && ++cancelledTimers * 2 > timers.size()) {
+            PurgeCancelledTimers();
+        }
+    }
+
+    double ScriptScheduler::GetRemainingTime(uint64_t ticket) const {
+        auto it = waiting.find(ticket);
+        if (it == waiting.end() || it->second.deadline < 0.0) {
+            return -1.0;
+        }
+        return std::max(0.0, it->second.deadline - now);
+    }
+
+    void ScriptScheduler::PurgeCancelledTimers() {
+        timers.erase(std::remove_if(timers.begin(), timers.end(),
+                                    [this](const Timer& timer) { return waiting.count(timer.ticket) == 0; }),
+                     timers.end());
+        std::make_heap(timers.begin(), timers.end(), std::greater<Timer>());
+        cancelledTimers = 0;
+    }
+
+    void ScriptScheduler::Advance(double deltaTime) {
+        now += deltaTime;
+        while (!timers.empty() && timers.front().deadline <= now) {
+            std::pop_heap(timers.begin(), timers.end(), std::greater<Timer>());
+            uint64_t ticket = timers.back().ticket;
+            timers.pop_back();
+            if (!Wake(ticket)) {
+                --cancelledTimers;  // 已取消
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(completions->mutex);
+            if (completions->tickets.empty()) {
+                return;
+            }
+            draining.swap(completions->tickets);
+        }
+        for (uint64_t ticket : draining) {
+            Wake(ticket);
+        }
+        draining.clear();
+    }
+
+    bool ScriptScheduler::Wake(uint64_t ticket) {
+        auto it = waiting.find(ticket);
+        if (it == waiting.end()) {
+            return false;
+        }
+        ScriptInterpreter* interpreter = it->second.interpreter;
+        waiting.erase(it);
+        interpreter->OnAwaitComplete(ticket);
+        return true;
+    }
+
+} // namespace VisualNovel
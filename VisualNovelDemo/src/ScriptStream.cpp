@@ -0,0 +1,142 @@
+#include "ScriptStream.h"
+#include <iostream>
+#include "ScriptParser.h"
+#include "Profiler.h"
+#include "Metrics.h"
+
+namespace VisualNovel {
+
+    std::unique_ptr<ScriptStream> ScriptStream::Open(const std::string& path, size_t chunkLines) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "无法打开脚本文件: " << path << std::endl;
+            return nullptr;
+        }
+        return std::make_unique<ScriptStream>(path, std::move(file), chunkLines);
+    }
+
+    ScriptStream::ScriptStream(const std::string& scriptPath, std::ifstream input, size_t linesPerChunk)
+        : path(scriptPath), file(std::move(input)), chunkLines(linesPerChunk ? linesPerChunk : 1),
+          arena(std::make_unique<SceneArena>()), readyCount(0), complete(false), cancelled(false) {
+        for (std::atomic<const ScriptCommand*>& segment : segments) {
+            segment.store(nullptr, std::memory_order_relaxed);
+        }
+        parseThread = std::thread([this]() { Run(); });
+    }
+
+    ScriptStream::~ScriptStream() {
+        cancelled.store(true, std::memory_order_relaxed);
+        if (parseThread.joinable()) {
+            parseThread.join();
+        }
+    }
+
+    int ScriptStream::FindLabel(const std::string& label) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = labels.find(label);
+        return it == labels.end() ? -1 : it->second.position;
+    }
+
+    void ScriptStream::WaitUntilComplete() {
+        std::unique_lock<std::mutex> lock(mutex);
+        progress.wait(lock, [this]() { return complete.load(std::memory_order_relaxed); });
+    }
+
+    ScriptImage ScriptStream::TakeImage() {
+        WaitUntilComplete();
+        return std::move(image);
+    }
+
+    void ScriptStream::Run() {
+        VN_TRACE_ZONE(ASSETS, "ScriptStream::Run");
+        // 解析器写入暂存区，每批发布时移入段中；解析器记下的标签位置是暂存区中的下标，
+        // 只用于检查重复定义，发布的位置在 Publish 中按 LABEL 命令的实际下标计算
+        ScriptCommandList* staging = arena->Make<ScriptCommandList>();
+        std::map<std::string, ScriptLabel> parserLabels;
+        ScriptParser parser(*staging, parserLabels);
+
+        std::string line;
+        int lineNumber = 0;
+        size_t pendingLines = 0;
+        bool ok = true;
+        while (!cancelled.load(std::memory_order_relaxed) && std::getline(file, line)) {
+            parser.FeedLine(line, ++lineNumber);
+            if (++pendingLines == chunkLines) {
+                pendingLines = 0;
+                if (!(ok = Publish(*staging))) {
+                    break;
+                }
+            }
+        }
+        if (ok) {
+            parser.Finish();
+            Publish(*staging);
+        }
+        file.close();
+
+        // Publish 可能已记下"命令过多"，解析错误接在后面
+        const std::vector<std::string>& parseErrors = parser.GetErrors();
+        errors.insert(errors.end(), parseErrors.begin(), parseErrors.end());
+        for (const std::string& error : errors) {
+            std::cerr << "[脚本错误] " << error << std::endl;
+        }
+        MetricsRegistry::Instance().Increment(EngineMetrics::Get().scriptLinesParsed, lineNumber);
+        Finish();
+    }
+
+    bool ScriptStream::Publish(ScriptCommandList& staging) {
+        size_t count = readyCount.load(std::memory_order_relaxed);
+        std::vector<std::pair<std::string, int>> newLabels;
+        bool ok = true;
+        for (ScriptCommand& command : staging) {
+            size_t segment = count >> kSegmentBits;
+            if ((count & (kSegmentSize - 1)) == 0) {
+                if (segment >= kMaxSegments) {
+                    errors.push_back(path + ": 命令过多，之后的部分没有载入");
+                    ok = false;
+                    break;
+                }
+                // 预留整段，之后追加不会移动已发布的命令
+                ScriptCommandList* list = arena->Make<ScriptCommandList>();
+                list->reserve(kSegmentSize);
+                segmentLists.push_back(list);
+                segments[segment].store(list->data(), std::memory_order_release);
+            }
+            ScriptCommandList& list = *segmentLists[segment];
+            list.push_back(std::move(command));
+            if (list.back().type == CommandType::LABEL && !list.back().parameters.empty()) {
+                newLabels.emplace_back(std::string(list.back().parameters[0]), static_cast<int>(count));
+            }
+            ++count;
+        }
+        staging.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& entry : newLabels) {
+                labels[entry.first] = ScriptLabel{entry.first, entry.second};
+            }
+            readyCount.store(count, std::memory_order_release);
+        }
+        progress.notify_all();
+        return ok;
+    }
+
+    void ScriptStream::Finish() {
+        // 整理成连续的命令表，执行线程此时可能仍在读段，所以复制而不是移动
+        size_t count = readyCount.load(std::memory_order_relaxed);
+        image.arena = std::make_unique<SceneArena>();
+        image.commands = image.arena->Make<ScriptCommandList>();
+        image.commands->reserve(count);
+        for (size_t i = 0; i < count && !cancelled.load(std::memory_order_relaxed); ++i) {
+            image.commands->push_back(At(i));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            image.labels = labels;
+            complete.store(true, std::memory_order_release);
+        }
+        progress.notify_all();
+    }
+
+} // namespace VisualNovel
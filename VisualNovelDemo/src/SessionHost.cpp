@@ -0,0 +1,310 @@
+#include "SessionHost.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "ScriptParser.h"
+
+namespace VisualNovel {
+
+    // ==================== SharedProgram ====================
+
+    SharedProgram::SharedProgram() : compiled(nullptr) {
+    }
+
+    std::shared_ptr<const SharedProgram> SharedProgram::Load(const std::string& path, bool useCompiled) {
+        // 与 ScriptInterpreter::LoadScript 的选择规则相同
+        const CompiledScript* precompiled = useCompiled ? CompiledScriptRegistry::Find(path) : nullptr;
+        std::ifstream file(path, std::ios::binary);
+        if (!file && !precompiled) {
+            std::cerr << "[会话] 无法打开脚本文件: " << path << std::endl;
+            return nullptr;
+        }
+        std::string content;
+        if (file) {
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            content = buffer.str();
+        }
+        if (precompiled && (!file || HashScriptSource(content) == precompiled->sourceHash)) {
+            auto program = std::make_shared<SharedProgram>();
+            program->path = path;
+            program->compiled = precompiled;
+            return program;
+        }
+        return FromString(content, path);
+    }
+
+    std::shared_ptr<const SharedProgram> SharedProgram::FromString(const std::string& content, const std::string& name) {
+        auto image = std::make_shared<ScriptImage>();
+        image->arena = std::make_unique<SceneArena>();
+        image->commands = image->arena->Make<ScriptCommandList>();
+        ScriptParser parser(*image->commands, image->labels);
+        bool ok = parser.Parse(content);
+        for (const std::string& error : parser.GetErrors()) {
+            std::cerr << "[会话] " << name << ": " << error << std::endl;
+        }
+        if (!ok) {
+            return nullptr;
+        }
+        auto program = std::make_shared<SharedProgram>();
+        program->path = name;
+        program->image = std::move(image);
+        return program;
+    }
+
+    void SharedProgram::Attach(ScriptInterpreter& interpreter) const {
+        if (compiled) {
+            interpreter.LoadCompiled(*compiled);
+        } else {
+            interpreter.LoadShared(image);
+        }
+    }
+
+    // ==================== PlayerSession ====================
+
+    PlayerSession::PlayerSession(uint64_t sessionId, std::shared_ptr<const SharedProgram> sharedProgram,
+                                 ScriptScheduler& scheduler, size_t arenaChunkBytes)
+        : id(sessionId), program(std::move(sharedProgram)), interpreter(arenaChunkBytes), events(8),
+          lineCursor(0), revision(0), changed(true) {
+        interpreter.SetScheduler(&scheduler);
+        interpreter.SetEventQueue(&events);
+        program->Attach(interpreter);
+        interpreter.Start();
+    }
+
+    void PlayerSession::Apply(const SessionInput& input) {
+        if (interpreter.GetAwait() != ScriptAwait::PLAYER) {
+            return;  // 还在执行、等待计时器或已结束，迟到的输入丢弃
+        }
+        const ChoiceOptionList& choices = interpreter.GetChoiceOptions();
+        switch (input.type) {
+            case SessionInputType::ADVANCE:
+                if (!choices.empty()) {
+                    return;  // 选择支只能通过 CHOOSE 继续
+                }
+                // 一批台词逐行显示，最后一行读完后才让脚本继续
+                if (lineCursor + 1 < interpreter.GetDialogueLines().size()) {
+                    ++lineCursor;
+                    changed = true;
+                } else {
+                    interpreter.Resume();
+                }
+                break;
+            case SessionInputType::CHOOSE:
+                if (input.choice >= choices.size()) {
+                    std::cerr << "[会话] " << id << " 选项超出范围: " << input.choice << std::endl;
+                    return;
+                }
+                interpreter.JumpToLabel(std::string(choices[input.choice].targetLabel));
+                break;
+        }
+    }
+
+    bool PlayerSession::Update(float deltaTime) {
+        events.Clear();
+        if (interpreter.IsRunning() && !interpreter.IsWaiting()) {
+            interpreter.Update(deltaTime);
+            lineCursor = 0;
+            changed = true;
+            for (const EngineEvent& event : events.GetEvents()) {
+                ApplyEvent(event);
+            }
+        }
+        if (!changed) {
+            return false;
+        }
+        changed = false;
+        ++revision;
+        return true;
+    }
+
+    const DialogueLine* PlayerSession::GetCurrentLine() const {
+        const DialogueLineList& lines = interpreter.GetDialogueLines();
+        return lineCursor < lines.size() ? &lines[lineCursor] : nullptr;
+    }
+
+    void PlayerSession::ApplyEvent(const EngineEvent& event) {
+        switch (event.type) {
+            case EngineEventType::BACKGROUND:
+                background = event.value;
+                break;
+            case EngineEventType::BGM:
+                bgm = event.value;
+                break;
+            case EngineEventType::BGM_STOP:
+                bgm = std::string_view();
+                break;
+            case EngineEventType::CHARACTER_SHOW: {
+                SessionSprite& sprite = sprites[event.atoms[0]];
+                if (event.atoms[1] != Atom::NONE) sprite.position = event.atoms[1];
+                if (event.atoms[2] != Atom::NONE) sprite.expression = event.atoms[2];
+                break;
+            }
+            case EngineEventType::CHARACTER_HIDE:
+                sprites.Erase(event.atoms[0]);
+                break;
+            default:
+                break;  // 台词、音效等一次性事件留给客户端从 GetEvents 读取
+        }
+    }
+
+    // ==================== SessionHost ====================
+
+    SessionHost::SessionHost(const SessionHostConfig& hostConfig)
+        : config(hostConfig), nextId(1), sessionCount(0), generation(0), pendingDelta(0.0f), nextShard(0),
+          finishedShards(0), busyWorkers(0), stopping(false) {
+        if (config.threadCount == 0) {
+            config.threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        if (config.shardCount == 0) {
+            config.shardCount = config.threadCount * 4;
+        }
+        shards.reserve(config.shardCount);
+        for (size_t i = 0; i < config.shardCount; ++i) {
+            shards.push_back(std::make_unique<Shard>());
+        }
+        // 调用 Tick 的线程也领取分片，只需要另开 threadCount - 1 个
+        for (size_t i = 1; i < config.threadCount; ++i) {
+            workers.emplace_back([this] { RunWorker(); });
+        }
+    }
+
+    SessionHost::~SessionHost() {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            stopping = true;
+        }
+        poolWake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    uint64_t SessionHost::CreateSession(std::shared_ptr<const SharedProgram> program) {
+        if (!program) {
+            std::cerr << "[会话] 没有可执行的脚本" << std::endl;
+            return 0;
+        }
+        uint64_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+        Shard& shard = ShardOf(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.indices.emplace(id, shard.sessions.size());
+        shard.sessions.push_back(
+            std::make_unique<PlayerSession>(id, std::move(program), shard.scheduler, config.arenaChunkBytes));
+        sessionCount.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    void SessionHost::DestroySession(uint64_t id) {
+        Shard& shard = ShardOf(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.indices.find(id);
+        if (it == shard.indices.end()) {
+            return;
+        }
+        size_t index = it->second;
+        shard.indices.erase(it);
+        PlayerSession* session = shard.sessions[index].get();
+        shard.updated.erase(std::remove(shard.updated.begin(), shard.updated.end(), session), shard.updated.end());
+        // 与最后一个交换后弹出，其他会话的下标只改一个
+        if (index + 1 != shard.sessions.size()) {
+            std::swap(shard.sessions[index], shard.sessions.back());
+            shard.indices[shard.sessions[index]->GetId()] = index;
+        }
+        shard.sessions.pop_back();
+        sessionCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void SessionHost::Post(const SessionInput& input) {
+        Shard& shard = ShardOf(input.session);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.inbox.push_back(input);
+    }
+
+    void SessionHost::Tick(float deltaTime) {
+        if (workers.empty()) {
+            for (const std::unique_ptr<Shard>& shard : shards) {
+                TickShard(*shard, deltaTime);
+            }
+            return;
+        }
+        RunShards(deltaTime);
+    }
+
+    void SessionHost::TickShard(Shard& shard, float deltaTime) {
+        // 整个分片推进期间持有分片锁，其他线程对本分片的 Post 在此之后进入下一次 Tick
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.updated.clear();
+        shard.applying.swap(shard.inbox);
+        for (const SessionInput& input : shard.applying) {
+            auto it = shard.indices.find(input.session);
+            if (it != shard.indices.end()) {
+                shard.sessions[it->second]->Apply(input);
+            }
+        }
+        shard.applying.clear();
+
+        // 到期的 @wait 在这里恢复，随后在本次 Update 中继续执行
+        shard.scheduler.Advance(deltaTime);
+        for (const std::unique_ptr<PlayerSession>& session : shard.sessions) {
+            if (session->Update(deltaTime)) {
+                shard.updated.push_back(session.get());
+            }
+        }
+    }
+
+    void SessionHost::RunShards(float deltaTime) {
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            // 上一次 Tick 中醒得晚的线程还在检查 nextShard 时不能重置它
+            poolDone.wait(lock, [this] { return busyWorkers == 0; });
+            pendingDelta = deltaTime;
+            nextShard.store(0, std::memory_order_relaxed);
+            finishedShards = 0;
+            ++generation;
+        }
+        poolWake.notify_all();
+
+        size_t done = 0;
+        for (size_t i = nextShard.fetch_add(1); i < shards.size(); i = nextShard.fetch_add(1)) {
+            TickShard(*shards[i], deltaTime);
+            ++done;
+        }
+
+        std::unique_lock<std::mutex> lock(poolMutex);
+        finishedShards += done;
+        poolDone.wait(lock, [this] { return finishedShards == shards.size(); });
+    }
+
+    void SessionHost::RunWorker() {
+        uint64_t seen = 0;
+        while (true) {
+            float deltaTime;
+            {
+                std::unique_lock<std::mutex> lock(poolMutex);
+                poolWake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                deltaTime = pendingDelta;
+                ++busyWorkers;
+            }
+
+            size_t done = 0;
+            for (size_t i = nextShard.fetch_add(1); i < shards.size(); i = nextShard.fetch_add(1)) {
+                TickShard(*shards[i], deltaTime);
+                ++done;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                finishedShards += done;
+                --busyWorkers;
+            }
+            poolDone.notify_all();
+        }
+    }
+
+} // namespace VisualNovel
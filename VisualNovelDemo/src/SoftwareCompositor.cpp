@@ -0,0 +1,335 @@
+#include "SoftwareCompositor.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace VisualNovel {
+
+    namespace {
+        // x / 255 四舍五入，x 不超过 255 * 255
+        inline uint32_t Div255(uint32_t x) {
+            x += 128;
+            return (x + (x >> 8)) >> 8;
+        }
+
+        void Premultiply(SoftwareImage& image) {
+            uint8_t* p = image.pixels.data();
+            for (size_t i = 0, count = image.pixels.size() / 4; i < count; ++i, p += 4) {
+                uint32_t alpha = p[3];
+                if (alpha == 255) continue;
+                p[0] = static_cast<uint8_t>(Div255(p[0] * alpha));
+                p[1] = static_cast<uint8_t>(Div255(p[1] * alpha));
+                p[2] = static_cast<uint8_t>(Div255(p[2] * alpha));
+            }
+        }
+
+        // 2x2 取平均生成下一层：先纵向两行平均，再横向两列平均，每步都是 (a + b + 1) >> 1
+        SoftwareImage Downsample(const SoftwareImage& source, bool useSimd) {
+            SoftwareImage result(source.width / 2, source.height / 2);
+            for (int y = 0; y < result.height; ++y) {
+                const uint8_t* upper = source.Row(y * 2);
+                const uint8_t* lower = source.Row(y * 2 + 1);
+                uint8_t* out = result.Row(y);
+                int x = 0;
+#if defined(__SSE2__)
+                if (useSimd) {
+                    for (; x + 4 <= result.width; x += 4) {
+                        const __m128i* a = reinterpret_cast<const __m128i*>(upper + x * 8);
+                        const __m128i* b = reinterpret_cast<const __m128i*>(lower + x * 8);
+                        __m128i left = _mm_avg_epu8(_mm_loadu_si128(a), _mm_loadu_si128(b));
+                        __m128i right = _mm_avg_epu8(_mm_loadu_si128(a + 1), _mm_loadu_si128(b + 1));
+                        // [p0 p1 p2 p3] -> [p0 p2 p1 p3]，再拼出偶数列和奇数列
+                        left = _mm_shuffle_epi32(left, _MM_SHUFFLE(3, 1, 2, 0));
+                        right = _mm_shuffle_epi32(right, _MM_SHUFFLE(3, 1, 2, 0));
+                        __m128i even = _mm_unpacklo_epi64(left, right);
+                        __m128i odd = _mm_unpackhi_epi64(left, right);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_avg_epu8(even, odd));
+                    }
+                }
+#else
+                (void)useSimd;
+#endif
+                for (; x < result.width; ++x) {
+                    for (int c = 0; c < 4; ++c) {
+                        int left = (upper[x * 8 + c] + lower[x * 8 + c] + 1) >> 1;
+                        int right = (upper[x * 8 + 4 + c] + lower[x * 8 + 4 + c] + 1) >> 1;
+                        out[x * 4 + c] = static_cast<uint8_t>((left + right + 1) >> 1);
+                    }
+                }
+            }
+            return result;
+        }
+
+        struct Axis {
+            int lowest;
+            int highest;
+        };
+
+        Axis ClampRegion(double start, double end, int size) {
+            Axis axis;
+            axis.lowest = std::max(0, static_cast<int>(std::floor(start)));
+            axis.highest = std::min(size - 1, static_cast<int>(std::ceil(end)) - 1);
+            axis.highest = std::max(axis.highest, axis.lowest);
+            return axis;
+        }
+
+        // 源图坐标转为 8 位小数的定点数；超出区域的夹到边缘
+        void MapCoordinate(double source, const Axis& axis, int32_t& first, int32_t& second, int32_t& weight) {
+            int64_t fixed = static_cast<int64_t>(std::floor(source * 256.0));
+            int64_t index = fixed >> 8;
+            weight = static_cast<int32_t>(fixed & 255);
+            if (index < axis.lowest) {
+                index = axis.lowest;
+                weight = 0;
+            } else if (index >= axis.highest) {
+                index = axis.highest;
+                weight = 0;
+            }
+            first = static_cast<int32_t>(index);
+            second = static_cast<int32_t>(std::min<int64_t>(index + 1, axis.highest));
+        }
+
+        // 双线性采样后以预乘 alpha 叠加：out = s + d * (255 - sa) / 255
+        inline void BlendPixelScalar(const uint8_t* a0, const uint8_t* a1, const uint8_t* b0, const uint8_t* b1,
+                                     uint32_t fx, uint32_t fy, uint8_t* dst) {
+            uint32_t source[4];
+            for (int c = 0; c < 4; ++c) {
+                uint32_t top = (a0[c] * (256 - fx) + a1[c] * fx + 128) >> 8;
+                uint32_t bottom = (b0[c] * (256 - fx) + b1[c] * fx + 128) >> 8;
+                source[c] = (top * (256 - fy) + bottom * fy + 128) >> 8;
+            }
+            uint32_t inverse = 255 - source[3];
+            for (int c = 0; c < 4; ++c) {
+                dst[c] = static_cast<uint8_t>(source[c] + Div255(dst[c] * inverse));
+            }
+        }
+
+#if defined(__SSE2__)
+        inline __m128i LoadPair(const uint8_t* first, const uint8_t* second) {
+            int32_t a, b;
+            std::memcpy(&a, first, 4);
+            std::memcpy(&b, second, 4);
+            return _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128(a), _mm_cvtsi32_si128(b)),
+                                     _mm_setzero_si128());
+        }
+
+        // 与 BlendPixelScalar 相同的运算，一次两个像素，每通道一个16位通道
+        inline void BlendPairSimd(const uint8_t* upper, const uint8_t* lower, const int32_t* firstX,
+                                  const int32_t* secondX, int32_t fxA, int32_t fxB, __m128i fy, __m128i inverseFy,
+                                  uint8_t* dst) {
+            const __m128i full = _mm_set1_epi16(256);
+            const __m128i half = _mm_set1_epi16(128);
+            __m128i fx = _mm_set_epi16(static_cast<short>(fxB), static_cast<short>(fxB), static_cast<short>(fxB),
+                                       static_cast<short>(fxB), static_cast<short>(fxA), static_cast<short>(fxA),
+                                       static_cast<short>(fxA), static_cast<short>(fxA));
+            __m128i inverseFx = _mm_sub_epi16(full, fx);
+
+            __m128i a0 = LoadPair(upper + firstX[0], upper + firstX[1]);
+            __m128i a1 = LoadPair(upper + secondX[0], upper + secondX[1]);
+            __m128i b0 = LoadPair(lower + firstX[0], lower + firstX[1]);
+            __m128i b1 = LoadPair(lower + secondX[0], lower + secondX[1]);
+            // 乘积之和不超过 255 * 256 + 128，16 位无符号不会溢出
+            __m128i top = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(a0, inverseFx), _mm_mullo_epi16(a1, fx)), half);
+            __m128i bottom = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(b0, inverseFx), _mm_mullo_epi16(b1, fx)), half);
+            top = _mm_srli_epi16(top, 8);
+            bottom = _mm_srli_epi16(bottom, 8);
+            __m128i source = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(top, inverseFy), _mm_mullo_epi16(bottom, fy)), half);
+            source = _mm_srli_epi16(source, 8);
+
+            __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)),
+                                                _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i inverseAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+            __m128i destination = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(dst)),
+                                                    _mm_setzero_si128());
+            __m128i scaled = _mm_add_epi16(_mm_mullo_epi16(destination, inverseAlpha), half);
+            scaled = _mm_srli_epi16(_mm_add_epi16(scaled, _mm_srli_epi16(scaled, 8)), 8);
+            __m128i result = _mm_add_epi16(source, scaled);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(result, result));
+        }
+#endif
+    }
+
+    SoftwareCompositor::SoftwareCompositor(int referenceWidth)
+        : referenceWidth(referenceWidth), useSimd(true), cachedBytes(0) {}
+
+    SoftwareCompositor::~SoftwareCompositor() {
+        ClearCache();
+    }
+
+    bool SoftwareCompositor::IsSimdAvailable() const {
+#if defined(__SSE2__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void SoftwareCompositor::ClearCache() {
+        MetricsRegistry::Instance().AddGauge(EngineMetrics::Get().assetBytes, -static_cast<int64_t>(cachedBytes));
+        cachedBytes = 0;
+        cache.clear();
+        missingTextures.clear();
+    }
+
+    bool SoftwareCompositor::LoadTexture(const std::string& name, SoftwareImage& image) const {
+        if (loader) {
+            return loader(name, image);
+        }
+        std::filesystem::path path = assetRoot.empty() ? std::filesystem::path(name)
+                                                       : std::filesystem::path(assetRoot) / name;
+        if (path.has_extension()) {
+            return LoadImageFile(path.string(), image);
+        }
+        return LoadImageFile(path.string() + ".png", image) || LoadImageFile(path.string() + ".pam", image);
+    }
+
+    const SoftwareCompositor::Texture* SoftwareCompositor::GetTexture(const std::string& name) {
+        const EngineMetrics& metrics = EngineMetrics::Get();
+        auto it = cache.find(name);
+        if (it != cache.end()) {
+            MetricsRegistry::Instance().Increment(metrics.assetCacheHits);
+        } else {
+            MetricsRegistry::Instance().Increment(metrics.assetCacheMisses);
+            // 读取失败也缓存为空，避免每次绘制都重试
+            std::unique_ptr<Texture> texture;
+            SoftwareImage image;
+            if (LoadTexture(name, image) && image.width > 0 && image.height > 0) {
+                Premultiply(image);
+                texture = std::make_unique<Texture>();
+                texture->levels.push_back(std::move(image));
+                while (texture->levels.back().width >= 2 && texture->levels.back().height >= 2) {
+                    SoftwareImage next = Downsample(texture->levels.back(), useSimd);
+                    texture->levels.push_back(std::move(next));
+                }
+                size_t bytes = 0;
+                for (const SoftwareImage& level : texture->levels) {
+                    bytes += level.pixels.size();
+                }
+                cachedBytes += bytes;
+                MetricsRegistry::Instance().AddGauge(metrics.assetBytes, static_cast<int64_t>(bytes));
+            }
+            it = cache.emplace(name, std::move(texture)).first;
+        }
+        if (!it->second) {
+            missingTextures.insert(name);
+        }
+        return it->second.get();
+    }
+
+    void SoftwareCompositor::Render(const SceneSnapshot& scene, SoftwareImage& target) {
+        missingTextures.clear();
+        for (size_t i = 0; i < target.pixels.size(); i += 4) {
+            target.pixels[i] = target.pixels[i + 1] = target.pixels[i + 2] = 0;
+            target.pixels[i + 3] = 255;
+        }
+
+        if (!scene.background.empty()) {
+            if (const Texture* background = GetTexture(scene.background)) {
+                SceneSprite full;
+                DrawSprite(*background, full, target, 0.0, 0.0, target.width, target.height);
+            }
+        }
+
+        drawOrder.clear();
+        for (const SceneSprite& sprite : scene.sprites) {
+            drawOrder.push_back(&sprite);
+        }
+        std::stable_sort(drawOrder.begin(), drawOrder.end(),
+                         [](const SceneSprite* a, const SceneSprite* b) { return a->depth < b->depth; });
+
+        double factor = static_cast<double>(target.width) / referenceWidth;
+        for (const SceneSprite* sprite : drawOrder) {
+            const Texture* texture = GetTexture(sprite->texture);
+            if (!texture) {
+                continue;
+            }
+            const SoftwareImage& base = texture->levels.front();
+            double width = sprite->uw * base.width * sprite->scale * factor;
+            double height = sprite->vh * base.height * sprite->scale * factor;
+            double left = sprite->x * target.width - width * 0.5;
+            double top = sprite->y * target.height - height * 0.5;
+            DrawSprite(*texture, *sprite, target, left, top, width, height);
+        }
+    }
+
+    void SoftwareCompositor::DrawSprite(const Texture& texture, const SceneSprite& sprite, SoftwareImage& target,
+                                        double left, double top, double width, double height) {
+        if (width <= 0.0 || height <= 0.0 || sprite.uw <= 0.0f || sprite.vh <= 0.0f) {
+            return;
+        }
+
+        // 目标像素中心落在 [left, left + width) 内的才绘制
+        int x0 = std::max(0, static_cast<int>(std::ceil(left - 0.5)));
+        int x1 = std::min(target.width, static_cast<int>(std::ceil(left + width - 0.5)));
+        int y0 = std::max(0, static_cast<int>(std::ceil(top - 0.5)));
+        int y1 = std::min(target.height, static_cast<int>(std::ceil(top + height - 0.5)));
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+
+        // 每个目标像素覆盖两个以上源像素时换到更小的 mip 层
+        const SoftwareImage& base = texture.levels.front();
+        double regionX = sprite.u * base.width;
+        double regionY = sprite.v * base.height;
+        double regionWidth = sprite.uw * base.width;
+        double regionHeight = sprite.vh * base.height;
+        size_t level = 0;
+        while (level + 1 < texture.levels.size() && regionWidth / width >= 2.0 && regionHeight / height >= 2.0) {
+            ++level;
+            regionX *= 0.5;
+            regionY *= 0.5;
+            regionWidth *= 0.5;
+            regionHeight *= 0.5;
+        }
+        const SoftwareImage& image = texture.levels[level];
+        double stepX = regionWidth / width;
+        double stepY = regionHeight / height;
+
+        Axis horizontal = ClampRegion(regionX, regionX + regionWidth, image.width);
+        Axis vertical = ClampRegion(regionY, regionY + regionHeight, image.height);
+
+        // 列的采样位置每行相同，先算好；first/second 存字节偏移
+        columns.resize(static_cast<size_t>(x1 - x0));
+        for (int x = x0; x < x1; ++x) {
+            Sample& sample = columns[x - x0];
+            MapCoordinate(regionX + (x + 0.5 - left) * stepX - 0.5, horizontal, sample.first, sample.second,
+                          sample.weight);
+            sample.first *= 4;
+            sample.second *= 4;
+        }
+
+        for (int y = y0; y < y1; ++y) {
+            Sample row;
+            MapCoordinate(regionY + (y + 0.5 - top) * stepY - 0.5, vertical, row.first, row.second, row.weight);
+            const uint8_t* upper = image.Row(row.first);
+            const uint8_t* lower = image.Row(row.second);
+            uint8_t* dst = target.Row(y) + x0 * 4;
+            const Sample* sample = columns.data();
+            size_t count = columns.size();
+            size_t i = 0;
+#if defined(__SSE2__)
+            if (useSimd) {
+                __m128i fy = _mm_set1_epi16(static_cast<short>(row.weight));
+                __m128i inverseFy = _mm_sub_epi16(_mm_set1_epi16(256), fy);
+                for (; i + 2 <= count; i += 2) {
+                    int32_t firstX[2] = {sample[i].first, sample[i + 1].first};
+                    int32_t secondX[2] = {sample[i].second, sample[i + 1].second};
+                    BlendPairSimd(upper, lower, firstX, secondX, sample[i].weight, sample[i + 1].weight, fy,
+                                  inverseFy, dst + i * 4);
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                BlendPixelScalar(upper + sample[i].first, upper + sample[i].second, lower + sample[i].first,
+                                 lower + sample[i].second, static_cast<uint32_t>(sample[i].weight),
+                                 static_cast<uint32_t>(row.weight), dst + i * 4);
+            }
+        }
+    }
+
+} // namespace VisualNovel
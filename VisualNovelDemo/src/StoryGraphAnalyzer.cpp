@@ -0,0 +1,456 @@
+#include "StoryGraphAnalyzer.h"
+#include <algorithm>
+#include <future>
+#include <queue>
+#include <sstream>
+#include <cstdio>
+
+namespace VisualNovel {
+
+    namespace {
+        const uint32_t kBase = 1000000000u;
+        const uint32_t kUnvisited = UINT32_MAX;
+        const int64_t kNoRoute = -1;
+    }
+
+    PathCount::PathCount(uint32_t value) {
+        if (value >= kBase) {
+            limbs.push_back(value % kBase);
+            limbs.push_back(value / kBase);
+        } else if (value > 0) {
+            limbs.push_back(value);
+        }
+    }
+
+    void PathCount::Add(const PathCount& other) {
+        if (other.limbs.size() > limbs.size()) {
+            limbs.resize(other.limbs.size(), 0);
+        }
+        uint32_t carry = 0;
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            uint64_t sum = uint64_t(limbs[i]) + carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+            if (i >= other.limbs.size() && carry == 0) break;
+            limbs[i] = static_cast<uint32_t>(sum % kBase);
+            carry = static_cast<uint32_t>(sum / kBase);
+        }
+        if (carry) limbs.push_back(carry);
+    }
+
+    bool PathCount::IsZero() const {
+        return limbs.empty();
+    }
+
+    std::string PathCount::ToString() const {
+        if (limbs.empty()) return "0";
+        std::string result = std::to_string(limbs.back());
+        char buffer[16];
+        for (size_t i = limbs.size() - 1; i-- > 0;) {
+            std::snprintf(buffer, sizeof(buffer), "%09u", limbs[i]);
+            result += buffer;
+        }
+        return result;
+    }
+
+    uint32_t StoryGraph::NodeCount() const {
+        return static_cast<uint32_t>(names.size());
+    }
+
+    StoryGraph StoryGraph::FromCommands(const ScriptCommandList& commands,
+                                        const std::map<std::string, ScriptLabel>& labels) {
+        StoryGraph graph;
+        const size_t count = commands.size();
+
+        // 基本块起点：脚本开头、每个标签、每条转移命令之后
+        std::vector<uint8_t> leader(count + 1, 0);
+        leader[0] = 1;
+        std::vector<std::string> labelAt(count + 1);
+        for (const auto& entry : labels) {
+            size_t pos = static_cast<size_t>(std::max(0, std::min(entry.second.position, static_cast<int>(count))));
+            leader[pos] = 1;
+            labelAt[pos] = entry.first;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            switch (commands[i].type) {
+                case CommandType::JUMP:
+                case CommandType::CHOICE:
+                case CommandType::CONDITION:
+                case CommandType::CALL:
+                case CommandType::RETURN:
+                case CommandType::END:
+                    leader[i + 1] = 1;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        std::vector<uint32_t> blockOf(count + 1, 0);
+        std::vector<size_t> blockStart;
+        for (size_t i = 0; i <= count; ++i) {
+            // 结尾处只有在有标签指向它、或脚本为空时才需要一个空块
+            if (leader[i] && (i < count || !labelAt[i].empty() || count == 0)) {
+                blockStart.push_back(i);
+            }
+            blockOf[i] = blockStart.empty() ? 0 : static_cast<uint32_t>(blockStart.size() - 1);
+        }
+
+        const uint32_t blockCount = static_cast<uint32_t>(blockStart.size());
+        graph.names.reserve(blockCount);
+        graph.edgeOffsets.reserve(blockCount + 1);
+        graph.callOffsets.reserve(blockCount + 1);
+        graph.edgeOffsets.push_back(0);
+        graph.callOffsets.push_back(0);
+
+        auto resolve = [&](std::string_view label, const ScriptCommand& cmd, uint32_t& block) {
+            auto it = labels.find(std::string(label));
+            if (it == labels.end()) {
+                graph.danglingLabels.push_back("第 " + std::to_string(cmd.lineNumber) + " 行: 未定义的标签 " +
+                                               std::string(label));
+                return false;
+            }
+            block = blockOf[std::max(0, std::min(it->second.position, static_cast<int>(count)))];
+            return true;
+        };
+
+        for (uint32_t b = 0; b < blockCount; ++b) {
+            size_t begin = blockStart[b];
+            size_t end = b + 1 < blockCount ? blockStart[b + 1] : count;
+            end = std::max(begin, end);
+
+            uint32_t lines = 0;
+            for (size_t i = begin; i < end; ++i) {
+                if (commands[i].type == CommandType::DIALOGUE) ++lines;
+            }
+
+            if (!labelAt[begin].empty()) {
+                graph.names.push_back(labelAt[begin]);
+            } else if (begin < count) {
+                graph.names.push_back("行 " + std::to_string(commands[begin].lineNumber));
+            } else {
+                graph.names.push_back("<结尾>");
+            }
+            graph.sourceLines.push_back(begin < count ? commands[begin].lineNumber : 0);
+            graph.lineCounts.push_back(lines);
+
+            bool exit = false;
+            bool fallthrough = true;
+            uint32_t target = 0;
+            if (end > begin) {
+                const ScriptCommand& last = commands[end - 1];
+                switch (last.type) {
+                    case CommandType::JUMP:
+                        fallthrough = false;
+                        if (resolve(last.parameters[0], last, target)) graph.edges.push_back(target);
+                        break;
+                    case CommandType::CHOICE:
+                        fallthrough = false;
+                        for (size_t p = 1; p < last.parameters.size(); p += 2) {
+                            if (resolve(last.parameters[p], last, target)) graph.edges.push_back(target);
+                        }
+                        break;
+                    case CommandType::CONDITION:
+                        if (resolve(last.parameters.back(), last, target)) graph.edges.push_back(target);
+                        break;
+                    case CommandType::CALL:
+                        if (resolve(last.parameters[0], last, target)) graph.calls.push_back(target);
+                        break;
+                    case CommandType::RETURN:
+                    case CommandType::END:
+                        fallthrough = false;
+                        exit = true;
+                        break;
+                    default:
+                        break;
+                }
+            }
+            if (fallthrough) {
+                if (b + 1 < blockCount) {
+                    graph.edges.push_back(b + 1);
+                } else {
+                    exit = true;
+                }
+            }
+
+            graph.isExit.push_back(exit ? 1 : 0);
+            graph.edgeOffsets.push_back(static_cast<uint32_t>(graph.edges.size()));
+            graph.callOffsets.push_back(static_cast<uint32_t>(graph.calls.size()));
+        }
+
+        return graph;
+    }
+
+    StoryGraphReport StoryGraphAnalyzer::Analyze(const StoryGraph& graph) {
+        StoryGraphReport report;
+        if (graph.NodeCount() == 0) return report;
+
+        // 可达性与最短路线不依赖强连通分量，先放到其他核心上
+        auto reachTask = std::async(std::launch::async, [&graph]() {
+            return ComputeReachable(graph);
+        });
+        auto shortestTask = std::async(std::launch::async, [&graph]() {
+            uint64_t length = 0;
+            bool found = ComputeShortestRoute(graph, length);
+            return std::make_pair(found, length);
+        });
+
+        std::vector<std::vector<uint32_t>> components = ComputeComponents(graph);
+        std::vector<uint32_t> componentOf(graph.NodeCount());
+        for (uint32_t c = 0; c < components.size(); ++c) {
+            for (uint32_t v : components[c]) componentOf[v] = c;
+        }
+
+        auto countTask = std::async(std::launch::async, [&]() {
+            PathCount count;
+            bool bounded = CountPaths(graph, components, componentOf, count);
+            return std::make_pair(bounded, count);
+        });
+
+        uint64_t longest = 0;
+        bool longestBounded = ComputeLongestRoute(graph, components, componentOf, longest);
+
+        for (const auto& component : components) {
+            bool cyclic = component.size() > 1;
+            if (!cyclic) {
+                uint32_t v = component[0];
+                for (uint32_t e = graph.edgeOffsets[v]; e < graph.edgeOffsets[v + 1]; ++e) {
+                    if (graph.edges[e] == v) cyclic = true;
+                }
+            }
+            if (cyclic) report.loops.push_back(component);
+        }
+
+        std::vector<uint8_t> reachable = reachTask.get();
+        for (uint32_t v = 0; v < graph.NodeCount(); ++v) {
+            if (reachable[v]) {
+                ++report.reachableCount;
+            } else {
+                report.unreachable.push_back(v);
+            }
+        }
+
+        auto shortest = shortestTask.get();
+        report.hasRoute = shortest.first;
+        report.shortestRoute = shortest.second;
+
+        auto counted = countTask.get();
+        report.unboundedPaths = !counted.first || !longestBounded;
+        report.pathCount = counted.second;
+        report.longestRoute = longest;
+        return report;
+    }
+
+    std::vector<uint8_t> StoryGraphAnalyzer::ComputeReachable(const StoryGraph& graph) {
+        std::vector<uint8_t> reachable(graph.NodeCount(), 0);
+        std::vector<uint32_t> stack{graph.entry};
+        reachable[graph.entry] = 1;
+        while (!stack.empty()) {
+            uint32_t v = stack.back();
+            stack.pop_back();
+            auto visit = [&](uint32_t w) {
+                if (!reachable[w]) {
+                    reachable[w] = 1;
+                    stack.push_back(w);
+                }
+            };
+            for (uint32_t e = graph.edgeOffsets[v]; e < graph.edgeOffsets[v + 1]; ++e) visit(graph.edges[e]);
+            for (uint32_t e = graph.callOffsets[v]; e < graph.callOffsets[v + 1]; ++e) visit(graph.calls[e]);
+        }
+        return reachable;
+    }
+
+    std::vector<std::vector<uint32_t>> StoryGraphAnalyzer::ComputeComponents(const StoryGraph& graph) {
+        // 迭代版 Tarjan，分量按完成顺序输出，即凝聚图的逆拓扑序
+        const uint32_t n = graph.NodeCount();
+        std::vector<uint32_t> index(n, kUnvisited);
+        std::vector<uint32_t> low(n, 0);
+        std::vector<uint8_t> onStack(n, 0);
+        std::vector<uint32_t> stack;
+        std::vector<std::pair<uint32_t, uint32_t>> callStack;  // 节点，下一条待处理的边
+        std::vector<std::vector<uint32_t>> components;
+        uint32_t counter = 0;
+
+        for (uint32_t root = 0; root < n; ++root) {
+            if (index[root] != kUnvisited) continue;
+
+            index[root] = low[root] = counter++;
+            stack.push_back(root);
+            onStack[root] = 1;
+            callStack.push_back({root, graph.edgeOffsets[root]});
+
+            while (!callStack.empty()) {
+                uint32_t v = callStack.back().first;
+                uint32_t& next = callStack.back().second;
+
+                if (next < graph.edgeOffsets[v + 1]) {
+                    uint32_t w = graph.edges[next++];
+                    if (index[w] == kUnvisited) {
+                        index[w] = low[w] = counter++;
+                        stack.push_back(w);
+                        onStack[w] = 1;
+                        callStack.push_back({w, graph.edgeOffsets[w]});
+                    } else if (onStack[w]) {
+                        low[v] = std::min(low[v], index[w]);
+                    }
+                    continue;
+                }
+
+                callStack.pop_back();
+                if (low[v] == index[v]) {
+                    components.emplace_back();
+                    uint32_t w;
+                    do {
+                        w = stack.back();
+                        stack.pop_back();
+                        onStack[w] = 0;
+                        components.back().push_back(w);
+                    } while (w != v);
+                }
+                if (!callStack.empty()) {
+                    uint32_t parent = callStack.back().first;
+                    low[parent] = std::min(low[parent], low[v]);
+                }
+            }
+        }
+        return components;
+    }
+
+    bool StoryGraphAnalyzer::ComputeShortestRoute(const StoryGraph& graph, uint64_t& length) {
+        // 节点带权（对话行数）的 Dijkstra
+        std::vector<uint64_t> dist(graph.NodeCount(), UINT64_MAX);
+        using Item = std::pair<uint64_t, uint32_t>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+        dist[graph.entry] = graph.lineCounts[graph.entry];
+        queue.push({dist[graph.entry], graph.entry});
+
+        while (!queue.empty()) {
+            Item item = queue.top();
+            queue.pop();
+            uint32_t v = item.second;
+            if (item.first != dist[v]) continue;
+            if (graph.isExit[v]) {
+                length = item.first;
+                return true;
+            }
+            for (uint32_t e = graph.edgeOffsets[v]; e < graph.edgeOffsets[v + 1]; ++e) {
+                uint32_t w = graph.edges[e];
+                uint64_t candidate = item.first + graph.lineCounts[w];
+                if (candidate < dist[w]) {
+                    dist[w] = candidate;
+                    queue.push({candidate, w});
+                }
+            }
+        }
+        return false;
+    }
+
+    bool StoryGraphAnalyzer::CountPaths(const StoryGraph& graph,
+                                        const std::vector<std::vector<uint32_t>>& components,
+                                        const std::vector<uint32_t>& componentOf,
+                                        PathCount& count) {
+        // 逆拓扑序上的 DP：路线数(v) = [v 是结局] + Σ 路线数(后继)
+        std::vector<PathCount> paths(components.size());
+        std::vector<uint8_t> unbounded(components.size(), 0);
+
+        for (uint32_t c = 0; c < components.size(); ++c) {
+            const auto& component = components[c];
+            PathCount sum;
+            bool infinite = false;
+            bool cyclic = component.size() > 1;
+            for (uint32_t v : component) {
+                if (graph.isExit[v]) sum.Add(PathCount(1));
+                for (uint32_t e = graph.edgeOffsets[v]; e < graph.edgeOffsets[v + 1]; ++e) {
+                    uint32_t target = componentOf[graph.edges[e]];
+                    if (target == c) {
+                        cyclic = true;
+                        continue;
+                    }
+                    if (unbounded[target]) {
+                        infinite = true;
+                    } else {
+                        sum.Add(paths[target]);
+                    }
+                }
+            }
+            // 能通往结局的环意味着路线数无上限
+            if (cyclic && (infinite || !sum.IsZero())) infinite = true;
+
+            unbounded[c] = infinite ? 1 : 0;
+            if (!infinite) paths[c] = std::move(sum);
+        }
+
+        uint32_t entry = componentOf[graph.entry];
+        count = paths[entry];
+        return !unbounded[entry];
+    }
+
+    bool StoryGraphAnalyzer::ComputeLongestRoute(const StoryGraph& graph,
+                                                 const std::vector<std::vector<uint32_t>>& components,
+                                                 const std::vector<uint32_t>& componentOf,
+                                                 uint64_t& length) {
+        std::vector<int64_t> longest(components.size(), kNoRoute);
+        std::vector<uint8_t> unbounded(components.size(), 0);
+
+        for (uint32_t c = 0; c < components.size(); ++c) {
+            const auto& component = components[c];
+            int64_t best = kNoRoute;
+            bool infinite = false;
+            bool cyclic = component.size() > 1;
+            for (uint32_t v : component) {
+                if (graph.isExit[v]) best = std::max<int64_t>(best, 0);
+                for (uint32_t e = graph.edgeOffsets[v]; e < graph.edgeOffsets[v + 1]; ++e) {
+                    uint32_t target = componentOf[graph.edges[e]];
+                    if (target == c) {
+                        cyclic = true;
+                        continue;
+                    }
+                    if (unbounded[target]) infinite = true;
+                    best = std::max(best, longest[target]);
+                }
+            }
+            if (cyclic && (infinite || best != kNoRoute)) infinite = true;
+
+            unbounded[c] = infinite ? 1 : 0;
+            if (!infinite && best != kNoRoute) {
+                longest[c] = best + graph.lineCounts[component[0]];
+            }
+        }
+
+        uint32_t entry = componentOf[graph.entry];
+        length = longest[entry] == kNoRoute ? 0 : static_cast<uint64_t>(longest[entry]);
+        return !unbounded[entry];
+    }
+
+    std::string StoryGraphAnalyzer::FormatReport(const StoryGraph& graph, const StoryGraphReport& report) {
+        std::ostringstream out;
+        out << "节点: " << graph.NodeCount() << "  可达: " << report.reachableCount
+            << "  不可达: " << report.unreachable.size() << "\n";
+
+        for (uint32_t v : report.unreachable) {
+            out << "  [不可达] " << graph.names[v] << " (行 " << graph.sourceLines[v] << ")\n";
+        }
+        for (const std::string& dangling : graph.danglingLabels) {
+            out << "  [错误] " << dangling << "\n";
+        }
+
+        out << "循环: " << report.loops.size() << "\n";
+        for (const auto& loop : report.loops) {
+            out << "  [循环]";
+            for (uint32_t v : loop) out << " " << graph.names[v];
+            out << "\n";
+        }
+
+        if (!report.hasRoute) {
+            out << "路线: 没有通往结局的路线\n";
+        } else if (report.unboundedPaths) {
+            out << "路线数: 无限（通往结局的路上有循环）\n";
+            out << "最短路线: " << report.shortestRoute << " 行\n";
+            out << "最长路线: 无上限\n";
+        } else {
+            out << "路线数: " << report.pathCount.ToString() << "\n";
+            out << "最短路线: " << report.shortestRoute << " 行\n";
+            out << "最长路线: " << report.longestRoute << " 行\n";
+        }
+        return out.str();
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,400 @@
+#include "TextSearchIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "ScriptInterpreter.h"
+#include "ScriptProject.h"
+#include "Profiler.h"
+
+namespace VisualNovel {
+
+    namespace {
+        const uint64_t kUnigram = 0xFFFFFFFFull;  // 单个码点的词元，第二个位置填一个不存在的码点
+        const uint32_t kIndexVersion = 1;
+
+        char LowerAscii(char c) {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        // 解码一个码点；非法字节按单字节处理，映射到码点范围之外避免和合法字符混淆
+        uint32_t DecodeUtf8(std::string_view text, size_t& pos) {
+            unsigned char lead = static_cast<unsigned char>(text[pos]);
+            size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+            if (length == 0 || pos + length > text.size()) {
+                ++pos;
+                return 0x110000u + lead;
+            }
+            if (length == 1) {
+                ++pos;
+                return static_cast<uint32_t>(LowerAscii(static_cast<char>(lead)));
+            }
+            uint32_t cp = lead & (0x7F >> length);
+            for (size_t i = 1; i < length; ++i) {
+                unsigned char next = static_cast<unsigned char>(text[pos + i]);
+                if ((next & 0xC0) != 0x80) {
+                    ++pos;
+                    return 0x110000u + lead;
+                }
+                cp = (cp << 6) | (next & 0x3F);
+            }
+            pos += length;
+            return cp;
+        }
+
+        size_t FindIgnoreCase(std::string_view text, std::string_view keyword) {
+            auto it = std::search(text.begin(), text.end(), keyword.begin(), keyword.end(),
+                [](char a, char b) { return LowerAscii(a) == LowerAscii(b); });
+            return it == text.end() ? std::string_view::npos : static_cast<size_t>(it - text.begin());
+        }
+
+        void AddPosting(std::vector<uint32_t>& postings, uint32_t document) {
+            if (postings.empty() || postings.back() != document) {
+                postings.push_back(document);
+            }
+        }
+
+        template <typename Map>
+        void CompactMap(Map& map, uint32_t firstDocument) {
+            for (auto it = map.begin(); it != map.end();) {
+                std::vector<uint32_t>& postings = it->second;
+                postings.erase(postings.begin(), std::lower_bound(postings.begin(), postings.end(), firstDocument));
+                it = postings.empty() ? map.erase(it) : std::next(it);
+            }
+        }
+
+        // ---- 二进制读写 ----
+        template <typename T>
+        void WritePod(std::ostream& out, T value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        bool ReadPod(std::istream& in, T& value) {
+            return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+        }
+
+        void WriteString(std::ostream& out, const std::string& text) {
+            WritePod(out, static_cast<uint32_t>(text.size()));
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+
+        bool ReadString(std::istream& in, std::string& text) {
+            uint32_t size = 0;
+            if (!ReadPod(in, size)) return false;
+            text.resize(size);
+            return size == 0 || static_cast<bool>(in.read(&text[0], size));
+        }
+
+        void WritePostings(std::ostream& out, const std::vector<uint32_t>& postings) {
+            WritePod(out, static_cast<uint32_t>(postings.size()));
+            out.write(reinterpret_cast<const char*>(postings.data()),
+                      static_cast<std::streamsize>(postings.size() * sizeof(uint32_t)));
+        }
+
+        bool ReadPostings(std::istream& in, std::vector<uint32_t>& postings) {
+            uint32_t size = 0;
+            if (!ReadPod(in, size)) return false;
+            postings.resize(size);
+            return size == 0 ||
+                   static_cast<bool>(in.read(reinterpret_cast<char*>(postings.data()), size * sizeof(uint32_t)));
+        }
+
+        template <typename Map>
+        void WriteStringMap(std::ostream& out, const Map& map) {
+            WritePod(out, static_cast<uint32_t>(map.size()));
+            for (const auto& entry : map) {
+                WriteString(out, entry.first);
+                WritePostings(out, entry.second);
+            }
+        }
+
+        template <typename Map>
+        bool ReadStringMap(std::istream& in, Map& map) {
+            uint32_t count = 0;
+            if (!ReadPod(in, count)) return false;
+            for (uint32_t i = 0; i < count; ++i) {
+                std::string key;
+                if (!ReadString(in, key) || !ReadPostings(in, map[key])) return false;
+            }
+            return true;
+        }
+    }
+
+    TextSearchIndex::TextSearchIndex()
+        : firstDocument(0), compactedBefore(0) {
+    }
+
+    void TextSearchIndex::Tokenize(std::string_view text, std::vector<uint64_t>& out) {
+        size_t pos = 0;
+        uint32_t previous = 0;
+        bool hasPrevious = false;
+        while (pos < text.size()) {
+            uint32_t cp = DecodeUtf8(text, pos);
+            out.push_back((static_cast<uint64_t>(cp) << 32) | kUnigram);
+            if (hasPrevious) {
+                out.push_back((static_cast<uint64_t>(previous) << 32) | cp);
+            }
+            previous = cp;
+            hasPrevious = true;
+        }
+    }
+
+    uint32_t TextSearchIndex::Add(SearchDocument document) {
+        uint32_t id = GetEndDocument();
+
+        std::vector<uint64_t> tokens;
+        Tokenize(document.text, tokens);
+        std::sort(tokens.begin(), tokens.end());
+        tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+        for (uint64_t token : tokens) {
+            grams[token].push_back(id);
+        }
+
+        if (!document.speaker.empty()) {
+            AddPosting(speakers[document.speaker], id);
+        }
+        if (!document.speakerName.empty()) {
+            AddPosting(speakers[document.speakerName], id);
+        }
+        if (!document.label.empty()) {
+            AddPosting(labels[document.label], id);
+        }
+        documents.push_back(std::move(document));
+        return id;
+    }
+
+    void TextSearchIndex::RemoveBefore(uint32_t document) {
+        while (firstDocument < document && !documents.empty()) {
+            documents.pop_front();
+            ++firstDocument;
+        }
+        if (documents.empty()) {
+            firstDocument = std::max(firstDocument, document);  // 之后加入的文档从 document 开始编号
+        }
+        // 已移除的编号留在倒排表里，查询时跳过；积累到比现存文档还多时再统一清理
+        if (firstDocument - compactedBefore > documents.size()) {
+            Compact();
+        }
+    }
+
+    void TextSearchIndex::Compact() {
+        CompactMap(grams, firstDocument);
+        CompactMap(speakers, firstDocument);
+        CompactMap(labels, firstDocument);
+        compactedBefore = firstDocument;
+    }
+
+    void TextSearchIndex::Clear() {
+        documents.clear();
+        grams.clear();
+        speakers.clear();
+        labels.clear();
+        firstDocument = 0;
+        compactedBefore = 0;
+    }
+
+    const SearchDocument* TextSearchIndex::GetDocument(uint32_t document) const {
+        if (document < firstDocument || document >= GetEndDocument()) {
+            return nullptr;
+        }
+        return &documents[document - firstDocument];
+    }
+
+    const std::vector<uint32_t>* TextSearchIndex::FindPostings(uint64_t gram) const {
+        auto it = grams.find(gram);
+        return it == grams.end() ? nullptr : &it->second;
+    }
+
+    std::vector<SearchHit> TextSearchIndex::Search(const SearchQuery& query) const {
+        VN_TRACE_ZONE(ENGINE, "TextSearchIndex::Search");
+        std::vector<SearchHit> hits;
+        std::vector<const std::vector<uint32_t>*> lists;
+
+        if (!query.text.empty()) {
+            std::vector<uint64_t> tokens;
+            Tokenize(query.text, tokens);
+            // 两个码点以上时只用相邻码点对，单个码点的倒排表太长
+            if (tokens.size() > 1) {
+                tokens.erase(std::remove_if(tokens.begin(), tokens.end(),
+                    [](uint64_t token) { return (token & kUnigram) == kUnigram; }), tokens.end());
+            }
+            std::sort(tokens.begin(), tokens.end());
+            tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+            for (uint64_t token : tokens) {
+                const std::vector<uint32_t>* postings = FindPostings(token);
+                if (!postings) return hits;
+                lists.push_back(postings);
+            }
+        }
+        if (!query.speaker.empty()) {
+            auto it = speakers.find(query.speaker);
+            if (it == speakers.end()) return hits;
+            lists.push_back(&it->second);
+        }
+        if (!query.label.empty()) {
+            auto it = labels.find(query.label);
+            if (it == labels.end()) return hits;
+            lists.push_back(&it->second);
+        }
+        if (lists.empty()) {
+            return hits;
+        }
+
+        // 从最短的倒排表出发，其余表各保留一个只进不退的游标
+        std::sort(lists.begin(), lists.end(),
+            [](const auto* a, const auto* b) { return a->size() < b->size(); });
+        std::vector<std::vector<uint32_t>::const_iterator> cursors;
+        for (size_t i = 1; i < lists.size(); ++i) {
+            cursors.push_back(lists[i]->begin());
+        }
+
+        auto start = std::lower_bound(lists[0]->begin(), lists[0]->end(), firstDocument);
+        for (auto candidate = start; candidate != lists[0]->end() && hits.size() < query.limit; ++candidate) {
+            uint32_t document = *candidate;
+            bool matched = true;
+            for (size_t i = 0; i < cursors.size() && matched; ++i) {
+                cursors[i] = std::lower_bound(cursors[i], lists[i + 1]->end(), document);
+                matched = cursors[i] != lists[i + 1]->end() && *cursors[i] == document;
+            }
+            if (!matched) continue;
+
+            const SearchDocument& entry = documents[document - firstDocument];
+            size_t offset = 0;
+            if (!query.text.empty()) {
+                offset = FindIgnoreCase(entry.text, query.text);
+                if (offset == std::string_view::npos) continue;  // 词元都在但不相邻
+            }
+            hits.push_back({document, &entry, offset});
+        }
+        return hits;
+    }
+
+    void TextSearchIndex::IndexScript(TextSearchIndex& index, const ScriptCommandList& commands,
+                                      const std::string& source) {
+        IndexCommands(index, commands.data(), commands.data() + commands.size(), source);
+    }
+
+    void TextSearchIndex::IndexCommands(TextSearchIndex& index, const ScriptCommand* first, const ScriptCommand* last,
+                                        const std::string& source) {
+        std::map<std::string, std::string> displayNames;
+        std::string label;
+        for (const ScriptCommand* it = first; it != last; ++it) {
+            const ScriptCommand& command = *it;
+            const ArenaStringList& params = command.parameters;
+            if (command.type == CommandType::LABEL && !params.empty()) {
+                label = params[0];
+            } else if (command.type == CommandType::SPECIAL_EFFECT && params.size() > 1 && params[0] == "character") {
+                for (size_t i = 2; i < params.size(); ++i) {
+                    if (params[i].compare(0, 5, "name=") == 0) {
+                        displayNames[std::string(params[1])] = params[i].substr(5);
+                    }
+                }
+            } else if (command.type == CommandType::DIALOGUE && params.size() > 2) {
+                SearchDocument document;
+                document.text = params[2];
+                document.speaker = params[0];
+                auto name = displayNames.find(document.speaker);
+                if (name != displayNames.end()) document.speakerName = name->second;
+                document.label = label;
+                document.source = source;
+                document.line = command.lineNumber;
+                index.Add(std::move(document));
+            } else if (command.type == CommandType::CHOICE) {
+                for (size_t i = 0; i < params.size(); i += 2) {
+                    SearchDocument document;
+                    document.text = params[i];
+                    document.speaker = "@choice";
+                    document.label = label;
+                    document.source = source;
+                    document.line = command.lineNumber;
+                    index.Add(std::move(document));
+                }
+            }
+        }
+    }
+
+    void TextSearchIndex::IndexProject(TextSearchIndex& index, const ScriptProject& project) {
+        // 按模块切开，每个文件的行号和标签各自独立
+        const ScriptCommand* commands = project.GetCommands().data();
+        for (const ScriptModule& module : project.GetModules()) {
+            IndexCommands(index, commands + module.firstCommand,
+                          commands + module.firstCommand + module.commandCount, module.path);
+        }
+    }
+
+    bool TextSearchIndex::Save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            return false;
+        }
+        out.write("VNSI", 4);
+        WritePod(out, kIndexVersion);
+        WritePod(out, firstDocument);
+        WritePod(out, static_cast<uint32_t>(documents.size()));
+        for (const SearchDocument& document : documents) {
+            WriteString(out, document.text);
+            WriteString(out, document.speaker);
+            WriteString(out, document.speakerName);
+            WriteString(out, document.label);
+            WriteString(out, document.source);
+            WritePod(out, static_cast<int32_t>(document.line));
+        }
+        WritePod(out, static_cast<uint32_t>(grams.size()));
+        for (const auto& entry : grams) {
+            WritePod(out, entry.first);
+            WritePostings(out, entry.second);
+        }
+        WriteStringMap(out, speakers);
+        WriteStringMap(out, labels);
+        return static_cast<bool>(out);
+    }
+
+    bool TextSearchIndex::Load(const std::string& path) {
+        Clear();
+        std::ifstream in(path, std::ios::binary);
+        char magic[4];
+        uint32_t version = 0;
+        uint32_t count = 0;
+        if (!in.read(magic, 4) || std::memcmp(magic, "VNSI", 4) != 0 || !ReadPod(in, version) ||
+            version != kIndexVersion || !ReadPod(in, firstDocument) || !ReadPod(in, count)) {
+            Clear();
+            return false;
+        }
+        compactedBefore = firstDocument;
+        for (uint32_t i = 0; i < count; ++i) {
+            SearchDocument document;
+            int32_t line = 0;
+            if (!ReadString(in, document.text) || !ReadString(in, document.speaker) ||
+                !ReadString(in, document.speakerName) || !ReadString(in, document.label) ||
+                !ReadString(in, document.source) || !ReadPod(in, line)) {
+                Clear();
+                return false;
+            }
+            document.line = line;
+            documents.push_back(std::move(document));
+        }
+
+        uint32_t gramCount = 0;
+        bool ok = ReadPod(in, gramCount);
+        grams.reserve(gramCount);
+        for (uint32_t i = 0; ok && i < gramCount; ++i) {
+            uint64_t gram = 0;
+            ok = ReadPod(in, gram) && ReadPostings(in, grams[gram]);
+        }
+        ok = ok && ReadStringMap(in, speakers) && ReadStringMap(in, labels);
+
+        // 倒排表必须有序且不越界，否则查询会访问不存在的文档
+        uint32_t end = GetEndDocument();
+        auto valid = [end](const std::vector<uint32_t>& postings) {
+            return std::is_sorted(postings.begin(), postings.end()) && (postings.empty() || postings.back() < end);
+        };
+        for (const auto& entry : grams) ok = ok && valid(entry.second);
+        for (const auto& entry : speakers) ok = ok && valid(entry.second);
+        for (const auto& entry : labels) ok = ok && valid(entry.second);
+        if (!ok) {
+            Clear();
+        }
+        return ok;
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,100 @@
+#include "ThumbnailWriter.h"
+#include <filesystem>
+#include <iostream>
+
+namespace VisualNovel {
+
+    ThumbnailWriter::ThumbnailWriter(const std::string& assetRoot, int referenceWidth)
+        : compositor(referenceWidth), busy(false), stopping(false), writtenCount(0), failedCount(0) {
+        compositor.SetAssetRoot(assetRoot);
+        worker = std::thread([this]() { Run(); });
+    }
+
+    ThumbnailWriter::ThumbnailWriter(SoftwareCompositor::TextureLoader loader, int referenceWidth)
+        : compositor(referenceWidth), busy(false), stopping(false), writtenCount(0), failedCount(0) {
+        compositor.SetTextureLoader(std::move(loader));
+        worker = std::thread([this]() { Run(); });
+    }
+
+    ThumbnailWriter::~ThumbnailWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    void ThumbnailWriter::Submit(SceneSnapshot scene, const std::string& path, int width, int height) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bool replaced = false;
+            for (Job& job : pending) {
+                if (job.path == path) {
+                    job.scene = std::move(scene);
+                    job.width = width;
+                    job.height = height;
+                    replaced = true;
+                    break;
+                }
+            }
+            if (!replaced) {
+                pending.push_back(Job{std::move(scene), path, width, height});
+            }
+        }
+        wake.notify_one();
+    }
+
+    void ThumbnailWriter::Flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return pending.empty() && !busy; });
+    }
+
+    uint64_t ThumbnailWriter::GetWrittenCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return writtenCount;
+    }
+
+    uint64_t ThumbnailWriter::GetFailedCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return failedCount;
+    }
+
+    void ThumbnailWriter::Run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty()) {
+                return;  // 正在停止且没有剩余任务
+            }
+            Job job = std::move(pending.front());
+            pending.pop_front();
+            busy = true;
+            lock.unlock();
+
+            SoftwareImage image(job.width, job.height);
+            compositor.Render(job.scene, image);
+            for (const std::string& name : compositor.GetMissingTextures()) {
+                if (!reportedMissing.insert(name).second) continue;
+                std::cerr << "[缩略图] 找不到纹理: " << name << std::endl;
+            }
+            std::filesystem::path parent = std::filesystem::path(job.path).parent_path();
+            std::error_code error;
+            if (!parent.empty()) {
+                std::filesystem::create_directories(parent, error);
+            }
+            bool saved = SaveImageFile(job.path, image);
+            if (!saved) {
+                std::cerr << "[缩略图] 无法写入 " << job.path << std::endl;
+            }
+
+            lock.lock();
+            busy = false;
+            ++(saved ? writtenCount : failedCount);
+            if (pending.empty()) {
+                idle.notify_all();
+            }
+        }
+    }
+
+} // namespace VisualNovel
@@ -0,0 +1,238 @@
+#include "TweenSystem.h"
+#include <algorithm>
+#include <array>
+
+namespace VisualNovel {
+
+    namespace {
+        constexpr size_t kTableSegments = 256;
+        constexpr size_t kEasingCount = static_cast<size_t>(Easing::Count);
+
+        constexpr float EasingFunction(Easing easing, float t) {
+            switch (easing) {
+                case Easing::LINEAR:           return t;
+                case Easing::EASE_IN_QUAD:     return t * t;
+                case Easing::EASE_OUT_QUAD:    return t * (2.0f - t);
+                case Easing::EASE_IN_OUT_QUAD:
+                    return t < 0.5f ? 2.0f * t * t : 1.0f - (2.0f - 2.0f * t) * (2.0f - 2.0f * t) * 0.5f;
+                case Easing::EASE_IN_CUBIC:    return t * t * t;
+                case Easing::EASE_OUT_CUBIC:   return 1.0f - (1.0f - t) * (1.0f - t) * (1.0f - t);
+                case Easing::EASE_IN_OUT_CUBIC:
+                    return t < 0.5f ? 4.0f * t * t * t
+                                    : 1.0f - (2.0f - 2.0f * t) * (2.0f - 2.0f * t) * (2.0f - 2.0f * t) * 0.5f;
+                case Easing::EASE_OUT_BACK: {
+                    const float c1 = 1.70158f;
+                    const float u = t - 1.0f;
+                    return 1.0f + (c1 + 1.0f) * u * u * u + c1 * u * u;
+                }
+                case Easing::SMOOTHSTEP:       return t * t * (3.0f - 2.0f * t);
+                case Easing::Count:            break;
+            }
+            return t;
+        }
+
+        // 每条曲线 256 段，多存一个终点方便插值
+        using EasingTables = std::array<std::array<float, kTableSegments + 1>, kEasingCount>;
+
+        constexpr EasingTables BakeEasingTables() {
+            EasingTables tables{};
+            for (size_t curve = 0; curve < kEasingCount; ++curve) {
+                for (size_t i = 0; i <= kTableSegments; ++i) {
+                    tables[curve][i] = EasingFunction(static_cast<Easing>(curve), static_cast<float>(i) / kTableSegments);
+                }
+            }
+            return tables;
+        }
+
+        constexpr EasingTables kEasingTables = BakeEasingTables();
+
+        inline float Lookup(Easing easing, float t) {
+            const std::array<float, kTableSegments + 1>& table = kEasingTables[static_cast<size_t>(easing)];
+            float position = t * kTableSegments;
+            size_t index = static_cast<size_t>(position);
+            if (index >= kTableSegments) {
+                return table[kTableSegments];
+            }
+            float fraction = position - static_cast<float>(index);
+            return table[index] + (table[index + 1] - table[index]) * fraction;
+        }
+
+        // 时长为 0 时也要走一次 Update 才到终点，用极短的时长代替
+        const float kMinimumDuration = 1e-6f;
+    }
+
+    float EvaluateEasing(Easing easing, float t) {
+        return Lookup(easing, std::min(std::max(t, 0.0f), 1.0f));
+    }
+
+    TweenSystem::TweenSystem(size_t capacity)
+        : nextId(1) {
+        targets.reserve(capacity);
+        mirrors.reserve(capacity);
+        owners.reserve(capacity);
+        from.reserve(capacity);
+        delta.reserve(capacity);
+        elapsed.reserve(capacity);
+        inverseDuration.reserve(capacity);
+        easings.reserve(capacity);
+        ids.reserve(capacity);
+        tags.reserve(capacity);
+        userData.reserve(capacity);
+        events.reserve(capacity);
+    }
+
+    uint32_t TweenSystem::Add(const TweenDesc& desc) {
+        if (!desc.target) {
+            return 0;
+        }
+        CancelTarget(desc.target);
+
+        uint32_t id = nextId++;
+        if (nextId == 0) {
+            nextId = 1;
+        }
+        targets.push_back(desc.target);
+        mirrors.push_back(desc.mirror);
+        owners.push_back(desc.owner);
+        from.push_back(desc.from);
+        delta.push_back(desc.to - desc.from);
+        elapsed.push_back(-std::max(desc.delay, 0.0f));
+        inverseDuration.push_back(1.0f / std::max(desc.duration, kMinimumDuration));
+        easings.push_back(desc.easing < Easing::Count ? desc.easing : Easing::LINEAR);
+        ids.push_back(id);
+        tags.push_back(desc.tag);
+        userData.push_back(desc.userData);
+        return id;
+    }
+
+    uint32_t TweenSystem::To(float* target, float to, float duration, Easing easing) {
+        if (!target) {
+            return 0;
+        }
+        TweenDesc desc;
+        desc.target = target;
+        desc.from = *target;
+        desc.to = to;
+        desc.duration = duration;
+        desc.easing = easing;
+        return Add(desc);
+    }
+
+    bool TweenSystem::Cancel(uint32_t id) {
+        auto it = std::find(ids.begin(), ids.end(), id);
+        if (it == ids.end()) {
+            return false;
+        }
+        Remove(static_cast<size_t>(it - ids.begin()), true);
+        return true;
+    }
+
+    size_t TweenSystem::CancelTarget(const float* target) {
+        size_t removed = 0;
+        for (size_t i = 0; i < targets.size();) {
+            if (targets[i] == target) {
+                Remove(i, true);
+                ++removed;
+            } else {
+                ++i;
+            }
+        }
+        return removed;
+    }
+
+    size_t TweenSystem::CancelOwner(const void* owner) {
+        size_t removed = 0;
+        for (size_t i = 0; i < owners.size();) {
+            if (owner && owners[i] == owner) {
+                Remove(i, true);
+                ++removed;
+            } else {
+                ++i;
+            }
+        }
+        return removed;
+    }
+
+    void TweenSystem::FinishAll() {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            float value = from[i] + delta[i];
+            *targets[i] = value;
+            if (mirrors[i]) {
+                *mirrors[i] = value;
+            }
+            events.push_back(TweenEvent{ids[i], tags[i], userData[i], false});
+        }
+        Clear();
+    }
+
+    void TweenSystem::Clear() {
+        targets.clear();
+        mirrors.clear();
+        owners.clear();
+        from.clear();
+        delta.clear();
+        elapsed.clear();
+        inverseDuration.clear();
+        easings.clear();
+        ids.clear();
+        tags.clear();
+        userData.clear();
+    }
+
+    bool TweenSystem::IsActive(uint32_t id) const {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+
+    void TweenSystem::Update(float deltaTime) {
+        for (size_t i = 0; i < ids.size();) {
+            float time = elapsed[i] + deltaTime;
+            elapsed[i] = time;
+            if (time < 0.0f) {
+                ++i;  // 还在延迟中
+                continue;
+            }
+            float t = time * inverseDuration[i];
+            bool done = t >= 1.0f;
+            float value = from[i] + delta[i] * (done ? 1.0f : Lookup(easings[i], t));
+            *targets[i] = value;
+            if (mirrors[i]) {
+                *mirrors[i] = value;
+            }
+            if (done) {
+                Remove(i, false);  // 最后一个换到 i，不前进
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    void TweenSystem::Remove(size_t index, bool cancelled) {
+        events.push_back(TweenEvent{ids[index], tags[index], userData[index], cancelled});
+        size_t last = ids.size() - 1;
+        if (index != last) {
+            targets[index] = targets[last];
+            mirrors[index] = mirrors[last];
+            owners[index] = owners[last];
+            from[index] = from[last];
+            delta[index] = delta[last];
+            elapsed[index] = elapsed[last];
+            inverseDuration[index] = inverseDuration[last];
+            easings[index] = easings[last];
+            ids[index] = ids[last];
+            tags[index] = tags[last];
+            userData[index] = userData[last];
+        }
+        targets.pop_back();
+        mirrors.pop_back();
+        owners.pop_back();
+        from.pop_back();
+        delta.pop_back();
+        elapsed.pop_back();
+        inverseDuration.pop_back();
+        easings.pop_back();
+        ids.pop_back();
+        tags.pop_back();
+        userData.pop_back();
+    }
+
+} // namespace VisualNovel
@@ -1,24 +1,83 @@
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <vector>
 #include <SDL2/SDL.h>
 #include "VisualNovelEngine.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "HotReloader.h"
+#include "Localization.h"
+#include "ThumbnailWriter.h"
+#include "AudioMixer.h"
 
 using namespace VisualNovel;
 
+// 当前背景：更新线程在 BACKGROUND 事件中记录，存档时也在更新线程中读取
+std::string& GetCurrentBackground() {
+    static std::string background;
+    return background;
+}
+
+// 控制台命令中需要读取引擎状态的部分：控制台线程投递后等待结果，更新线程每帧开始时执行
+class EngineTaskQueue {
+private:
+    std::mutex mutex;
+    std::vector<std::function<void()>> pending;
+    std::vector<std::function<void()>> running;
+
+public:
+    // 在更新线程执行 task 并返回它的结果，只能在其他线程调用
+    template <typename Task>
+    auto Run(Task task) -> decltype(task()) {
+        std::packaged_task<decltype(task())()> packaged(std::move(task));
+        auto result = packaged.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.emplace_back([&packaged]() { packaged(); });
+        }
+        return result.get();
+    }
+
+    // 只在更新线程调用
+    void Execute() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running.swap(pending);
+        }
+        for (std::function<void()>& task : running) {
+            task();
+        }
+        running.clear();
+    }
+};
+
+EngineTaskQueue& GetEngineTasks() {
+    static EngineTaskQueue tasks;
+    return tasks;
+}
+
 // 简单的控制台界面模拟
 class ConsoleInterface {
 private:
     VisualNovelEngine* engine;
     bool running;
+    ThumbnailWriter thumbnails;  // 纹理路径相对 data 目录
     
 public:
-    ConsoleInterface(VisualNovelEngine* eng) : engine(eng), running(true) {}
+    ConsoleInterface(VisualNovelEngine* eng) : engine(eng), running(true), thumbnails("data") {}
     
     void Run() {
         std::cout << "=== 视觉小说引擎控制台 ===" << std::endl;
-        std::cout << "命令: next, skip, menu, save, load, quit" << std::endl;
+        std::cout << "命令: next, skip, menu, save, load, profile, trace, metrics, lang, search, quit" << std::endl;
         
         while (running) {
             std::cout << "\n> ";
@@ -37,10 +96,22 @@ public:
         } else if (cmd == "menu" || cmd == "m") {
             engine->ShowMenu();
         } else if (cmd == "save") {
-            engine->SaveGame(0, "手动存档");
+            {
+                ScopedMetricTimer timer(EngineMetrics::Get().saveLatency);
+                engine->SaveGame(0, "手动存档");
+                // 存档只复制一份画面快照，缩略图在后台线程合成和写出；
+                // 渲染列表随更新线程的补间变化，快照在更新线程的帧间取得
+                SceneSnapshot scene = GetEngineTasks().Run([this]() {
+                    return CaptureScene(engine->GetCharacterRenderer().GetRenderList(), GetCurrentBackground());
+                });
+                thumbnails.Submit(std::move(scene), "saves/slot_0.png");
+            }
             std::cout << "游戏已保存" << std::endl;
         } else if (cmd == "load") {
-            engine->LoadGame(0);
+            {
+                ScopedMetricTimer timer(EngineMetrics::Get().loadLatency);
+                engine->LoadGame(0);
+            }
             std::cout << "游戏已加载" << std::endl;
         } else if (cmd == "quit" || cmd == "q") {
             running = false;
@@ -50,46 +121,169 @@ public:
             std::cout << "启用自动播放" << std::endl;
         } else if (cmd == "history" || cmd == "h") {
             engine->ShowHistory();
+        } else if (cmd == "profile on" || cmd == "profile off") {
+            Profiler::Instance().SetEnabled(cmd == "profile on");
+            std::cout << "性能追踪已" << (cmd == "profile on" ? "开启" : "关闭") << std::endl;
+        } else if (cmd == "profile") {
+            Profiler::Instance().PrintSummary(std::cout);
+        } else if (cmd == "metrics") {
+            MetricsRegistry::Instance().WriteJson(std::cout);
+        } else if (cmd == "lang") {
+            const std::string& language = Localization::Instance().GetLanguage();
+            std::cout << "当前语言: " << (language.empty() ? "原文" : language) << std::endl;
+        } else if (cmd.compare(0, 5, "lang ") == 0) {
+            // 在更新线程的下一帧切换，当前台词随之改为新语言
+            std::string language = cmd.substr(5);
+            Localization::Instance().RequestLanguage(language == "source" ? "" : language);
+            std::cout << "切换语言: " << language << std::endl;
+        } else if (cmd.compare(0, 7, "search ") == 0) {
+            // search 关键词 [@角色]：在历史记录中查找，最近的在前
+            SearchQuery query;
+            std::string arguments = cmd.substr(7);
+            size_t at = arguments.find(" @");
+            if (at != std::string::npos) {
+                query.speaker = arguments.substr(at + 2);
+                arguments.resize(at);
+            }
+            query.text = arguments;
+            query.limit = 20;
+            // 索引随更新线程记录的台词增长，搜索和读取结果都在更新线程中完成
+            std::string results = GetEngineTasks().Run([this, &query]() {
+                std::ostringstream out;
+                for (const SearchHit& hit : engine->GetDialogueSystem().SearchHistory(query)) {
+                    const SearchDocument& entry = *hit.entry;
+                    out << (entry.speakerName.empty() ? entry.speaker : entry.speakerName) << ": "
+                        << entry.text << "\n";
+                }
+                return out.str();
+            });
+            std::cout << results << std::flush;
+        } else if (cmd == "trace") {
+            if (Profiler::Instance().DumpChromeTrace("trace.json")) {
+                std::cout << "追踪已写入 trace.json" << std::endl;
+            }
         } else {
             std::cout << "未知命令" << std::endl;
         }
     }
 };
 
-// 文本显示回调示例
-void OnTextDisplay(const std::string& text) {
-    std::cout << "\n--- 对话 ---" << std::endl;
-    std::cout << text << std::endl;
-    std::cout << "-------------" << std::endl;
+// 每帧事件处理示例：引擎 Update 之后一次取出本帧的全部事件
+void OnEngineEvent(const EngineEvent& event, CharacterRenderer& renderer, AudioMixer& audio, bool voiceEnabled) {
+    switch (event.type) {
+        case EngineEventType::TEXT:
+            std::cout << "\n--- 对话 ---\n" << event.value << "\n-------------" << std::endl;
+            break;
+        case EngineEventType::BACKGROUND: {
+            std::cout << "[背景切换: " << event.value << "]" << std::endl;
+            GetCurrentBackground() = "backgrounds/" + std::string(event.value);
+            break;
+        }
+        case EngineEventType::BGM:
+            std::cout << "[播放BGM: " << event.value << "]" << std::endl;
+            audio.PlayBgm(std::string(event.value));
+            break;
+        case EngineEventType::BGM_STOP:
+            std::cout << "[停止BGM]" << std::endl;
+            audio.StopBgm();
+            break;
+        case EngineEventType::SOUND:
+            std::cout << "[音效: " << event.value << "]" << std::endl;
+            audio.PlaySound(std::string(event.value));
+            break;
+        case EngineEventType::CHOICE:
+            std::cout << "\n*** 请做出选择 ***" << std::endl;
+            break;
+        case EngineEventType::VOICE:
+            // 与台词同一帧交给混音器，下一块混音即开始发声；没有语音的台词停掉上一句
+            if (event.value.empty()) {
+                audio.StopVoice();
+            } else if (voiceEnabled) {
+                audio.PlayVoice(std::string(event.value));
+            }
+            break;
+        case EngineEventType::CHARACTER_SHOW: {
+            // 角色、位置、表情在脚本解析时已经驻留，这里只按 Atom 查找；配置路径只在第一次登场时拼接
+            Atom id = event.atoms[0];
+            CharacterSprite* sprite = renderer.GetCharacter(id);
+            if (!sprite && id != Atom::NONE) {
+                sprite = renderer.CreateCharacter(id, "data/characters/" + Atoms::GetName(id) + ".json");
+            }
+            if (sprite) {
+                renderer.SetCharacterPosition(id, event.atoms[1]);
+                sprite->SetExpression(event.atoms[2]);
+            }
+            break;
+        }
+        case EngineEventType::CHARACTER_HIDE:
+            renderer.RemoveCharacter(event.atoms[0]);
+            break;
+        case EngineEventType::Count:
+            break;
+    }
 }
 
-// 背景切换回调示例
-void OnBackgroundChange(const std::string& bgName) {
-    std::cout << "[背景切换: " << bgName << "]" << std::endl;
-}
+// 角色配置热重载：在场的角色换成按新配置创建的精灵，位置、缩放、图层和表情保持不变。
+// 配置已在监视线程中读取和解析，这里只做替换
+void ReloadCharacter(CharacterRenderer& renderer, std::unique_ptr<CharacterSprite> reloaded) {
+    Atom id = reloaded->GetCharacterAtom();
+    CharacterSprite* sprite = renderer.GetCharacter(id);
+    if (!sprite) {
+        return;  // 不在场上的角色下次登场时自然读取新配置
+    }
+    glm::vec2 position = sprite->GetRenderPosition();
+    float scale = sprite->GetRenderScale();
+    CharacterPosition positionInfo = sprite->GetPositionInfo();
+    Atom expression = sprite->GetExpressionAtom();
 
-// BGM播放回调示例
-void OnBgmPlay(const std::string& bgmName) {
-    std::cout << "[播放BGM: " << bgmName << "]" << std::endl;
+    reloaded->SetPosition(position);
+    reloaded->SetScale(scale);
+    reloaded->SetDepth(positionInfo.depth);
+    reloaded->SetLayer(positionInfo.layer);
+    reloaded->SetExpression(expression);
+    renderer.AdoptCharacter(id, std::move(reloaded));
+    std::cout << "[热重载] 角色 " << Atoms::GetName(id) << " 已更新" << std::endl;
 }
 
-// 选择支显示回调示例
-void OnChoicePresent() {
-    std::cout << "\n*** 请做出选择 ***" << std::endl;
+// 异步命令示例：@preload 文件... 在后台线程读入资源文件，读完后脚本才继续，更新线程不被阻塞
+void RegisterPreloadCommand(ScriptInterpreter& interpreter) {
+    interpreter.RegisterAsyncCommand("preload", [](const std::vector<std::string>& files, ScriptContinuation done) {
+        std::thread([files, done]() {
+            for (const std::string& file : files) {
+                std::ifstream stream(file, std::ios::binary);
+                if (!stream) {
+                    std::cerr << "[preload] 找不到资源: " << file << std::endl;
+                    continue;
+                }
+                char buffer[64 * 1024];
+                while (stream.read(buffer, sizeof(buffer))) {}
+            }
+            done.Resume();
+        }).detach();
+    });
 }
 
 int main() {
     std::cout << "启动视觉小说引擎..." << std::endl;
+
+    // VN_PROFILE=1 时从启动开始追踪；超过两帧预算的帧自动导出追踪
+    Profiler& profiler = Profiler::Instance();
+    profiler.SetEnabled(std::getenv("VN_PROFILE") != nullptr);
+    profiler.SetFrameBudget(33.0, "trace_over_budget.json");
+
+    // VN_METRICS=文件 时每5秒追加一行指标快照
+    if (const char* metricsPath = std::getenv("VN_METRICS")) {
+        MetricsRegistry::Instance().StartPeriodicDump(metricsPath, 5.0);
+    }
+    
+    // VN_LANG=代码 时使用 data/lang/<代码>.vnst，否则显示脚本原文
+    if (const char* language = std::getenv("VN_LANG")) {
+        Localization::Instance().SetLanguage(language);
+    }
     
     // 创建引擎实例
     auto engine = std::make_unique<VisualNovelEngine>();
     
-    // 设置回调
-    engine->SetTextCallback(OnTextDisplay);
-    engine->SetBackgroundCallback(OnBackgroundChange);
-    engine->SetBgmCallback(OnBgmPlay);
-    engine->SetChoiceCallback(OnChoicePresent);
-    
     // 初始化引擎
     if (!engine->Initialize("config/game_config.ini")) {
         std::cerr << "引擎初始化失败!" << std::endl;
@@ -98,23 +292,97 @@ int main() {
     
     std::cout << "引擎初始化成功!" << std::endl;
     
+    // 通知改为每帧一次的事件流，代替逐个事件的回调
+    engine->EnableEventStream();
+    
+    RegisterPreloadCommand(engine->GetScriptInterpreter());
+    
+    // VN_AOT_SCRIPTS 构建中已编译进程序的脚本直接执行；VN_INTERPRET_SCRIPTS 时总是解析脚本文件
+    if (std::getenv("VN_INTERPRET_SCRIPTS") != nullptr) {
+        engine->GetScriptInterpreter().SetUseCompiledScripts(false);
+    }
+    
     // 启动游戏
     std::cout << "开始游戏..." << std::endl;
     engine->StartGame("data/scripts/prologue.txt");
     
+    // 脚本和角色配置保存后自动生效，不必重启；VN_NO_HOT_RELOAD 关闭
+    HotReloader reloader;
+    reloader.WatchScript("data/scripts/prologue.txt");
+    reloader.WatchCharacters("data/characters");
+    reloader.SetCharacterReloadHandler([&engine](const std::string&, std::unique_ptr<CharacterSprite> sprite) {
+        ReloadCharacter(engine->GetCharacterRenderer(), std::move(sprite));
+    });
+    if (std::getenv("VN_NO_HOT_RELOAD") == nullptr) {
+        reloader.Start();
+    }
+    
+    // 音频：data/audio 下的 WAV 按块流式解码后混音。VN_AUDIO_WAV=文件 时把混音结果写入 WAV，
+    // 否则输出到空设备（只按时长节拍混音，用于没有声卡的环境）
+    AudioConfig audioConfig;
+    audioConfig.assetRoot = "data/audio";
+    AudioMixer audio(audioConfig);
+    const GameSettings& settings = engine->GetSettings();
+    audio.SetBusVolume(AudioBus::BGM, settings.bgmVolume);
+    audio.SetBusVolume(AudioBus::SE, settings.seVolume);
+    audio.SetBusVolume(AudioBus::VOICE, settings.voiceVolume);
+    std::unique_ptr<AudioOutput> audioOutput;
+    if (const char* wavPath = std::getenv("VN_AUDIO_WAV")) {
+        audioOutput = std::make_unique<WavFileAudioOutput>(wavPath);
+    } else {
+        audioOutput = std::make_unique<NullAudioOutput>();
+    }
+    if (!audio.Start(std::move(audioOutput))) {
+        std::cerr << "音频输出初始化失败，继续无声运行" << std::endl;
+    }
+    
     // 创建控制台界面
     ConsoleInterface console(engine.get());
     
-    // 在主线程中运行引擎更新
-    std::thread engineThread([&engine]() {
+    // 在单独的更新线程中运行引擎更新；它引用的引擎、热重载和音频在线程结束后才销毁
+    std::atomic<bool> engineRunning(true);
+    std::thread engineThread([&engine, &reloader, &audio, &engineRunning]() {
         auto lastTime = std::chrono::high_resolution_clock::now();
+        FrameAllocationTracker allocations;
         
-        while (true) {
+        while (engineRunning.load(std::memory_order_relaxed)) {
             auto currentTime = std::chrono::high_resolution_clock::now();
             auto deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
             lastTime = currentTime;
             
-            engine->Update(deltaTime);
+            Profiler::Instance().BeginFrame();
+            {
+                // 控制台命令的分配不计入帧分配统计
+                VN_TRACE_ZONE(ENGINE, "EngineTasks::Execute");
+                GetEngineTasks().Execute();
+            }
+            allocations.BeginFrame();
+            {
+                VN_TRACE_ZONE(ENGINE, "HotReloader::Apply");
+                reloader.Apply(engine->GetScriptInterpreter());
+            }
+            Localization::Instance().ApplyPendingLanguage();
+            {
+                VN_TRACE_ZONE(ENGINE, "VisualNovelEngine::Update");
+                engine->Update(deltaTime);
+            }
+            {
+                VN_TRACE_ZONE(ENGINE, "CharacterRenderer::UpdateTweens");
+                engine->GetCharacterRenderer().UpdateTweens(deltaTime);
+            }
+            {
+                VN_TRACE_ZONE(CALLBACK, "DrainEvents");
+                bool voiceEnabled = engine->GetSettings().voiceEnabled;
+                CharacterRenderer& renderer = engine->GetCharacterRenderer();
+                engine->DrainEvents([&renderer, &audio, voiceEnabled](const EngineEvent& event) {
+                    OnEngineEvent(event, renderer, audio, voiceEnabled);
+                });
+            }
+            audio.CollectFinished();
+            MetricsRegistry::Instance().SetGauge(EngineMetrics::Get().liveSprites,
+                static_cast<int64_t>(engine->GetCharacterRenderer().GetCharacterCount()));
+            allocations.EndFrame();
+            Profiler::Instance().EndFrame();
             
             // 控制更新频率
             std::this_thread::sleep_for(std::chrono::milliseconds(16)); // ~60 FPS
@@ -124,8 +392,11 @@ int main() {
     // 运行控制台
     console.Run();
     
-    // 清理
-    engineThread.detach();
+    // 清理：先等更新线程结束当前帧，再停止它使用的热重载和音频
+    engineRunning.store(false, std::memory_order_relaxed);
+    engineThread.join();
+    reloader.Stop();
+    MetricsRegistry::Instance().StopPeriodicDump();
     
     std::cout << "游戏结束，感谢游玩!" << std::endl;
     return 0;
@@ -0,0 +1,143 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "SoftwareCompositor.h"
+
+using namespace VisualNovel;
+
+// 场景离线渲染工具：不需要 GPU，用于生成和比对基准图像
+// 用法: scene_render <场景文件> [输出.png|.pam] [--assets 资源目录] [--golden 基准图像] [--scalar]
+// 场景文件每行一条，# 开头为注释：
+//   canvas 宽 高
+//   background 纹理
+//   sprite 纹理 x y 深度 缩放 [u v 宽 高]
+// 指定 --golden 时与基准图像逐字节比较，不一致返回 1（基准图像建议用 .pam 保存）
+
+static void PrintUsage(const char* program) {
+    std::cerr << "用法: " << program
+              << " <场景文件> [输出.png|.pam] [--assets 资源目录] [--golden 基准图像] [--scalar]" << std::endl;
+}
+
+static bool ParseScene(std::istream& input, SceneSnapshot& scene, int& width, int& height, std::string& error) {
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        std::istringstream fields(line);
+        std::string keyword;
+        if (!(fields >> keyword) || keyword[0] == '#') {
+            continue;
+        }
+        bool valid = true;
+        if (keyword == "canvas") {
+            valid = static_cast<bool>(fields >> width >> height) && width > 0 && height > 0;
+        } else if (keyword == "background") {
+            valid = static_cast<bool>(fields >> scene.background);
+        } else if (keyword == "sprite") {
+            SceneSprite sprite;
+            valid = static_cast<bool>(fields >> sprite.texture >> sprite.x >> sprite.y >> sprite.depth >> sprite.scale);
+            float u, v, uw, vh;
+            if (valid && fields >> u >> v >> uw >> vh) {
+                sprite.u = u;
+                sprite.v = v;
+                sprite.uw = uw;
+                sprite.vh = vh;
+            }
+            scene.sprites.push_back(sprite);
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            error = "第 " + std::to_string(lineNumber) + " 行无法解析: " + line;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string scenePath;
+    std::string outputPath;
+    std::string assetRoot;
+    std::string goldenPath;
+    bool scalar = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--assets" && i + 1 < argc) assetRoot = argv[++i];
+        else if (arg == "--golden" && i + 1 < argc) goldenPath = argv[++i];
+        else if (arg == "--scalar") scalar = true;
+        else if (arg.compare(0, 2, "--") != 0 && scenePath.empty()) scenePath = arg;
+        else if (arg.compare(0, 2, "--") != 0 && outputPath.empty()) outputPath = arg;
+        else {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (scenePath.empty() || (outputPath.empty() && goldenPath.empty())) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    std::ifstream input(scenePath);
+    if (!input) {
+        std::cerr << "无法打开场景文件: " << scenePath << std::endl;
+        return 1;
+    }
+    SceneSnapshot scene;
+    int width = 1280, height = 720;
+    std::string error;
+    if (!ParseScene(input, scene, width, height, error)) {
+        std::cerr << scenePath << ": " << error << std::endl;
+        return 1;
+    }
+
+    SoftwareCompositor compositor;
+    compositor.SetAssetRoot(assetRoot);
+    compositor.SetUseSimd(!scalar);
+    SoftwareImage image(width, height);
+    compositor.Render(scene, image);
+    for (const std::string& name : compositor.GetMissingTextures()) {
+        std::cerr << "找不到纹理: " << name << std::endl;
+    }
+    if (!compositor.GetMissingTextures().empty()) {
+        return 1;
+    }
+
+    if (!outputPath.empty() && !SaveImageFile(outputPath, image)) {
+        std::cerr << "无法写入 " << outputPath << std::endl;
+        return 1;
+    }
+
+    if (!goldenPath.empty()) {
+        SoftwareImage golden;
+        if (!LoadImageFile(goldenPath, golden, &error)) {
+            std::cerr << goldenPath << ": " << error << std::endl;
+            return 1;
+        }
+        if (golden.width != image.width || golden.height != image.height) {
+            std::cerr << "尺寸不一致: 基准 " << golden.width << "x" << golden.height << "，渲染 "
+                      << image.width << "x" << image.height << std::endl;
+            return 1;
+        }
+        size_t differentPixels = 0;
+        int maxDifference = 0;
+        for (size_t i = 0; i < image.pixels.size(); i += 4) {
+            bool different = false;
+            for (size_t c = 0; c < 4; ++c) {
+                int difference = std::abs(int(image.pixels[i + c]) - int(golden.pixels[i + c]));
+                if (difference > 0) different = true;
+                if (difference > maxDifference) maxDifference = difference;
+            }
+            differentPixels += different;
+        }
+        if (differentPixels > 0) {
+            std::cerr << "与基准图像不一致: " << differentPixels << " 个像素，最大差值 " << maxDifference << std::endl;
+            return 1;
+        }
+        std::cout << "与基准图像一致" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "ScriptCompiler.h"
+
+using namespace VisualNovel;
+
+// 脚本预编译工具
+// 用法: script_compiler <脚本> <输出.cpp> [--source 登记路径]
+// 登记路径是游戏运行时 LoadScript 使用的路径，默认与输入路径相同，
+// 如 CMake 从源码目录编译 data/scripts/prologue.txt 时登记为 data/scripts/prologue.txt。
+// 内容没有变化时不改写输出文件，避免无谓的重新编译
+
+static void PrintUsage(const char* program) {
+    std::cerr << "用法: " << program << " <脚本> <输出.cpp> [--source 登记路径]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputPath;
+    std::string outputPath;
+    std::string sourcePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--source" && i + 1 < argc) sourcePath = argv[++i];
+        else if (arg.compare(0, 2, "--") != 0 && inputPath.empty()) inputPath = arg;
+        else if (arg.compare(0, 2, "--") != 0 && outputPath.empty()) outputPath = arg;
+        else {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (inputPath.empty() || outputPath.empty()) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+    if (sourcePath.empty()) {
+        sourcePath = inputPath;
+    }
+
+    std::ifstream input(inputPath, std::ios::binary);
+    if (!input) {
+        std::cerr << "无法打开脚本文件: " << inputPath << std::endl;
+        return 1;
+    }
+    std::stringstream content;
+    content << input.rdbuf();
+
+    ScriptCompiler compiler;
+    compiler.Parse(content.str(), sourcePath);
+    std::ostringstream generated;
+    if (!compiler.Generate(generated)) {
+        for (const std::string& error : compiler.GetErrors()) {
+            std::cerr << inputPath << ": " << error << std::endl;
+        }
+        return 1;
+    }
+
+    std::ifstream existing(outputPath, std::ios::binary);
+    if (existing) {
+        std::stringstream previous;
+        previous << existing.rdbuf();
+        if (previous.str() == generated.str()) {
+            return 0;
+        }
+    }
+    std::ofstream output(outputPath, std::ios::binary);
+    output << generated.str();
+    if (!output) {
+        std::cerr << "无法写入 " << outputPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include "ScriptGenerator.h"
+
+using namespace VisualNovel;
+
+// 合成脚本生成工具
+// 用法: script_generator [--lines N] [--branching N] [--label-density F] [--choice-ratio F]
+//                        [--variables F] [--conditions F] [--staging F] [--variable-count N]
+//                        [--cast N] [--seed N] [--label-prefix P] [--next-label L] [--out 目录]
+// 指定 --out 时写出 <目录>/scripts/generated.txt 和 <目录>/characters/charN.json，
+// 否则把脚本写到标准输出
+
+static void PrintUsage(const char* program) {
+    std::cerr << "用法: " << program << " [--lines N] [--branching N] [--label-density F] [--choice-ratio F]\n"
+              << "       [--variables F] [--conditions F] [--staging F] [--variable-count N]\n"
+              << "       [--cast N] [--seed N] [--label-prefix P] [--next-label L] [--out 目录]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    ScriptGeneratorOptions options;
+    std::string outDir;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--lines") options.lineCount = std::stoull(value);
+            else if (arg == "--branching") options.branchingFactor = std::stoi(value);
+            else if (arg == "--label-density") options.labelDensity = std::stod(value);
+            else if (arg == "--choice-ratio") options.choiceRatio = std::stod(value);
+            else if (arg == "--variables") options.variableUsage = std::stod(value);
+            else if (arg == "--conditions") options.conditionUsage = std::stod(value);
+            else if (arg == "--staging") options.stagingUsage = std::stod(value);
+            else if (arg == "--variable-count") options.variableCount = std::stoi(value);
+            else if (arg == "--cast") options.castSize = std::stoi(value);
+            else if (arg == "--seed") options.seed = std::stoull(value);
+            else if (arg == "--label-prefix") options.labelPrefix = value;
+            else if (arg == "--next-label") options.nextLabel = value;
+            else if (arg == "--out") outDir = value;
+            else {
+                PrintUsage(argv[0]);
+                return 2;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "参数 " << arg << " 的值无效: " << value << std::endl;
+            return 2;
+        }
+    }
+
+    ScriptGenerator generator(options);
+
+    if (outDir.empty()) {
+        generator.GenerateScript(std::cout);
+        return 0;
+    }
+
+    std::filesystem::path root(outDir);
+    std::filesystem::create_directories(root / "scripts");
+    std::filesystem::create_directories(root / "characters");
+
+    std::ofstream script(root / "scripts" / "generated.txt", std::ios::binary);
+    if (!script) {
+        std::cerr << "无法写入脚本文件" << std::endl;
+        return 1;
+    }
+    generator.GenerateScript(script);
+
+    for (int c = 0; c < generator.GetOptions().castSize; ++c) {
+        std::ofstream config(root / "characters" / (ScriptGenerator::GetCharacterId(c) + ".json"), std::ios::binary);
+        config << generator.GenerateCharacterConfig(c);
+    }
+
+    std::cout << "已生成 " << options.lineCount << " 行脚本和 " << generator.GetOptions().castSize
+              << " 个角色配置到 " << outDir << std::endl;
+    return 0;
+}
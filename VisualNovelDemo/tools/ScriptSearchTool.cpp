@@ -0,0 +1,90 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "ScriptProject.h"
+#include "TextSearchIndex.h"
+
+using namespace VisualNovel;
+
+// 脚本全文检索工具
+// 用法: script_search [--project 目录 | --index 文件] [--save 文件]
+//                     [--speaker 角色] [--label 标签] [--limit N] [关键词]
+// 默认索引 data/scripts 下的全部脚本；--save 把建好的索引写出，之后用 --index 直接载入。
+// 每条结果输出 “文件:行号 [标签] 角色: 台词”
+
+static void PrintUsage(const char* program) {
+    std::cerr << "用法: " << program << " [--project 目录 | --index 文件] [--save 文件]\n"
+              << "       [--speaker 角色] [--label 标签] [--limit N] [关键词]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string projectDirectory = "data/scripts";
+    std::string indexPath;
+    std::string savePath;
+    SearchQuery query;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--project" && hasValue) projectDirectory = argv[++i];
+        else if (arg == "--index" && hasValue) indexPath = argv[++i];
+        else if (arg == "--save" && hasValue) savePath = argv[++i];
+        else if (arg == "--speaker" && hasValue) query.speaker = argv[++i];
+        else if (arg == "--label" && hasValue) query.label = argv[++i];
+        else if (arg == "--limit" && hasValue) {
+            try {
+                query.limit = std::stoul(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "--limit 的值无效: " << argv[i] << std::endl;
+                return 2;
+            }
+        }
+        else if (arg.compare(0, 2, "--") != 0 && query.text.empty()) query.text = arg;
+        else {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    TextSearchIndex index;
+    if (!indexPath.empty()) {
+        if (!index.Load(indexPath)) {
+            std::cerr << "无法载入索引 " << indexPath << std::endl;
+            return 1;
+        }
+    } else {
+        ScriptProject project;
+        project.Load(projectDirectory);
+        for (const std::string& error : project.GetErrors()) {
+            std::cerr << "[错误] " << error << std::endl;
+        }
+        TextSearchIndex::IndexProject(index, project);
+    }
+    double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cerr << index.GetDocumentCount() << " 行已索引 (" << loadMs << " ms)" << std::endl;
+
+    if (!savePath.empty()) {
+        if (!index.Save(savePath)) {
+            std::cerr << "无法写入 " << savePath << std::endl;
+            return 1;
+        }
+        std::cerr << "索引已保存到 " << savePath << std::endl;
+    }
+    if (query.text.empty() && query.speaker.empty() && query.label.empty()) {
+        return 0;
+    }
+
+    start = Clock::now();
+    std::vector<SearchHit> hits = index.Search(query);
+    double searchMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    for (const SearchHit& hit : hits) {
+        const SearchDocument& entry = *hit.entry;
+        const std::string& speaker = entry.speakerName.empty() ? entry.speaker : entry.speakerName;
+        std::cout << entry.source << ":" << entry.line << " [" << entry.label << "] " << speaker << ": "
+                  << entry.text << "\n";
+    }
+    std::cerr << hits.size() << " 条结果 (" << searchMs << " ms)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <future>
+#include <filesystem>
+#include <algorithm>
+#include "ScriptParser.h"
+#include "StoryGraphAnalyzer.h"
+#include "ScriptProject.h"
+
+using namespace VisualNovel;
+
+// 剧情分析工具：对每个脚本构建控制流图，报告不可达节点、循环、路线数与路线长度
+// 用法: story_analyzer <脚本文件或目录>...
+//       story_analyzer --project <目录>   把目录下的全部脚本链接成一个工程整体分析，标签可以跨文件
+// 存在解析错误或未定义标签时返回1，可直接挂到构建流程里
+
+struct AnalysisResult {
+    std::string path;
+    std::string text;
+    bool ok;
+};
+
+static AnalysisResult AnalyzeFile(const std::string& path) {
+    AnalysisResult result{path, "", false};
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        result.text = "无法打开文件\n";
+        return result;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    // 命令只在分析期间使用，从分配区分配后整块丢弃
+    SceneArena arena;
+    ScriptCommandList commands(arena.GetResource());
+    std::map<std::string, ScriptLabel> labels;
+    ScriptParser parser(commands, labels);
+    bool parsed = parser.Parse(buffer.str());
+
+    std::ostringstream out;
+    for (const std::string& error : parser.GetErrors()) {
+        out << "  [错误] " << error << "\n";
+    }
+
+    StoryGraph graph = StoryGraph::FromCommands(commands, labels);
+    StoryGraphReport report = StoryGraphAnalyzer::Analyze(graph);
+    out << StoryGraphAnalyzer::FormatReport(graph, report);
+
+    result.text = out.str();
+    result.ok = parsed && graph.danglingLabels.empty();
+    return result;
+}
+
+static int AnalyzeProject(const std::string& directory) {
+    ScriptProject project;
+    bool linked = project.Load(directory);
+    const ScriptProjectStats& stats = project.GetStats();
+    std::cout << "=== " << directory << " (" << stats.files << " 个文件, " << stats.commands << " 条命令, "
+              << stats.labels << " 个标签) ===\n";
+    for (const std::string& error : project.GetErrors()) {
+        std::cout << "  [错误] " << error << "\n";
+    }
+
+    StoryGraph graph = StoryGraph::FromCommands(project.GetCommands(), project.GetLabels());
+    StoryGraphReport report = StoryGraphAnalyzer::Analyze(graph);
+    std::cout << StoryGraphAnalyzer::FormatReport(graph, report) << std::endl;
+    return linked && graph.danglingLabels.empty() ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: " << argv[0] << " <脚本文件或目录>...\n"
+                  << "      " << argv[0] << " --project <目录>" << std::endl;
+        return 2;
+    }
+    if (std::string(argv[1]) == "--project") {
+        return AnalyzeProject(argc > 2 ? argv[2] : "data/scripts");
+    }
+
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::filesystem::path path(argv[i]);
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                    files.push_back(entry.path().string());
+                }
+            }
+        } else {
+            files.push_back(path.string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    // 每个文件一个任务，结果按文件顺序输出
+    std::vector<std::future<AnalysisResult>> tasks;
+    for (const std::string& file : files) {
+        tasks.push_back(std::async(std::launch::async, AnalyzeFile, file));
+    }
+
+    bool allOk = true;
+    for (auto& task : tasks) {
+        AnalysisResult result = task.get();
+        std::cout << "=== " << result.path << " ===\n" << result.text << std::endl;
+        allOk = allOk && result.ok;
+    }
+
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <set>
+#include <cstdio>
+#include "ScriptParser.h"
+#include "Localization.h"
+
+using namespace VisualNovel;
+
+// 语言表工具
+// 用法: string_table extract <脚本文件或目录>... [--out 文件.tsv]
+//       string_table compile <输入.tsv> <输出.vnst> [--language 代码]
+//
+// extract 列出脚本中全部可翻译文本，每行为 “ID<TAB>上下文<TAB>原文”，
+// 翻译时只需改第三列；compile 把翻译好的 TSV 编译为可直接映射的 .vnst 文件。
+// 文本中的制表符、换行和反斜杠分别写作 \t、\n 和 \\ 两个字符
+
+namespace {
+
+    std::string Escape(std::string_view text) {
+        std::string out;
+        out.reserve(text.size());
+        for (char c : text) {
+            if (c == '\t') out += "\\t";
+            else if (c == '\n') out += "\\n";
+            else if (c == '\\') out += "\\\\";
+            else out += c;
+        }
+        return out;
+    }
+
+    std::string Unescape(std::string_view text) {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '\\' && i + 1 < text.size()) {
+                char next = text[++i];
+                out += next == 't' ? '\t' : next == 'n' ? '\n' : next;
+            } else {
+                out += text[i];
+            }
+        }
+        return out;
+    }
+
+    bool ExtractFile(const std::string& path, std::ostream& out, std::set<uint64_t>& seen) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "无法打开 " << path << std::endl;
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+
+        SceneArena arena;
+        ScriptCommandList commands(arena.GetResource());
+        std::map<std::string, ScriptLabel> labels;
+        ScriptParser parser(commands, labels);
+        bool ok = parser.Parse(buffer.str());
+        for (const std::string& error : parser.GetErrors()) {
+            std::cerr << path << ": " << error << std::endl;
+        }
+
+        std::string name = std::filesystem::path(path).filename().string();
+        for (const ScriptCommand& command : commands) {
+            const ArenaStringList& params = command.parameters;
+            if (command.type == CommandType::DIALOGUE && !command.textIds.empty() && params.size() > 2) {
+                if (seen.insert(command.textIds[0]).second) {
+                    char id[17];
+                    std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(command.textIds[0]));
+                    out << id << '\t' << Escape(name + ":" + std::to_string(command.lineNumber) + " " +
+                                                std::string(params[0]))
+                        << '\t' << Escape(params[2]) << '\n';
+                }
+            } else if (command.type == CommandType::CHOICE) {
+                for (size_t i = 0; i < command.textIds.size() && i * 2 < params.size(); ++i) {
+                    if (!seen.insert(command.textIds[i]).second) continue;
+                    char id[17];
+                    std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(command.textIds[i]));
+                    out << id << '\t' << Escape(name + ":" + std::to_string(command.lineNumber) + " @choice")
+                        << '\t' << Escape(params[i * 2]) << '\n';
+                }
+            }
+        }
+        return ok;
+    }
+
+    int Extract(const std::vector<std::string>& inputs, const std::string& outPath) {
+        std::vector<std::string> files;
+        for (const std::string& input : inputs) {
+            if (std::filesystem::is_directory(input)) {
+                for (const auto& entry : std::filesystem::recursive_directory_iterator(input)) {
+                    if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                        files.push_back(entry.path().generic_string());
+                    }
+                }
+            } else {
+                files.push_back(input);
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        std::ofstream file;
+        if (!outPath.empty()) {
+            file.open(outPath, std::ios::binary);
+            if (!file) {
+                std::cerr << "无法写入 " << outPath << std::endl;
+                return 1;
+            }
+        }
+        std::ostream& out = outPath.empty() ? std::cout : file;
+
+        std::set<uint64_t> seen;
+        bool ok = true;
+        for (const std::string& path : files) {
+            ok = ExtractFile(path, out, seen) && ok;
+        }
+        return ok ? 0 : 1;
+    }
+
+    int Compile(const std::string& inPath, const std::string& outPath, std::string language) {
+        std::ifstream in(inPath, std::ios::binary);
+        if (!in) {
+            std::cerr << "无法打开 " << inPath << std::endl;
+            return 1;
+        }
+        if (language.empty()) {
+            language = std::filesystem::path(inPath).stem().string();
+        }
+
+        std::vector<std::pair<uint64_t, std::string>> entries;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(in, line)) {
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+
+            size_t first = line.find('\t');
+            size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+            if (second == std::string::npos) {
+                std::cerr << inPath << ":" << lineNumber << ": 需要三列" << std::endl;
+                return 1;
+            }
+            uint64_t id = 0;
+            try {
+                id = std::stoull(line.substr(0, first), nullptr, 16);
+            } catch (const std::exception&) {
+                std::cerr << inPath << ":" << lineNumber << ": ID 无效" << std::endl;
+                return 1;
+            }
+            entries.emplace_back(id, Unescape(std::string_view(line).substr(second + 1)));
+        }
+
+        size_t count = entries.size();
+        if (!StringTable::Write(outPath, language, std::move(entries))) {
+            std::cerr << "无法写入 " << outPath << std::endl;
+            return 1;
+        }
+        std::cout << outPath << ": " << language << ", " << count << " 条" << std::endl;
+        return 0;
+    }
+
+    void PrintUsage(const char* program) {
+        std::cerr << "用法: " << program << " extract <脚本文件或目录>... [--out 文件.tsv]\n"
+                  << "      " << program << " compile <输入.tsv> <输出.vnst> [--language 代码]" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+    std::string mode = argv[1];
+    std::vector<std::string> positional;
+    std::string outPath;
+    std::string language;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--out" || arg == "--language") && i + 1 < argc) {
+            (arg == "--out" ? outPath : language) = argv[++i];
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (mode == "extract" && !positional.empty()) {
+        return Extract(positional, outPath);
+    }
+    if (mode == "compile" && positional.size() == 2) {
+        return Compile(positional[0], positional[1], language);
+    }
+    PrintUsage(argv[0]);
+    return 2;
+}
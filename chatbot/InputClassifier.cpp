@@ -0,0 +1,37 @@
+#include "InputClassifier.h"
+#include <algorithm>
+#include <cctype>
+
+InputIntent classifyInput(const std::string& input) {
+    std::string lowercase = input;
+    std::transform(lowercase.begin(), lowercase.end(), lowercase.begin(),
+                  [](unsigned char c){ return std::tolower(c); });
+    
+    if (lowercase.find("你好") != std::string::npos || 
+        lowercase.find("嗨") != std::string::npos ||
+        lowercase.find("hello") != std::string::npos) {
+        return InputIntent::Greeting;
+    }
+    if (lowercase.find("名字") != std::string::npos ||
+        lowercase.find("叫") != std::string::npos) {
+        return InputIntent::AskName;
+    }
+    if (lowercase.find("心情") != std::string::npos ||
+        lowercase.find("感觉") != std::string::npos) {
+        return InputIntent::AskMood;
+    }
+    if (lowercase.find("游戏") != std::string::npos ||
+        lowercase.find("玩") != std::string::npos) {
+        return InputIntent::Game;
+    }
+    if (lowercase.find("再见") != std::string::npos ||
+        lowercase.find("拜拜") != std::string::npos ||
+        lowercase.find("bye") != std::string::npos) {
+        return InputIntent::Farewell;
+    }
+    if (lowercase.find("喜欢") != std::string::npos ||
+        lowercase.find("爱") != std::string::npos) {
+        return InputIntent::Love;
+    }
+    return InputIntent::Daily;
+}
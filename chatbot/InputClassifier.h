@@ -0,0 +1,21 @@
+#pragma once
+#ifndef INPUT_CLASSIFIER_H
+#define INPUT_CLASSIFIER_H
+
+#include <string>
+
+// 输入意图
+enum class InputIntent {
+    Greeting,
+    AskName,
+    AskMood,
+    Game,
+    Farewell,
+    Love,
+    Daily
+};
+
+// 根据关键词判断玩家输入的意图（CuteChatBot 和基准测试共用）
+InputIntent classifyInput(const std::string& input);
+
+#endif // INPUT_CLASSIFIER_H